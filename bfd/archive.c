@@ -1177,6 +1177,127 @@ bfd_slurp_armap (bfd *abfd)
   bfd_has_map (abfd) = FALSE;
   return TRUE;
 }
+
+/* An entry in the symbol index of an archive.  The symdefs are
+   indexed by their names up to any `@', so that looking up a symbol
+   finds all of its versions.  */
+
+struct ar_symbol_index_entry
+{
+  const char *name;
+  size_t len;
+  /* The first symdef with this name.  */
+  symindex first;
+};
+
+static hashval_t
+hash_symbol_index_entry (const void *p)
+{
+  const struct ar_symbol_index_entry *ent
+    = (const struct ar_symbol_index_entry *) p;
+
+  return iterative_hash (ent->name, ent->len, 0);
+}
+
+static int
+eq_symbol_index_entry (const void *p1, const void *p2)
+{
+  const struct ar_symbol_index_entry *ent1
+    = (const struct ar_symbol_index_entry *) p1;
+  const struct ar_symbol_index_entry *ent2
+    = (const struct ar_symbol_index_entry *) p2;
+
+  return (ent1->len == ent2->len
+	  && memcmp (ent1->name, ent2->name, ent1->len) == 0);
+}
+
+/* Build an index of the armap of ABFD by symbol name, unless there
+   is one already.  The index lives as long as the archive, so a
+   linker that searches the same archive several times builds it only
+   once.  Returns FALSE on error, TRUE otherwise.  */
+
+bfd_boolean
+_bfd_archive_build_symbol_index (bfd *abfd)
+{
+  struct artdata *ardata = bfd_ardata (abfd);
+  struct ar_symbol_index_entry *ents;
+  htab_t htab;
+  symindex i;
+
+  if (ardata->symbol_index != NULL)
+    return TRUE;
+
+  htab = htab_create_alloc (ardata->symdef_count, hash_symbol_index_entry,
+			    eq_symbol_index_entry, NULL,
+			    _bfd_calloc_wrapper, free);
+  if (htab == NULL)
+    return FALSE;
+
+  ents = ((struct ar_symbol_index_entry *)
+	  bfd_alloc2 (abfd, ardata->symdef_count, sizeof (*ents)));
+  ardata->symbol_index_next
+    = (symindex *) bfd_alloc2 (abfd, ardata->symdef_count, sizeof (symindex));
+  if (ents == NULL || ardata->symbol_index_next == NULL)
+    {
+      htab_delete (htab);
+      return FALSE;
+    }
+
+  /* Add the symdefs last to first, so that each chain of symdefs with
+     the same name is in armap order.  */
+  for (i = ardata->symdef_count; i-- > 0; )
+    {
+      struct ar_symbol_index_entry *ent = &ents[i];
+      void **slot;
+
+      ent->name = ardata->symdefs[i].name;
+      ent->len = strcspn (ent->name, "@");
+      slot = htab_find_slot (htab, ent, INSERT);
+      if (slot == NULL)
+	{
+	  htab_delete (htab);
+	  return FALSE;
+	}
+      if (*slot == NULL)
+	{
+	  ardata->symbol_index_next[i] = BFD_NO_MORE_SYMBOLS;
+	  *slot = ent;
+	}
+      else
+	{
+	  ent = (struct ar_symbol_index_entry *) *slot;
+	  ardata->symbol_index_next[i] = ent->first;
+	}
+      ent->first = i;
+    }
+
+  ardata->symbol_index = htab;
+  return TRUE;
+}
+
+/* Look up NAME in the index built by _bfd_archive_build_symbol_index.
+   If PREV is BFD_NO_MORE_SYMBOLS, return the first symdef with NAME
+   as its name, ignoring any symbol version, otherwise the one after
+   PREV.  Return BFD_NO_MORE_SYMBOLS when there are no more.  The
+   symdefs are returned in armap order.  */
+
+symindex
+_bfd_archive_symbol_index_lookup (bfd *abfd, const char *name, symindex prev)
+{
+  struct artdata *ardata = bfd_ardata (abfd);
+  struct ar_symbol_index_entry key, *ent;
+
+  if (prev != BFD_NO_MORE_SYMBOLS)
+    return ardata->symbol_index_next[prev];
+
+  key.name = name;
+  key.len = strcspn (name, "@");
+  ent = (struct ar_symbol_index_entry *) htab_find (ardata->symbol_index,
+						     &key);
+  if (ent == NULL)
+    return BFD_NO_MORE_SYMBOLS;
+  return ent->first;
+}
 
 /* Returns FALSE on error, TRUE otherwise.  */
 /* Flavor 2 of a bsd armap, similar to bfd_slurp_bsd_armap except the
@@ -2850,6 +2971,12 @@ _bfd_archive_close_and_cleanup (bfd *abfd)
 	  htab_delete (htab);
 	  bfd_ardata (abfd)->cache = NULL;
 	}
+
+      if (bfd_ardata (abfd)->symbol_index != NULL)
+	{
+	  htab_delete (bfd_ardata (abfd)->symbol_index);
+	  bfd_ardata (abfd)->symbol_index = NULL;
+	}
     }
   if (arch_eltdata (abfd) != NULL)
     {
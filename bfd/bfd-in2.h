@@ -79,6 +79,7 @@ extern "C" {
 
 
 #define BFD_SUPPORTS_PLUGINS @supports_plugins@
+#define BFD_SUPPORTS_THREADS @supports_threads@
 
 /* The word size used by BFD on the host.  This may be 64 with a 32
    bit target if the host is 64 bit, or if other 64 bit targets have
@@ -444,6 +445,37 @@ extern void bfd_hash_traverse
    this size.  */
 extern unsigned long bfd_hash_set_default_size (unsigned long);
 
+/* Make room in a hash table for a number of new entries, so that
+   adding them grows the table at most once.  */
+extern void bfd_hash_table_reserve
+  (struct bfd_hash_table *, unsigned int);
+
+/* Make room in a hash table for a number of new entries right away,
+   for callers which then add them without growing the table.  */
+extern void bfd_hash_table_reserve_now
+  (struct bfd_hash_table *, unsigned int);
+
+/* Statistics about the chains of a hash table.  */
+
+struct bfd_hash_table_stats
+{
+  /* The number of slots in the hash table.  */
+  unsigned int size;
+  /* The number of entries in the hash table.  */
+  unsigned int count;
+  /* The number of slots with at least one entry.  */
+  unsigned int used;
+  /* The length of the longest chain.  */
+  unsigned int longest;
+  /* The number of chains of each length.  The last element counts
+     the chains at least that long.  */
+  unsigned int chains[8];
+};
+
+/* Fill in statistics about the chains of a hash table.  */
+extern void bfd_hash_table_stats
+  (struct bfd_hash_table *, struct bfd_hash_table_stats *);
+
 /* Types of compressed DWARF debug sections.  We currently support
    zlib.  */
 enum compressed_debug_section_type
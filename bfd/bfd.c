@@ -444,7 +444,13 @@ CODE_FRAGMENT
 .
 */
 
+#ifdef ENABLE_THREADS
+/* The input sections of an ELF link may be relocated on several
+   threads, each of which may set the error condition.  */
+static __thread bfd_error_type bfd_error = bfd_error_no_error;
+#else
 static bfd_error_type bfd_error = bfd_error_no_error;
+#endif
 static bfd *input_bfd = NULL;
 static bfd_error_type input_error = bfd_error_no_error;
 
@@ -482,7 +488,8 @@ SYNOPSIS
 	bfd_error_type bfd_get_error (void);
 
 DESCRIPTION
-	Return the current BFD error condition.
+	Return the current BFD error condition.  If BFD was configured
+	with --enable-threads, each thread has its own error condition.
 */
 
 bfd_error_type
@@ -634,30 +641,25 @@ static const char *_bfd_error_program_name;
 	integer_for_the_%d);
  */
 
-void
-_bfd_default_error_handler (const char *fmt, ...)
+/* Expand the %A and %B in FMT, taking their arguments from *AP, as
+   described above.  Return the resulting format, which is either FMT
+   itself or BUF, of ERROR_FMT_SIZE bytes.  */
+
+#define ERROR_FMT_SIZE 1000
+
+static const char *
+error_handler_fmt (const char *fmt, char *buf, va_list *ap)
 {
-  va_list ap;
   char *bufp;
   const char *new_fmt, *p;
-  size_t avail = 1000;
-  char buf[1000];
+  size_t avail = ERROR_FMT_SIZE;
 
-  /* PR 4992: Don't interrupt output being sent to stdout.  */
-  fflush (stdout);
-
-  if (_bfd_error_program_name != NULL)
-    fprintf (stderr, "%s: ", _bfd_error_program_name);
-  else
-    fprintf (stderr, "BFD: ");
-
-  va_start (ap, fmt);
   new_fmt = fmt;
   bufp = buf;
 
   /* Reserve enough space for the existing format string.  */
   avail -= strlen (fmt) + 1;
-  if (avail > 1000)
+  if (avail > ERROR_FMT_SIZE)
     _exit (EXIT_FAILURE);
 
   p = fmt;
@@ -698,7 +700,7 @@ _bfd_default_error_handler (const char *fmt, ...)
 	    {
 	      if (p[1] == 'B')
 		{
-		  bfd *abfd = va_arg (ap, bfd *);
+		  bfd *abfd = va_arg (*ap, bfd *);
 
 		  if (abfd == NULL)
 		    /* Invoking %B with a null bfd pointer is an internal error.  */
@@ -712,7 +714,7 @@ _bfd_default_error_handler (const char *fmt, ...)
 		}
 	      else
 		{
-		  asection *sec = va_arg (ap, asection *);
+		  asection *sec = va_arg (*ap, asection *);
 		  bfd *abfd;
 		  const char *group = NULL;
 		  struct coff_comdat_info *ci;
@@ -781,7 +783,26 @@ _bfd_default_error_handler (const char *fmt, ...)
       p = p + 2;
     }
 
-  vfprintf (stderr, new_fmt, ap);
+  return new_fmt;
+}
+
+void
+_bfd_default_error_handler (const char *fmt, ...)
+{
+  va_list ap;
+  char buf[ERROR_FMT_SIZE];
+
+  /* PR 4992: Don't interrupt output being sent to stdout.  */
+  fflush (stdout);
+
+  if (_bfd_error_program_name != NULL)
+    fprintf (stderr, "%s: ", _bfd_error_program_name);
+  else
+    fprintf (stderr, "BFD: ");
+
+  va_start (ap, fmt);
+  fmt = error_handler_fmt (fmt, buf, &ap);
+  vfprintf (stderr, fmt, ap);
   va_end (ap);
 
   /* On AIX, putc is implemented as a macro that triggers a -Wunused-value
@@ -790,6 +811,23 @@ _bfd_default_error_handler (const char *fmt, ...)
   fflush (stderr);
 }
 
+/* Return the message _bfd_default_error_handler prints for FMT and
+   the arguments in *AP, without the program name and the trailing
+   newline.  The message is allocated with malloc; NULL is returned if
+   memory runs out.  */
+
+char *
+_bfd_error_message (const char *fmt, va_list *ap)
+{
+  char buf[ERROR_FMT_SIZE];
+  char *msg;
+
+  fmt = error_handler_fmt (fmt, buf, ap);
+  if (vasprintf (&msg, fmt, *ap) < 0)
+    return NULL;
+  return msg;
+}
+
 /* This is a function pointer to the routine which should handle BFD
    error messages.  It is called when a BFD routine encounters an
    error for which it wants to print a message.  Going through a
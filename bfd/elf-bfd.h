@@ -1028,6 +1028,20 @@ struct elf_backend_data
      asection *input_section, bfd_byte *contents, Elf_Internal_Rela *relocs,
      Elf_Internal_Sym *local_syms, asection **local_sections);
 
+  /* The RELOCATE_SECTION_CONCURRENTLY function is called by the ELF
+     backend linker before it relocates any input section, when
+     several threads have been requested.  It should return TRUE if
+     RELOCATE_SECTION may be called for different input sections at
+     the same time on different threads for this link: that is, if
+     relocating one input section writes only to its contents and
+     relocs, changes no hash table entry, output section or other
+     shared data, and never returns 2.  Problems reported through
+     _bfd_error_handler and the link callbacks are then held back and
+     passed on in link order.  If this function is NULL, or returns
+     FALSE, the input sections are relocated one at a time.  */
+  bfd_boolean (*elf_backend_relocate_section_concurrently)
+    (bfd *output_bfd, struct bfd_link_info *info);
+
   /* The FINISH_DYNAMIC_SYMBOL function is called by the ELF backend
      linker just before it writes a symbol out to the .dynsym section.
      The processor backend may make any required adjustment to the
@@ -5602,6 +5602,33 @@ check_relocation_error:
   return TRUE;
 }
 
+/* Return TRUE if elf_x86_64_relocate_section may be called for
+   different input sections on different threads.  This is so when the
+   link fills in no GOT, PLT, IFUNC or dynamic relocations, since those
+   are shared by all the input sections, and has no
+   _TLS_MODULE_BASE_, whose value relocate_section sets.  */
+
+static bfd_boolean
+elf_x86_64_relocate_section_concurrently (bfd *output_bfd ATTRIBUTE_UNUSED,
+					  struct bfd_link_info *info)
+{
+  struct elf_x86_64_link_hash_table *htab;
+
+  htab = elf_x86_64_hash_table (info);
+  if (htab == NULL)
+    return FALSE;
+
+  return (!bfd_link_pic (info)
+	  && !htab->elf.dynamic_sections_created
+	  && htab->tls_module_base == NULL
+	  && (htab->elf.sgot == NULL || htab->elf.sgot->size == 0)
+	  && (htab->elf.srelgot == NULL || htab->elf.srelgot->size == 0)
+	  && (htab->elf.iplt == NULL || htab->elf.iplt->size == 0)
+	  && (htab->elf.igotplt == NULL || htab->elf.igotplt->size == 0)
+	  && (htab->elf.irelifunc == NULL
+	      || htab->elf.irelifunc->size == 0));
+}
+
 /* Finish up dynamic symbol handling.  We set the contents of various
    dynamic sections here.  */
 
@@ -6738,6 +6765,8 @@ static const struct bfd_elf_special_section
 #endif
 #define elf_backend_reloc_type_class	    elf_x86_64_reloc_type_class
 #define elf_backend_relocate_section	    elf_x86_64_relocate_section
+#define elf_backend_relocate_section_concurrently \
+  elf_x86_64_relocate_section_concurrently
 #define elf_backend_size_dynamic_sections   elf_x86_64_size_dynamic_sections
 #define elf_backend_always_size_sections    elf_x86_64_always_size_sections
 #define elf_backend_init_index_section	    _bfd_elf_init_1_index_section
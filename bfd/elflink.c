@@ -31,6 +31,9 @@
 #if BFD_SUPPORTS_PLUGINS
 #include "plugin.h"
 #endif
+#ifdef ENABLE_THREADS
+#include <pthread.h>
+#endif
 
 /* This struct is used to pass information to routines called via
    elf_link_hash_traverse which must return failure.  */
@@ -3999,6 +4002,11 @@ error_free_dyn:
 	    goto error_free_sym;
 	  elf_sym_hashes (abfd) = sym_hash;
 	}
+
+      /* Make room for all of the external symbols before adding any
+	 of them, so that the hash table is rehashed at most once per
+	 input file rather than each time it fills up.  */
+      bfd_hash_table_reserve (&info->hash->table, extsymcount);
     }
 
   if (dynamic)
@@ -5199,6 +5207,27 @@ _bfd_elf_archive_symbol_lookup (bfd *abfd,
   return h;
 }
 
+/* Mark for checking the symdefs of the archive ABFD which have the
+   same names as the symbols on the undefs list from H onwards, unless
+   they are already INCLUDED.  */
+
+static void
+elf_link_mark_archive_symbols (bfd *abfd, struct bfd_link_hash_entry *h,
+			       unsigned char *included, unsigned char *check)
+{
+  for (; h != NULL; h = h->u.undef.next)
+    {
+      symindex i;
+
+      for (i = _bfd_archive_symbol_index_lookup (abfd, h->root.string,
+						  BFD_NO_MORE_SYMBOLS);
+	   i != BFD_NO_MORE_SYMBOLS;
+	   i = _bfd_archive_symbol_index_lookup (abfd, h->root.string, i))
+	if (!included[i])
+	  check[i] = TRUE;
+    }
+}
+
 /* Add symbols from an ELF archive file to the linker hash table.  We
    don't use _bfd_generic_link_add_archive_symbols because we need to
    handle versioned symbols.
@@ -5210,15 +5239,24 @@ _bfd_elf_archive_symbol_lookup (bfd *abfd,
    object file.
 
    Unfortunately, we do have to make multiple passes over the symbol
-   table until nothing further is resolved.  */
+   table until nothing further is resolved.  To keep those passes
+   cheap, the archive map is indexed by name, and only the symbols
+   which have the same names as symbols on the undefs list are looked
+   up in the linker hash table.  A symbol only becomes undefined or
+   common by being put on that list, so this finds the same archive
+   members in the same order as looking up every symbol would.  One
+   pass over the whole archive map is still made before giving up, in
+   case a symbol was made undefined some other way.  */
 
 static bfd_boolean
 elf_link_add_archive_symbols (bfd *abfd, struct bfd_link_info *info)
 {
   symindex c;
   unsigned char *included = NULL;
+  unsigned char *check = NULL;
   carsym *symdefs;
   bfd_boolean loop;
+  bfd_boolean full;
   bfd_size_type amt;
   const struct elf_backend_data *bed;
   struct elf_link_hash_entry * (*archive_symbol_lookup)
@@ -5249,6 +5287,22 @@ elf_link_add_archive_symbols (bfd *abfd, struct bfd_link_info *info)
   bed = get_elf_backend_data (abfd);
   archive_symbol_lookup = bed->elf_backend_archive_symbol_lookup;
 
+  /* The index can only be used if we know which names the backend
+     looks up for an archive map symbol.  The default may look up a
+     versioned name without its version, which the index ignores.
+     Without the index, every symbol is checked on every pass.  */
+  full = TRUE;
+  if (archive_symbol_lookup == _bfd_elf_archive_symbol_lookup
+      && _bfd_archive_build_symbol_index (abfd))
+    {
+      check = (unsigned char *) bfd_zmalloc (amt);
+      if (check == NULL)
+	goto error_return;
+      elf_link_mark_archive_symbols (abfd, info->hash->undefs, included,
+				     check);
+      full = FALSE;
+    }
+
   do
     {
       file_ptr last;
@@ -5270,11 +5324,15 @@ elf_link_add_archive_symbols (bfd *abfd, struct bfd_link_info *info)
 
 	  if (included[i])
 	    continue;
+	  if (!full && !check[i])
+	    continue;
 	  if (symdef->file_offset == last)
 	    {
 	      included[i] = TRUE;
 	      continue;
 	    }
+	  if (check != NULL)
+	    check[i] = FALSE;
 
 	  h = archive_symbol_lookup (abfd, info, symdef->name);
 	  if (h == (struct elf_link_hash_entry *) 0 - 1)
@@ -5320,7 +5378,13 @@ elf_link_add_archive_symbols (bfd *abfd, struct bfd_link_info *info)
 
 	  if (!(*info->callbacks
 		->add_archive_element) (info, element, symdef->name, &element))
-	    continue;
+	    {
+	      /* The symbol is still undefined, so look at it again on
+		 the next pass.  */
+	      if (check != NULL)
+		check[i] = TRUE;
+	      continue;
+	    }
 	  if (!bfd_link_add_symbols (element, info))
 	    goto error_return;
 
@@ -5332,7 +5396,15 @@ elf_link_add_archive_symbols (bfd *abfd, struct bfd_link_info *info)
 	     does not require another pass.  This isn't a bug, but it
 	     does make the code less efficient than it could be.  */
 	  if (undefs_tail != info->hash->undefs_tail)
-	    loop = TRUE;
+	    {
+	      loop = TRUE;
+	      if (check != NULL)
+		elf_link_mark_archive_symbols (abfd,
+					       (undefs_tail != NULL
+						? undefs_tail->u.undef.next
+						: info->hash->undefs),
+					       included, check);
+	    }
 
 	  /* Look backward to mark all symbols from this object file
 	     which we have already seen in this pass.  */
@@ -5350,14 +5422,27 @@ elf_link_add_archive_symbols (bfd *abfd, struct bfd_link_info *info)
 	     on through the loop.  */
 	  last = symdef->file_offset;
 	}
+
+      /* Before stopping, make one pass looking at every symbol.  */
+      if (check != NULL)
+	{
+	  if (loop)
+	    full = FALSE;
+	  else if (!full)
+	    loop = full = TRUE;
+	}
     }
   while (loop);
 
+  if (check != NULL)
+    free (check);
   free (included);
 
   return TRUE;
 
  error_return:
+  if (check != NULL)
+    free (check);
   if (included != NULL)
     free (included);
   return FALSE;
@@ -7697,6 +7782,10 @@ struct elf_final_link_info
   Elf_External_Sym_Shndx *symshndxbuf;
   /* Number of STT_FILE syms seen.  */
   size_t filesym_count;
+  /* If not NULL, the input sections are relocated on several threads,
+     and elf_link_input_bfd adds them to this batch rather than
+     relocating them and writing them out itself.  */
+  struct elf_link_batch *batch;
 };
 
 /* This struct is used to pass information to elf_link_output_extsym.  */
@@ -9805,6 +9894,1076 @@ _bfd_elf_check_kept_section (asection *sec, struct bfd_link_info *info)
   return kept;
 }
 
+/* Write out the contents CONTENTS of the input section O, once they
+   have been relocated.  */
+
+static bfd_boolean
+elf_link_output_input_section (struct elf_final_link_info *flinfo,
+			       asection *o, bfd_byte *contents)
+{
+  bfd *output_bfd = flinfo->output_bfd;
+  const struct elf_backend_data *bed = get_elf_backend_data (output_bfd);
+  bfd_size_type address_size = bed->s->arch_size == 32 ? 4 : 8;
+
+  if (bed->elf_backend_write_section
+      && (*bed->elf_backend_write_section) (output_bfd, flinfo->info, o,
+					    contents))
+    {
+      /* Section written out.  */
+    }
+  else switch (o->sec_info_type)
+    {
+    case SEC_INFO_TYPE_STABS:
+      if (! (_bfd_write_section_stabs
+	     (output_bfd,
+	      &elf_hash_table (flinfo->info)->stab_info,
+	      o, &elf_section_data (o)->sec_info, contents)))
+	return FALSE;
+      break;
+    case SEC_INFO_TYPE_MERGE:
+      if (! _bfd_write_merged_section (output_bfd, o,
+				       elf_section_data (o)->sec_info))
+	return FALSE;
+      break;
+    case SEC_INFO_TYPE_EH_FRAME:
+      {
+	if (! _bfd_elf_write_section_eh_frame (output_bfd, flinfo->info,
+					       o, contents))
+	  return FALSE;
+      }
+      break;
+    case SEC_INFO_TYPE_EH_FRAME_ENTRY:
+      {
+	if (! _bfd_elf_write_section_eh_frame_entry (output_bfd,
+						     flinfo->info,
+						     o, contents))
+	  return FALSE;
+      }
+      break;
+    default:
+      {
+	if (! (o->flags & SEC_EXCLUDE))
+	  {
+	    file_ptr offset = (file_ptr) o->output_offset;
+	    bfd_size_type todo = o->size;
+
+	    offset *= bfd_octets_per_byte (output_bfd);
+
+	    if ((o->flags & SEC_ELF_REVERSE_COPY))
+	      {
+		/* Reverse-copy input section to output.  */
+		do
+		  {
+		    todo -= address_size;
+		    if (! bfd_set_section_contents (output_bfd,
+						    o->output_section,
+						    contents + todo,
+						    offset,
+						    address_size))
+		      return FALSE;
+		    if (todo == 0)
+		      break;
+		    offset += address_size;
+		  }
+		while (1);
+	      }
+	    else if (! bfd_set_section_contents (output_bfd,
+						 o->output_section,
+						 contents,
+						 offset, todo))
+	      return FALSE;
+	  }
+      }
+      break;
+    }
+
+  return TRUE;
+}
+
+/* The number of input BFDs for each thread, and the total size of the
+   section contents, above which a batch of input BFDs is relocated
+   and written out.  */
+
+#define ELF_LINK_BATCH_BFDS_PER_THREAD 8
+#define ELF_LINK_BATCH_CONTENTS_SIZE (64 * 1024 * 1024)
+
+/* The kinds of diagnostic reported while relocating an input section
+   of a batch.  All but elf_link_batch_diag_error are the link
+   callbacks of the same name, and that is _bfd_error_handler.  */
+
+enum elf_link_batch_diag_kind
+{
+  elf_link_batch_diag_warning,
+  elf_link_batch_diag_undefined_symbol,
+  elf_link_batch_diag_reloc_overflow,
+  elf_link_batch_diag_reloc_dangerous,
+  elf_link_batch_diag_unattached_reloc,
+  elf_link_batch_diag_einfo,
+  elf_link_batch_diag_info,
+  elf_link_batch_diag_minfo,
+  elf_link_batch_diag_error
+};
+
+/* The kinds of argument taken by a conversion in the format of the
+   einfo, info and minfo callbacks.  These are the conversions of ld's
+   vfinfo.  */
+
+enum elf_link_batch_arg_kind
+{
+  /* No argument, as for %P, %X or %%.  */
+  elf_link_batch_arg_none,
+  /* A pointer, for %A, %B, %I, %S and %p.  */
+  elf_link_batch_arg_ptr,
+  /* A string, for %s and %T.  */
+  elf_link_batch_arg_str,
+  /* A BFD, a section and an offset, for %C, %D, %G and %H.  */
+  elf_link_batch_arg_loc,
+  /* A bfd_vma, for %V, %v and %W.  */
+  elf_link_batch_arg_vma,
+  /* An int for %d, an unsigned int for %u, a long for %ld and an
+     unsigned long for %lu.  */
+  elf_link_batch_arg_int,
+  elf_link_batch_arg_uint,
+  elf_link_batch_arg_long,
+  elf_link_batch_arg_ulong,
+  /* A reloc, for %R.  */
+  elf_link_batch_arg_reloc
+};
+
+/* A piece of a message passed to the einfo, info or minfo callback.
+   The message is split after each conversion which takes an argument,
+   so that it can be passed on later one piece at a time.  */
+
+struct elf_link_batch_piece
+{
+  struct elf_link_batch_piece *next;
+  /* The format of this piece, with at most one conversion which takes
+     an argument.  */
+  char *fmt;
+  /* The kind of argument, and the argument.  */
+  enum elf_link_batch_arg_kind arg;
+  void *ptr;
+  char *str;
+  asection *section;
+  bfd_vma vma;
+  long num;
+  arelent reloc;
+};
+
+/* A diagnostic reported while an input section of a batch was being
+   relocated on one of several threads.  It is passed on when the
+   section is written out, so that diagnostics come out in link order,
+   one at a time.  */
+
+struct elf_link_batch_diag
+{
+  struct elf_link_batch_diag *next;
+  enum elf_link_batch_diag_kind kind;
+  /* The string arguments of the callback, copied.  For the warning
+     callback these are the warning and the symbol, for reloc_overflow
+     the name and the reloc name, and for _bfd_error_handler the
+     formatted message.  */
+  char *str1;
+  char *str2;
+  /* The other arguments of the callback.  */
+  struct bfd_link_hash_entry *entry;
+  bfd_vma addend;
+  bfd *abfd;
+  asection *section;
+  bfd_vma address;
+  bfd_boolean is_fatal;
+  /* For the einfo, info and minfo callbacks, the pieces of the
+     message, and the BFD error and errno when it was reported, for
+     %E.  */
+  struct elf_link_batch_piece *pieces;
+  bfd_error_type error;
+  int sys_errno;
+};
+
+/* An input section whose relocation and output have been deferred to
+   the end of a batch.  */
+
+struct elf_link_batch_section
+{
+  /* The input section.  */
+  asection *sec;
+  /* Its contents.  */
+  bfd_byte *contents;
+  /* Its relocs.  */
+  Elf_Internal_Rela *relocs;
+  /* The local symbols of its BFD, and their sections.  */
+  Elf_Internal_Sym *isymbuf;
+  asection **local_sections;
+  /* TRUE if the section is to be relocated.  */
+  bfd_boolean relocate;
+  /* The value returned by relocate_section, and the BFD error if it
+     failed.  */
+  int ret;
+  bfd_error_type error;
+  /* The diagnostics reported while relocating it, in order.  */
+  struct elf_link_batch_diag *diags;
+  struct elf_link_batch_diag **diags_tail;
+  /* TRUE if memory ran out while recording a diagnostic.  */
+  bfd_boolean diags_lost;
+};
+
+/* A batch of input BFDs whose sections are relocated together, on
+   several threads, and then written out in link order.  Everything
+   else elf_link_input_bfd does, such as writing out the local
+   symbols, is still done one input BFD at a time, in link order.  */
+
+struct elf_link_batch
+{
+  struct elf_final_link_info *flinfo;
+  /* The number of threads to use.  */
+  unsigned int thread_count;
+  /* The sections of the batch, in link order.  */
+  struct elf_link_batch_section *sections;
+  size_t section_count;
+  size_t section_alloc;
+  /* Buffers to free once the batch has been written out.  */
+  void **buffers;
+  size_t buffer_count;
+  size_t buffer_alloc;
+  /* The number of input BFDs in the batch, and the total size of
+     their section contents.  */
+  unsigned int bfd_count;
+  bfd_size_type contents_size;
+  /* The next section to relocate.  */
+  size_t next;
+#ifdef ENABLE_THREADS
+  /* Lock for NEXT.  */
+  pthread_mutex_t lock;
+#endif
+};
+
+/* Arrange for BUF to be freed once BATCH has been written out.  */
+
+static bfd_boolean
+elf_link_batch_keep (struct elf_link_batch *batch, void *buf)
+{
+  if (buf == NULL)
+    return TRUE;
+
+  if (batch->buffer_count == batch->buffer_alloc)
+    {
+      size_t alloc = batch->buffer_alloc * 2 + 16;
+      void **buffers;
+
+      buffers = (void **) bfd_realloc (batch->buffers,
+				       alloc * sizeof (void *));
+      if (buffers == NULL)
+	{
+	  free (buf);
+	  return FALSE;
+	}
+      batch->buffers = buffers;
+      batch->buffer_alloc = alloc;
+    }
+  batch->buffers[batch->buffer_count++] = buf;
+  return TRUE;
+}
+
+/* Set *PBUF to a buffer for the contents of the input section O.
+   This is the shared buffer when sections are relocated one at a
+   time, and a buffer of its own when O is to be added to a batch.  */
+
+static bfd_boolean
+elf_link_contents_buffer (struct elf_final_link_info *flinfo, asection *o,
+			  bfd_byte **pbuf)
+{
+  bfd_size_type size;
+
+  if (flinfo->batch == NULL)
+    {
+      *pbuf = flinfo->contents;
+      return TRUE;
+    }
+
+  *pbuf = NULL;
+  size = o->rawsize > o->size ? o->rawsize : o->size;
+  if (size == 0)
+    return TRUE;
+  *pbuf = (bfd_byte *) bfd_malloc (size);
+  return *pbuf != NULL;
+}
+
+/* Add the input section O, with contents CONTENTS, to BATCH.  If
+   RELOCATE, relocate it with RELOCS, ISYMBUF and LOCAL_SECTIONS before
+   writing it out.  CONTENTS and RELOCS are freed along with the batch
+   unless they are cached in O.  */
+
+static bfd_boolean
+elf_link_batch_add_section (struct elf_link_batch *batch, asection *o,
+			    bfd_byte *contents, bfd_boolean relocate,
+			    Elf_Internal_Rela *relocs,
+			    Elf_Internal_Sym *isymbuf,
+			    asection **local_sections)
+{
+  struct elf_link_batch_section *bs;
+
+  if (contents != elf_section_data (o)->this_hdr.contents)
+    {
+      if (! elf_link_batch_keep (batch, contents))
+	return FALSE;
+      batch->contents_size += o->rawsize > o->size ? o->rawsize : o->size;
+    }
+  if (relocs != elf_section_data (o)->relocs
+      && ! elf_link_batch_keep (batch, relocs))
+    return FALSE;
+
+  if (batch->section_count == batch->section_alloc)
+    {
+      size_t alloc = batch->section_alloc * 2 + 64;
+
+      bs = ((struct elf_link_batch_section *)
+	    bfd_realloc (batch->sections, alloc * sizeof (*bs)));
+      if (bs == NULL)
+	return FALSE;
+      batch->sections = bs;
+      batch->section_alloc = alloc;
+    }
+
+  bs = &batch->sections[batch->section_count++];
+  bs->sec = o;
+  bs->contents = contents;
+  bs->relocs = relocs;
+  bs->isymbuf = isymbuf;
+  bs->local_sections = local_sections;
+  bs->relocate = relocate;
+  bs->ret = TRUE;
+  bs->error = bfd_error_no_error;
+  bs->diags = NULL;
+  bs->diags_lost = FALSE;
+  return TRUE;
+}
+
+/* Free the list of message pieces starting at PIECE.  */
+
+static void
+elf_link_batch_free_pieces (struct elf_link_batch_piece *piece)
+{
+  while (piece != NULL)
+    {
+      struct elf_link_batch_piece *next = piece->next;
+
+      free (piece->fmt);
+      free (piece->str);
+      free (piece);
+      piece = next;
+    }
+}
+
+#ifdef ENABLE_THREADS
+
+/* The key for the batch section each thread is relocating, so that
+   the diagnostics it reports can be recorded against the section.  */
+
+static pthread_key_t elf_link_batch_key;
+static pthread_once_t elf_link_batch_key_once = PTHREAD_ONCE_INIT;
+static bfd_boolean elf_link_batch_key_ok;
+
+static void
+elf_link_batch_create_key (void)
+{
+  elf_link_batch_key_ok
+    = pthread_key_create (&elf_link_batch_key, NULL) == 0;
+}
+
+/* Return a copy of STR, allocated with malloc.  */
+
+static char *
+elf_link_batch_strdup (const char *str)
+{
+  size_t len;
+  char *copy;
+
+  if (str == NULL)
+    return NULL;
+  len = strlen (str) + 1;
+  copy = (char *) bfd_malloc (len);
+  if (copy != NULL)
+    memcpy (copy, str, len);
+  return copy;
+}
+
+/* Note that a diagnostic of the section being relocated on this
+   thread was lost because memory ran out.  */
+
+static void
+elf_link_batch_lost (void)
+{
+  struct elf_link_batch_section *bs;
+
+  bs = ((struct elf_link_batch_section *)
+	pthread_getspecific (elf_link_batch_key));
+  if (bs != NULL)
+    bs->diags_lost = TRUE;
+}
+
+/* Record a diagnostic of KIND with string arguments STR1 and STR2,
+   which are copied, against the section being relocated on this
+   thread.  Return it, for the caller to fill in, or NULL if memory
+   ran out.  */
+
+static struct elf_link_batch_diag *
+elf_link_batch_record (enum elf_link_batch_diag_kind kind,
+		       const char *str1, const char *str2)
+{
+  struct elf_link_batch_section *bs;
+  struct elf_link_batch_diag *diag;
+
+  bs = ((struct elf_link_batch_section *)
+	pthread_getspecific (elf_link_batch_key));
+  if (bs == NULL)
+    abort ();
+
+  diag = ((struct elf_link_batch_diag *)
+	  bfd_zmalloc (sizeof (struct elf_link_batch_diag)));
+  if (diag == NULL)
+    {
+      bs->diags_lost = TRUE;
+      return NULL;
+    }
+  diag->kind = kind;
+  diag->str1 = elf_link_batch_strdup (str1);
+  diag->str2 = elf_link_batch_strdup (str2);
+  if ((str1 != NULL && diag->str1 == NULL)
+      || (str2 != NULL && diag->str2 == NULL))
+    {
+      free (diag->str1);
+      free (diag->str2);
+      free (diag);
+      bs->diags_lost = TRUE;
+      return NULL;
+    }
+  *bs->diags_tail = diag;
+  bs->diags_tail = &diag->next;
+  return diag;
+}
+
+/* The callbacks and error handler used while sections are relocated
+   on several threads.  They record the diagnostic against the section
+   being relocated.  */
+
+static void
+elf_link_batch_warning (struct bfd_link_info *info ATTRIBUTE_UNUSED,
+			const char *warning, const char *symbol,
+			bfd *abfd, asection *section, bfd_vma address)
+{
+  struct elf_link_batch_diag *diag;
+
+  diag = elf_link_batch_record (elf_link_batch_diag_warning, warning, symbol);
+  if (diag != NULL)
+    {
+      diag->abfd = abfd;
+      diag->section = section;
+      diag->address = address;
+    }
+}
+
+static void
+elf_link_batch_undefined_symbol (struct bfd_link_info *info ATTRIBUTE_UNUSED,
+				 const char *name, bfd *abfd,
+				 asection *section, bfd_vma address,
+				 bfd_boolean is_fatal)
+{
+  struct elf_link_batch_diag *diag;
+
+  diag = elf_link_batch_record (elf_link_batch_diag_undefined_symbol,
+				name, NULL);
+  if (diag != NULL)
+    {
+      diag->abfd = abfd;
+      diag->section = section;
+      diag->address = address;
+      diag->is_fatal = is_fatal;
+    }
+}
+
+static void
+elf_link_batch_reloc_overflow (struct bfd_link_info *info ATTRIBUTE_UNUSED,
+			       struct bfd_link_hash_entry *entry,
+			       const char *name, const char *reloc_name,
+			       bfd_vma addend, bfd *abfd, asection *section,
+			       bfd_vma address)
+{
+  struct elf_link_batch_diag *diag;
+
+  diag = elf_link_batch_record (elf_link_batch_diag_reloc_overflow,
+				name, reloc_name);
+  if (diag != NULL)
+    {
+      diag->entry = entry;
+      diag->addend = addend;
+      diag->abfd = abfd;
+      diag->section = section;
+      diag->address = address;
+    }
+}
+
+static void
+elf_link_batch_reloc_dangerous (struct bfd_link_info *info ATTRIBUTE_UNUSED,
+				const char *message, bfd *abfd,
+				asection *section, bfd_vma address)
+{
+  struct elf_link_batch_diag *diag;
+
+  diag = elf_link_batch_record (elf_link_batch_diag_reloc_dangerous,
+				message, NULL);
+  if (diag != NULL)
+    {
+      diag->abfd = abfd;
+      diag->section = section;
+      diag->address = address;
+    }
+}
+
+static void
+elf_link_batch_unattached_reloc (struct bfd_link_info *info ATTRIBUTE_UNUSED,
+				 const char *name, bfd *abfd,
+				 asection *section, bfd_vma address)
+{
+  struct elf_link_batch_diag *diag;
+
+  diag = elf_link_batch_record (elf_link_batch_diag_unattached_reloc,
+				name, NULL);
+  if (diag != NULL)
+    {
+      diag->abfd = abfd;
+      diag->section = section;
+      diag->address = address;
+    }
+}
+
+static void
+elf_link_batch_error_handler (const char *fmt, ...)
+{
+  va_list ap;
+  char *msg;
+
+  va_start (ap, fmt);
+  msg = _bfd_error_message (fmt, &ap);
+  va_end (ap);
+
+  if (msg == NULL)
+    {
+      elf_link_batch_lost ();
+      return;
+    }
+  elf_link_batch_record (elf_link_batch_diag_error, msg, NULL);
+  free (msg);
+}
+
+/* Record a message of KIND, for the einfo, info or minfo callback,
+   with format FMT and arguments AP.  The arguments are taken as ld's
+   vfinfo would take them.  Strings and relocs are copied, since they
+   may not live until the message is passed on.  A %F is moved to the
+   last piece, so that the whole message is printed before ld exits.  */
+
+/* Record a message of KIND, for the einfo, info or minfo callback,
+   with format FMT and arguments AP.  The arguments are taken as ld's
+   vfinfo would take them.  Strings and relocs are copied, since they
+   may not live until the message is passed on.  A %F is moved to the
+   last piece, so that the whole message is printed before ld exits.  */
+
+static void
+elf_link_batch_record_message (enum elf_link_batch_diag_kind kind,
+			       const char *fmt, va_list ap)
+{
+  bfd_error_type error = bfd_get_error ();
+  int sys_errno = errno;
+  struct elf_link_batch_diag *diag;
+  struct elf_link_batch_piece *pieces = NULL;
+  struct elf_link_batch_piece **tail = &pieces;
+  bfd_boolean fatal = FALSE;
+  const char *p = fmt;
+
+  while (*p != '\0')
+    {
+      struct elf_link_batch_piece *piece;
+      size_t len = 0;
+
+      piece = ((struct elf_link_batch_piece *)
+	       bfd_zmalloc (sizeof (struct elf_link_batch_piece)));
+      if (piece == NULL)
+	goto lost;
+      *tail = piece;
+      tail = &piece->next;
+      /* Leave room for a %F at the end.  */
+      piece->fmt = (char *) bfd_malloc (strlen (p) + 3);
+      if (piece->fmt == NULL)
+	goto lost;
+
+      while (*p != '\0' && piece->arg == elf_link_batch_arg_none)
+	{
+	  size_t n = 2;
+
+	  if (*p != '%' || p[1] == '\0')
+	    {
+	      piece->fmt[len++] = *p++;
+	      continue;
+	    }
+
+	  switch (p[1])
+	    {
+	    case 'F':
+	      fatal = TRUE;
+	      p += 2;
+	      continue;
+	    case 'A':
+	    case 'B':
+	    case 'I':
+	    case 'S':
+	    case 'p':
+	      piece->arg = elf_link_batch_arg_ptr;
+	      piece->ptr = va_arg (ap, void *);
+	      break;
+	    case 's':
+	    case 'T':
+	      {
+		const char *str = va_arg (ap, const char *);
+
+		piece->arg = elf_link_batch_arg_str;
+		piece->str = elf_link_batch_strdup (str);
+		if (str != NULL && piece->str == NULL)
+		  goto lost;
+	      }
+	      break;
+	    case 'C':
+	    case 'D':
+	    case 'G':
+	    case 'H':
+	      piece->arg = elf_link_batch_arg_loc;
+	      piece->ptr = va_arg (ap, bfd *);
+	      piece->section = va_arg (ap, asection *);
+	      piece->vma = va_arg (ap, bfd_vma);
+	      break;
+	    case 'V':
+	    case 'v':
+	    case 'W':
+	      piece->arg = elf_link_batch_arg_vma;
+	      piece->vma = va_arg (ap, bfd_vma);
+	      break;
+	    case 'd':
+	      piece->arg = elf_link_batch_arg_int;
+	      piece->num = va_arg (ap, int);
+	      break;
+	    case 'u':
+	      piece->arg = elf_link_batch_arg_uint;
+	      piece->num = va_arg (ap, unsigned int);
+	      break;
+	    case 'l':
+	      if (p[2] == 'd')
+		{
+		  piece->arg = elf_link_batch_arg_long;
+		  piece->num = va_arg (ap, long);
+		  n = 3;
+		}
+	      else if (p[2] == 'u')
+		{
+		  piece->arg = elf_link_batch_arg_ulong;
+		  piece->num = (long) va_arg (ap, unsigned long);
+		  n = 3;
+		}
+	      break;
+	    case 'R':
+	      piece->arg = elf_link_batch_arg_reloc;
+	      piece->reloc = *va_arg (ap, arelent *);
+	      break;
+	    default:
+	      break;
+	    }
+
+	  memcpy (piece->fmt + len, p, n);
+	  len += n;
+	  p += n;
+	}
+
+      if (*p == '\0' && fatal)
+	{
+	  memcpy (piece->fmt + len, "%F", 2);
+	  len += 2;
+	}
+      piece->fmt[len] = '\0';
+    }
+
+  diag = elf_link_batch_record (kind, NULL, NULL);
+  if (diag == NULL)
+    {
+      elf_link_batch_free_pieces (pieces);
+      return;
+    }
+  diag->pieces = pieces;
+  diag->error = error;
+  diag->sys_errno = sys_errno;
+  return;
+
+ lost:
+  elf_link_batch_free_pieces (pieces);
+  elf_link_batch_lost ();
+}
+
+static void
+elf_link_batch_einfo (const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start (ap, fmt);
+  elf_link_batch_record_message (elf_link_batch_diag_einfo, fmt, ap);
+  va_end (ap);
+}
+
+static void
+elf_link_batch_info (const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start (ap, fmt);
+  elf_link_batch_record_message (elf_link_batch_diag_info, fmt, ap);
+  va_end (ap);
+}
+
+static void
+elf_link_batch_minfo (const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start (ap, fmt);
+  elf_link_batch_record_message (elf_link_batch_diag_minfo, fmt, ap);
+  va_end (ap);
+}
+
+#endif /* ENABLE_THREADS */
+
+/* Set the BFD error to ERROR, recorded on one of the threads.  The
+   input BFD of bfd_error_on_input is not recorded, so that is left
+   alone.  */
+
+static void
+elf_link_batch_set_error (bfd_error_type error)
+{
+  if (error != bfd_error_on_input)
+    bfd_set_error (error);
+}
+
+/* Pass on the message recorded in DIAG through FN, which is the
+   einfo, info or minfo callback, one piece at a time.  */
+
+static void
+elf_link_batch_report_message (void (*fn) (const char *, ...),
+			       struct elf_link_batch_diag *diag)
+{
+  struct elf_link_batch_piece *piece;
+
+  elf_link_batch_set_error (diag->error);
+  errno = diag->sys_errno;
+  for (piece = diag->pieces; piece != NULL; piece = piece->next)
+    switch (piece->arg)
+      {
+      case elf_link_batch_arg_none:
+	(*fn) (piece->fmt);
+	break;
+      case elf_link_batch_arg_ptr:
+	(*fn) (piece->fmt, piece->ptr);
+	break;
+      case elf_link_batch_arg_str:
+	(*fn) (piece->fmt, piece->str);
+	break;
+      case elf_link_batch_arg_loc:
+	(*fn) (piece->fmt, (bfd *) piece->ptr, piece->section, piece->vma);
+	break;
+      case elf_link_batch_arg_vma:
+	(*fn) (piece->fmt, piece->vma);
+	break;
+      case elf_link_batch_arg_int:
+	(*fn) (piece->fmt, (int) piece->num);
+	break;
+      case elf_link_batch_arg_uint:
+	(*fn) (piece->fmt, (unsigned int) piece->num);
+	break;
+      case elf_link_batch_arg_long:
+	(*fn) (piece->fmt, piece->num);
+	break;
+      case elf_link_batch_arg_ulong:
+	(*fn) (piece->fmt, (unsigned long) piece->num);
+	break;
+      case elf_link_batch_arg_reloc:
+	(*fn) (piece->fmt, &piece->reloc);
+	break;
+      }
+}
+
+/* Pass on the diagnostics recorded while relocating BS, through the
+   callbacks of INFO and _bfd_error_handler.  Return FALSE if some
+   were lost.  */
+
+static bfd_boolean
+elf_link_batch_report (struct bfd_link_info *info,
+		       struct elf_link_batch_section *bs)
+{
+  struct elf_link_batch_diag *diag;
+
+  for (diag = bs->diags; diag != NULL; diag = diag->next)
+    switch (diag->kind)
+      {
+      case elf_link_batch_diag_warning:
+	(*info->callbacks->warning) (info, diag->str1, diag->str2,
+				     diag->abfd, diag->section,
+				     diag->address);
+	break;
+      case elf_link_batch_diag_undefined_symbol:
+	(*info->callbacks->undefined_symbol) (info, diag->str1, diag->abfd,
+					      diag->section, diag->address,
+					      diag->is_fatal);
+	break;
+      case elf_link_batch_diag_reloc_overflow:
+	(*info->callbacks->reloc_overflow) (info, diag->entry, diag->str1,
+					    diag->str2, diag->addend,
+					    diag->abfd, diag->section,
+					    diag->address);
+	break;
+      case elf_link_batch_diag_reloc_dangerous:
+	(*info->callbacks->reloc_dangerous) (info, diag->str1, diag->abfd,
+					     diag->section, diag->address);
+	break;
+      case elf_link_batch_diag_unattached_reloc:
+	(*info->callbacks->unattached_reloc) (info, diag->str1, diag->abfd,
+					      diag->section, diag->address);
+	break;
+      case elf_link_batch_diag_einfo:
+	elf_link_batch_report_message (info->callbacks->einfo, diag);
+	break;
+      case elf_link_batch_diag_info:
+	elf_link_batch_report_message (info->callbacks->info, diag);
+	break;
+      case elf_link_batch_diag_minfo:
+	elf_link_batch_report_message (info->callbacks->minfo, diag);
+	break;
+      case elf_link_batch_diag_error:
+	(*_bfd_error_handler) ("%s", diag->str1);
+	break;
+      }
+
+  if (bs->diags_lost)
+    {
+      bfd_set_error (bfd_error_no_memory);
+      return FALSE;
+    }
+  return TRUE;
+}
+
+/* Relocate sections of BATCH until there are none left.  This is run
+   on each of the threads.  */
+
+static void *
+elf_link_batch_relocate (void *arg)
+{
+  struct elf_link_batch *batch = (struct elf_link_batch *) arg;
+  struct elf_final_link_info *flinfo = batch->flinfo;
+  const struct elf_backend_data *bed
+    = get_elf_backend_data (flinfo->output_bfd);
+
+  while (1)
+    {
+      struct elf_link_batch_section *bs;
+      size_t i;
+
+#ifdef ENABLE_THREADS
+      pthread_mutex_lock (&batch->lock);
+#endif
+      i = batch->next++;
+#ifdef ENABLE_THREADS
+      pthread_mutex_unlock (&batch->lock);
+#endif
+      if (i >= batch->section_count)
+	break;
+
+      bs = &batch->sections[i];
+      bs->diags_tail = &bs->diags;
+      if (bs->relocate)
+	{
+#ifdef ENABLE_THREADS
+	  if (elf_link_batch_key_ok)
+	    pthread_setspecific (elf_link_batch_key, bs);
+#endif
+	  bs->ret = (*bed->elf_backend_relocate_section) (flinfo->output_bfd,
+							  flinfo->info,
+							  bs->sec->owner,
+							  bs->sec,
+							  bs->contents,
+							  bs->relocs,
+							  bs->isymbuf,
+							  bs->local_sections);
+	  /* The BFD error is kept for each thread.  */
+	  if (!bs->ret)
+	    bs->error = bfd_get_error ();
+	}
+    }
+
+  return NULL;
+}
+
+/* Free the buffers of BATCH and empty it.  */
+
+static void
+elf_link_batch_clear (struct elf_link_batch *batch)
+{
+  size_t i;
+
+  for (i = 0; i < batch->section_count; i++)
+    {
+      struct elf_link_batch_diag *diag, *next;
+
+      for (diag = batch->sections[i].diags; diag != NULL; diag = next)
+	{
+	  elf_link_batch_free_pieces (diag->pieces);
+	  next = diag->next;
+	  free (diag->str1);
+	  free (diag->str2);
+	  free (diag);
+	}
+    }
+  for (i = 0; i < batch->buffer_count; i++)
+    free (batch->buffers[i]);
+  batch->buffer_count = 0;
+  batch->section_count = 0;
+  batch->bfd_count = 0;
+  batch->contents_size = 0;
+}
+
+/* Free BATCH.  */
+
+static void
+elf_link_batch_free (struct elf_link_batch *batch)
+{
+  elf_link_batch_clear (batch);
+  if (batch->sections != NULL)
+    free (batch->sections);
+  if (batch->buffers != NULL)
+    free (batch->buffers);
+#ifdef ENABLE_THREADS
+  pthread_mutex_destroy (&batch->lock);
+#endif
+}
+
+/* Relocate the sections of BATCH on its threads, then write them out
+   in the order they were added, and empty BATCH.  */
+
+static bfd_boolean
+elf_link_batch_flush (struct elf_link_batch *batch)
+{
+  bfd_boolean ok = TRUE;
+  size_t i;
+
+  batch->next = 0;
+#ifdef ENABLE_THREADS
+  {
+    struct bfd_link_info *info = batch->flinfo->info;
+    const struct bfd_link_callbacks *callbacks = info->callbacks;
+    struct bfd_link_callbacks record_callbacks;
+    bfd_error_handler_type error_handler = NULL;
+    pthread_t *threads;
+    unsigned int count;
+    unsigned int n;
+
+    count = batch->thread_count - 1;
+    if (count > batch->section_count)
+      count = batch->section_count;
+    pthread_once (&elf_link_batch_key_once, elf_link_batch_create_key);
+    if (!elf_link_batch_key_ok)
+      count = 0;
+    threads = NULL;
+    if (count != 0)
+      threads = (pthread_t *) bfd_malloc (count * sizeof (pthread_t));
+    if (threads == NULL)
+      count = 0;
+
+    /* The diagnostics of the sections are recorded while the threads
+       run, and passed on below when the sections are written out.  */
+    if (count != 0)
+      {
+	record_callbacks = *callbacks;
+	record_callbacks.warning = elf_link_batch_warning;
+	record_callbacks.undefined_symbol = elf_link_batch_undefined_symbol;
+	record_callbacks.reloc_overflow = elf_link_batch_reloc_overflow;
+	record_callbacks.reloc_dangerous = elf_link_batch_reloc_dangerous;
+	record_callbacks.unattached_reloc = elf_link_batch_unattached_reloc;
+	record_callbacks.einfo = elf_link_batch_einfo;
+	record_callbacks.info = elf_link_batch_info;
+	record_callbacks.minfo = elf_link_batch_minfo;
+	info->callbacks = &record_callbacks;
+	error_handler = bfd_set_error_handler (elf_link_batch_error_handler);
+      }
+
+    /* If a thread cannot be created, the others, and this one, do its
+       share of the work.  */
+    for (n = 0; n < count; n++)
+      if (pthread_create (&threads[n], NULL, elf_link_batch_relocate,
+			  batch) != 0)
+	break;
+
+    elf_link_batch_relocate (batch);
+
+    while (n != 0)
+      pthread_join (threads[--n], NULL);
+    if (threads != NULL)
+      free (threads);
+
+    if (count != 0)
+      {
+	info->callbacks = callbacks;
+	bfd_set_error_handler (error_handler);
+      }
+  }
+#else
+  elf_link_batch_relocate (batch);
+#endif
+
+  for (i = 0; ok && i < batch->section_count; i++)
+    {
+      struct elf_link_batch_section *bs = &batch->sections[i];
+
+      /* Backends only relocate sections concurrently if they never
+	 ask for relocs to be written out.  */
+      BFD_ASSERT (bs->ret != 2);
+      if (!elf_link_batch_report (batch->flinfo->info, bs))
+	ok = FALSE;
+      else if (!bs->ret)
+	{
+	  elf_link_batch_set_error (bs->error);
+	  ok = FALSE;
+	}
+      else if (!elf_link_output_input_section (batch->flinfo, bs->sec,
+					       bs->contents))
+	ok = FALSE;
+    }
+
+  elf_link_batch_clear (batch);
+  return ok;
+}
+
+/* Return TRUE if the input sections of this link may be relocated on
+   several threads.  */
+
+static bfd_boolean
+elf_link_relocate_concurrently (bfd *output_bfd ATTRIBUTE_UNUSED,
+				struct bfd_link_info *info ATTRIBUTE_UNUSED)
+{
+#ifdef ENABLE_THREADS
+  const struct elf_backend_data *bed = get_elf_backend_data (output_bfd);
+
+  return (info->thread_count > 1
+	  && !bfd_link_relocatable (info)
+	  && !info->emitrelocations
+	  && bed->elf_backend_relocate_section_concurrently != NULL
+	  && (*bed->elf_backend_relocate_section_concurrently) (output_bfd,
+								 info));
+#else
+  return FALSE;
+#endif
+}
+
 /* Link an input file into the linker output file.  This function
    handles all the sections and relocations of the input file at once.
    This is so that we only have to read the local symbols once, and
@@ -10146,14 +11305,18 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	      && o->rawsize != 0
 	      && o->rawsize < o->size)
 	    {
-	      memcpy (flinfo->contents, contents, o->rawsize);
-	      contents = flinfo->contents;
+	      bfd_byte *buffer;
+
+	      if (! elf_link_contents_buffer (flinfo, o, &buffer))
+		return FALSE;
+	      memcpy (buffer, contents, o->rawsize);
+	      contents = buffer;
 	    }
 	}
       else
 	{
-	  contents = flinfo->contents;
-	  if (! bfd_get_full_section_contents (input_bfd, o, &contents))
+	  if (! elf_link_contents_buffer (flinfo, o, &contents)
+	      || ! bfd_get_full_section_contents (input_bfd, o, &contents))
 	    return FALSE;
 	}
 
@@ -10164,10 +11327,13 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	  int action_discarded;
 	  int ret;
 
-	  /* Get the swapped relocs.  */
+	  /* Get the swapped relocs.  Sections added to a batch need
+	     relocs of their own.  */
 	  internal_relocs
 	    = _bfd_elf_link_read_relocs (input_bfd, o, flinfo->external_relocs,
-					 flinfo->internal_relocs, FALSE);
+					 (flinfo->batch != NULL
+					  ? NULL : flinfo->internal_relocs),
+					 FALSE);
 	  if (internal_relocs == NULL
 	      && o->reloc_count > 0)
 	    return FALSE;
@@ -10260,6 +11426,11 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 		      && (h->root.u.def.section->owner->flags
 			  & BFD_PLUGIN) != 0)
 		    {
+		      /* The sections already in the batch must be
+			 relocated against the symbol as it was.  */
+		      if (flinfo->batch != NULL
+			  && ! elf_link_batch_flush (flinfo->batch))
+			return FALSE;
 		      h->root.type = bfd_link_hash_undefined;
 		      h->root.u.undef.abfd = h->root.u.def.section->owner;
 		    }
@@ -10301,6 +11472,10 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 		  if (!eval_symbol (&val, &sym_name, input_bfd, flinfo, dot,
 				    isymbuf, locsymcount, s_type == STT_SRELC))
 		    return FALSE;
+		  if (h != NULL
+		      && flinfo->batch != NULL
+		      && ! elf_link_batch_flush (flinfo->batch))
+		    return FALSE;
 
 		  /* Symbol evaluated OK.  Update to absolute value.  */
 		  set_symbol_value (input_bfd, isymbuf, locsymcount,
@@ -10335,6 +11510,10 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 							      flinfo->info);
 			  if (kept != NULL)
 			    {
+			      if (h != NULL
+				  && flinfo->batch != NULL
+				  && ! elf_link_batch_flush (flinfo->batch))
+				return FALSE;
 			      *ps = kept;
 			      continue;
 			    }
@@ -10343,6 +11522,17 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 		}
 	    }
 
+	  /* Leave the relocation of the section, and writing it out,
+	     to the batch.  */
+	  if (flinfo->batch != NULL)
+	    {
+	      if (! elf_link_batch_add_section (flinfo->batch, o, contents,
+						TRUE, internal_relocs,
+						isymbuf, flinfo->sections))
+		return FALSE;
+	      continue;
+	    }
+
 	  /* Relocate the section by invoking a back end routine.
 
 	     The back end routine is responsible for adjusting the
@@ -10631,80 +11821,88 @@ elf_link_input_bfd (struct elf_final_link_info *flinfo, bfd *input_bfd)
 	}
 
       /* Write out the modified section contents.  */
-      if (bed->elf_backend_write_section
-	  && (*bed->elf_backend_write_section) (output_bfd, flinfo->info, o,
-						contents))
-	{
-	  /* Section written out.  */
-	}
-      else switch (o->sec_info_type)
+      if (flinfo->batch != NULL)
 	{
-	case SEC_INFO_TYPE_STABS:
-	  if (! (_bfd_write_section_stabs
-		 (output_bfd,
-		  &elf_hash_table (flinfo->info)->stab_info,
-		  o, &elf_section_data (o)->sec_info, contents)))
+	  if (! elf_link_batch_add_section (flinfo->batch, o, contents,
+					    FALSE, NULL, NULL, NULL))
 	    return FALSE;
-	  break;
-	case SEC_INFO_TYPE_MERGE:
-	  if (! _bfd_write_merged_section (output_bfd, o,
-					   elf_section_data (o)->sec_info))
-	    return FALSE;
-	  break;
-	case SEC_INFO_TYPE_EH_FRAME:
-	  {
-	    if (! _bfd_elf_write_section_eh_frame (output_bfd, flinfo->info,
-						   o, contents))
-	      return FALSE;
-	  }
-	  break;
-	case SEC_INFO_TYPE_EH_FRAME_ENTRY:
-	  {
-	    if (! _bfd_elf_write_section_eh_frame_entry (output_bfd,
-							 flinfo->info,
-							 o, contents))
-	      return FALSE;
-	  }
-	  break;
-	default:
-	  {
-	    if (! (o->flags & SEC_EXCLUDE))
-	      {
-		file_ptr offset = (file_ptr) o->output_offset;
-		bfd_size_type todo = o->size;
+	}
+      else if (! elf_link_output_input_section (flinfo, o, contents))
+	return FALSE;
+    }
 
-		offset *= bfd_octets_per_byte (output_bfd);
+  return TRUE;
+}
 
-		if ((o->flags & SEC_ELF_REVERSE_COPY))
-		  {
-		    /* Reverse-copy input section to output.  */
-		    do
-		      {
-			todo -= address_size;
-			if (! bfd_set_section_contents (output_bfd,
-							o->output_section,
-							contents + todo,
-							offset,
-							address_size))
-			  return FALSE;
-			if (todo == 0)
-			  break;
-			offset += address_size;
-		      }
-		    while (1);
-		  }
-		else if (! bfd_set_section_contents (output_bfd,
-						     o->output_section,
-						     contents,
-						     offset, todo))
-		  return FALSE;
-	      }
-	  }
-	  break;
+/* Link the input file INPUT_BFD as part of BATCH.  Its local symbols
+   are written out now, and its sections are added to BATCH, which is
+   relocated and written out once it is large enough.  */
+
+static bfd_boolean
+elf_link_batch_input_bfd (struct elf_link_batch *batch, bfd *input_bfd)
+{
+  struct elf_final_link_info *flinfo = batch->flinfo;
+  const struct elf_backend_data *bed
+    = get_elf_backend_data (flinfo->output_bfd);
+  Elf_Internal_Sym *internal_syms = flinfo->internal_syms;
+  asection **sections = flinfo->sections;
+  Elf_Internal_Shdr *symtab_hdr;
+  size_t locsymcount;
+  bfd_boolean ok;
+
+  if ((input_bfd->flags & DYNAMIC) != 0)
+    return TRUE;
+
+  /* The local symbols of each input file, and their sections, are
+     needed until its sections have been relocated, so they cannot be
+     kept in the shared buffers.  Read the string table now too, since
+     relocate_section may look up symbol names on any thread.  */
+  symtab_hdr = &elf_tdata (input_bfd)->symtab_hdr;
+  if (elf_bad_symtab (input_bfd))
+    locsymcount = symtab_hdr->sh_size / bed->s->sizeof_sym;
+  else
+    locsymcount = symtab_hdr->sh_info;
+
+  flinfo->internal_syms = NULL;
+  flinfo->sections = NULL;
+  if (locsymcount != 0)
+    {
+      flinfo->internal_syms = (Elf_Internal_Sym *)
+	bfd_malloc (locsymcount * sizeof (Elf_Internal_Sym));
+      flinfo->sections = (asection **)
+	bfd_malloc (locsymcount * sizeof (asection *));
+      if (flinfo->internal_syms == NULL || flinfo->sections == NULL)
+	{
+	  if (flinfo->internal_syms != NULL)
+	    free (flinfo->internal_syms);
+	  if (flinfo->sections != NULL)
+	    free (flinfo->sections);
+	  flinfo->internal_syms = internal_syms;
+	  flinfo->sections = sections;
+	  return FALSE;
 	}
+
+      if (symtab_hdr->sh_link < elf_numsections (input_bfd)
+	  && elf_elfsections (input_bfd)[symtab_hdr->sh_link]->sh_size > 1)
+	bfd_elf_string_from_elf_section (input_bfd, symtab_hdr->sh_link, 1);
     }
 
-  return TRUE;
+  ok = elf_link_input_bfd (flinfo, input_bfd);
+
+  if (! elf_link_batch_keep (batch, flinfo->internal_syms))
+    ok = FALSE;
+  if (! elf_link_batch_keep (batch, flinfo->sections))
+    ok = FALSE;
+  flinfo->internal_syms = internal_syms;
+  flinfo->sections = sections;
+
+  batch->bfd_count++;
+  if (ok
+      && (batch->bfd_count >= (batch->thread_count
+			       * ELF_LINK_BATCH_BFDS_PER_THREAD)
+	  || batch->contents_size >= ELF_LINK_BATCH_CONTENTS_SIZE))
+    ok = elf_link_batch_flush (batch);
+  return ok;
 }
 
 /* Generate a reloc when linking an ELF file.  This is a reloc
@@ -11053,6 +12251,8 @@ elf_final_link_free (bfd *obfd, struct elf_final_link_info *flinfo)
     free (flinfo->sections);
   if (flinfo->symshndxbuf != NULL)
     free (flinfo->symshndxbuf);
+  if (flinfo->batch != NULL)
+    elf_link_batch_free (flinfo->batch);
   for (o = obfd->sections; o != NULL; o = o->next)
     {
       struct bfd_elf_section_data *esdo = elf_section_data (o);
@@ -11075,6 +12275,7 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
   asection *o;
   struct bfd_link_order *p;
   bfd *sub;
+  struct elf_link_batch batch;
   bfd_size_type max_contents_size;
   bfd_size_type max_external_reloc_size;
   bfd_size_type max_internal_reloc_count;
@@ -11135,6 +12336,7 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
   flinfo.sections = NULL;
   flinfo.symshndxbuf = NULL;
   flinfo.filesym_count = 0;
+  flinfo.batch = NULL;
 
   /* The object attributes have been merged.  Remove the input
      sections from the link, and set the contents of the output
@@ -11556,7 +12758,24 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
      it.  Fortunately, it only happens when performing a relocatable
      link, which is not the common case.  FIXME: If keep_memory is set
      we could write the relocs out and then read them again; I don't
-     know how bad the memory loss will be.  */
+     know how bad the memory loss will be.
+
+     When the input sections may be relocated on several threads, the
+     input files are instead linked in batches: the local symbols of
+     each input file of a batch are written out in turn, then the
+     sections of all of them are relocated at once, and then written
+     out in the same order as they would otherwise have been.  */
+
+  if (elf_link_relocate_concurrently (abfd, info))
+    {
+      memset (&batch, 0, sizeof (batch));
+      batch.flinfo = &flinfo;
+      batch.thread_count = info->thread_count;
+#ifdef ENABLE_THREADS
+      pthread_mutex_init (&batch.lock, NULL);
+#endif
+      flinfo.batch = &batch;
+    }
 
   for (sub = info->input_bfds; sub != NULL; sub = sub->link.next)
     sub->output_has_begun = FALSE;
@@ -11571,13 +12790,27 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
 	    {
 	      if (! sub->output_has_begun)
 		{
-		  if (! elf_link_input_bfd (&flinfo, sub))
+		  if (flinfo.batch != NULL)
+		    {
+		      if (! elf_link_batch_input_bfd (flinfo.batch, sub))
+			goto error_return;
+		    }
+		  else if (! elf_link_input_bfd (&flinfo, sub))
 		    goto error_return;
 		  sub->output_has_begun = TRUE;
 		}
+	      continue;
 	    }
-	  else if (p->type == bfd_section_reloc_link_order
-		   || p->type == bfd_symbol_reloc_link_order)
+
+	  /* Anything else is written out after the input sections
+	     which come before it.  */
+	  if (flinfo.batch != NULL
+	      && flinfo.batch->section_count != 0
+	      && ! elf_link_batch_flush (flinfo.batch))
+	    goto error_return;
+
+	  if (p->type == bfd_section_reloc_link_order
+	      || p->type == bfd_symbol_reloc_link_order)
 	    {
 	      if (! elf_reloc_link_order (abfd, info, o, p))
 		goto error_return;
@@ -11622,6 +12855,14 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
 	}
     }
 
+  if (flinfo.batch != NULL)
+    {
+      if (! elf_link_batch_flush (flinfo.batch))
+	goto error_return;
+      elf_link_batch_free (flinfo.batch);
+      flinfo.batch = NULL;
+    }
+
   /* Free symbol buffer if needed.  */
   if (!info->reduce_memory_overheads)
     {
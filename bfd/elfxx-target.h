@@ -458,6 +458,9 @@
 #ifndef elf_backend_relocate_section
 #define elf_backend_relocate_section	0
 #endif
+#ifndef elf_backend_relocate_section_concurrently
+#define elf_backend_relocate_section_concurrently	0
+#endif
 #ifndef elf_backend_finish_dynamic_symbol
 #define elf_backend_finish_dynamic_symbol	0
 #endif
@@ -748,6 +751,7 @@ static struct elf_backend_data elfNN_bed =
   elf_backend_size_dynamic_sections,
   elf_backend_init_index_section,
   elf_backend_relocate_section,
+  elf_backend_relocate_section_concurrently,
   elf_backend_finish_dynamic_symbol,
   elf_backend_finish_dynamic_sections,
   elf_backend_begin_write_processing,
@@ -92,6 +92,23 @@ SUBSECTION
 	Use <<bfd_hash_set_default_size>> to set the default size of
 	hash table to use.
 
+@findex bfd_hash_table_reserve
+	A hash table grows as entries are added to it.  If you are
+	about to add many entries, call <<bfd_hash_table_reserve>>
+	with their number so that the table is resized once, up
+	front.
+
+@findex bfd_hash_table_reserve_now
+	<<bfd_hash_table_reserve>> may leave a single resize to
+	<<bfd_hash_insert>>.  If you are going to link the entries
+	into the table yourself, call <<bfd_hash_table_reserve_now>>
+	instead, which always makes the table big enough for them.
+
+@findex bfd_hash_table_stats
+	<<bfd_hash_table_stats>> fills in a <<struct
+	bfd_hash_table_stats>> with the number of slots and entries in
+	a hash table and the lengths of its chains.
+
 INODE
 Looking Up or Entering a String, Traversing a Hash Table, Creating and Freeing a Hash Table, Hash Tables
 SUBSECTION
@@ -300,6 +317,10 @@ SUBSUBSECTION
 /* The default number of entries to use when creating a hash table.  */
 #define DEFAULT_SIZE 4051
 
+/* The largest prime higher_prime_number returns, 4294967291.  */
+#define LARGEST_PRIME (((unsigned long) 2147483647) \
+		       + ((unsigned long) 2147483644))
+
 /* The following function returns a nearest prime number which is
    greater than N, and near a power of two.  Copied from libiberty.
    Returns zero for ridiculously large N to signify an error.  */
@@ -338,8 +359,7 @@ higher_prime_number (unsigned long n)
       (unsigned long) 536870909,
       (unsigned long) 1073741789,
       (unsigned long) 2147483647,
-					/* 4294967291L */
-      ((unsigned long) 2147483647) + ((unsigned long) 2147483644),
+      LARGEST_PRIME,
   };
 
   const unsigned long *low = &primes[0];
@@ -496,6 +516,48 @@ bfd_hash_lookup (struct bfd_hash_table *table,
   return bfd_hash_insert (table, string, hash);
 }
 
+/* Move the entries of a hash table to a new array of NEWSIZE slots.
+   If NEWSIZE is zero, or the new array cannot be allocated, leave the
+   table as it is and return FALSE.  */
+
+static bfd_boolean
+bfd_hash_table_grow (struct bfd_hash_table *table, unsigned long newsize)
+{
+  struct bfd_hash_entry **newtable;
+  unsigned int hi;
+  unsigned int _index;
+  unsigned long alloc = newsize * sizeof (struct bfd_hash_entry *);
+
+  /* If we can't find a higher prime, or we can't possibly alloc
+     that much memory, don't try to grow the table.  */
+  if (newsize == 0 || alloc / sizeof (struct bfd_hash_entry *) != newsize)
+    return FALSE;
+
+  newtable = ((struct bfd_hash_entry **)
+	      objalloc_alloc ((struct objalloc *) table->memory, alloc));
+  if (newtable == NULL)
+    return FALSE;
+  memset (newtable, 0, alloc);
+
+  for (hi = 0; hi < table->size; hi ++)
+    while (table->table[hi])
+      {
+	struct bfd_hash_entry *chain = table->table[hi];
+	struct bfd_hash_entry *chain_end = chain;
+
+	while (chain_end->next && chain_end->next->hash == chain->hash)
+	  chain_end = chain_end->next;
+
+	table->table[hi] = chain_end->next;
+	_index = chain->hash % newsize;
+	chain_end->next = newtable[_index];
+	newtable[_index] = chain;
+      }
+  table->table = newtable;
+  table->size = newsize;
+  return TRUE;
+}
+
 /* Insert an entry in a hash table.  */
 
 struct bfd_hash_entry *
@@ -516,49 +578,91 @@ bfd_hash_insert (struct bfd_hash_table *table,
   table->table[_index] = hashp;
   table->count++;
 
-  if (!table->frozen && table->count > table->size * 3 / 4)
+  if (!table->frozen && table->count > table->size * 3 / 4
+      && !bfd_hash_table_grow (table, higher_prime_number (table->size)))
+    table->frozen = 1;
+
+  return hashp;
+}
+
+/* Reserve room in a hash table for COUNT more entries.  If LAZY, and
+   growing the table once in the usual way would make enough room,
+   leave that to bfd_hash_insert.  */
+
+static void
+hash_table_reserve (struct bfd_hash_table *table, unsigned int count,
+		    bfd_boolean lazy)
+{
+  unsigned long need;
+
+  if (table->frozen)
+    return;
+
+  need = (unsigned long) table->count + count;
+  need += need / 3;
+
+  /* higher_prime_number returns zero past LARGEST_PRIME, which would
+     freeze the table, so settle for the largest table there is.  */
+  if (need >= LARGEST_PRIME)
+    need = LARGEST_PRIME - 1;
+  if (need < table->size)
+    return;
+
+  if (lazy && need <= higher_prime_number (table->size))
+    return;
+
+  /* Failing to make room is not an error: the table still grows as
+     entries are added, and chains are only longer otherwise.  */
+  bfd_hash_table_grow (table, higher_prime_number (need));
+}
+
+/* Reserve room in a hash table for COUNT more entries, so that adding
+   them does not grow the table again.  Callers about to add many
+   entries at once, such as the symbols of an input file, can use this
+   to rehash the table a single time rather than each time it becomes
+   three quarters full.  */
+
+void
+bfd_hash_table_reserve (struct bfd_hash_table *table, unsigned int count)
+{
+  hash_table_reserve (table, count, TRUE);
+}
+
+/* Likewise, but make the room now, for callers which link the new
+   entries into the table themselves, so that it never grows.  */
+
+void
+bfd_hash_table_reserve_now (struct bfd_hash_table *table, unsigned int count)
+{
+  hash_table_reserve (table, count, FALSE);
+}
+
+/* Report statistics about the chains in a hash table.  */
+
+void
+bfd_hash_table_stats (struct bfd_hash_table *table,
+		      struct bfd_hash_table_stats *stats)
+{
+  unsigned int i;
+
+  memset (stats, 0, sizeof (*stats));
+  stats->size = table->size;
+  stats->count = table->count;
+  for (i = 0; i < table->size; i++)
     {
-      unsigned long newsize = higher_prime_number (table->size);
-      struct bfd_hash_entry **newtable;
-      unsigned int hi;
-      unsigned long alloc = newsize * sizeof (struct bfd_hash_entry *);
-
-      /* If we can't find a higher prime, or we can't possibly alloc
-	 that much memory, don't try to grow the table.  */
-      if (newsize == 0 || alloc / sizeof (struct bfd_hash_entry *) != newsize)
-	{
-	  table->frozen = 1;
-	  return hashp;
-	}
+      struct bfd_hash_entry *p;
+      unsigned int len = 0;
 
-      newtable = ((struct bfd_hash_entry **)
-		  objalloc_alloc ((struct objalloc *) table->memory, alloc));
-      if (newtable == NULL)
-	{
-	  table->frozen = 1;
-	  return hashp;
-	}
-      memset (newtable, 0, alloc);
-
-      for (hi = 0; hi < table->size; hi ++)
-	while (table->table[hi])
-	  {
-	    struct bfd_hash_entry *chain = table->table[hi];
-	    struct bfd_hash_entry *chain_end = chain;
-
-	    while (chain_end->next && chain_end->next->hash == chain->hash)
-	      chain_end = chain_end->next;
-
-	    table->table[hi] = chain_end->next;
-	    _index = chain->hash % newsize;
-	    chain_end->next = newtable[_index];
-	    newtable[_index] = chain;
-	  }
-      table->table = newtable;
-      table->size = newsize;
+      for (p = table->table[i]; p != NULL; p = p->next)
+	len++;
+      if (len != 0)
+	stats->used++;
+      if (len > stats->longest)
+	stats->longest = len;
+      if (len >= ARRAY_SIZE (stats->chains))
+	len = ARRAY_SIZE (stats->chains) - 1;
+      stats->chains[len]++;
     }
-
-  return hashp;
 }
 
 /* Rename an entry in a hash table.  */
@@ -27,6 +27,7 @@
    Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
    MA 02110-1301, USA.  */
 
+#include <stdarg.h>
 #include "hashtab.h"
 
 #ifdef __cplusplus
@@ -90,6 +91,11 @@ struct artdata
   file_ptr armap_datepos;	/* Position within archive to seek to
 				   rewrite the date field.  */
   void *tdata;			/* Backend specific information.  */
+  /* Index of the symdefs by name, built by
+     _bfd_archive_build_symbol_index.  */
+  htab_t symbol_index;
+  /* For each symdef, the next one in the index with the same name.  */
+  symindex *symbol_index_next;
 };
 
 #define bfd_ardata(bfd) ((bfd)->tdata.aout_ar_data)
@@ -124,6 +130,7 @@ extern void *bfd_zmalloc2
   (bfd_size_type, bfd_size_type);
 
 extern void _bfd_default_error_handler (const char *s, ...);
+extern char *_bfd_error_message (const char *, va_list *);
 extern bfd_error_handler_type _bfd_error_handler;
 extern bfd_assert_handler_type _bfd_assert_handler;
 
@@ -187,6 +194,10 @@ bfd_boolean _bfd_compute_and_write_armap
   (bfd *, unsigned int elength);
 bfd *_bfd_get_elt_at_filepos
   (bfd *archive, file_ptr filepos);
+bfd_boolean _bfd_archive_build_symbol_index
+  (bfd *);
+symindex _bfd_archive_symbol_index_lookup
+  (bfd *, const char *, symindex);
 extern bfd *_bfd_generic_get_elt_at_index
   (bfd *, symindex);
 bfd * _bfd_new_bfd
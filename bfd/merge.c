@@ -29,6 +29,10 @@
 #include "libbfd.h"
 #include "hashtab.h"
 #include "libiberty.h"
+#include "objalloc.h"
+#ifdef ENABLE_THREADS
+#include <pthread.h>
+#endif
 
 struct sec_merge_sec_info;
 
@@ -70,6 +74,10 @@ struct sec_merge_hash
   unsigned int entsize;
   /* Are entries fixed size or zero terminated strings?  */
   bfd_boolean strings;
+  /* Memory for the entries added on other threads, one objalloc per
+     thread.  */
+  struct objalloc **shard_memory;
+  unsigned int shard_count;
 };
 
 struct sec_merge_info
@@ -130,18 +138,18 @@ sec_merge_hash_newfunc (struct bfd_hash_entry *entry,
   return entry;
 }
 
-/* Look up an entry in a section merge hash table.  */
+/* Compute the hash code of the entity at STRING in TABLE, and set
+   *PLEN to its length.  For strings, the length includes the zero
+   terminator.  */
 
-static struct sec_merge_hash_entry *
-sec_merge_hash_lookup (struct sec_merge_hash *table, const char *string,
-		       unsigned int alignment, bfd_boolean create)
+static unsigned long
+sec_merge_hash_string (struct sec_merge_hash *table, const char *string,
+		       unsigned int *plen)
 {
   const unsigned char *s;
   unsigned long hash;
   unsigned int c;
-  struct sec_merge_hash_entry *hashp;
   unsigned int len, i;
-  unsigned int _index;
 
   hash = 0;
   len = 0;
@@ -192,6 +200,21 @@ sec_merge_hash_lookup (struct sec_merge_hash *table, const char *string,
       len = table->entsize;
     }
 
+  *plen = len;
+  return hash;
+}
+
+/* Find the entity STRING, with hash code HASH and length LEN, in
+   TABLE.  This only looks at the chain for HASH.  */
+
+static struct sec_merge_hash_entry *
+sec_merge_hash_find (struct sec_merge_hash *table, const char *string,
+		     unsigned long hash, unsigned int len,
+		     unsigned int alignment, bfd_boolean create)
+{
+  struct sec_merge_hash_entry *hashp;
+  unsigned int _index;
+
   _index = hash % table->table.size;
   for (hashp = (struct sec_merge_hash_entry *) table->table.table[_index];
        hashp != NULL;
@@ -217,8 +240,23 @@ sec_merge_hash_lookup (struct sec_merge_hash *table, const char *string,
 	}
     }
 
-  if (! create)
-    return NULL;
+  return NULL;
+}
+
+/* Look up an entry in a section merge hash table, given its hash code
+   HASH and length LEN.  */
+
+static struct sec_merge_hash_entry *
+sec_merge_hash_lookup_hashed (struct sec_merge_hash *table,
+			      const char *string, unsigned long hash,
+			      unsigned int len, unsigned int alignment,
+			      bfd_boolean create)
+{
+  struct sec_merge_hash_entry *hashp;
+
+  hashp = sec_merge_hash_find (table, string, hash, len, alignment, create);
+  if (hashp != NULL || ! create)
+    return hashp;
 
   hashp = ((struct sec_merge_hash_entry *)
 	   bfd_hash_insert (&table->table, string, hash));
@@ -229,6 +267,20 @@ sec_merge_hash_lookup (struct sec_merge_hash *table, const char *string,
   return hashp;
 }
 
+/* Look up an entry in a section merge hash table.  */
+
+static struct sec_merge_hash_entry *
+sec_merge_hash_lookup (struct sec_merge_hash *table, const char *string,
+		       unsigned int alignment, bfd_boolean create)
+{
+  unsigned long hash;
+  unsigned int len;
+
+  hash = sec_merge_hash_string (table, string, &len);
+  return sec_merge_hash_lookup_hashed (table, string, hash, len, alignment,
+				       create);
+}
+
 /* Create a new hash table.  */
 
 static struct sec_merge_hash *
@@ -252,20 +304,24 @@ sec_merge_init (unsigned int entsize, bfd_boolean strings)
   table->last = NULL;
   table->entsize = entsize;
   table->strings = strings;
+  table->shard_memory = NULL;
+  table->shard_count = 0;
 
   return table;
 }
 
 /* Get the index of an entity in a hash table, adding it if it is not
-   already present.  */
+   already present.  HASH and LEN are as computed by
+   sec_merge_hash_string.  */
 
 static struct sec_merge_hash_entry *
 sec_merge_add (struct sec_merge_hash *tab, const char *str,
+	       unsigned long hash, unsigned int len,
 	       unsigned int alignment, struct sec_merge_sec_info *secinfo)
 {
   struct sec_merge_hash_entry *entry;
 
-  entry = sec_merge_hash_lookup (tab, str, alignment, TRUE);
+  entry = sec_merge_hash_lookup_hashed (tab, str, hash, len, alignment, TRUE);
   if (entry == NULL)
     return NULL;
 
@@ -459,17 +515,24 @@ _bfd_add_merge_section (bfd *abfd, void **psinfo, asection *sec,
   return FALSE;
 }
 
-/* Record one section into the hash table.  */
+/* Call ADD, with DATA, for each entity of the section SECINFO in
+   turn.  ADD is passed the entity, its hash code and length as
+   computed by sec_merge_hash_string, and the alignment it needs.  */
+
 static bfd_boolean
-record_section (struct sec_merge_info *sinfo,
-		struct sec_merge_sec_info *secinfo)
+sec_merge_scan (struct sec_merge_sec_info *secinfo,
+		bfd_boolean (*add) (void *, const char *, unsigned long,
+				    unsigned int, unsigned int),
+		void *data)
 {
   asection *sec = secinfo->sec;
-  struct sec_merge_hash_entry *entry;
+  struct sec_merge_hash *htab = secinfo->htab;
   bfd_boolean nul;
   unsigned char *p, *end;
   bfd_vma mask, eltalign;
   unsigned int align, i;
+  unsigned long hash;
+  unsigned int len;
 
   align = sec->alignment_power;
   end = secinfo->contents + sec->size;
@@ -483,11 +546,10 @@ record_section (struct sec_merge_info *sinfo,
 	  eltalign = ((eltalign ^ (eltalign - 1)) + 1) >> 1;
 	  if (!eltalign || eltalign > mask)
 	    eltalign = mask + 1;
-	  entry = sec_merge_add (sinfo->htab, (char *) p, (unsigned) eltalign,
-				 secinfo);
-	  if (! entry)
-	    goto error_return;
-	  p += entry->len;
+	  hash = sec_merge_hash_string (htab, (char *) p, &len);
+	  if (! (*add) (data, (char *) p, hash, len, (unsigned) eltalign))
+	    return FALSE;
+	  p += len;
 	  if (sec->entsize == 1)
 	    {
 	      while (p < end && *p == 0)
@@ -495,10 +557,9 @@ record_section (struct sec_merge_info *sinfo,
 		  if (!nul && !((p - secinfo->contents) & mask))
 		    {
 		      nul = TRUE;
-		      entry = sec_merge_add (sinfo->htab, "",
-					     (unsigned) mask + 1, secinfo);
-		      if (! entry)
-			goto error_return;
+		      hash = sec_merge_hash_string (htab, "", &len);
+		      if (! (*add) (data, "", hash, len, (unsigned) mask + 1))
+			return FALSE;
 		    }
 		  p++;
 		}
@@ -515,10 +576,10 @@ record_section (struct sec_merge_info *sinfo,
 		  if (!nul && !((p - secinfo->contents) & mask))
 		    {
 		      nul = TRUE;
-		      entry = sec_merge_add (sinfo->htab, (char *) p,
-					     (unsigned) mask + 1, secinfo);
-		      if (! entry)
-			goto error_return;
+		      hash = sec_merge_hash_string (htab, (char *) p, &len);
+		      if (! (*add) (data, (char *) p, hash, len,
+				    (unsigned) mask + 1))
+			return FALSE;
 		    }
 		  p += sec->entsize;
 		}
@@ -529,20 +590,368 @@ record_section (struct sec_merge_info *sinfo,
     {
       for (p = secinfo->contents; p < end; p += sec->entsize)
 	{
-	  entry = sec_merge_add (sinfo->htab, (char *) p, 1, secinfo);
-	  if (! entry)
-	    goto error_return;
+	  hash = sec_merge_hash_string (htab, (char *) p, &len);
+	  if (! (*add) (data, (char *) p, hash, len, 1))
+	    return FALSE;
 	}
     }
 
   return TRUE;
+}
+
+/* Add one entity of the section DATA to its hash table.  */
+
+static bfd_boolean
+record_entity (void *data, const char *str, unsigned long hash,
+	       unsigned int len, unsigned int alignment)
+{
+  struct sec_merge_sec_info *secinfo = (struct sec_merge_sec_info *) data;
+
+  return sec_merge_add (secinfo->htab, str, hash, len, alignment,
+			secinfo) != NULL;
+}
+
+/* Record one section into the hash table.  */
+static bfd_boolean
+record_section (struct sec_merge_info *sinfo,
+		struct sec_merge_sec_info *secinfo)
+{
+  if (sec_merge_scan (secinfo, record_entity, secinfo))
+    return TRUE;
 
-error_return:
   for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
     *secinfo->psecinfo = NULL;
   return FALSE;
 }
 
+#ifdef ENABLE_THREADS
+
+/* Run FUNC on COUNT threads, passing the Ith thread ARGS + I * SIZE.
+   The calling thread runs the first.  If a thread cannot be created,
+   its share of the work is done on the calling thread instead.  */
+
+static void
+sec_merge_run_threads (void *(*func) (void *), void *args, size_t size,
+		       unsigned int count)
+{
+  pthread_t *threads;
+  unsigned int n, started;
+
+  threads = NULL;
+  if (count > 1)
+    threads = (pthread_t *) bfd_malloc (count * sizeof (pthread_t));
+
+  started = 1;
+  if (threads != NULL)
+    for (; started < count; started++)
+      if (pthread_create (&threads[started], NULL, func,
+			  (char *) args + started * size) != 0)
+	break;
+
+  (*func) (args);
+  for (n = started; n < count; n++)
+    (*func) ((char *) args + n * size);
+  for (n = 1; n < started; n++)
+    pthread_join (threads[n], NULL);
+
+  if (threads != NULL)
+    free (threads);
+}
+
+/* An entity found in an input section by record_sections_concurrently.  */
+
+struct sec_merge_found
+{
+  union
+  {
+    /* The entity.  */
+    const char *str;
+    /* Once it has been looked up, the hash table entry it added, or
+       NULL if it was already there.  */
+    struct sec_merge_hash_entry *added;
+  } u;
+  unsigned long hash;
+  unsigned int len;
+  unsigned int alignment;
+};
+
+/* The entities of one input section, in order.  */
+
+struct sec_merge_found_sec
+{
+  struct sec_merge_sec_info *secinfo;
+  struct sec_merge_found *found;
+  size_t count;
+  size_t alloc;
+  bfd_boolean ok;
+};
+
+/* The state shared by the threads of record_sections_concurrently.  */
+
+struct sec_merge_record
+{
+  struct sec_merge_hash *htab;
+  struct sec_merge_found_sec *secs;
+  size_t sec_count;
+  /* The next section to scan.  */
+  size_t next;
+  pthread_mutex_t lock;
+};
+
+/* One of the threads adding entities to the hash table.  It owns the
+   hash table slots whose index modulo the number of threads is
+   INDEX, and so adds all copies of an entity, in input order.  */
+
+struct sec_merge_shard
+{
+  struct sec_merge_record *rec;
+  unsigned int index;
+  unsigned int count;
+  /* The number of entries added.  */
+  unsigned int added;
+  bfd_boolean ok;
+};
+
+/* Remember one entity of the section DATA.  */
+
+static bfd_boolean
+record_found (void *data, const char *str, unsigned long hash,
+	      unsigned int len, unsigned int alignment)
+{
+  struct sec_merge_found_sec *fs = (struct sec_merge_found_sec *) data;
+  struct sec_merge_found *f;
+
+  if (fs->count == fs->alloc)
+    {
+      size_t alloc = fs->alloc * 2 + 256;
+
+      f = ((struct sec_merge_found *)
+	   bfd_realloc (fs->found, alloc * sizeof (*f)));
+      if (f == NULL)
+	return FALSE;
+      fs->found = f;
+      fs->alloc = alloc;
+    }
+
+  f = &fs->found[fs->count++];
+  f->u.str = str;
+  f->hash = hash;
+  f->len = len;
+  f->alignment = alignment;
+  return TRUE;
+}
+
+/* Find and hash the entities of sections until there are none left.
+   This is run on each of the threads.  */
+
+static void *
+scan_sections (void *arg)
+{
+  struct sec_merge_record *rec = (struct sec_merge_record *) arg;
+
+  while (1)
+    {
+      struct sec_merge_found_sec *fs;
+      size_t i;
+
+      pthread_mutex_lock (&rec->lock);
+      i = rec->next++;
+      pthread_mutex_unlock (&rec->lock);
+      if (i >= rec->sec_count)
+	break;
+
+      fs = &rec->secs[i];
+      fs->ok = sec_merge_scan (fs->secinfo, record_found, fs);
+    }
+
+  return NULL;
+}
+
+/* Add the entities that hash to the slots of the shard ARG to the
+   hash table, allocating the new entries on the shard's objalloc.  */
+
+static void *
+add_shard_entities (void *arg)
+{
+  struct sec_merge_shard *shard = (struct sec_merge_shard *) arg;
+  struct sec_merge_hash *htab = shard->rec->htab;
+  struct objalloc *memory = htab->shard_memory[shard->index];
+  size_t i, j;
+
+  for (i = 0; i < shard->rec->sec_count; i++)
+    {
+      struct sec_merge_found_sec *fs = &shard->rec->secs[i];
+
+      for (j = 0; j < fs->count; j++)
+	{
+	  struct sec_merge_found *f = &fs->found[j];
+	  struct sec_merge_hash_entry *entry;
+	  unsigned int _index;
+
+	  _index = f->hash % htab->table.size;
+	  if (_index % shard->count != shard->index)
+	    continue;
+
+	  entry = sec_merge_hash_find (htab, f->u.str, f->hash, f->len,
+				       f->alignment, TRUE);
+	  if (entry != NULL)
+	    {
+	      f->u.added = NULL;
+	      continue;
+	    }
+
+	  entry = ((struct sec_merge_hash_entry *)
+		   objalloc_alloc (memory, sizeof (*entry)));
+	  if (entry == NULL)
+	    {
+	      shard->ok = FALSE;
+	      return NULL;
+	    }
+	  entry->root.string = f->u.str;
+	  entry->root.hash = f->hash;
+	  entry->root.next = htab->table.table[_index];
+	  htab->table.table[_index] = &entry->root;
+	  entry->len = f->len;
+	  entry->alignment = f->alignment;
+	  entry->u.suffix = NULL;
+	  entry->secinfo = fs->secinfo;
+	  entry->next = NULL;
+	  f->u.added = entry;
+	  shard->added++;
+	}
+    }
+
+  return NULL;
+}
+
+/* Record the sections of SINFO into its hash table on THREAD_COUNT
+   threads.  The entities of every section are found and hashed first,
+   a section per thread at a time, and then added to the hash table
+   with each thread owning a share of the hash table slots.  The
+   entries end up chained in the same order as record_section would
+   have left them, so the merged sections are the same.  */
+
+static bfd_boolean
+record_sections_concurrently (bfd *abfd, struct sec_merge_info *sinfo,
+			      void (*remove_hook) (bfd *, asection *),
+			      unsigned int thread_count)
+{
+  struct sec_merge_hash *htab = sinfo->htab;
+  struct sec_merge_sec_info *secinfo;
+  struct sec_merge_record rec;
+  struct sec_merge_shard *shards = NULL;
+  bfd_size_type total;
+  unsigned int n;
+  size_t i, j;
+  bfd_boolean ok = FALSE;
+
+  rec.htab = htab;
+  rec.sec_count = 0;
+  for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
+    rec.sec_count++;
+  rec.secs = ((struct sec_merge_found_sec *)
+	      bfd_zmalloc (rec.sec_count * sizeof (*rec.secs)));
+  if (rec.secs == NULL)
+    goto error_return;
+
+  rec.sec_count = 0;
+  for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
+    if (secinfo->sec->flags & SEC_EXCLUDE)
+      {
+	*secinfo->psecinfo = NULL;
+	if (remove_hook)
+	  (*remove_hook) (abfd, secinfo->sec);
+      }
+    else
+      rec.secs[rec.sec_count++].secinfo = secinfo;
+
+  rec.next = 0;
+  pthread_mutex_init (&rec.lock, NULL);
+  sec_merge_run_threads (scan_sections, &rec, 0,
+			 (thread_count < rec.sec_count
+			  ? thread_count : (unsigned int) rec.sec_count));
+  pthread_mutex_destroy (&rec.lock);
+
+  total = 0;
+  for (i = 0; i < rec.sec_count; i++)
+    {
+      if (! rec.secs[i].ok)
+	goto error_return;
+      total += rec.secs[i].count;
+    }
+
+  /* The threads add entries without growing the table, so make it
+     big enough for all of them first.  */
+  if (total > (unsigned int) -1)
+    total = (unsigned int) -1;
+  bfd_hash_table_reserve_now (&htab->table, total);
+
+  htab->shard_memory = ((struct objalloc **)
+			bfd_zmalloc (thread_count * sizeof (struct objalloc *)));
+  if (htab->shard_memory == NULL)
+    goto error_return;
+  htab->shard_count = thread_count;
+  shards = ((struct sec_merge_shard *)
+	    bfd_malloc (thread_count * sizeof (*shards)));
+  if (shards == NULL)
+    goto error_return;
+  for (n = 0; n < thread_count; n++)
+    {
+      htab->shard_memory[n] = objalloc_create ();
+      if (htab->shard_memory[n] == NULL)
+	goto error_return;
+      shards[n].rec = &rec;
+      shards[n].index = n;
+      shards[n].count = thread_count;
+      shards[n].added = 0;
+      shards[n].ok = TRUE;
+    }
+
+  sec_merge_run_threads (add_shard_entities, shards, sizeof (*shards),
+			 thread_count);
+
+  for (n = 0; n < thread_count; n++)
+    {
+      if (! shards[n].ok)
+	goto error_return;
+      htab->table.count += shards[n].added;
+    }
+
+  /* Chain the new entries in input order, as sec_merge_add does.  */
+  for (i = 0; i < rec.sec_count; i++)
+    for (j = 0; j < rec.secs[i].count; j++)
+      {
+	struct sec_merge_hash_entry *entry = rec.secs[i].found[j].u.added;
+
+	if (entry == NULL)
+	  continue;
+	htab->size++;
+	if (htab->first == NULL)
+	  htab->first = entry;
+	else
+	  htab->last->next = entry;
+	htab->last = entry;
+      }
+  ok = TRUE;
+
+ error_return:
+  if (shards != NULL)
+    free (shards);
+  if (rec.secs != NULL)
+    {
+      for (i = 0; i < rec.sec_count; i++)
+	if (rec.secs[i].found != NULL)
+	  free (rec.secs[i].found);
+      free (rec.secs);
+    }
+  if (! ok)
+    for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
+      *secinfo->psecinfo = NULL;
+  return ok;
+}
+
+#endif /* ENABLE_THREADS */
+
 static int
 strrevcmp (const void *a, const void *b)
 {
@@ -607,10 +1016,151 @@ is_suffix (const struct sec_merge_hash_entry *A,
 		 B->root.string, B->len) == 0;
 }
 
+#ifdef ENABLE_THREADS
+
+/* A run of the array being sorted by sec_merge_sort, or two adjacent
+   runs to be merged.  */
+
+struct sec_merge_sort_run
+{
+  struct sec_merge_hash_entry **src;
+  struct sec_merge_hash_entry **dst;
+  size_t start;
+  size_t mid;
+  size_t end;
+  int (*cmp) (const void *, const void *);
+};
+
+/* Sort the run ARG in place.  */
+
+static void *
+sort_run (void *arg)
+{
+  struct sec_merge_sort_run *run = (struct sec_merge_sort_run *) arg;
+
+  qsort (run->src + run->start, run->end - run->start,
+	 sizeof (struct sec_merge_hash_entry *), run->cmp);
+  return NULL;
+}
+
+/* Merge the two sorted runs of ARG from SRC into DST.  */
+
+static void *
+merge_runs (void *arg)
+{
+  struct sec_merge_sort_run *run = (struct sec_merge_sort_run *) arg;
+  size_t i = run->start, j = run->mid, k = run->start;
+
+  while (i < run->mid && j < run->end)
+    if ((*run->cmp) (&run->src[j], &run->src[i]) < 0)
+      run->dst[k++] = run->src[j++];
+    else
+      run->dst[k++] = run->src[i++];
+  while (i < run->mid)
+    run->dst[k++] = run->src[i++];
+  while (j < run->end)
+    run->dst[k++] = run->src[j++];
+  return NULL;
+}
+
+#endif /* ENABLE_THREADS */
+
+/* Sort the COUNT entries of ARRAY with CMP.  CMP orders all strings
+   in the hash table, as they are distinct, so the result does not
+   depend on how the work is split.  With more than one thread, runs
+   of the array are sorted on THREAD_COUNT threads, and then merged in
+   pairs, also concurrently.  */
+
+static void
+sec_merge_sort (struct sec_merge_hash_entry **array, size_t count,
+		int (*cmp) (const void *, const void *),
+		unsigned int thread_count ATTRIBUTE_UNUSED)
+{
+#ifdef ENABLE_THREADS
+  struct sec_merge_sort_run *runs;
+  struct sec_merge_hash_entry **tmp, **src, **dst;
+  size_t *bounds;
+  unsigned int n, nruns;
+
+  /* Small arrays are not worth the threads.  */
+  nruns = thread_count;
+  if (count / 4096 < nruns)
+    nruns = count / 4096;
+  if (nruns > 1)
+    {
+      tmp = ((struct sec_merge_hash_entry **)
+	     bfd_malloc (count * sizeof (*tmp)));
+      runs = ((struct sec_merge_sort_run *)
+	      bfd_malloc (nruns * sizeof (*runs)));
+      bounds = (size_t *) bfd_malloc ((nruns + 1) * sizeof (*bounds));
+      if (tmp != NULL && runs != NULL && bounds != NULL)
+	{
+	  for (n = 0; n <= nruns; n++)
+	    bounds[n] = count / nruns * n + (n == nruns ? count % nruns : 0);
+	  for (n = 0; n < nruns; n++)
+	    {
+	      runs[n].src = array;
+	      runs[n].start = bounds[n];
+	      runs[n].end = bounds[n + 1];
+	      runs[n].cmp = cmp;
+	    }
+	  sec_merge_run_threads (sort_run, runs, sizeof (*runs), nruns);
+
+	  /* Merge pairs of adjacent runs until there is only one.  An
+	     odd run out is copied along unchanged.  */
+	  src = array;
+	  dst = tmp;
+	  while (nruns > 1)
+	    {
+	      unsigned int pairs = (nruns + 1) / 2;
+
+	      for (n = 0; n < pairs; n++)
+		{
+		  runs[n].src = src;
+		  runs[n].dst = dst;
+		  runs[n].cmp = cmp;
+		  runs[n].start = bounds[2 * n];
+		  if (2 * n + 1 < nruns)
+		    {
+		      runs[n].mid = bounds[2 * n + 1];
+		      runs[n].end = bounds[2 * n + 2];
+		    }
+		  else
+		    runs[n].mid = runs[n].end = bounds[2 * n + 1];
+		}
+	      sec_merge_run_threads (merge_runs, runs, sizeof (*runs), pairs);
+
+	      for (n = 0; n < pairs; n++)
+		bounds[n] = runs[n].start;
+	      bounds[pairs] = count;
+	      nruns = pairs;
+	      src = dst;
+	      dst = dst == tmp ? array : tmp;
+	    }
+	  if (src != array)
+	    memcpy (array, src, count * sizeof (*array));
+
+	  free (bounds);
+	  free (runs);
+	  free (tmp);
+	  return;
+	}
+      if (bounds != NULL)
+	free (bounds);
+      if (runs != NULL)
+	free (runs);
+      if (tmp != NULL)
+	free (tmp);
+    }
+#endif
+
+  qsort (array, count, sizeof (struct sec_merge_hash_entry *), cmp);
+}
+
 /* This is a helper function for _bfd_merge_sections.  It attempts to
    merge strings matching suffixes of longer strings.  */
 static void
-merge_strings (struct sec_merge_info *sinfo)
+merge_strings (struct sec_merge_info *sinfo, unsigned int thread_count)
 {
   struct sec_merge_hash_entry **array, **a, *e;
   struct sec_merge_sec_info *secinfo;
@@ -641,10 +1191,11 @@ merge_strings (struct sec_merge_info *sinfo)
   sinfo->htab->size = a - array;
   if (sinfo->htab->size != 0)
     {
-      qsort (array, (size_t) sinfo->htab->size,
-	     sizeof (struct sec_merge_hash_entry *),
-	     (alignment != (unsigned) -1 && alignment > sinfo->htab->entsize
-	      ? strrevcmp_align : strrevcmp));
+      sec_merge_sort (array, (size_t) sinfo->htab->size,
+		      (alignment != (unsigned) -1
+		       && alignment > sinfo->htab->entsize
+		       ? strrevcmp_align : strrevcmp),
+		      thread_count);
 
       /* Loop over the sorted array and merge suffixes */
       e = *--a;
@@ -726,6 +1277,12 @@ _bfd_merge_sections (bfd *abfd,
 		     void (*remove_hook) (bfd *, asection *))
 {
   struct sec_merge_info *sinfo;
+  unsigned int thread_count = 1;
+
+#ifdef ENABLE_THREADS
+  if (info->thread_count > 1)
+    thread_count = info->thread_count;
+#endif
 
   for (sinfo = (struct sec_merge_info *) xsinfo; sinfo; sinfo = sinfo->next)
     {
@@ -740,24 +1297,35 @@ _bfd_merge_sections (bfd *abfd,
       secinfo->next = NULL;
 
       /* Record the sections into the hash table.  */
-      for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
-	if (secinfo->sec->flags & SEC_EXCLUDE)
-	  {
-	    *secinfo->psecinfo = NULL;
-	    if (remove_hook)
-	      (*remove_hook) (abfd, secinfo->sec);
-	  }
-	else if (! record_section (sinfo, secinfo))
-	  break;
+#ifdef ENABLE_THREADS
+      if (thread_count > 1 && sinfo->chain->next != NULL)
+	{
+	  if (! record_sections_concurrently (abfd, sinfo, remove_hook,
+					      thread_count))
+	    continue;
+	}
+      else
+#endif
+	{
+	  for (secinfo = sinfo->chain; secinfo; secinfo = secinfo->next)
+	    if (secinfo->sec->flags & SEC_EXCLUDE)
+	      {
+		*secinfo->psecinfo = NULL;
+		if (remove_hook)
+		  (*remove_hook) (abfd, secinfo->sec);
+	      }
+	    else if (! record_section (sinfo, secinfo))
+	      break;
 
-      if (secinfo)
-	continue;
+	  if (secinfo)
+	    continue;
+	}
 
       if (sinfo->htab->first == NULL)
 	continue;
 
       if (sinfo->htab->strings)
-	merge_strings (sinfo);
+	merge_strings (sinfo, thread_count);
       else
 	{
 	  struct sec_merge_hash_entry *e;
@@ -927,7 +1495,14 @@ _bfd_merge_sections_free (void *xsinfo)
 
   for (sinfo = (struct sec_merge_info *) xsinfo; sinfo; sinfo = sinfo->next)
     {
+      unsigned int n;
+
       bfd_hash_table_free (&sinfo->htab->table);
+      for (n = 0; n < sinfo->htab->shard_count; n++)
+	if (sinfo->htab->shard_memory[n] != NULL)
+	  objalloc_free (sinfo->htab->shard_memory[n]);
+      if (sinfo->htab->shard_memory != NULL)
+	free (sinfo->htab->shard_memory);
       free (sinfo->htab);
     }
 }
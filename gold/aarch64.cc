@@ -1722,7 +1722,7 @@ class AArch64_relobj : public Sized_relobj_file<size, big_endian>
   AArch64_relobj(const std::string& name, Input_file* input_file, off_t offset,
 		 const typename elfcpp::Ehdr<size, big_endian>& ehdr)
     : Sized_relobj_file<size, big_endian>(name, input_file, offset, ehdr),
-      stub_tables_()
+      stub_tables_(), stub_relocs_()
   { }
 
   ~AArch64_relobj()
@@ -1756,6 +1756,17 @@ class AArch64_relobj : public Sized_relobj_file<size, big_endian>
   scan_sections_for_stubs(The_target_aarch64*, const Symbol_table*,
 			  const Layout*);
 
+  // Record which of the RELOC_COUNT relocations at PRELOCS, which
+  // apply to section SHNDX, may need a stub.
+  void
+  record_stub_relocs(unsigned int shndx, const unsigned char* prelocs,
+		     size_t reloc_count);
+
+  // Free the lists made by record_stub_relocs.
+  void
+  clear_stub_relocs()
+  { Stub_relocs_map().swap(this->stub_relocs_); }
+
   // Whether a section is a scannable text section.
   bool
   text_section_is_scannable(const elfcpp::Shdr<size, big_endian>&, unsigned int,
@@ -1835,9 +1846,43 @@ class AArch64_relobj : public Sized_relobj_file<size, big_endian>
 				    const Relobj::Output_sections&,
 				    const Symbol_table*, const unsigned char*);
 
+  // The relocations of a section which may need a stub.
+  struct Stub_relocs
+  {
+    Stub_relocs()
+      : reloc_count(0), indexes()
+    { }
+
+    // The number of relocations in the relocation section, or -1 if
+    // more than one relocation section applies to the section.
+    size_t reloc_count;
+    // The indexes of the branch relocations.
+    std::vector<unsigned int> indexes;
+  };
+
+  typedef Unordered_map<unsigned int, Stub_relocs> Stub_relocs_map;
+
+  // Return the indexes of the relocations which may need a stub
+  // among the RELOC_COUNT relocations for section SHNDX, or NULL if
+  // they were not recorded.
+  const std::vector<unsigned int>*
+  stub_relocs(unsigned int shndx, size_t reloc_count) const
+  {
+    typename Stub_relocs_map::const_iterator p =
+      this->stub_relocs_.find(shndx);
+    if (p == this->stub_relocs_.end() || p->second.reloc_count != reloc_count)
+      return NULL;
+    return &p->second.indexes;
+  }
+
   // List of stub tables.
   Stub_table_list stub_tables_;
 
+  // The relocations which may need a stub, by the index of the section
+  // they apply to.  These are recorded when the relocations are
+  // scanned, so that each relaxation pass only looks at them.
+  Stub_relocs_map stub_relocs_;
+
   // Mapping symbol information sorted by (section index, section_offset).
   Mapping_symbol_info mapping_symbol_info_;
 };  // End of AArch64_relobj
@@ -2250,6 +2295,41 @@ AArch64_relobj<size, big_endian>::scan_errata(
 }
 
 
+// Record the branch relocations, which are the ones that may need a
+// stub.  This is called from the Scan_relocs task for this object, so
+// with --threads different objects are done in parallel.
+
+template<int size, bool big_endian>
+void
+AArch64_relobj<size, big_endian>::record_stub_relocs(
+    unsigned int shndx,
+    const unsigned char* prelocs,
+    size_t reloc_count)
+{
+  std::pair<typename Stub_relocs_map::iterator, bool> ins =
+    this->stub_relocs_.insert(std::make_pair(shndx, Stub_relocs()));
+  Stub_relocs* stub_relocs = &ins.first->second;
+  if (!ins.second)
+    {
+      // More than one relocation section applies to this section.
+      // Leave them to be scanned in full.
+      stub_relocs->reloc_count = static_cast<size_t>(-1);
+      std::vector<unsigned int>().swap(stub_relocs->indexes);
+      return;
+    }
+
+  stub_relocs->reloc_count = reloc_count;
+  const int reloc_size = elfcpp::Elf_sizes<size>::rela_size;
+  for (size_t i = 0; i < reloc_count; ++i, prelocs += reloc_size)
+    {
+      elfcpp::Rela<size, big_endian> reloc(prelocs);
+      unsigned int r_type = elfcpp::elf_r_type<size>(reloc.get_r_info());
+      if (Target_aarch64<size, big_endian>::reloc_may_need_stub(r_type))
+	stub_relocs->indexes.push_back(i);
+    }
+}
+
+
 // Scan relocations for stub generation.
 
 template<int size, bool big_endian>
@@ -2323,9 +2403,11 @@ AArch64_relobj<size, big_endian>::scan_sections_for_stubs(
 	  gold_assert (sh_type == elfcpp::SHT_RELA);
 	  reloc_size = elfcpp::Elf_sizes<size>::rela_size;
 
+	  size_t reloc_count = shdr.get_sh_size() / reloc_size;
 	  Output_section* os = out_sections[index];
 	  target->scan_section_for_stubs(&relinfo, sh_type, prelocs,
-					 shdr.get_sh_size() / reloc_size,
+					 reloc_count,
+					 this->stub_relocs(index, reloc_count),
 					 os,
 					 output_offset == invalid_address,
 					 input_view, output_address,
@@ -2961,10 +3043,12 @@ class Target_aarch64 : public Sized_target<size, big_endian>
   unsigned int
   tcb_size() const { return This::TCB_SIZE; }
 
-  // Scan a section for stub generation.
+  // Scan a section for stub generation.  If the vector is not NULL,
+  // only the relocations with those indexes are scanned.
   void
   scan_section_for_stubs(const Relocate_info<size, big_endian>*, unsigned int,
-			 const unsigned char*, size_t, Output_section*,
+			 const unsigned char*, size_t,
+			 const std::vector<unsigned int>*, Output_section*,
 			 bool, const unsigned char*,
 			 Address,
 			 section_size_type);
@@ -2976,12 +3060,22 @@ class Target_aarch64 : public Sized_target<size, big_endian>
       const The_relocate_info* relinfo,
       const unsigned char* prelocs,
       size_t reloc_count,
+      const std::vector<unsigned int>* reloc_indexes,
       Output_section* output_section,
       bool needs_special_offset_handling,
       const unsigned char* view,
       Address view_address,
       section_size_type);
 
+  // Return whether a relocation of type R_TYPE is a branch which may
+  // need a stub.
+  static bool
+  reloc_may_need_stub(unsigned int r_type)
+  {
+    return (r_type == elfcpp::R_AARCH64_CALL26
+	    || r_type == elfcpp::R_AARCH64_JUMP26);
+  }
+
   // Relocate a single stub.
   void
   relocate_stub(The_reloc_stub*, const Relocate_info<size, big_endian>*,
@@ -3803,6 +3897,7 @@ Target_aarch64<size, big_endian>::scan_reloc_section_for_stubs(
     const Relocate_info<size, big_endian>* relinfo,
     const unsigned char* prelocs,
     size_t reloc_count,
+    const std::vector<unsigned int>* reloc_indexes,
     Output_section* /*output_section*/,
     bool /*needs_special_offset_handling*/,
     const unsigned char* /*view*/,
@@ -3820,14 +3915,16 @@ Target_aarch64<size, big_endian>::scan_reloc_section_for_stubs(
   gold::Default_comdat_behavior default_comdat_behavior;
   Comdat_behavior comdat_behavior = CB_UNDETERMINED;
 
-  for (size_t i = 0; i < reloc_count; ++i, prelocs += reloc_size)
+  // If we know which relocations are branches, only look at those.
+  size_t count = reloc_indexes != NULL ? reloc_indexes->size() : reloc_count;
+  for (size_t j = 0; j < count; ++j)
     {
-      Reltype reloc(prelocs);
+      size_t i = reloc_indexes != NULL ? (*reloc_indexes)[j] : j;
+      Reltype reloc(prelocs + i * reloc_size);
       typename elfcpp::Elf_types<size>::Elf_WXword r_info = reloc.get_r_info();
       unsigned int r_sym = elfcpp::elf_r_sym<size>(r_info);
       unsigned int r_type = elfcpp::elf_r_type<size>(r_info);
-      if (r_type != elfcpp::R_AARCH64_CALL26
-	  && r_type != elfcpp::R_AARCH64_JUMP26)
+      if (!This::reloc_may_need_stub(r_type))
 	continue;
 
       section_offset_type offset =
@@ -3980,6 +4077,7 @@ Target_aarch64<size, big_endian>::scan_section_for_stubs(
     unsigned int sh_type,
     const unsigned char* prelocs,
     size_t reloc_count,
+    const std::vector<unsigned int>* reloc_indexes,
     Output_section* output_section,
     bool needs_special_offset_handling,
     const unsigned char* view,
@@ -3991,6 +4089,7 @@ Target_aarch64<size, big_endian>::scan_section_for_stubs(
       relinfo,
       prelocs,
       reloc_count,
+      reloc_indexes,
       output_section,
       needs_special_offset_handling,
       view,
@@ -5569,10 +5668,18 @@ Target_aarch64<size, big_endian>::do_relax(
   // Do not continue relaxation.
   bool continue_relaxation = any_stub_table_changed;
   if (!continue_relaxation)
-    for (Stub_table_iterator sp = this->stub_tables_.begin();
-	 (sp != this->stub_tables_.end());
-	 ++sp)
-      (*sp)->finalize_stubs();
+    {
+      for (Stub_table_iterator sp = this->stub_tables_.begin();
+	   (sp != this->stub_tables_.end());
+	   ++sp)
+	(*sp)->finalize_stubs();
+
+      // The branch relocations are no longer needed.
+      for (Input_objects::Relobj_iterator op = input_objects->relobj_begin();
+	   op != input_objects->relobj_end();
+	   ++op)
+	static_cast<The_aarch64_relobj*>(*op)->clear_stub_relocs();
+    }
 
   return continue_relaxation;
 }
@@ -6715,6 +6822,17 @@ Target_aarch64<size, big_endian>::scan_relocs(
     needs_special_offset_handling,
     local_symbol_count,
     plocal_symbols);
+
+  // Note the branches in code sections, so that the relaxation passes
+  // do not have to look at every relocation again.
+  if (this->may_relax()
+      && output_section != NULL
+      && (output_section->flags() & elfcpp::SHF_EXECINSTR) != 0)
+    {
+      AArch64_relobj<size, big_endian>* aarch64_relobj =
+	static_cast<AArch64_relobj<size, big_endian>*>(object);
+      aarch64_relobj->record_stub_relocs(data_shndx, prelocs, reloc_count);
+    }
 }
 
 // Return the value to use for a dynamic which requires special
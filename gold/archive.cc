@@ -23,9 +23,13 @@
 #include "gold.h"
 
 #include <cerrno>
+#include <cstdio>
 #include <cstring>
 #include <climits>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "libiberty.h"
 #include "filenames.h"
 
@@ -38,6 +42,7 @@
 #include "object.h"
 #include "layout.h"
 #include "archive.h"
+#include "descriptors.h"
 #include "plugin.h"
 #include "incremental.h"
 
@@ -178,6 +183,49 @@ struct Archive::Archive_header
 unsigned int Archive::total_archives;
 unsigned int Archive::total_members;
 unsigned int Archive::total_members_loaded;
+unsigned int Archive::total_cache_hits;
+unsigned int Archive::total_cache_misses;
+
+// The archive cache.  With --archive-cache, the symbol map, the
+// extended name table and the member count of each archive are saved
+// in a file in the cache directory, so that later links need not
+// read and parse the symbol map again.  A cache file holds, in host
+// byte order:
+//   the magic string archive_cache_magic;
+//   the size of the key and the key (see Archive::cache_key);
+//   the member count, the symbol count, the size of the symbol
+//   names and the size of the extended name table, as 64-bit words;
+//   the name offset and file offset of each symbol, as 64-bit words;
+//   the symbol names and the extended name table.
+// Nothing ever removes files from the cache directory.  A changed
+// archive gets a new key and so a new file, and the file for the old
+// contents stays behind until the user removes it.
+
+static const char archive_cache_magic[8] =
+{
+  'g', 'a', 'r', 'c', 'h', 'e', '0', '1'
+};
+
+// Return the name of the file in CACHE_DIR which holds the archive
+// identified by KEY.  The file is named for a hash of the key; the key
+// itself is stored in the file to detect collisions.
+
+static std::string
+archive_cache_file_name(const char* cache_dir, const std::string& key)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < key.size(); ++i)
+    {
+      hash ^= static_cast<unsigned char>(key[i]);
+      hash *= 1099511628211ULL;
+    }
+  char buf[20];
+  snprintf(buf, sizeof buf, "%016llx", static_cast<unsigned long long>(hash));
+  std::string ret(cache_dir);
+  ret += '/';
+  ret += buf;
+  return ret;
+}
 
 // Archive methods.
 
@@ -201,7 +249,7 @@ Archive::Archive(const std::string& name, Input_file* input_file,
     armap_names_(), extended_names_(), armap_checked_(), seen_offsets_(),
     members_(), is_thin_archive_(is_thin_archive), included_member_(false),
     nested_archives_(), dirpath_(dirpath), num_members_(0),
-    included_all_members_(false)
+    included_all_members_(false), cache_status_(CACHE_UNUSED)
 {
   this->no_export_ =
     parameters->options().check_excluded_libs(input_file->found_name());
@@ -217,6 +265,45 @@ Archive::setup()
   if (this->input_file_->file().filesize() == sarmag)
     return;
 
+  const char* cache_dir = parameters->options().archive_cache();
+  if (cache_dir == NULL || *cache_dir == '\0')
+    this->read_symbol_table();
+  else
+    {
+      std::string key = this->cache_key();
+      std::string cache_file = archive_cache_file_name(cache_dir, key);
+
+      if (this->read_cache(cache_file, key))
+	this->cache_status_ = CACHE_HIT;
+      else
+	{
+	  int errors = parameters->errors()->error_count();
+	  this->read_symbol_table();
+	  this->cache_status_ = CACHE_MISS;
+	  if (!this->armap_.empty()
+	      && parameters->errors()->error_count() == errors)
+	    this->write_cache(cache_file, key);
+	}
+    }
+
+  bool preread_syms = (parameters->options().threads()
+                       && parameters->options().preread_archive_symbols());
+#ifndef ENABLE_THREADS
+  preread_syms = false;
+#else
+  if (parameters->options().has_plugins())
+    preread_syms = false;
+#endif
+  if (preread_syms)
+    this->read_all_symbols();
+}
+
+// Read the archive symbol map and the extended name table from the
+// file.
+
+void
+Archive::read_symbol_table()
+{
   // The first member of the archive should be the symbol table.
   std::string armap_name;
   off_t header_size = this->read_header(sarmag, false, &armap_name, NULL);
@@ -257,16 +344,6 @@ Archive::setup()
       const char* px = reinterpret_cast<const char*>(p);
       this->extended_names_.assign(px, extended_size);
     }
-  bool preread_syms = (parameters->options().threads()
-                       && parameters->options().preread_archive_symbols());
-#ifndef ENABLE_THREADS
-  preread_syms = false;
-#else
-  if (parameters->options().has_plugins())
-    preread_syms = false;
-#endif
-  if (preread_syms)
-    this->read_all_symbols();
 }
 
 // Unlock any nested archives.
@@ -336,6 +413,167 @@ Archive::read_armap(off_t start, section_size_type size)
   this->armap_checked_.resize(nsyms);
 }
 
+// Return the key which identifies this archive in the archive cache.
+
+std::string
+Archive::cache_key()
+{
+  char* path = lrealpath(this->file().filename().c_str());
+  std::string key(path);
+  free(path);
+
+  Timespec mtime = this->file().get_mtime();
+  char buf[100];
+  snprintf(buf, sizeof buf, "%lld.%09d %lld",
+	   static_cast<long long>(mtime.seconds), mtime.nanoseconds,
+	   static_cast<long long>(this->file().filesize()));
+  key += '\0';
+  key += buf;
+  return key;
+}
+
+// Read the symbol map, the extended name table and the member count
+// from the cache file CACHE_FILE.
+
+bool
+Archive::read_cache(const std::string& cache_file, const std::string& key)
+{
+  int o = open_descriptor(-1, cache_file.c_str(), O_RDONLY);
+  if (o < 0)
+    return false;
+
+  std::string contents;
+  struct stat st;
+  if (::fstat(o, &st) == 0 && st.st_size > 0)
+    {
+      contents.resize(st.st_size);
+      size_t got = 0;
+      while (got < contents.size())
+	{
+	  ssize_t len = ::read(o, &contents[got], contents.size() - got);
+	  if (len <= 0)
+	    break;
+	  got += len;
+	}
+      contents.resize(got);
+    }
+  release_descriptor(o, true);
+
+  const char* p = contents.data();
+  const char* pend = p + contents.size();
+  if (static_cast<size_t>(pend - p) < sizeof archive_cache_magic + 8
+      || memcmp(p, archive_cache_magic, sizeof archive_cache_magic) != 0)
+    return false;
+  p += sizeof archive_cache_magic;
+
+  uint64_t key_size;
+  memcpy(&key_size, p, 8);
+  p += 8;
+  if (key_size != key.size()
+      || static_cast<uint64_t>(pend - p) < key_size + 4 * 8
+      || memcmp(p, key.data(), key_size) != 0)
+    return false;
+  p += key_size;
+
+  uint64_t header[4];
+  memcpy(header, p, sizeof header);
+  p += sizeof header;
+  uint64_t num_members = header[0];
+  uint64_t nsyms = header[1];
+  uint64_t names_size = header[2];
+  uint64_t extended_size = header[3];
+  uint64_t left = pend - p;
+  if (nsyms > left / 16
+      || names_size > left - nsyms * 16
+      || extended_size != left - nsyms * 16 - names_size)
+    return false;
+
+  std::vector<uint64_t> entries(nsyms * 2);
+  if (nsyms > 0)
+    memcpy(&entries[0], p, nsyms * 16);
+  p += nsyms * 16;
+
+  // The key includes the size of the archive, but check every file
+  // offset against it anyway; if the cache file is damaged, we read the
+  // symbol map from the archive and write the cache file again.
+  uint64_t file_size = this->file().filesize();
+  for (uint64_t i = 0; i < nsyms; ++i)
+    if (entries[i * 2] >= names_size
+	|| entries[i * 2 + 1] < sarmag
+	|| entries[i * 2 + 1] >= file_size)
+      return false;
+
+  this->armap_.resize(nsyms);
+  for (uint64_t i = 0; i < nsyms; ++i)
+    {
+      this->armap_[i].name_offset = entries[i * 2];
+      this->armap_[i].file_offset = entries[i * 2 + 1];
+    }
+  this->armap_names_.assign(p, names_size);
+  p += names_size;
+  this->extended_names_.assign(p, extended_size);
+  this->num_members_ = num_members;
+  this->armap_checked_.resize(nsyms);
+  return true;
+}
+
+// Write the symbol map, the extended name table and the member count
+// to the cache file CACHE_FILE.  The file is written under a temporary
+// name and then renamed, so that a link running in parallel never
+// sees a partial file.
+
+void
+Archive::write_cache(const std::string& cache_file,
+		     const std::string& key) const
+{
+  std::string contents(archive_cache_magic, sizeof archive_cache_magic);
+  uint64_t key_size = key.size();
+  contents.append(reinterpret_cast<const char*>(&key_size), 8);
+  contents.append(key);
+
+  uint64_t header[4];
+  header[0] = this->num_members_;
+  header[1] = this->armap_.size();
+  header[2] = this->armap_names_.size();
+  header[3] = this->extended_names_.size();
+  contents.append(reinterpret_cast<const char*>(header), sizeof header);
+
+  for (std::vector<Armap_entry>::const_iterator p = this->armap_.begin();
+       p != this->armap_.end();
+       ++p)
+    {
+      uint64_t entry[2];
+      entry[0] = p->name_offset;
+      entry[1] = p->file_offset;
+      contents.append(reinterpret_cast<const char*>(entry), sizeof entry);
+    }
+  contents.append(this->armap_names_);
+  contents.append(this->extended_names_);
+
+  char buf[30];
+  snprintf(buf, sizeof buf, ".%ld.tmp", static_cast<long>(getpid()));
+  std::string tmp_file = cache_file + buf;
+  int o = open_descriptor(-1, tmp_file.c_str(),
+			  O_WRONLY | O_CREAT | O_EXCL | O_TRUNC, 0666);
+  if (o < 0)
+    return;
+
+  size_t written = 0;
+  while (written < contents.size())
+    {
+      ssize_t len = ::write(o, contents.data() + written,
+			    contents.size() - written);
+      if (len <= 0)
+	break;
+      written += len;
+    }
+  release_descriptor(o, true);
+
+  if (written != contents.size()
+      || ::rename(tmp_file.c_str(), cache_file.c_str()) != 0)
+    ::unlink(tmp_file.c_str());
+}
+
 // Read the header of an archive member at OFF.  Fail if something
 // goes wrong.  Return the size of the member.  Set *PNAME to the name
 // of the member.
@@ -773,6 +1011,12 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
 {
   ++Archive::total_archives;
 
+  if (this->cache_status_ == CACHE_HIT)
+    ++Archive::total_cache_hits;
+  else if (this->cache_status_ == CACHE_MISS)
+    ++Archive::total_cache_misses;
+  this->cache_status_ = CACHE_UNUSED;
+
   if (this->input_file_->options().whole_archive())
     return this->include_all_members(symtab, layout, input_objects,
 				     mapfile);
@@ -1087,6 +1331,13 @@ Archive::print_stats()
           program_name, Archive::total_members);
   fprintf(stderr, _("%s: loaded archive members: %u\n"),
           program_name, Archive::total_members_loaded);
+  if (parameters->options().archive_cache() != NULL)
+    {
+      fprintf(stderr, _("%s: archive cache hits: %u\n"),
+	      program_name, Archive::total_cache_hits);
+      fprintf(stderr, _("%s: archive cache misses: %u\n"),
+	      program_name, Archive::total_cache_misses);
+    }
 }
 
 // Add_archive_symbols methods.
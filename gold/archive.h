@@ -287,16 +287,56 @@ class Archive : public Library_base
   // Number of archive members loaded.
   static unsigned int total_members_loaded;
 
+  // Number of archives whose symbol table was found in the
+  // --archive-cache directory.
+  static unsigned int total_cache_hits;
+  // Number of archives whose symbol table was not found in the
+  // --archive-cache directory.
+  static unsigned int total_cache_misses;
+
+  // Whether the symbol table was read from the archive cache.
+  enum Cache_status
+  {
+    // The archive cache was not used.
+    CACHE_UNUSED,
+    // The symbol table was found in the archive cache.
+    CACHE_HIT,
+    // The symbol table was read from the archive and then written
+    // to the archive cache.
+    CACHE_MISS
+  };
+
   // Get a view into the underlying file.
   const unsigned char*
   get_view(off_t start, section_size_type size, bool aligned, bool cache)
   { return this->input_file_->file().get_view(0, start, size, aligned, cache); }
 
+  // Read the archive symbol map and the extended name table from
+  // the file.
+  void
+  read_symbol_table();
+
   // Read the archive symbol map.
   template<int mapsize>
   void
   read_armap(off_t start, section_size_type size);
 
+  // Return the key which identifies this archive in the archive
+  // cache: the real path name, the modification time and the size.
+  std::string
+  cache_key();
+
+  // Read the archive symbol map, the extended name table and the
+  // member count from the cache file CACHE_FILE.  Return false if the
+  // file does not exist or is not for the archive identified by KEY.
+  bool
+  read_cache(const std::string& cache_file, const std::string& key);
+
+  // Write the archive symbol map, the extended name table and the
+  // member count to the cache file CACHE_FILE.  Errors are ignored.
+  void
+  write_cache(const std::string& cache_file, const std::string& key) const;
+
   // Read an archive member header at OFF.  CACHE is whether to cache
   // the file view.  Return the size of the member, and set *PNAME to
   // the name.
@@ -411,6 +451,9 @@ class Archive : public Library_base
   bool no_export_;
   // True if this library has been included as a --whole-archive.
   bool included_all_members_;
+  // Whether the symbol table was read from the archive cache.  This
+  // is reset to CACHE_UNUSED once it has been counted for --stats.
+  Cache_status cache_status_;
 };
 
 // This class is used to read an archive and pick out the desired
@@ -1498,7 +1498,7 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
       attributes_section_data_(NULL), mapping_symbols_info_(),
       section_has_cortex_a8_workaround_(NULL), exidx_section_map_(),
       output_local_symbol_count_needs_update_(false),
-      merge_flags_and_attributes_(true)
+      merge_flags_and_attributes_(true), stub_relocs_()
   { }
 
   ~Arm_relobj()
@@ -1534,6 +1534,17 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
   scan_sections_for_stubs(Target_arm<big_endian>*, const Symbol_table*,
 			  const Layout*);
 
+  // Record which of the RELOC_COUNT relocations at PRELOCS, which
+  // apply to section SHNDX, may need a stub.
+  void
+  record_stub_relocs(unsigned int shndx, const unsigned char* prelocs,
+		     size_t reloc_count);
+
+  // Free the lists made by record_stub_relocs.
+  void
+  clear_stub_relocs()
+  { Stub_relocs_map().swap(this->stub_relocs_); }
+
   // Convert regular input section with index SHNDX to a relaxed section.
   void
   convert_input_section_to_relaxed_section(unsigned shndx)
@@ -1739,9 +1750,37 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
   Arm_address
   simple_input_section_output_address(unsigned int, Output_section*);
 
+  // The relocations of a section which may need a stub.
+  struct Stub_relocs
+  {
+    Stub_relocs()
+      : reloc_count(0), indexes()
+    { }
+
+    // The number of relocations in the relocation section, or -1 if
+    // more than one relocation section applies to the section.
+    size_t reloc_count;
+    // The indexes of the branch relocations.
+    std::vector<unsigned int> indexes;
+  };
+
+  // Return the indexes of the relocations which may need a stub
+  // among the RELOC_COUNT relocations for section SHNDX, or NULL if
+  // they were not recorded.
+  const std::vector<unsigned int>*
+  stub_relocs(unsigned int shndx, size_t reloc_count) const
+  {
+    typename Stub_relocs_map::const_iterator p =
+      this->stub_relocs_.find(shndx);
+    if (p == this->stub_relocs_.end() || p->second.reloc_count != reloc_count)
+      return NULL;
+    return &p->second.indexes;
+  }
+
   typedef std::vector<Stub_table<big_endian>*> Stub_table_list;
   typedef Unordered_map<unsigned int, const Arm_exidx_input_section*>
     Exidx_section_map;
+  typedef Unordered_map<unsigned int, Stub_relocs> Stub_relocs_map;
 
   // List of stub tables.
   Stub_table_list stub_tables_;
@@ -1763,6 +1802,10 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
   // Whether we merge processor flags and attributes of this object to
   // output.
   bool merge_flags_and_attributes_;
+  // The relocations which may need a stub, by the index of the section
+  // they apply to.  These are recorded when the relocations are
+  // scanned, so that each relaxation pass only looks at them.
+  Stub_relocs_map stub_relocs_;
 };
 
 // Arm_dynobj class.
@@ -2394,6 +2437,21 @@ class Target_arm : public Sized_target<32, big_endian>
   static unsigned int
   get_real_reloc_type(unsigned int r_type);
 
+  // Return whether a relocation of type R_TYPE, after mapping by
+  // get_real_reloc_type, may need a stub.
+  static bool
+  reloc_may_need_stub(unsigned int r_type)
+  {
+    return (r_type == elfcpp::R_ARM_CALL
+	    || r_type == elfcpp::R_ARM_JUMP24
+	    || r_type == elfcpp::R_ARM_PLT32
+	    || r_type == elfcpp::R_ARM_THM_CALL
+	    || r_type == elfcpp::R_ARM_THM_XPC22
+	    || r_type == elfcpp::R_ARM_THM_JUMP24
+	    || r_type == elfcpp::R_ARM_THM_JUMP19
+	    || r_type == elfcpp::R_ARM_V4BX);
+  }
+
   //
   // Methods to support stub-generations.
   //
@@ -2416,10 +2474,12 @@ class Target_arm : public Sized_target<32, big_endian>
   Stub_table<big_endian>*
   new_stub_table(Arm_input_section<big_endian>*);
 
-  // Scan a section for stub generation.
+  // Scan a section for stub generation.  If the vector is not NULL,
+  // only the relocations with those indexes are scanned.
   void
   scan_section_for_stubs(const Relocate_info<32, big_endian>*, unsigned int,
-			 const unsigned char*, size_t, Output_section*,
+			 const unsigned char*, size_t,
+			 const std::vector<unsigned int>*, Output_section*,
 			 bool, const unsigned char*, Arm_address,
 			 section_size_type);
 
@@ -2921,6 +2981,7 @@ class Target_arm : public Sized_target<32, big_endian>
       const Relocate_info<32, big_endian>* relinfo,
       const unsigned char* prelocs,
       size_t reloc_count,
+      const std::vector<unsigned int>* reloc_indexes,
       Output_section* output_section,
       bool needs_special_offset_handling,
       const unsigned char* view,
@@ -6338,6 +6399,42 @@ Arm_relobj<big_endian>::scan_section_for_cortex_a8_erratum(
     }
 }
 
+// Record the relocations which may need a stub: the same types that
+// Target_arm::scan_reloc_section_for_stubs looks at.  This is called
+// from the Scan_relocs task for this object, so with --threads
+// different objects are done in parallel.
+
+template<bool big_endian>
+void
+Arm_relobj<big_endian>::record_stub_relocs(
+    unsigned int shndx,
+    const unsigned char* prelocs,
+    size_t reloc_count)
+{
+  std::pair<typename Stub_relocs_map::iterator, bool> ins =
+    this->stub_relocs_.insert(std::make_pair(shndx, Stub_relocs()));
+  Stub_relocs* stub_relocs = &ins.first->second;
+  if (!ins.second)
+    {
+      // More than one relocation section applies to this section.
+      // Leave them to be scanned in full.
+      stub_relocs->reloc_count = static_cast<size_t>(-1);
+      std::vector<unsigned int>().swap(stub_relocs->indexes);
+      return;
+    }
+
+  stub_relocs->reloc_count = reloc_count;
+  const int reloc_size = elfcpp::Elf_sizes<32>::rel_size;
+  for (size_t i = 0; i < reloc_count; ++i, prelocs += reloc_size)
+    {
+      elfcpp::Rel<32, big_endian> reloc(prelocs);
+      unsigned int r_type = elfcpp::elf_r_type<32>(reloc.get_r_info());
+      r_type = Target_arm<big_endian>::get_real_reloc_type(r_type);
+      if (Target_arm<big_endian>::reloc_may_need_stub(r_type))
+	stub_relocs->indexes.push_back(i);
+    }
+}
+
 // Scan relocations for stub generation.
 
 template<bool big_endian>
@@ -6409,9 +6506,16 @@ Arm_relobj<big_endian>::scan_sections_for_stubs(
 	  else
 	    reloc_size = elfcpp::Elf_sizes<32>::rela_size;
 
+	  // Only REL relocations are recorded by record_stub_relocs.
+	  size_t reloc_count = shdr.get_sh_size() / reloc_size;
+	  const std::vector<unsigned int>* reloc_indexes =
+	    (sh_type == elfcpp::SHT_REL
+	     ? this->stub_relocs(index, reloc_count)
+	     : NULL);
+
 	  Output_section* os = out_sections[index];
 	  arm_target->scan_section_for_stubs(&relinfo, sh_type, prelocs,
-					     shdr.get_sh_size() / reloc_size,
+					     reloc_count, reloc_indexes,
 					     os,
 					     output_offset == invalid_address,
 					     input_view, output_address,
@@ -9245,6 +9349,17 @@ Target_arm<big_endian>::scan_relocs(Symbol_table* symtab,
     needs_special_offset_handling,
     local_symbol_count,
     plocal_symbols);
+
+  // Note the branches in code sections, so that the relaxation passes
+  // do not have to look at every relocation again.
+  if (this->may_relax()
+      && output_section != NULL
+      && (output_section->flags() & elfcpp::SHF_EXECINSTR) != 0)
+    {
+      Arm_relobj<big_endian>* arm_relobj =
+	Arm_relobj<big_endian>::as_arm_relobj(object);
+      arm_relobj->record_stub_relocs(data_shndx, prelocs, reloc_count);
+    }
 }
 
 // Finalize the sections.
@@ -11881,6 +11996,7 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
     const Relocate_info<32, big_endian>* relinfo,
     const unsigned char* prelocs,
     size_t reloc_count,
+    const std::vector<unsigned int>* reloc_indexes,
     Output_section* output_section,
     bool needs_special_offset_handling,
     const unsigned char* view,
@@ -11898,9 +12014,12 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
   gold::Default_comdat_behavior default_comdat_behavior;
   Comdat_behavior comdat_behavior = CB_UNDETERMINED;
 
-  for (size_t i = 0; i < reloc_count; ++i, prelocs += reloc_size)
+  // If we know which relocations are branches, only look at those.
+  size_t count = reloc_indexes != NULL ? reloc_indexes->size() : reloc_count;
+  for (size_t j = 0; j < count; ++j)
     {
-      Reltype reloc(prelocs);
+      size_t i = reloc_indexes != NULL ? (*reloc_indexes)[j] : j;
+      Reltype reloc(prelocs + i * reloc_size);
 
       typename elfcpp::Elf_types<32>::Elf_WXword r_info = reloc.get_r_info();
       unsigned int r_sym = elfcpp::elf_r_sym<32>(r_info);
@@ -11909,14 +12028,7 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
       r_type = this->get_real_reloc_type(r_type);
 
       // Only a few relocation types need stubs.
-      if ((r_type != elfcpp::R_ARM_CALL)
-	 && (r_type != elfcpp::R_ARM_JUMP24)
-	 && (r_type != elfcpp::R_ARM_PLT32)
-	 && (r_type != elfcpp::R_ARM_THM_CALL)
-	 && (r_type != elfcpp::R_ARM_THM_XPC22)
-	 && (r_type != elfcpp::R_ARM_THM_JUMP24)
-	 && (r_type != elfcpp::R_ARM_THM_JUMP19)
-	 && (r_type != elfcpp::R_ARM_V4BX))
+      if (!reloc_may_need_stub(r_type))
 	continue;
 
       section_offset_type offset =
@@ -12117,6 +12229,7 @@ Target_arm<big_endian>::scan_section_for_stubs(
     unsigned int sh_type,
     const unsigned char* prelocs,
     size_t reloc_count,
+    const std::vector<unsigned int>* reloc_indexes,
     Output_section* output_section,
     bool needs_special_offset_handling,
     const unsigned char* view,
@@ -12128,6 +12241,7 @@ Target_arm<big_endian>::scan_section_for_stubs(
 	relinfo,
 	prelocs,
 	reloc_count,
+	reloc_indexes,
 	output_section,
 	needs_special_offset_handling,
 	view,
@@ -12140,6 +12254,7 @@ Target_arm<big_endian>::scan_section_for_stubs(
 	relinfo,
 	prelocs,
 	reloc_count,
+	reloc_indexes,
 	output_section,
 	needs_special_offset_handling,
 	view,
@@ -12382,6 +12497,9 @@ Target_arm<big_endian>::do_relax(
 	      Task_lock_obj<Object> tl(task, arm_relobj);
 	      arm_relobj->update_output_local_symbol_count();
 	    }
+
+	  // The branch relocations are no longer needed.
+	  arm_relobj->clear_stub_relocs();
 	}
     }
 
@@ -24,11 +24,23 @@
 #include <zlib.h>
 #include "parameters.h"
 #include "options.h"
+#include "layout.h"
 #include "compressed_output.h"
 
 namespace gold
 {
 
+// Return the zlib compression level to use.
+
+static int
+zlib_compress_level()
+{
+  if (parameters->options().optimize() >= 1)
+    return 9;
+  else
+    return 1;
+}
+
 // Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
 // if it successfully compressed, false if it failed for any reason
 // (including not having zlib support in the library).  If it returns
@@ -48,17 +60,11 @@ zlib_compress(int header_size,
   *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
   *compressed_data = new unsigned char[*compressed_size + header_size];
 
-  int compress_level;
-  if (parameters->options().optimize() >= 1)
-    compress_level = 9;
-  else
-    compress_level = 1;
-
   int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
                      compressed_size,
                      reinterpret_cast<const Bytef*>(uncompressed_data),
                      uncompressed_size,
-                     compress_level);
+                     zlib_compress_level());
   if (rc == Z_OK)
     {
       *compressed_size += header_size;
@@ -72,6 +78,53 @@ zlib_compress(int header_size,
     }
 }
 
+// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE as a raw
+// deflate stream with no zlib header or trailer, so that it can be
+// joined with the other chunks of a section into a single zlib
+// stream.  Unless IS_LAST, the data is ended with a full flush, which
+// leaves the output byte aligned without marking the final block.
+// Returns true if it successfully compressed, in which case it
+// allocates memory for the compressed data using new, and sets
+// *COMPRESSED_DATA and *COMPRESSED_SIZE.
+
+static bool
+zlib_compress_chunk(const unsigned char* uncompressed_data,
+		    unsigned long uncompressed_size,
+		    bool is_last,
+		    unsigned char** compressed_data,
+		    unsigned long* compressed_size)
+{
+  z_stream strm;
+  strm.zalloc = NULL;
+  strm.zfree = NULL;
+  strm.opaque = NULL;
+  if (deflateInit2(&strm, zlib_compress_level(), Z_DEFLATED, -MAX_WBITS,
+		   8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  // Leave room for the empty stored block written by the flush.
+  unsigned long bound = deflateBound(&strm, uncompressed_size) + 16;
+  *compressed_data = new unsigned char[bound];
+
+  strm.next_in = const_cast<Bytef*>(uncompressed_data);
+  strm.avail_in = uncompressed_size;
+  strm.next_out = *compressed_data;
+  strm.avail_out = bound;
+  int rc = deflate(&strm, is_last ? Z_FINISH : Z_FULL_FLUSH);
+  bool ok = (is_last
+	     ? rc == Z_STREAM_END
+	     : rc == Z_OK && strm.avail_in == 0 && strm.avail_out > 0);
+  *compressed_size = bound - strm.avail_out;
+  deflateEnd(&strm);
+
+  if (!ok)
+    {
+      delete[] *compressed_data;
+      *compressed_data = NULL;
+    }
+  return ok;
+}
+
 // Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, into a buffer
 // UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns TRUE if it
 // decompressed successfully, false if it failed.  The buffer, of
@@ -211,17 +264,19 @@ decompress_input_section(const unsigned char* compressed_data,
 
 // Class Output_compressed_section.
 
-// Set the final data size of a compressed section.  This is where
-// we actually compress the section data.
+// Copy the contents of anything other than a regular input section
+// into the postprocessing buffer, and divide the buffer into chunks
+// of --compress-debug-sections-chunk-size bytes.  Unless a chunk size
+// is given, --threads uses chunks of default_chunk_size bytes, so that
+// they can be compressed in parallel, and a link without it uses a
+// single chunk.  The chunks do not depend on the number of threads, so
+// the output does not either.
 
-void
-Output_compressed_section::set_final_data_size()
+unsigned int
+Output_compressed_section::prepare_chunks()
 {
-  off_t uncompressed_size = this->postprocessing_buffer_size();
-
-  // (Try to) compress the data.
-  unsigned long compressed_size;
-  unsigned char* uncompressed_data = this->postprocessing_buffer();
+  gold_assert(!this->chunks_prepared_);
+  this->chunks_prepared_ = true;
 
   // At this point the contents of all regular input sections will
   // have been copied into the postprocessing buffer, and relocations
@@ -229,36 +284,182 @@ Output_compressed_section::set_final_data_size()
   // anything other than a regular input section.
   this->write_to_postprocessing_buffer();
 
-  bool success = false;
-  enum { none, gnu_zlib, gabi_zlib } compress;
-  int compression_header_size = 12;
+  this->header_size_ = 12;
   const int size = parameters->target().get_size();
   if (strcmp(this->options_->compress_debug_sections(), "zlib-gnu") == 0)
-    compress = gnu_zlib;
+    this->compress_ = COMPRESS_GNU_ZLIB;
   else if (strcmp(this->options_->compress_debug_sections(), "zlib-gabi") == 0
 	   || strcmp(this->options_->compress_debug_sections(), "zlib") == 0)
     {
-      compress = gabi_zlib;
+      this->compress_ = COMPRESS_GABI_ZLIB;
       if (size == 32)
-	compression_header_size = elfcpp::Elf_sizes<32>::chdr_size;
+	this->header_size_ = elfcpp::Elf_sizes<32>::chdr_size;
       else if (size == 64)
-	compression_header_size = elfcpp::Elf_sizes<64>::chdr_size;
+	this->header_size_ = elfcpp::Elf_sizes<64>::chdr_size;
       else
 	gold_unreachable();
     }
   else
-    compress = none;
-  if (compress != none)
-    success = zlib_compress(compression_header_size, uncompressed_data,
-			    uncompressed_size, &this->data_,
-			    &compressed_size);
-  if (success)
+    return 0;
+
+  section_size_type uncompressed_size = this->postprocessing_buffer_size();
+  uint64_t chunk_size;
+  if (this->options_->user_set_compress_debug_sections_chunk_size())
+    chunk_size = this->options_->compress_debug_sections_chunk_size();
+  else if (this->options_->threads())
+    chunk_size = default_chunk_size;
+  else
+    chunk_size = 0;
+  // Each chunk is compressed with a single call to deflate, and the
+  // z_stream byte counts are only 32 bits.
+  const uint64_t max_chunk_size = static_cast<uint64_t>(1) << 30;
+  if (chunk_size > max_chunk_size)
+    chunk_size = max_chunk_size;
+  if (chunk_size == 0 || uncompressed_size <= chunk_size)
+    this->chunks_.push_back(Chunk(0, uncompressed_size));
+  else
+    {
+      for (section_size_type off = 0;
+	   off < uncompressed_size;
+	   off += chunk_size)
+	this->chunks_.push_back(Chunk(off, std::min(static_cast<uint64_t>(
+						      uncompressed_size - off),
+						    chunk_size)));
+    }
+  return this->chunks_.size();
+}
+
+// Compress chunk I.
+
+void
+Output_compressed_section::compress_chunk(unsigned int i)
+{
+  Chunk* chunk = &this->chunks_[i];
+  const unsigned char* p = this->postprocessing_buffer() + chunk->offset;
+
+  // A section which fits in a single chunk is compressed directly
+  // into a zlib stream following the compression header.
+  if (this->chunks_.size() == 1)
+    {
+      zlib_compress(this->header_size_, p, chunk->length, &chunk->data,
+		    &chunk->size);
+      return;
+    }
+
+  chunk->adler = adler32(adler32(0L, Z_NULL, 0), p, chunk->length);
+  zlib_compress_chunk(p, chunk->length, i + 1 == this->chunks_.size(),
+		      &chunk->data, &chunk->size);
+}
+
+// Join the compressed chunks into DATA_.  The raw deflate data of the
+// chunks is wrapped in a zlib header and an adler32 trailer, so that
+// the result is a single zlib stream which any zlib consumer can
+// decompress.
+
+unsigned long
+Output_compressed_section::join_chunks()
+{
+  unsigned long compressed_size = this->header_size_;
+  bool ok = !this->chunks_.empty();
+  for (std::vector<Chunk>::const_iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      if (p->data == NULL)
+	ok = false;
+      compressed_size += p->size;
+    }
+
+  if (!ok)
+    compressed_size = 0;
+  else if (this->chunks_.size() == 1)
+    {
+      // zlib_compress already left room for the compression header.
+      this->data_ = this->chunks_[0].data;
+      this->chunks_[0].data = NULL;
+      compressed_size = this->chunks_[0].size;
+    }
+  else
+    {
+      // Two bytes of zlib header, four bytes of adler32 trailer.
+      compressed_size += 2 + 4;
+      this->data_ = new unsigned char[compressed_size];
+      unsigned char* pov = this->data_ + this->header_size_;
+
+      // This is the zlib header which deflate writes for a 32K window
+      // and our compression level.
+      int level = zlib_compress_level();
+      unsigned int level_flags;
+      if (level < 2)
+	level_flags = 0;
+      else if (level < 6)
+	level_flags = 1;
+      else if (level == 6)
+	level_flags = 2;
+      else
+	level_flags = 3;
+      unsigned int zlib_header = (0x78 << 8) | (level_flags << 6);
+      zlib_header += 31 - (zlib_header % 31);
+      elfcpp::Swap_unaligned<16, true>::writeval(pov, zlib_header);
+      pov += 2;
+
+      unsigned long adler = 0;
+      for (std::vector<Chunk>::const_iterator p = this->chunks_.begin();
+	   p != this->chunks_.end();
+	   ++p)
+	{
+	  memcpy(pov, p->data, p->size);
+	  pov += p->size;
+	  if (p == this->chunks_.begin())
+	    adler = p->adler;
+	  else
+	    adler = adler32_combine(adler, p->adler, p->length);
+	}
+
+      elfcpp::Swap_unaligned<32, true>::writeval(pov, adler);
+      pov += 4;
+      gold_assert(static_cast<unsigned long>(pov - this->data_)
+		  == compressed_size);
+    }
+
+  for (std::vector<Chunk>::iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    delete[] p->data;
+  this->chunks_.clear();
+
+  return compressed_size;
+}
+
+// Set the final data size of a compressed section.  This is where
+// we actually compress the section data, unless that has already
+// been done in parallel by Compress_sections_task.
+
+void
+Output_compressed_section::set_final_data_size()
+{
+  off_t uncompressed_size = this->postprocessing_buffer_size();
+
+  if (!this->chunks_prepared_)
+    {
+      unsigned int chunk_count = this->prepare_chunks();
+      for (unsigned int i = 0; i < chunk_count; ++i)
+	this->compress_chunk(i);
+    }
+
+  unsigned long compressed_size = 0;
+  if (this->compress_ != COMPRESS_NONE)
+    compressed_size = this->join_chunks();
+  if (compressed_size != 0)
     {
+      const int size = parameters->target().get_size();
       elfcpp::Elf_Xword flags = this->flags();
-      if (compress == gabi_zlib)
+      if (this->compress_ == COMPRESS_GABI_ZLIB)
 	{
 	  // Set the SHF_COMPRESSED bit.
 	  flags |= elfcpp::SHF_COMPRESSED;
+	  // Clear the reserved field of the 64-bit header.
+	  memset(this->data_, 0, this->header_size_);
 	  const bool is_big_endian = parameters->target().is_big_endian();
 	  uint64_t addralign = this->addralign();
 	  if (size == 32)
@@ -335,4 +536,80 @@ Output_compressed_section::do_write(Output_file* of)
   of->write_output_view(offset, data_size, view);
 }
 
+// A task to compress one chunk of a compressed output section.
+
+class Compress_chunk_task : public Task
+{
+ public:
+  Compress_chunk_task(Output_compressed_section* os, unsigned int chunk,
+		      Task_token* blocker)
+    : os_(os), chunk_(chunk), blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->os_->compress_chunk(this->chunk_); }
+
+  std::string
+  get_name() const
+  { return std::string("Compress_chunk_task ") + this->os_->name(); }
+
+ private:
+  Output_compressed_section* os_;
+  unsigned int chunk_;
+  Task_token* blocker_;
+};
+
+// Class Compress_sections_task.
+
+// We can only run once the input sections have been written.
+
+Task_token*
+Compress_sections_task::is_runnable()
+{
+  if (this->input_sections_blocker_->is_blocked())
+    return this->input_sections_blocker_;
+  return NULL;
+}
+
+// We hold COMPRESS_BLOCKER until the chunk tasks have been queued.
+
+void
+Compress_sections_task::locks(Task_locker* tl)
+{
+  tl->add(this, this->compress_blocker_);
+}
+
+// Queue a task to compress each chunk of each compressed section.
+
+void
+Compress_sections_task::run(Workqueue* workqueue)
+{
+  const Layout::Compressed_section_list& sections =
+    this->layout_->compressed_sections();
+  std::vector<unsigned int> chunk_counts;
+  for (Layout::Compressed_section_list::const_iterator p = sections.begin();
+       p != sections.end();
+       ++p)
+    chunk_counts.push_back((*p)->prepare_chunks());
+
+  // Other tasks may share COMPRESS_BLOCKER, so the workqueue has to
+  // add the blockers for us.
+  for (unsigned int i = 0; i < sections.size(); ++i)
+    for (unsigned int j = 0; j < chunk_counts[i]; ++j)
+      {
+	workqueue->add_blocker(this->compress_blocker_);
+	workqueue->queue(new Compress_chunk_task(sections[i], j,
+						 this->compress_blocker_));
+      }
+}
+
 } // End namespace gold.
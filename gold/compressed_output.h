@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -60,9 +61,23 @@ class Output_compressed_section : public Output_section
 			    const char* name, elfcpp::Elf_Word flags,
 			    elfcpp::Elf_Xword type)
     : Output_section(name, flags, type),
-      options_(options)
+      options_(options), data_(NULL), compress_(COMPRESS_NONE),
+      header_size_(0), chunks_(), chunks_prepared_(false)
   { this->set_requires_postprocessing(); }
 
+  // Copy the contents of anything other than a regular input section
+  // into the postprocessing buffer, and divide the buffer into chunks
+  // which can be compressed independently.  Return the number of
+  // chunks.  This is called once all the input sections have been
+  // written.
+  unsigned int
+  prepare_chunks();
+
+  // Compress chunk I.  Different chunks may be compressed in
+  // parallel.
+  void
+  compress_chunk(unsigned int i);
+
  protected:
   // Set the final data size.
   void
@@ -73,12 +88,91 @@ class Output_compressed_section : public Output_section
   do_write(Output_file*);
 
  private:
+  // The type of compression.
+  enum Compression
+  {
+    COMPRESS_NONE,
+    COMPRESS_GNU_ZLIB,
+    COMPRESS_GABI_ZLIB
+  };
+
+  // The chunk size used with --threads when no
+  // --compress-debug-sections-chunk-size is given.
+  static const uint64_t default_chunk_size = 1024 * 1024;
+
+  // A chunk of the section contents.
+  struct Chunk
+  {
+    Chunk(section_size_type off, section_size_type len)
+      : offset(off), length(len), data(NULL), size(0), adler(0)
+    { }
+
+    // The offset and length of the uncompressed data.
+    section_size_type offset;
+    section_size_type length;
+    // The compressed data, or NULL if compression failed.
+    unsigned char* data;
+    unsigned long size;
+    // The adler32 checksum of the uncompressed data.
+    unsigned long adler;
+  };
+
+  // Join the compressed chunks into a single zlib stream in DATA_,
+  // following the compression header.  Return the size of the
+  // section, or 0 if any chunk could not be compressed.
+  unsigned long
+  join_chunks();
+
   // The options--this includes the compression type.
   const General_options* options_;
   // The compressed data.
   unsigned char* data_;
   // The new section name if we do compress.
   std::string new_section_name_;
+  // The type of compression.
+  Compression compress_;
+  // The size of the compression header.
+  int header_size_;
+  // The chunks of the section contents.
+  std::vector<Chunk> chunks_;
+  // Whether prepare_chunks has been called.
+  bool chunks_prepared_;
+};
+
+// This task compresses the contents of the compressed output
+// sections in parallel, by queuing a Compress_chunk_task for each
+// chunk.  It runs once all the input sections have been written, and
+// COMPRESS_BLOCKER is unblocked when all the chunks are compressed.
+
+class Compress_sections_task : public Task
+{
+ public:
+  Compress_sections_task(const Layout* layout,
+			 Task_token* input_sections_blocker,
+			 Task_token* compress_blocker)
+    : layout_(layout), input_sections_blocker_(input_sections_blocker),
+      compress_blocker_(compress_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Compress_sections_task"; }
+
+ private:
+  const Layout* layout_;
+  Task_token* input_sections_blocker_;
+  Task_token* compress_blocker_;
 };
 
 } // End namespace gold.
@@ -28,8 +28,11 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include <vector>
+#include <map>
 #include <algorithm>
 
 #include "getopt.h"
@@ -39,12 +42,14 @@
 #include "elfcpp.h"
 #include "elfcpp_file.h"
 #include "dwarf.h"
+#include "options.h"
 #include "dirsearch.h"
 #include "fileread.h"
 #include "object.h"
 #include "compressed_output.h"
 #include "stringpool.h"
 #include "dwarf_reader.h"
+#include "workqueue.h"
 
 static void
 usage(FILE* fd, int) ATTRIBUTE_NORETURN;
@@ -70,6 +75,9 @@ struct Dwo_file_entry
 };
 typedef std::vector<Dwo_file_entry> File_list;
 
+// A set of DWO ids.
+typedef Unordered_set<uint64_t> Dwo_id_set;
+
 // Type to hold the offset and length of an input section
 // within an output section.
 
@@ -99,6 +107,22 @@ struct Unit_set
   { }
 };
 
+// A compilation unit or type unit read from an input file, to be
+// added to the output file.
+
+struct Dwo_unit
+{
+  uint64_t signature;
+  const unsigned char* contents;
+  section_size_type size;
+  // True if CONTENTS was allocated with new[].
+  bool is_new;
+};
+typedef std::vector<Dwo_unit> Dwo_unit_list;
+
+// A list of CU or TU sets read from the index section of a .dwp file.
+typedef std::vector<Unit_set*> Unit_set_list;
+
 // An input file.
 // This class may represent a .dwo file, a .dwp file
 // produced by an earlier run, or an executable file whose
@@ -108,9 +132,14 @@ class Dwo_file
 {
  public:
   Dwo_file(const char* name)
-    : name_(name), obj_(NULL), input_file_(NULL), is_compressed_(),
-      sect_offsets_(), str_offset_map_()
-  { }
+    : name_(name), obj_(NULL), input_file_(NULL), machine_(0), osabi_(0),
+      abiversion_(0), is_compressed_(), sect_offsets_(), str_offset_map_(),
+      debug_types_(), debug_str_(0), debug_cu_index_(0), debug_tu_index_(0),
+      prepared_sections_(), info_units_(), types_units_()
+  {
+    for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+      this->debug_shndx_[i] = 0;
+  }
 
   ~Dwo_file();
 
@@ -123,6 +152,41 @@ class Dwo_file
   void
   read(Dwp_output_file* output_file);
 
+  // Read the input file, and the sections and units that will be
+  // sent to the output file.  This does not use the output file, so
+  // several input files may be prepared in parallel.
+  void
+  prepare();
+
+  // Send the contents read by prepare to OUTPUT_FILE.  Input files
+  // must be written one at a time, in order.
+  void
+  write(Dwp_output_file* output_file);
+
+  // The filename.
+  const char*
+  name() const
+  { return this->name_; }
+
+  // Return true if the file read by prepare is a .dwp file.
+  bool
+  is_dwp() const
+  { return this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0; }
+
+  // Add the DWO ids of the compilation units in the .dwp file read by
+  // prepare to DWO_IDS.
+  void
+  get_dwo_ids(Dwo_id_set* dwo_ids);
+
+  // Send the contents of the .dwp file read by prepare to OUTPUT_FILE,
+  // when OUTPUT_FILE replaces it.  CU and TU sets already added to
+  // OUTPUT_FILE replace the ones in this file, and if DWO_IDS is not
+  // NULL, CU sets whose DWO id is not in DWO_IDS are dropped.  Only
+  // the contributions and strings used by the remaining sets are
+  // copied.
+  void
+  write_update(Dwp_output_file* output_file, const Dwo_id_set* dwo_ids);
+
   // Verify a .dwp file given a list of .dwo files referenced by the
   // corresponding executable file.  Returns true if no problems
   // were found.
@@ -174,8 +238,13 @@ class Dwo_file
   // Set *PLEN to the size.  Set *IS_NEW to true if the contents need to be
   // deleted by the caller.
   const unsigned char*
-  section_contents(unsigned int shndx, section_size_type* plen, bool* is_new)
-  { return this->obj_->decompressed_section_contents(shndx, plen, is_new); }
+  section_contents(unsigned int shndx, section_size_type* plen, bool* is_new);
+
+  // Read the contents of a section to be copied to the output file,
+  // for a later call to section_contents.  If COPY is true, make sure
+  // that the contents will persist after the input file is closed.
+  void
+  prepare_section(unsigned int shndx, bool copy);
 
   // Read the .debug_cu_index or .debug_tu_index section of a .dwp file,
   // and process the CU or TU sets.
@@ -183,10 +252,16 @@ class Dwo_file
   read_unit_index(unsigned int, unsigned int *, Dwp_output_file*,
 		  bool is_tu_index);
 
+  // Read the .debug_cu_index or .debug_tu_index section of a .dwp file,
+  // and add each CU or TU set to SETS.  The section offsets of each set
+  // are relative to the input sections.
+  void
+  read_unit_sets(unsigned int shndx, bool is_tu_index, Unit_set_list* sets);
+
   template <bool big_endian>
   void
-  sized_read_unit_index(unsigned int, unsigned int *, Dwp_output_file*,
-			bool is_tu_index);
+  sized_read_unit_sets(unsigned int shndx, bool is_tu_index,
+		       Unit_set_list* sets);
 
   // Verify the .debug_cu_index section of a .dwp file, comparing it
   // against the list of .dwo files referenced by the corresponding
@@ -198,9 +273,23 @@ class Dwo_file
   bool
   sized_verify_dwo_list(unsigned int, const File_list& files);
 
-  // Merge the input string table section into the output file.
+  // Merge the input string table section into the output file.  If
+  // USED_STRINGS is not NULL, only the strings containing one of the
+  // sorted offsets in USED_STRINGS are merged.
+  void
+  add_strings(Dwp_output_file*, unsigned int,
+	      const std::vector<section_offset_type>* used_strings);
+
+  // Add the string offsets found in a contribution to the
+  // .debug_str_offsets.dwo section to USED_STRINGS.
+  void
+  get_used_strings(const unsigned char* contents, section_size_type len,
+		   std::vector<section_offset_type>* used_strings);
+
+  template <bool big_endian>
   void
-  add_strings(Dwp_output_file*, unsigned int);
+  sized_get_used_strings(const unsigned char* contents, section_size_type len,
+			 std::vector<section_offset_type>* used_strings);
 
   // Copy a section from the input file to the output file.
   Section_bounds
@@ -221,10 +310,23 @@ class Dwo_file
   remap_str_offset(section_offset_type val);
 
   // Add a set of .debug_info.dwo or .debug_types.dwo and related sections
-  // to OUTPUT_FILE.
+  // to OUTPUT_FILE.  UNITS are the units read from the .debug_info.dwo
+  // or .debug_types.dwo section.
   void
   add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
-	       bool is_debug_types);
+	       bool is_debug_types, Dwo_unit_list* units);
+
+  // The contents of a section read by prepare_section.
+  struct Prepared_section
+  {
+    const unsigned char* contents;
+    section_size_type len;
+    bool is_new;
+
+    Prepared_section()
+      : contents(NULL), len(0), is_new(false)
+    { }
+  };
 
   // The filename.
   const char* name_;
@@ -232,12 +334,31 @@ class Dwo_file
   Relobj* obj_;
   // The Input_file object.
   Input_file* input_file_;
+  // Target info from the ELF header.
+  int machine_;
+  int osabi_;
+  int abiversion_;
   // Flags indicating which sections are compressed.
   std::vector<bool> is_compressed_;
   // Map input section index onto output section offset and size.
   std::vector<Section_bounds> sect_offsets_;
   // Map input string offsets to output string offsets.
   Str_offset_map str_offset_map_;
+  // The debug sections found by prepare, indexed by DW_SECT.
+  unsigned int debug_shndx_[elfcpp::DW_SECT_MAX + 1];
+  // The .debug_types.dwo sections.
+  std::vector<unsigned int> debug_types_;
+  // The .debug_str.dwo section.
+  unsigned int debug_str_;
+  // The .debug_cu_index and .debug_tu_index sections of a .dwp file.
+  unsigned int debug_cu_index_;
+  unsigned int debug_tu_index_;
+  // The section contents read by prepare_section, indexed by shndx.
+  std::vector<Prepared_section> prepared_sections_;
+  // The units read from the .debug_info.dwo section.
+  Dwo_unit_list info_units_;
+  // The units read from each .debug_types.dwo section.
+  std::vector<Dwo_unit_list> types_units_;
 };
 
 // An ELF input file.
@@ -476,6 +597,10 @@ class Dwp_output_file
   void
   add_cu_set(Unit_set* cu_set);
 
+  // Lookup a DWO id and return TRUE if we have already seen it.
+  bool
+  lookup_cu(uint64_t dwo_id);
+
   // Lookup a type signature and return TRUE if we have already seen it.
   bool
   lookup_tu(uint64_t type_sig);
@@ -712,22 +837,24 @@ class Dwo_name_info_reader : public Dwarf_info_reader
 };
 
 // A specialization of Dwarf_info_reader, for reading DWARF CUs and TUs
-// and adding them to the output file.
+// to be added to the output file.
 
 class Unit_reader : public Dwarf_info_reader
 {
  public:
   Unit_reader(bool is_type_unit, Relobj* object, unsigned int shndx)
     : Dwarf_info_reader(is_type_unit, object, NULL, 0, shndx, 0, 0),
-      output_file_(NULL), sections_(NULL)
+      units_(NULL), copy_contents_(false)
   { }
 
   ~Unit_reader()
   { }
 
-  // Read the CUs or TUs and add them to the output file.
+  // Read the CUs or TUs and add them to UNITS.  If COPY_CONTENTS is
+  // true, copy the contents of each unit.
   void
-  add_units(Dwp_output_file*, unsigned int debug_abbrev, Section_bounds*);
+  read_units(unsigned int debug_abbrev, bool copy_contents,
+	     Dwo_unit_list* units);
 
  protected:
   // Visit a compilation unit.
@@ -740,8 +867,12 @@ class Unit_reader : public Dwarf_info_reader
 		  uint64_t signature, Dwarf_die*);
 
  private:
-  Dwp_output_file* output_file_;
-  Section_bounds* sections_;
+  // Add a unit to the list.
+  void
+  add_unit(uint64_t signature, off_t length);
+
+  Dwo_unit_list* units_;
+  bool copy_contents_;
 };
 
 // Return the name of a DWARF .dwo section.
@@ -828,6 +959,20 @@ Sized_relobj_dwo<size, big_endian>::do_section_contents(
 
 Dwo_file::~Dwo_file()
 {
+  for (unsigned int i = 0; i < this->prepared_sections_.size(); ++i)
+    if (this->prepared_sections_[i].is_new)
+      delete[] this->prepared_sections_[i].contents;
+  for (Dwo_unit_list::const_iterator p = this->info_units_.begin();
+       p != this->info_units_.end();
+       ++p)
+    if (p->is_new)
+      delete[] p->contents;
+  for (unsigned int i = 0; i < this->types_units_.size(); ++i)
+    for (Dwo_unit_list::const_iterator p = this->types_units_[i].begin();
+	 p != this->types_units_[i].end();
+	 ++p)
+      if (p->is_new)
+	delete[] p->contents;
   if (this->obj_ != NULL)
     delete this->obj_;
   if (this->input_file_ != NULL)
@@ -885,20 +1030,24 @@ Dwo_file::read_executable(File_list* files)
 void
 Dwo_file::read(Dwp_output_file* output_file)
 {
-  this->obj_ = this->make_object(output_file);
+  this->prepare();
+  this->write(output_file);
+}
+
+// Read the input file, and the sections and units that will be sent
+// to the output file.
+
+void
+Dwo_file::prepare()
+{
+  this->obj_ = this->make_object(NULL);
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
+  this->prepared_sections_.resize(shnum);
 
-  typedef std::vector<unsigned int> Types_list;
-  Types_list debug_types;
-  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
-  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
-    debug_shndx[i] = 0;
-  unsigned int debug_str = 0;
-  unsigned int debug_cu_index = 0;
-  unsigned int debug_tu_index = 0;
+  unsigned int* debug_shndx = this->debug_shndx_;
 
   // Scan the section table and collect debug sections.
   // (Section index 0 is a dummy section; skip it.)
@@ -920,7 +1069,7 @@ Dwo_file::read(Dwp_output_file* output_file)
       if (strcmp(suffix, "info.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_INFO] = i;
       else if (strcmp(suffix, "types.dwo") == 0)
-	debug_types.push_back(i);
+	this->debug_types_.push_back(i);
       else if (strcmp(suffix, "abbrev.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_ABBREV] = i;
       else if (strcmp(suffix, "line.dwo") == 0)
@@ -928,7 +1077,7 @@ Dwo_file::read(Dwp_output_file* output_file)
       else if (strcmp(suffix, "loc.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_LOC] = i;
       else if (strcmp(suffix, "str.dwo") == 0)
-	debug_str = i;
+	this->debug_str_ = i;
       else if (strcmp(suffix, "str_offsets.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_STR_OFFSETS] = i;
       else if (strcmp(suffix, "macinfo.dwo") == 0)
@@ -936,46 +1085,288 @@ Dwo_file::read(Dwp_output_file* output_file)
       else if (strcmp(suffix, "macro.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_MACRO] = i;
       else if (strcmp(suffix, "cu_index") == 0)
-	debug_cu_index = i;
+	this->debug_cu_index_ = i;
       else if (strcmp(suffix, "tu_index") == 0)
-	debug_tu_index = i;
+	this->debug_tu_index_ = i;
+    }
+
+  // The index sections of a .dwp file are read by write.
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
+    return;
+
+  // Read the string table, and the related sections that will be
+  // copied to the output file.  The .debug_str_offsets.dwo section
+  // is remapped rather than copied.
+  this->prepare_section(this->debug_str_, false);
+  for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
+    this->prepare_section(debug_shndx[i], i != elfcpp::DW_SECT_STR_OFFSETS);
+
+  if (debug_shndx[elfcpp::DW_SECT_INFO] == 0 && this->debug_types_.empty())
+    return;
+
+  if (debug_shndx[elfcpp::DW_SECT_ABBREV] == 0)
+    gold_fatal(_("%s: no .debug_abbrev.dwo section found"), this->name_);
+
+  // Parse the .debug_info and .debug_types sections, and collect the
+  // compilation and type units.  The output file keeps the contents
+  // of type units until it is finalized, so we copy those.  We also
+  // copy the contents of units from a compressed section, since the
+  // decompressed section contents are freed after parsing.
+  if (debug_shndx[elfcpp::DW_SECT_INFO] > 0)
+    {
+      unsigned int shndx = debug_shndx[elfcpp::DW_SECT_INFO];
+      Unit_reader reader(false, this->obj_, shndx);
+      reader.read_units(debug_shndx[elfcpp::DW_SECT_ABBREV],
+			this->obj_->section_is_compressed(shndx, NULL),
+			&this->info_units_);
     }
 
+  this->types_units_.resize(this->debug_types_.size());
+  for (unsigned int i = 0; i < this->debug_types_.size(); ++i)
+    {
+      Unit_reader reader(true, this->obj_, this->debug_types_[i]);
+      reader.read_units(debug_shndx[elfcpp::DW_SECT_ABBREV], true,
+			&this->types_units_[i]);
+    }
+}
+
+// Send the contents read by prepare to OUTPUT_FILE.
+
+void
+Dwo_file::write(Dwp_output_file* output_file)
+{
+  output_file->record_target_info(this->name_, this->machine_,
+				  this->obj_->elfsize(),
+				  this->obj_->is_big_endian(),
+				  this->osabi_, this->abiversion_);
+
+  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
+  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+    debug_shndx[i] = this->debug_shndx_[i];
+
   // Merge the input string table into the output string table.
-  this->add_strings(output_file, debug_str);
+  this->add_strings(output_file, this->debug_str_, NULL);
 
   // If we found any .dwp index sections, read those and add the section
   // sets to the output file.
-  if (debug_cu_index > 0 || debug_tu_index > 0)
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
     {
-      if (debug_cu_index > 0)
-	this->read_unit_index(debug_cu_index, debug_shndx, output_file, false);
-      if (debug_tu_index > 0)
+      if (this->debug_cu_index_ > 0)
+	this->read_unit_index(this->debug_cu_index_, debug_shndx, output_file,
+			      false);
+      if (this->debug_tu_index_ > 0)
         {
-	  if (debug_types.size() > 1)
+	  if (this->debug_types_.size() > 1)
 	    gold_fatal(_("%s: .dwp file must have no more than one "
 			 ".debug_types.dwo section"), this->name_);
-          if (debug_types.size() == 1)
-            debug_shndx[elfcpp::DW_SECT_TYPES] = debug_types[0];
+          if (this->debug_types_.size() == 1)
+            debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[0];
           else
             debug_shndx[elfcpp::DW_SECT_TYPES] = 0;
-	  this->read_unit_index(debug_tu_index, debug_shndx, output_file, true);
+	  this->read_unit_index(this->debug_tu_index_, debug_shndx,
+				output_file, true);
 	}
       return;
     }
 
   // If we found no index sections, this is a .dwo file.
   if (debug_shndx[elfcpp::DW_SECT_INFO] > 0)
-    this->add_unit_set(output_file, debug_shndx, false);
+    this->add_unit_set(output_file, debug_shndx, false, &this->info_units_);
 
   debug_shndx[elfcpp::DW_SECT_INFO] = 0;
-  for (Types_list::const_iterator tp = debug_types.begin();
-       tp != debug_types.end();
-       ++tp)
+  for (unsigned int i = 0; i < this->debug_types_.size(); ++i)
+    {
+      debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[i];
+      this->add_unit_set(output_file, debug_shndx, true,
+			 &this->types_units_[i]);
+    }
+}
+
+// Add the DWO ids of the compilation units in the .dwp file read by
+// prepare to DWO_IDS.
+
+void
+Dwo_file::get_dwo_ids(Dwo_id_set* dwo_ids)
+{
+  if (this->debug_cu_index_ == 0)
+    return;
+
+  Unit_set_list sets;
+  this->read_unit_sets(this->debug_cu_index_, false, &sets);
+  for (Unit_set_list::const_iterator p = sets.begin(); p != sets.end(); ++p)
+    {
+      dwo_ids->insert((*p)->signature);
+      delete *p;
+    }
+}
+
+// Send the contents of the .dwp file read by prepare to OUTPUT_FILE,
+// keeping only the CU and TU sets that have not been replaced.
+
+void
+Dwo_file::write_update(Dwp_output_file* output_file,
+		       const Dwo_id_set* dwo_ids)
+{
+  gold_assert(this->is_dwp());
+
+  output_file->record_target_info(this->name_, this->machine_,
+				  this->obj_->elfsize(),
+				  this->obj_->is_big_endian(),
+				  this->osabi_, this->abiversion_);
+
+  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
+  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+    debug_shndx[i] = this->debug_shndx_[i];
+  if (this->debug_types_.size() > 1)
+    gold_fatal(_("%s: .dwp file must have no more than one "
+		 ".debug_types.dwo section"), this->name_);
+  if (this->debug_types_.size() == 1)
+    debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[0];
+
+  // Collect the CU and TU sets to keep.
+  Unit_set_list sets;
+  if (this->debug_cu_index_ > 0)
+    {
+      Unit_set_list cu_sets;
+      this->read_unit_sets(this->debug_cu_index_, false, &cu_sets);
+      for (Unit_set_list::const_iterator p = cu_sets.begin();
+	   p != cu_sets.end();
+	   ++p)
+	{
+	  uint64_t dwo_id = (*p)->signature;
+	  if (output_file->lookup_cu(dwo_id)
+	      || (dwo_ids != NULL && dwo_ids->find(dwo_id) == dwo_ids->end()))
+	    delete *p;
+	  else
+	    sets.push_back(*p);
+	}
+    }
+  size_t cu_count = sets.size();
+  if (this->debug_tu_index_ > 0)
+    {
+      Unit_set_list tu_sets;
+      this->read_unit_sets(this->debug_tu_index_, true, &tu_sets);
+      for (Unit_set_list::const_iterator p = tu_sets.begin();
+	   p != tu_sets.end();
+	   ++p)
+	{
+	  if (output_file->lookup_tu((*p)->signature))
+	    delete *p;
+	  else
+	    sets.push_back(*p);
+	}
+    }
+
+  // Read the input sections, and check the bounds of each contribution.
+  const unsigned char* contents[elfcpp::DW_SECT_MAX + 1];
+  section_size_type len[elfcpp::DW_SECT_MAX + 1];
+  bool is_new[elfcpp::DW_SECT_MAX + 1];
+  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; ++i)
+    {
+      contents[i] = NULL;
+      len[i] = 0;
+      is_new[i] = false;
+      if (i > 0 && debug_shndx[i] > 0)
+	contents[i] = this->section_contents(debug_shndx[i], &len[i],
+					     &is_new[i]);
+    }
+  for (Unit_set_list::const_iterator p = sets.begin(); p != sets.end(); ++p)
+    for (unsigned int i = 1; i <= elfcpp::DW_SECT_MAX; ++i)
+      {
+	const Section_bounds& b((*p)->sections[i]);
+	if (b.size > 0
+	    && (contents[i] == NULL
+		|| static_cast<section_size_type>(b.offset) > len[i]
+		|| b.size > len[i] - b.offset))
+	  gold_fatal(_("%s: contribution to section %s is out of bounds"),
+		     this->name_,
+		     get_dwarf_section_name(static_cast<elfcpp::DW_SECT>(i)));
+      }
+
+  // Merge only the strings used by the remaining sets into the
+  // output string table.
+  std::vector<section_offset_type> used_strings;
+  if (contents[elfcpp::DW_SECT_STR_OFFSETS] != NULL)
     {
-      debug_shndx[elfcpp::DW_SECT_TYPES] = *tp;
-      this->add_unit_set(output_file, debug_shndx, true);
+      const unsigned char* str_offsets = contents[elfcpp::DW_SECT_STR_OFFSETS];
+      for (Unit_set_list::const_iterator p = sets.begin();
+	   p != sets.end();
+	   ++p)
+	{
+	  const Section_bounds& b((*p)->sections[elfcpp::DW_SECT_STR_OFFSETS]);
+	  this->get_used_strings(str_offsets + b.offset, b.size,
+				 &used_strings);
+	}
+      std::sort(used_strings.begin(), used_strings.end());
+      used_strings.erase(std::unique(used_strings.begin(),
+				     used_strings.end()),
+			 used_strings.end());
+    }
+  this->add_strings(output_file, this->debug_str_,
+		    (contents[elfcpp::DW_SECT_STR_OFFSETS] != NULL
+		     ? &used_strings
+		     : NULL));
+
+  // Copy the contributions used by the remaining sets.  A TU set shares
+  // its contributions to the related sections with the CU set from the
+  // same .dwo file, so we copy each of those only once.
+  typedef std::map<std::pair<unsigned int, section_offset_type>,
+		   section_offset_type> Contribution_map;
+  Contribution_map copied;
+  for (size_t k = 0; k < sets.size(); ++k)
+    {
+      Unit_set* unit_set = sets[k];
+      for (unsigned int i = 1; i <= elfcpp::DW_SECT_MAX; ++i)
+	{
+	  Section_bounds* b = &unit_set->sections[i];
+	  if (b->size == 0)
+	    continue;
+	  elfcpp::DW_SECT section_id = static_cast<elfcpp::DW_SECT>(i);
+	  const unsigned char* p = contents[i] + b->offset;
+
+	  // Dwp_output_file::add_contribution writes the .debug_info.dwo
+	  // section directly to the output file, and takes ownership of
+	  // the other contributions.
+	  if (section_id == elfcpp::DW_SECT_INFO)
+	    {
+	      b->offset = output_file->add_contribution(section_id, p,
+							b->size, 1);
+	      continue;
+	    }
+
+	  std::pair<Contribution_map::iterator, bool> ins =
+	      copied.insert(std::make_pair(std::make_pair(i, b->offset),
+					   static_cast<section_offset_type>(0)));
+	  if (ins.second)
+	    {
+	      const unsigned char* copy;
+	      if (section_id == elfcpp::DW_SECT_STR_OFFSETS)
+		copy = this->remap_str_offsets(p, b->size);
+	      else
+		{
+		  unsigned char* q = new unsigned char[b->size];
+		  memcpy(q, p, b->size);
+		  copy = q;
+		}
+	      ins.first->second = output_file->add_contribution(section_id,
+								copy,
+								b->size, 1);
+	    }
+	  b->offset = ins.first->second;
+	}
+
+      if (k < cu_count)
+	output_file->add_cu_set(unit_set);
+      else
+	{
+	  output_file->lookup_tu(unit_set->signature);
+	  output_file->add_tu_set(unit_set);
+	}
     }
+
+  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; ++i)
+    if (is_new[i])
+      delete[] contents[i];
 }
 
 // Verify a .dwp file given a list of .dwo files referenced by the
@@ -1104,40 +1495,158 @@ Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file,
   Sized_relobj_dwo<size, big_endian>* obj =
       new Sized_relobj_dwo<size, big_endian>(this->name_, input_file, ehdr);
   obj->setup();
+  this->machine_ = ehdr.get_e_machine();
+  this->osabi_ = ehdr.get_e_ident()[elfcpp::EI_OSABI];
+  this->abiversion_ = ehdr.get_e_ident()[elfcpp::EI_ABIVERSION];
   if (output_file != NULL)
-    output_file->record_target_info(
-	this->name_, ehdr.get_e_machine(), size, big_endian,
-	ehdr.get_e_ident()[elfcpp::EI_OSABI],
-	ehdr.get_e_ident()[elfcpp::EI_ABIVERSION]);
+    output_file->record_target_info(this->name_, this->machine_, size,
+				    big_endian, this->osabi_,
+				    this->abiversion_);
   return obj;
 }
 
+// Return a view of the contents of a section, decompressed if
+// necessary.  If the contents were read by prepare_section, the caller
+// takes them over.
+
+const unsigned char*
+Dwo_file::section_contents(unsigned int shndx, section_size_type* plen,
+			   bool* is_new)
+{
+  if (shndx < this->prepared_sections_.size()
+      && this->prepared_sections_[shndx].contents != NULL)
+    {
+      Prepared_section* ps = &this->prepared_sections_[shndx];
+      const unsigned char* contents = ps->contents;
+      *plen = ps->len;
+      *is_new = ps->is_new;
+      *ps = Prepared_section();
+      return contents;
+    }
+  return this->obj_->decompressed_section_contents(shndx, plen, is_new);
+}
+
+// Read the contents of a section for a later call to section_contents.
+
+void
+Dwo_file::prepare_section(unsigned int shndx, bool copy)
+{
+  if (shndx == 0 || this->prepared_sections_[shndx].contents != NULL)
+    return;
+
+  Prepared_section* ps = &this->prepared_sections_[shndx];
+  ps->contents = this->obj_->decompressed_section_contents(shndx, &ps->len,
+							   &ps->is_new);
+  if (copy && !ps->is_new)
+    {
+      unsigned char* contents = new unsigned char[ps->len];
+      memcpy(contents, ps->contents, ps->len);
+      ps->contents = contents;
+      ps->is_new = true;
+    }
+}
+
 // Read the .debug_cu_index or .debug_tu_index section of a .dwp file,
 // and process the CU or TU sets.
 
 void
 Dwo_file::read_unit_index(unsigned int shndx, unsigned int *debug_shndx,
 			  Dwp_output_file* output_file, bool is_tu_index)
+{
+  elfcpp::DW_SECT info_sect = (is_tu_index
+			       ? elfcpp::DW_SECT_TYPES
+			       : elfcpp::DW_SECT_INFO);
+  unsigned int info_shndx = debug_shndx[info_sect];
+
+  Unit_set_list sets;
+  this->read_unit_sets(shndx, is_tu_index, &sets);
+  if (sets.empty())
+    return;
+
+  gold_assert(info_shndx > 0);
+
+  // Copy the related sections and track the section offsets and sizes.
+  Section_bounds sections[elfcpp::DW_SECT_MAX + 1];
+  for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
+    {
+      if (debug_shndx[i] > 0)
+	sections[i] = this->copy_section(output_file, debug_shndx[i],
+					 static_cast<elfcpp::DW_SECT>(i));
+    }
+
+  // Get the contents of the .debug_info.dwo or .debug_types.dwo section.
+  section_size_type info_len;
+  bool info_is_new;
+  const unsigned char* info_contents =
+      this->section_contents(info_shndx, &info_len, &info_is_new);
+
+  for (Unit_set_list::const_iterator p = sets.begin(); p != sets.end(); ++p)
+    {
+      Unit_set* unit_set = *p;
+      if (is_tu_index && output_file->lookup_tu(unit_set->signature))
+	{
+	  delete unit_set;
+	  continue;
+	}
+
+      // Adjust the offset of each contribution within the input section
+      // by the offset of the input section within the output section.
+      for (unsigned int i = elfcpp::DW_SECT_ABBREV;
+	   i <= elfcpp::DW_SECT_MAX;
+	   ++i)
+	unit_set->sections[i].offset += sections[i].offset;
+
+      const unsigned char* unit_start =
+	  info_contents + unit_set->sections[info_sect].offset;
+      section_size_type unit_length = unit_set->sections[info_sect].size;
+      if (unit_set->sections[info_sect].offset + unit_length > info_len)
+	gold_fatal(_("%s: section %s is corrupt"), this->name_,
+		   this->section_name(shndx).c_str());
+
+      // Dwp_output_file::add_contribution writes the .debug_info.dwo
+      // section directly to the output file, so we only need to
+      // duplicate contributions for .debug_types.dwo section.
+      if (is_tu_index)
+	{
+	  unsigned char *copy = new unsigned char[unit_length];
+	  memcpy(copy, unit_start, unit_length);
+	  unit_start = copy;
+	}
+      section_offset_type off =
+	  output_file->add_contribution(info_sect, unit_start,
+					unit_length, 1);
+      unit_set->sections[info_sect].offset = off;
+      if (is_tu_index)
+	output_file->add_tu_set(unit_set);
+      else
+	output_file->add_cu_set(unit_set);
+    }
+
+  if (info_is_new)
+    delete[] info_contents;
+}
+
+// Read the .debug_cu_index or .debug_tu_index section of a .dwp file,
+// and collect the CU or TU sets.
+
+void
+Dwo_file::read_unit_sets(unsigned int shndx, bool is_tu_index,
+			 Unit_set_list* sets)
 {
   if (this->obj_->is_big_endian())
-    this->sized_read_unit_index<true>(shndx, debug_shndx, output_file,
-				      is_tu_index);
+    this->sized_read_unit_sets<true>(shndx, is_tu_index, sets);
   else
-    this->sized_read_unit_index<false>(shndx, debug_shndx, output_file,
-				       is_tu_index);
+    this->sized_read_unit_sets<false>(shndx, is_tu_index, sets);
 }
 
 template <bool big_endian>
 void
-Dwo_file::sized_read_unit_index(unsigned int shndx,
-				unsigned int *debug_shndx,
-				Dwp_output_file* output_file,
-				bool is_tu_index)
+Dwo_file::sized_read_unit_sets(unsigned int shndx, bool is_tu_index,
+			       Unit_set_list* sets)
 {
   elfcpp::DW_SECT info_sect = (is_tu_index
 			       ? elfcpp::DW_SECT_TYPES
 			       : elfcpp::DW_SECT_INFO);
-  unsigned int info_shndx = debug_shndx[info_sect];
 
   gold_assert(shndx > 0);
 
@@ -1163,9 +1672,11 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
       elfcpp::Swap_unaligned<32, big_endian>::readval(contents
 						      + 2 * sizeof(uint32_t));
   if (ncols == 0 || nused == 0)
-    return;
-
-  gold_assert(info_shndx > 0);
+    {
+      if (index_is_new)
+	delete[] contents;
+      return;
+    }
 
   unsigned int nslots =
       elfcpp::Swap_unaligned<32, big_endian>::readval(contents
@@ -1182,20 +1693,22 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
     gold_fatal(_("%s: section %s is corrupt"), this->name_,
 	       this->section_name(shndx).c_str());
 
-  // Copy the related sections and track the section offsets and sizes.
-  Section_bounds sections[elfcpp::DW_SECT_MAX + 1];
-  for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
+  // Read the column headers, which give the DW_SECT of each column.
+  std::vector<unsigned int> columns(ncols);
+  bool have_info_column = false;
+  for (unsigned int j = 0; j < ncols; ++j)
     {
-      if (debug_shndx[i] > 0)
-	sections[i] = this->copy_section(output_file, debug_shndx[i],
-					 static_cast<elfcpp::DW_SECT>(i));
+      columns[j] = elfcpp::Swap_unaligned<32, big_endian>::readval(
+	  pcolhdrs + j * sizeof(uint32_t));
+      if (columns[j] == 0 || columns[j] > elfcpp::DW_SECT_MAX)
+	gold_fatal(_("%s: section %s is corrupt"), this->name_,
+		   this->section_name(shndx).c_str());
+      if (columns[j] == static_cast<unsigned int>(info_sect))
+	have_info_column = true;
     }
-
-  // Get the contents of the .debug_info.dwo or .debug_types.dwo section.
-  section_size_type info_len;
-  bool info_is_new;
-  const unsigned char* info_contents =
-      this->section_contents(info_shndx, &info_len, &info_is_new);
+  if (!have_info_column)
+    gold_fatal(_("%s: section %s is corrupt"), this->name_,
+	       this->section_name(shndx).c_str());
 
   // Loop over the slots of the hash table.
   for (unsigned int i = 0; i < nslots; ++i)
@@ -1204,55 +1717,29 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
           elfcpp::Swap_unaligned<64, big_endian>::readval(phash);
       unsigned int index =
 	  elfcpp::Swap_unaligned<32, big_endian>::readval(pindex);
-      if (index != 0 && (!is_tu_index || !output_file->lookup_tu(signature)))
+      if (index > nused)
+	gold_fatal(_("%s: section %s is corrupt"), this->name_,
+		   this->section_name(shndx).c_str());
+      if (index != 0)
 	{
 	  Unit_set* unit_set = new Unit_set();
 	  unit_set->signature = signature;
-	  const unsigned char* pch = pcolhdrs;
 	  const unsigned char* porow =
 	      poffsets + (index - 1) * ncols * sizeof(uint32_t);
 	  const unsigned char* psrow =
 	      psizes + (index - 1) * ncols * sizeof(uint32_t);
-
-	  // Adjust the offset of each contribution within the input section
-	  // by the offset of the input section within the output section.
-	  for (unsigned int j = 0; j <= ncols; j++)
+	  for (unsigned int j = 0; j < ncols; j++)
 	    {
-	      unsigned int dw_sect =
-		  elfcpp::Swap_unaligned<64, big_endian>::readval(pch);
 	      unsigned int offset =
-		  elfcpp::Swap_unaligned<64, big_endian>::readval(porow);
+		  elfcpp::Swap_unaligned<32, big_endian>::readval(porow);
 	      unsigned int size =
-		  elfcpp::Swap_unaligned<64, big_endian>::readval(psrow);
-	      unit_set->sections[dw_sect].offset = (sections[dw_sect].offset
-						    + offset);
-	      unit_set->sections[dw_sect].size = size;
-	      pch += sizeof(uint32_t);
+		  elfcpp::Swap_unaligned<32, big_endian>::readval(psrow);
+	      unit_set->sections[columns[j]].offset = offset;
+	      unit_set->sections[columns[j]].size = size;
 	      porow += sizeof(uint32_t);
 	      psrow += sizeof(uint32_t);
 	    }
-
-	  const unsigned char* unit_start =
-	      info_contents + unit_set->sections[info_sect].offset;
-	  section_size_type unit_length = unit_set->sections[info_sect].size;
-
-	  // Dwp_output_file::add_contribution writes the .debug_info.dwo
-	  // section directly to the output file, so we only need to
-	  // duplicate contributions for .debug_types.dwo section.
-	  if (is_tu_index)
-	    {
-	      unsigned char *copy = new unsigned char[unit_length];
-	      memcpy(copy, unit_start, unit_length);
-	      unit_start = copy;
-	    }
-	  section_offset_type off =
-	      output_file->add_contribution(info_sect, unit_start,
-					    unit_length, 1);
-	  unit_set->sections[info_sect].offset = off;
-	  if (is_tu_index)
-	    output_file->add_tu_set(unit_set);
-	  else
-	    output_file->add_cu_set(unit_set);
+	  sets->push_back(unit_set);
 	}
       phash += sizeof(uint64_t);
       pindex += sizeof(uint32_t);
@@ -1260,8 +1747,6 @@ Dwo_file::sized_read_unit_index(unsigned int shndx,
 
   if (index_is_new)
     delete[] contents;
-  if (info_is_new)
-    delete[] info_contents;
 }
 
 // Verify the .debug_cu_index section of a .dwp file, comparing it
@@ -1363,7 +1848,8 @@ Dwo_file::sized_verify_dwo_list(unsigned int shndx, const File_list& files)
 // Merge the input string table section into the output file.
 
 void
-Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
+Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str,
+		      const std::vector<section_offset_type>* used_strings)
 {
   section_size_type len;
   bool is_new;
@@ -1385,14 +1871,29 @@ Dwo_file::add_strings(Dwp_output_file* output_file, unsigned int debug_str)
   this->str_offset_map_.reserve(count + 1);
 
   // Add the strings to the output string table, and record the new offsets
-  // in the map.
+  // in the map.  A string offset may point into the middle of a string,
+  // so we keep each string that contains a used offset.
   section_offset_type i = 0;
   section_offset_type new_offset;
+  std::vector<section_offset_type>::const_iterator u;
+  if (used_strings != NULL)
+    u = used_strings->begin();
   while (p < pend)
     {
       size_t len = strlen(p);
-      new_offset = output_file->add_string(p, len);
-      this->str_offset_map_.push_back(std::make_pair(i, new_offset));
+      bool is_used = true;
+      if (used_strings != NULL)
+	{
+	  while (u != used_strings->end() && *u < i)
+	    ++u;
+	  is_used = (u != used_strings->end()
+		     && *u <= i + static_cast<section_offset_type>(len));
+	}
+      if (is_used)
+	{
+	  new_offset = output_file->add_string(p, len);
+	  this->str_offset_map_.push_back(std::make_pair(i, new_offset));
+	}
       p += len + 1;
       i += len + 1;
     }
@@ -1450,6 +1951,35 @@ Dwo_file::copy_section(Dwp_output_file* output_file, unsigned int shndx,
   return bounds;
 }
 
+// Add the string offsets found in a contribution to the
+// .debug_str_offsets.dwo section to USED_STRINGS.
+
+void
+Dwo_file::get_used_strings(const unsigned char* contents,
+			   section_size_type len,
+			   std::vector<section_offset_type>* used_strings)
+{
+  if ((len & 3) != 0)
+    gold_fatal(_("%s: .debug_str_offsets.dwo section size not a multiple of 4"),
+	       this->name_);
+
+  if (this->obj_->is_big_endian())
+    this->sized_get_used_strings<true>(contents, len, used_strings);
+  else
+    this->sized_get_used_strings<false>(contents, len, used_strings);
+}
+
+template <bool big_endian>
+void
+Dwo_file::sized_get_used_strings(const unsigned char* contents,
+				 section_size_type len,
+				 std::vector<section_offset_type>* used_strings)
+{
+  for (section_size_type i = 0; i < len; i += 4)
+    used_strings->push_back(
+	elfcpp::Swap_unaligned<32, big_endian>::readval(contents + i));
+}
+
 // Remap the 
 const unsigned char*
 Dwo_file::remap_str_offsets(const unsigned char* contents,
@@ -1512,7 +2042,7 @@ Dwo_file::remap_str_offset(section_offset_type val)
 
 void
 Dwo_file::add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
-		       bool is_debug_types)
+		       bool is_debug_types, Dwo_unit_list* units)
 {
   unsigned int shndx = (is_debug_types
 			? debug_shndx[elfcpp::DW_SECT_TYPES]
@@ -1520,9 +2050,6 @@ Dwo_file::add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
 
   gold_assert(shndx != 0);
 
-  if (debug_shndx[elfcpp::DW_SECT_ABBREV] == 0)
-    gold_fatal(_("%s: no .debug_abbrev.dwo section found"), this->name_);
-
   // Copy the related sections and track the section offsets and sizes.
   Section_bounds sections[elfcpp::DW_SECT_MAX + 1];
   for (int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
@@ -1532,11 +2059,50 @@ Dwo_file::add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
 					 static_cast<elfcpp::DW_SECT>(i));
     }
 
-  // Parse the .debug_info or .debug_types section and add each compilation
-  // or type unit to the output file, along with the contributions to the
-  // related sections.
-  Unit_reader reader(is_debug_types, this->obj_, shndx);
-  reader.add_units(output_file, debug_shndx[elfcpp::DW_SECT_ABBREV], sections);
+  // Add each compilation or type unit to the output file, along with
+  // the contributions to the related sections.
+  elfcpp::DW_SECT section_id = (is_debug_types
+				? elfcpp::DW_SECT_TYPES
+				: elfcpp::DW_SECT_INFO);
+  for (Dwo_unit_list::iterator p = units->begin(); p != units->end(); ++p)
+    {
+      if (is_debug_types && output_file->lookup_tu(p->signature))
+	{
+	  if (p->is_new)
+	    delete[] p->contents;
+	  continue;
+	}
+
+      Unit_set* unit_set = new Unit_set();
+      unit_set->signature = p->signature;
+      for (unsigned int i = elfcpp::DW_SECT_ABBREV;
+	   i <= elfcpp::DW_SECT_MAX;
+	   ++i)
+	unit_set->sections[i] = sections[i];
+
+      // Dwp_output_file::add_contribution writes the .debug_info.dwo
+      // section directly to the output file, and does not free the
+      // memory.  It takes ownership of .debug_types.dwo contributions.
+      const unsigned char* contents = p->contents;
+      if (is_debug_types && !p->is_new)
+	{
+	  unsigned char* copy = new unsigned char[p->size];
+	  memcpy(copy, contents, p->size);
+	  contents = copy;
+	}
+      section_offset_type off =
+	  output_file->add_contribution(section_id, contents, p->size, 1);
+      if (!is_debug_types && p->is_new)
+	delete[] p->contents;
+
+      Section_bounds bounds(off, p->size);
+      unit_set->sections[section_id] = bounds;
+      if (is_debug_types)
+	output_file->add_tu_set(unit_set);
+      else
+	output_file->add_cu_set(unit_set);
+    }
+  units->clear();
 }
 
 // Class Dwp_output_file.
@@ -1702,6 +2268,14 @@ Dwp_output_file::add_cu_set(Unit_set* cu_set)
 		 this->name_, (unsigned long long)dwo_id);
 }
 
+// Lookup a DWO id and return TRUE if we have already seen it.
+bool
+Dwp_output_file::lookup_cu(uint64_t dwo_id)
+{
+  unsigned int slot;
+  return this->cu_index_.find_or_add(dwo_id, &slot);
+}
+
 // Lookup a type signature and return TRUE if we have already seen it.
 bool
 Dwp_output_file::lookup_tu(uint64_t type_sig)
@@ -2220,15 +2794,14 @@ Dwo_name_info_reader::visit_compilation_unit(off_t, off_t, Dwarf_die* die)
 
 // Class Unit_reader.
 
-// Read the CUs or TUs and add them to the output file.
+// Read the CUs or TUs and add them to UNITS.
 
 void
-Unit_reader::add_units(Dwp_output_file* output_file,
-		       unsigned int debug_abbrev,
-		       Section_bounds* sections)
+Unit_reader::read_units(unsigned int debug_abbrev, bool copy_contents,
+			Dwo_unit_list* units)
 {
-  this->output_file_ = output_file;
-  this->sections_ = sections;
+  this->units_ = units;
+  this->copy_contents_ = copy_contents;
   this->set_abbrev_shndx(debug_abbrev);
   this->parse();
 }
@@ -2240,22 +2813,7 @@ Unit_reader::visit_compilation_unit(off_t, off_t cu_length, Dwarf_die* die)
 {
   if (cu_length == 0)
     return;
-
-  Unit_set* unit_set = new Unit_set();
-  unit_set->signature = die->uint_attribute(elfcpp::DW_AT_GNU_dwo_id);
-  for (unsigned int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
-    unit_set->sections[i] = this->sections_[i];
-
-  // Dwp_output_file::add_contribution writes the .debug_info.dwo section
-  // directly to the output file, so we do not need to duplicate the
-  // section contents, and add_contribution does not need to free the memory.
-  section_offset_type off =
-      this->output_file_->add_contribution(elfcpp::DW_SECT_INFO,
-					   this->buffer_at_offset(0),
-					   cu_length, 1);
-  Section_bounds bounds(off, cu_length);
-  unit_set->sections[elfcpp::DW_SECT_INFO] = bounds;
-  this->output_file_->add_cu_set(unit_set);
+  this->add_unit(die->uint_attribute(elfcpp::DW_AT_GNU_dwo_id), cu_length);
 }
 
 // Visit a type unit.
@@ -2266,22 +2824,172 @@ Unit_reader::visit_type_unit(off_t, off_t tu_length, off_t,
 {
   if (tu_length == 0)
     return;
-  if (this->output_file_->lookup_tu(signature))
-    return;
+  this->add_unit(signature, tu_length);
+}
 
-  Unit_set* unit_set = new Unit_set();
-  unit_set->signature = signature;
-  for (unsigned int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
-    unit_set->sections[i] = this->sections_[i];
-
-  unsigned char* contents = new unsigned char[tu_length];
-  memcpy(contents, this->buffer_at_offset(0), tu_length);
-  section_offset_type off =
-      this->output_file_->add_contribution(elfcpp::DW_SECT_TYPES, contents,
-					   tu_length, 1);
-  Section_bounds bounds(off, tu_length);
-  unit_set->sections[elfcpp::DW_SECT_TYPES] = bounds;
-  this->output_file_->add_tu_set(unit_set);
+// Add the current unit to the list.
+
+void
+Unit_reader::add_unit(uint64_t signature, off_t length)
+{
+  Dwo_unit unit;
+  unit.signature = signature;
+  unit.contents = this->buffer_at_offset(0);
+  unit.size = length;
+  unit.is_new = false;
+  if (this->copy_contents_)
+    {
+      unsigned char* contents = new unsigned char[length];
+      memcpy(contents, unit.contents, length);
+      unit.contents = contents;
+      unit.is_new = true;
+    }
+  this->units_->push_back(unit);
+}
+
+// With --threads, the input files are read by Dwo_prepare_task tasks,
+// which run in parallel, and sent to the output file by
+// Dwo_write_task tasks, which run one at a time in the order of the
+// input files, so that the output file does not depend on the number
+// of threads.
+
+// A task which reads an input file.
+
+class Dwo_prepare_task : public Task
+{
+ public:
+  Dwo_prepare_task(Dwo_file* dwo_file, Task_token* prepared)
+    : dwo_file_(dwo_file), prepared_(prepared)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->prepared_); }
+
+  void
+  run(Workqueue*)
+  { this->dwo_file_->prepare(); }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_prepare_task ") + this->dwo_file_->name(); }
+
+ private:
+  Dwo_file* dwo_file_;
+  Task_token* prepared_;
+};
+
+// A task which sends an input file to the output file, once it has
+// been read and the previous input file has been written.  To limit
+// the number of input files held in memory, it queues the task which
+// reads a later input file, NEXT_PREPARE, if not NULL.
+
+class Dwo_write_task : public Task
+{
+ public:
+  Dwo_write_task(Dwp_output_file* output_file, Dwo_file* dwo_file,
+		 bool verbose, Task_token* prepared, Task_token* this_blocker,
+		 Task_token* next_blocker, Dwo_prepare_task* next_prepare)
+    : output_file_(output_file), dwo_file_(dwo_file), verbose_(verbose),
+      prepared_(prepared), this_blocker_(this_blocker),
+      next_blocker_(next_blocker), next_prepare_(next_prepare)
+  { }
+
+  ~Dwo_write_task()
+  {
+    delete this->prepared_;
+    if (this->this_blocker_ != NULL)
+      delete this->this_blocker_;
+  }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->prepared_->is_blocked())
+      return this->prepared_;
+    if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    if (this->next_prepare_ != NULL)
+      workqueue->queue(this->next_prepare_);
+    if (this->verbose_)
+      fprintf(stderr, "%s\n", this->dwo_file_->name());
+    this->dwo_file_->write(this->output_file_);
+    delete this->dwo_file_;
+  }
+
+  std::string
+  get_name() const
+  { return std::string("Dwo_write_task ") + this->dwo_file_->name(); }
+
+ private:
+  Dwp_output_file* output_file_;
+  Dwo_file* dwo_file_;
+  bool verbose_;
+  Task_token* prepared_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+  Dwo_prepare_task* next_prepare_;
+};
+
+// Queue the tasks which read the input files FILES and send them to
+// OUTPUT_FILE, using THREAD_COUNT threads, and run them.
+
+static void
+process_files_in_parallel(const File_list& files,
+			  Dwp_output_file* output_file, int thread_count,
+			  bool verbose)
+{
+  Workqueue workqueue(parameters->options());
+  workqueue.set_thread_count(thread_count);
+
+  // At most WINDOW input files are read ahead of the one being
+  // written.
+  const size_t window = 4 * thread_count;
+
+  size_t count = files.size();
+  std::vector<Dwo_file*> dwo_files(count);
+  std::vector<Task_token*> prepared(count);
+  std::vector<Dwo_prepare_task*> prepare_tasks(count);
+  for (size_t i = 0; i < count; ++i)
+    {
+      dwo_files[i] = new Dwo_file(files[i].dwo_name.c_str());
+      prepared[i] = new Task_token(true);
+      prepared[i]->add_blocker();
+      prepare_tasks[i] = new Dwo_prepare_task(dwo_files[i], prepared[i]);
+    }
+
+  Task_token* this_blocker = NULL;
+  for (size_t i = 0; i < count; ++i)
+    {
+      if (i < window)
+	workqueue.queue(prepare_tasks[i]);
+      Task_token* next_blocker = new Task_token(true);
+      next_blocker->add_blocker();
+      workqueue.queue(new Dwo_write_task(output_file, dwo_files[i], verbose,
+					 prepared[i], this_blocker,
+					 next_blocker,
+					 (i + window < count
+					  ? prepare_tasks[i + window]
+					  : NULL)));
+      this_blocker = next_blocker;
+    }
+
+  workqueue.process(0);
+  delete this_blocker;
 }
 
 }; // End namespace gold
@@ -2292,6 +3000,8 @@ using namespace gold;
 
 enum Dwp_options {
   VERIFY_ONLY = 0x101,
+  THREADS,
+  THREAD_COUNT,
 };
 
 struct option dwp_options[] =
@@ -2299,6 +3009,9 @@ struct option dwp_options[] =
     { "exec", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
     { "output", required_argument, NULL, 'o' },
+    { "threads", no_argument, NULL, THREADS },
+    { "thread-count", required_argument, NULL, THREAD_COUNT },
+    { "update", no_argument, NULL, 'u' },
     { "verbose", no_argument, NULL, 'v' },
     { "verify-only", no_argument, NULL, VERIFY_ONLY },
     { "version", no_argument, NULL, 'V' },
@@ -2315,6 +3028,11 @@ usage(FILE* fd, int exit_status)
   fprintf(fd, _("  -e EXE, --exec EXE       Get list of dwo files from EXE"
 					   " (defaults output to EXE.dwp)\n"));
   fprintf(fd, _("  -o FILE, --output FILE   Set output dwp file name\n"));
+  fprintf(fd, _("  --threads                Read input files in parallel\n"));
+  fprintf(fd, _("  --thread-count COUNT     Number of threads to use with"
+					   " --threads\n"));
+  fprintf(fd, _("  -u, --update             Update output file, reading only"
+					   " changed dwo files\n"));
   fprintf(fd, _("  -v, --verbose            Verbose output\n"));
   fprintf(fd, _("  --verify-only            Verify output file against"
 					   " exec file\n"));
@@ -2363,12 +3081,6 @@ main(int argc, char** argv)
   Errors errors(program_name);
   set_parameters_errors(&errors);
 
-  // Initialize gold's global options.  We don't use these in
-  // this program, but they need to be initialized so that
-  // functions we call from libgold work properly.
-  General_options options;
-  set_parameters_options(&options);
-
   // In libiberty; expands @filename to the args in "filename".
   expandargv(&argc, &argv);
 
@@ -2378,8 +3090,11 @@ main(int argc, char** argv)
   const char* exe_filename = NULL;
   bool verbose = false;
   bool verify_only = false;
+  bool update = false;
+  bool threads = false;
+  int thread_count = 0;
   int c;
-  while ((c = getopt_long(argc, argv, "e:ho:vV", dwp_options, NULL)) != -1)
+  while ((c = getopt_long(argc, argv, "e:ho:uvV", dwp_options, NULL)) != -1)
     {
       switch (c)
         {
@@ -2391,12 +3106,27 @@ main(int argc, char** argv)
 	  case 'o':
 	    output_filename.assign(optarg);
 	    break;
+	  case 'u':
+	    update = true;
+	    break;
 	  case 'v':
 	    verbose = true;
 	    break;
 	  case VERIFY_ONLY:
 	    verify_only = true;
 	    break;
+	  case THREADS:
+	    threads = true;
+	    break;
+	  case THREAD_COUNT:
+	    {
+	      char* endptr;
+	      thread_count = strtol(optarg, &endptr, 0);
+	      if (*endptr != '\0' || thread_count <= 0)
+		gold_fatal(_("invalid thread count: %s"), optarg);
+	      threads = true;
+	    }
+	    break;
 	  case 'V':
 	    print_version();
 	  case '?':
@@ -2405,6 +3135,19 @@ main(int argc, char** argv)
 	}
     }
 
+  // Initialize gold's global options.  We don't use most of these
+  // in this program, but they need to be initialized so that
+  // functions we call from libgold work properly.  With --threads,
+  // libgold must use real locks.
+  Command_line command_line;
+  if (threads)
+    {
+      const char* threads_argv[] = { "--threads" };
+      command_line.process(1, threads_argv);
+      threads = command_line.options().threads();
+    }
+  set_parameters_options(&command_line.options());
+
   if (output_filename.empty())
     {
       if (exe_filename == NULL)
@@ -2436,16 +3179,110 @@ main(int argc, char** argv)
       return ok ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
+  // With --update, read the index of the existing output file, and
+  // only read the .dwo files that replace its contents.  The new file
+  // is written under a temporary name, and renamed when complete.
+  Dwo_file* old_dwp = NULL;
+  Dwo_id_set exe_dwo_ids;
+  std::string tmp_filename(output_filename);
+  struct stat dwp_stat;
+  if (update && ::stat(output_filename.c_str(), &dwp_stat) == 0)
+    {
+      old_dwp = new Dwo_file(output_filename.c_str());
+      old_dwp->prepare();
+      if (!old_dwp->is_dwp())
+	gold_fatal(_("%s: not a .dwp file"), output_filename.c_str());
+
+      Dwo_id_set old_dwo_ids;
+      old_dwp->get_dwo_ids(&old_dwo_ids);
+
+      // Files listed on the command line are always read.  A .dwo file
+      // referenced by the executable is read only if its CU is not in
+      // the existing output file, or if it is newer than that file.
+      File_list changed_files;
+      for (File_list::const_iterator f = files.begin();
+	   f != files.end();
+	   ++f)
+	{
+	  if (f->dwo_id != 0)
+	    {
+	      exe_dwo_ids.insert(f->dwo_id);
+	      struct stat dwo_stat;
+	      if (old_dwo_ids.find(f->dwo_id) != old_dwo_ids.end()
+		  && (::stat(f->dwo_name.c_str(), &dwo_stat) != 0
+		      || dwo_stat.st_mtime < dwp_stat.st_mtime))
+		continue;
+	    }
+	  changed_files.push_back(*f);
+	}
+
+      // CUs that the executable no longer references are dropped.
+      bool have_stale = false;
+      if (exe_filename != NULL)
+	{
+	  for (Dwo_id_set::const_iterator p = old_dwo_ids.begin();
+	       p != old_dwo_ids.end();
+	       ++p)
+	    if (exe_dwo_ids.find(*p) == exe_dwo_ids.end())
+	      {
+		have_stale = true;
+		break;
+	      }
+	}
+
+      if (changed_files.empty() && !have_stale)
+	{
+	  if (verbose)
+	    fprintf(stderr, _("%s is up to date\n"), output_filename.c_str());
+	  delete old_dwp;
+	  return EXIT_SUCCESS;
+	}
+
+      files.swap(changed_files);
+      tmp_filename.append(".tmp");
+    }
+
   // Process each file, adding its contents to the output file.
-  Dwp_output_file output_file(output_filename.c_str());
-  for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+  Dwp_output_file output_file(tmp_filename.c_str());
+  if (threads)
+    {
+      if (thread_count == 0)
+	{
+#ifdef _SC_NPROCESSORS_ONLN
+	  thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	  if (thread_count <= 0)
+	    thread_count = 4;
+	}
+      process_files_in_parallel(files, &output_file, thread_count, verbose);
+    }
+  else
+    {
+      for (File_list::const_iterator f = files.begin();
+	   f != files.end();
+	   ++f)
+	{
+	  if (verbose)
+	    fprintf(stderr, "%s\n", f->dwo_name.c_str());
+	  Dwo_file dwo_file(f->dwo_name.c_str());
+	  dwo_file.read(&output_file);
+	}
+    }
+  if (old_dwp != NULL)
     {
       if (verbose)
-	fprintf(stderr, "%s\n", f->dwo_name.c_str());
-      Dwo_file dwo_file(f->dwo_name.c_str());
-      dwo_file.read(&output_file);
+	fprintf(stderr, "%s\n", old_dwp->name());
+      old_dwp->write_update(&output_file,
+			    exe_filename != NULL ? &exe_dwo_ids : NULL);
     }
   output_file.finalize();
+  if (old_dwp != NULL)
+    {
+      delete old_dwp;
+      if (::rename(tmp_filename.c_str(), output_filename.c_str()) < 0)
+	gold_fatal(_("cannot rename %s to %s: %s"), tmp_filename.c_str(),
+		   output_filename.c_str(), strerror(errno));
+    }
 
   return EXIT_SUCCESS;
 }
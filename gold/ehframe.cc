@@ -84,6 +84,9 @@ Eh_frame_hdr::Eh_frame_hdr(Output_section* eh_frame_section,
     eh_frame_section_(eh_frame_section),
     eh_frame_data_(eh_frame_data),
     fde_offsets_(),
+    fde_addresses_(),
+    sort_output_file_(NULL),
+    sorted_chunks_(false),
     any_unrecognized_eh_frame_sections_(false)
 {
 }
@@ -182,21 +185,34 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
       // relocations which are, of course, target specific.  This code
       // is run after all those relocations have been applied to the
       // output file.  Here we read the output file again to find the
-      // PC values.  Then we sort the list and write it out.
+      // PC values.  Then we sort the list and write it out.  When
+      // using threads, Eh_frame_hdr_sort_task has already done that
+      // for each chunk of the list, and we only need to merge the
+      // sorted chunks.
 
-      Fde_addresses<size> fde_addresses(this->fde_offsets_.size());
-      this->get_fde_addresses<size, big_endian>(of, &this->fde_offsets_,
-						&fde_addresses);
-
-      std::sort(fde_addresses.begin(), fde_addresses.end(),
-		Fde_address_compare<size>());
+      const size_t count = this->fde_offsets_.size();
+      if (this->sorted_chunks_)
+	{
+	  gold_assert(this->fde_addresses_.size() == count);
+	  Fde_addresses::iterator begin = this->fde_addresses_.begin();
+	  for (size_t width = fde_sort_chunk_size; width < count; width *= 2)
+	    for (size_t start = 0; start + width < count; start += 2 * width)
+	      std::inplace_merge(begin + start, begin + start + width,
+				 begin + std::min(start + 2 * width, count));
+	}
+      else
+	{
+	  this->fde_addresses_.resize(count);
+	  this->get_fde_addresses<size, big_endian>(of, 0, count);
+	  std::sort(this->fde_addresses_.begin(), this->fde_addresses_.end());
+	}
 
       typename elfcpp::Elf_types<size>::Elf_Addr output_address;
       output_address = this->address();
 
       unsigned char* pfde = oview + 12;
-      for (typename Fde_addresses<size>::iterator p = fde_addresses.begin();
-	   p != fde_addresses.end();
+      for (Fde_addresses::const_iterator p = this->fde_addresses_.begin();
+	   p != this->fde_addresses_.end();
 	   ++p)
 	{
 	  elfcpp::Swap<32, big_endian>::writeval(pfde,
@@ -290,17 +306,14 @@ Eh_frame_hdr::get_fde_pc(
   return pc;
 }
 
-// Given an array of FDE offsets in the .eh_frame section, return an
-// array of offsets from the exception frame header to the FDE's
-// output PC and to the output address of the FDE itself.  We get the
-// FDE's PC by actually looking in the .eh_frame section we just wrote
-// to the output file.
+// Set the entries of fde_addresses_ from START to END to the output
+// address of the PC of the corresponding FDE in fde_offsets_ and the
+// output address of the FDE itself.  We get the FDE's PC by actually
+// looking in the .eh_frame section we just wrote to the output file.
 
 template<int size, bool big_endian>
 void
-Eh_frame_hdr::get_fde_addresses(Output_file* of,
-				const Fde_offsets* fde_offsets,
-				Fde_addresses<size>* fde_addresses)
+Eh_frame_hdr::get_fde_addresses(Output_file* of, size_t start, size_t end)
 {
   typename elfcpp::Elf_types<size>::Elf_Addr eh_frame_address;
   eh_frame_address = this->eh_frame_section_->address();
@@ -309,20 +322,146 @@ Eh_frame_hdr::get_fde_addresses(Output_file* of,
   const unsigned char* eh_frame_contents = of->get_input_view(eh_frame_offset,
 							      eh_frame_size);
 
-  for (Fde_offsets::const_iterator p = fde_offsets->begin();
-       p != fde_offsets->end();
-       ++p)
+  for (size_t i = start; i < end; ++i)
     {
+      const Fde_offset& fo(this->fde_offsets_[i]);
       typename elfcpp::Elf_types<size>::Elf_Addr fde_pc;
       fde_pc = this->get_fde_pc<size, big_endian>(eh_frame_address,
 						  eh_frame_contents,
-						  p->first, p->second);
-      fde_addresses->push_back(fde_pc, eh_frame_address + p->first);
+						  fo.first, fo.second);
+      typename elfcpp::Elf_types<size>::Elf_Addr fde_address;
+      fde_address = eh_frame_address + fo.first;
+      this->fde_addresses_[i] = std::make_pair(fde_pc, fde_address);
     }
 
   of->free_input_view(eh_frame_offset, eh_frame_size, eh_frame_contents);
 }
 
+// Prepare to find and sort the FDE addresses in chunks.  This is
+// called by Eh_frame_hdr_sort_task after the .eh_frame section has
+// been written to OF.
+
+unsigned int
+Eh_frame_hdr::prepare_sort_chunks(Output_file* of)
+{
+  if (this->any_unrecognized_eh_frame_sections_ || this->fde_offsets_.empty())
+    return 0;
+  this->sort_output_file_ = of;
+  this->fde_addresses_.resize(this->fde_offsets_.size());
+  this->sorted_chunks_ = true;
+  return ((this->fde_offsets_.size() + fde_sort_chunk_size - 1)
+	  / fde_sort_chunk_size);
+}
+
+// Find the FDE addresses in chunk CHUNK, and sort them.
+
+void
+Eh_frame_hdr::sort_chunk(unsigned int chunk)
+{
+  size_t start = chunk * fde_sort_chunk_size;
+  size_t end = std::min(start + fde_sort_chunk_size,
+			this->fde_offsets_.size());
+  gold_assert(start < end);
+  Output_file* of = this->sort_output_file_;
+  switch (parameters->size_and_endianness())
+    {
+#ifdef HAVE_TARGET_32_LITTLE
+    case Parameters::TARGET_32_LITTLE:
+      this->get_fde_addresses<32, false>(of, start, end);
+      break;
+#endif
+#ifdef HAVE_TARGET_32_BIG
+    case Parameters::TARGET_32_BIG:
+      this->get_fde_addresses<32, true>(of, start, end);
+      break;
+#endif
+#ifdef HAVE_TARGET_64_LITTLE
+    case Parameters::TARGET_64_LITTLE:
+      this->get_fde_addresses<64, false>(of, start, end);
+      break;
+#endif
+#ifdef HAVE_TARGET_64_BIG
+    case Parameters::TARGET_64_BIG:
+      this->get_fde_addresses<64, true>(of, start, end);
+      break;
+#endif
+    default:
+      gold_unreachable();
+    }
+  std::sort(this->fde_addresses_.begin() + start,
+	    this->fde_addresses_.begin() + end);
+}
+
+// A task to find and sort the FDE addresses in one chunk.
+
+class Eh_frame_hdr_sort_chunk_task : public Task
+{
+ public:
+  Eh_frame_hdr_sort_chunk_task(Eh_frame_hdr* eh_frame_hdr, unsigned int chunk,
+			       Task_token* blocker)
+    : eh_frame_hdr_(eh_frame_hdr), chunk_(chunk), blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->eh_frame_hdr_->sort_chunk(this->chunk_); }
+
+  std::string
+  get_name() const
+  { return "Eh_frame_hdr_sort_chunk_task"; }
+
+ private:
+  Eh_frame_hdr* eh_frame_hdr_;
+  unsigned int chunk_;
+  Task_token* blocker_;
+};
+
+// Class Eh_frame_hdr_sort_task.
+
+// We can only run once the .eh_frame section has been written.
+
+Task_token*
+Eh_frame_hdr_sort_task::is_runnable()
+{
+  if (this->input_sections_blocker_->is_blocked())
+    return this->input_sections_blocker_;
+  return NULL;
+}
+
+// We hold SORT_BLOCKER until the chunk tasks have been queued.
+
+void
+Eh_frame_hdr_sort_task::locks(Task_locker* tl)
+{
+  tl->add(this, this->sort_blocker_);
+}
+
+// Queue a task to sort each chunk of the FDE addresses.
+
+void
+Eh_frame_hdr_sort_task::run(Workqueue* workqueue)
+{
+  unsigned int chunks = this->eh_frame_hdr_->prepare_sort_chunks(this->of_);
+
+  // Other tasks may share SORT_BLOCKER, so the workqueue has to add
+  // the blockers for us.
+  for (unsigned int i = 0; i < chunks; ++i)
+    {
+      workqueue->add_blocker(this->sort_blocker_);
+      workqueue->queue(new Eh_frame_hdr_sort_chunk_task(this->eh_frame_hdr_,
+							i,
+							this->sort_blocker_));
+    }
+}
+
 // Class Fde.
 
 // Write the FDE to OVIEW starting at OFFSET.  CIE_OFFSET is the
@@ -525,6 +664,20 @@ operator<(const Cie& cie1, const Cie& cie2)
   return cie1.contents_ < cie2.contents_;
 }
 
+// Class Parsed_eh_frame_section.
+
+Parsed_eh_frame_section::~Parsed_eh_frame_section()
+{
+  for (std::vector<std::pair<Cie*, bool> >::iterator p = this->cies_.begin();
+       p != this->cies_.end();
+       ++p)
+    delete p->first;
+  for (std::vector<Entry>::iterator p = this->entries_.begin();
+       p != this->entries_.end();
+       ++p)
+    delete p->fde;
+}
+
 // Class Eh_frame.
 
 Eh_frame::Eh_frame()
@@ -578,13 +731,42 @@ Eh_frame::add_ehframe_input_section(
     unsigned int reloc_shndx,
     unsigned int reloc_type)
 {
+  Parsed_eh_frame_section* parsed =
+    parse_ehframe_input_section(object, symbols, symbols_size,
+				symbol_names, symbol_names_size, shndx,
+				reloc_shndx, reloc_type);
+  return this->add_parsed_ehframe_input_section(parsed);
+}
+
+// Read the input section SHNDX in OBJECT into a new
+// Parsed_eh_frame_section, which records how the section should be
+// handled.
+
+template<int size, bool big_endian>
+Parsed_eh_frame_section*
+Eh_frame::parse_ehframe_input_section(
+    Sized_relobj_file<size, big_endian>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type)
+{
+  Parsed_eh_frame_section* parsed = new Parsed_eh_frame_section(object,
+								shndx);
+
   // Get the section contents.
   section_size_type contents_len;
   const unsigned char* pcontents = object->section_contents(shndx,
 							    &contents_len,
 							    false);
   if (contents_len == 0)
-    return EH_EMPTY_SECTION;
+    {
+      parsed->disposition_ = EH_EMPTY_SECTION;
+      return parsed;
+    }
 
   // If this is the marker section for the end of the data, then
   // return false to force it to be handled as an ordinary input
@@ -592,46 +774,123 @@ Eh_frame::add_ehframe_input_section(
   // of unrecognized .eh_frame sections.
   if (contents_len == 4
       && elfcpp::Swap<32, big_endian>::readval(pcontents) == 0)
-    return EH_END_MARKER_SECTION;
-
-  New_cies new_cies;
-  if (!this->do_add_ehframe_input_section(object, symbols, symbols_size,
-					  symbol_names, symbol_names_size,
-					  shndx, reloc_shndx,
-					  reloc_type, pcontents,
-					  contents_len, &new_cies))
     {
-      if (this->eh_frame_hdr_ != NULL)
+      parsed->disposition_ = EH_END_MARKER_SECTION;
+      return parsed;
+    }
+
+  if (do_parse_ehframe_input_section(object, symbols, symbols_size,
+				     symbol_names, symbol_names_size,
+				     shndx, reloc_shndx, reloc_type,
+				     pcontents, contents_len, parsed))
+    parsed->disposition_ = EH_OPTIMIZABLE_SECTION;
+
+  return parsed;
+}
+
+// Add the CIEs and FDEs in PARSED.  A CIE which is the same as one
+// seen in an earlier section, or earlier in this section, is
+// discarded, and its FDEs are added to the earlier CIE.
+
+Eh_frame::Eh_frame_section_disposition
+Eh_frame::add_parsed_ehframe_input_section(Parsed_eh_frame_section* parsed)
+{
+  Eh_frame_section_disposition disposition = parsed->disposition_;
+  if (disposition != EH_OPTIMIZABLE_SECTION)
+    {
+      if (disposition == EH_UNRECOGNIZED_SECTION
+	  && this->eh_frame_hdr_ != NULL)
 	this->eh_frame_hdr_->found_unrecognized_eh_frame_section();
+      delete parsed;
+      return disposition;
+    }
 
-      for (New_cies::iterator p = new_cies.begin();
-	   p != new_cies.end();
-	   ++p)
-	delete p->first;
+  Relobj* object = parsed->object_;
+  unsigned int shndx = parsed->shndx_;
+
+  // Find the CIE which will be used in place of each CIE in the
+  // section.
+  std::vector<std::pair<Cie*, bool> >& cies(parsed->cies_);
+  std::vector<Cie*> output_cies;
+  output_cies.reserve(cies.size());
+  for (size_t i = 0; i < cies.size(); ++i)
+    {
+      Cie* cie = cies[i].first;
+      if (cies[i].second)
+	{
+	  Cie_offsets::iterator find_cie = this->cie_offsets_.find(cie);
+	  if (find_cie != this->cie_offsets_.end())
+	    cie = *find_cie;
+	}
+      output_cies.push_back(cie);
+    }
+
+  for (std::vector<Parsed_eh_frame_section::Entry>::iterator p =
+	 parsed->entries_.begin();
+       p != parsed->entries_.end();
+       ++p)
+    {
+      bool discard;
+      switch (p->kind)
+	{
+	case Parsed_eh_frame_section::ENTRY_CIE:
+	  discard = output_cies[p->cie_index] != cies[p->cie_index].first;
+	  break;
+
+	case Parsed_eh_frame_section::ENTRY_DUPLICATE_CIE:
+	case Parsed_eh_frame_section::ENTRY_DISCARDED_FDE:
+	  discard = true;
+	  break;
+
+	case Parsed_eh_frame_section::ENTRY_FDE:
+	  // If we have discarded the section holding the code, we can
+	  // also discard the FDE.
+	  discard = (p->code_shndx != 0
+		     && !object->is_section_included(p->code_shndx));
+	  if (discard)
+	    delete p->fde;
+	  else
+	    output_cies[p->cie_index]->add_fde(p->fde);
+	  p->fde = NULL;
+	  break;
 
-      return EH_UNRECOGNIZED_SECTION;
+	default:
+	  gold_unreachable();
+	}
+
+      // We are deleting this CIE or FDE.  Record that in our mapping
+      // from input sections to the output section.  At this point we
+      // don't know for sure that we are doing a special mapping for
+      // this input section, but that's OK--if we don't do a special
+      // mapping, nobody will ever ask for the mapping we add here.
+      if (discard)
+	object->add_merge_mapping(this, shndx, p->input_offset, p->length,
+				  -1);
     }
 
   // Now that we know we are using this section, record any new CIEs
   // that we found.
-  for (New_cies::const_iterator p = new_cies.begin();
-       p != new_cies.end();
-       ++p)
+  for (size_t i = 0; i < cies.size(); ++i)
     {
-      if (p->second)
-	this->cie_offsets_.insert(p->first);
+      if (output_cies[i] != cies[i].first)
+	delete cies[i].first;
+      else if (cies[i].second)
+	this->cie_offsets_.insert(cies[i].first);
       else
-	this->unmergeable_cie_offsets_.push_back(p->first);
+	this->unmergeable_cie_offsets_.push_back(cies[i].first);
     }
+  cies.clear();
+
+  delete parsed;
 
   return EH_OPTIMIZABLE_SECTION;
 }
 
-// The bulk of the implementation of add_ehframe_input_section.
+// The bulk of the implementation of parse_ehframe_input_section.
 
 template<int size, bool big_endian>
 bool
-Eh_frame::do_add_ehframe_input_section(
+Eh_frame::do_parse_ehframe_input_section(
     Sized_relobj_file<size, big_endian>* object,
     const unsigned char* symbols,
     section_size_type symbols_size,
@@ -642,7 +901,7 @@ Eh_frame::do_add_ehframe_input_section(
     unsigned int reloc_type,
     const unsigned char* pcontents,
     section_size_type contents_len,
-    New_cies* new_cies)
+    Parsed_eh_frame_section* parsed)
 {
   Track_relocs<size, big_endian> relocs;
 
@@ -694,17 +953,16 @@ Eh_frame::do_add_ehframe_input_section(
       if (id == 0)
 	{
 	  // CIE.
-	  if (!this->read_cie(object, shndx, symbols, symbols_size,
-			      symbol_names, symbol_names_size,
-			      pcontents, p, pentend, &relocs, &cies,
-			      new_cies))
+	  if (!read_cie(object, shndx, symbols, symbols_size,
+			symbol_names, symbol_names_size,
+			pcontents, p, pentend, &relocs, &cies, parsed))
 	    return false;
 	}
       else
 	{
 	  // FDE.
-	  if (!this->read_fde(object, shndx, symbols, symbols_size,
-			      pcontents, id, p, pentend, &relocs, &cies))
+	  if (!read_fde(object, shndx, symbols, symbols_size,
+			pcontents, id, p, pentend, &relocs, &cies, parsed))
 	    return false;
 	}
 
@@ -729,7 +987,7 @@ Eh_frame::read_cie(Sized_relobj_file<size, big_endian>* object,
 		   const unsigned char* pcieend,
 		   Track_relocs<size, big_endian>* relocs,
 		   Offsets_to_cie* cies,
-		   New_cies* new_cies)
+		   Parsed_eh_frame_section* parsed)
 {
   bool mergeable = true;
 
@@ -924,46 +1182,33 @@ Eh_frame::read_cie(Sized_relobj_file<size, big_endian>* object,
 
   Cie cie(object, shndx, (pcie - 8) - pcontents, fde_encoding, 
 	  personality_name, pcie, pcieend - pcie);
-  Cie* cie_pointer = NULL;
+  Parsed_eh_frame_section::Entry_kind kind = Parsed_eh_frame_section::ENTRY_CIE;
+  unsigned int cie_index = parsed->cies_.size();
   if (mergeable)
     {
-      Cie_offsets::iterator find_cie = this->cie_offsets_.find(&cie);
-      if (find_cie != this->cie_offsets_.end())
-	cie_pointer = *find_cie;
-      else
+      // See if we already saw this CIE in this section.  CIEs seen in
+      // earlier sections are found when the section is added.
+      for (unsigned int i = 0; i < parsed->cies_.size(); ++i)
 	{
-	  // See if we already saw this CIE in this object file.
-	  for (New_cies::const_iterator pc = new_cies->begin();
-	       pc != new_cies->end();
-	       ++pc)
+	  if (*parsed->cies_[i].first == cie)
 	    {
-	      if (*(pc->first) == cie)
-		{
-		  cie_pointer = pc->first;
-		  break;
-		}
+	      kind = Parsed_eh_frame_section::ENTRY_DUPLICATE_CIE;
+	      cie_index = i;
+	      break;
 	    }
 	}
     }
 
-  if (cie_pointer == NULL)
-    {
-      cie_pointer = new Cie(cie);
-      new_cies->push_back(std::make_pair(cie_pointer, mergeable));
-    }
-  else
-    {
-      // We are deleting this CIE.  Record that in our mapping from
-      // input sections to the output section.  At this point we don't
-      // know for sure that we are doing a special mapping for this
-      // input section, but that's OK--if we don't do a special
-      // mapping, nobody will ever ask for the mapping we add here.
-      object->add_merge_mapping(this, shndx, (pcie - 8) - pcontents,
-                                pcieend - (pcie - 8), -1);
-    }
+  if (kind == Parsed_eh_frame_section::ENTRY_CIE)
+    parsed->cies_.push_back(std::make_pair(new Cie(cie), mergeable));
+
+  parsed->entries_.push_back(
+      Parsed_eh_frame_section::Entry(kind, (pcie - 8) - pcontents,
+				     pcieend - (pcie - 8), cie_index, NULL,
+				     0));
 
   // Record this CIE plus the offset in the input section.
-  cies->insert(std::make_pair(pcie - pcontents, cie_pointer));
+  cies->insert(std::make_pair(pcie - pcontents, cie_index));
 
   return true;
 }
@@ -981,7 +1226,8 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
 		   const unsigned char* pfde,
 		   const unsigned char* pfdeend,
 		   Track_relocs<size, big_endian>* relocs,
-		   Offsets_to_cie* cies)
+		   Offsets_to_cie* cies,
+		   Parsed_eh_frame_section* parsed)
 {
   // OFFSET is the distance between the 4 bytes before PFDE to the
   // start of the CIE.  The offset we recorded for the CIE is 8 bytes
@@ -990,7 +1236,8 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   Offsets_to_cie::const_iterator pcie = cies->find(cie_offset);
   if (pcie == cies->end())
     return false;
-  Cie* cie = pcie->second;
+  unsigned int cie_index = pcie->second;
+  const Cie* cie = parsed->cies_[cie_index].first;
 
   int pc_size = 0;
   switch (cie->fde_encoding() & 7)
@@ -1046,8 +1293,11 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
 	{
 	  // This FDE applies to a discarded function.  We
 	  // can discard this FDE.
-	  object->add_merge_mapping(this, shndx, (pfde - 8) - pcontents,
-				    pfdeend - (pfde - 8), -1);
+	  parsed->entries_.push_back(
+	      Parsed_eh_frame_section::Entry(
+		  Parsed_eh_frame_section::ENTRY_DISCARDED_FDE,
+		  (pfde - 8) - pcontents, pfdeend - (pfde - 8), cie_index,
+		  NULL, 0));
 	  return true;
 	}
 
@@ -1065,8 +1315,9 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   // pointer to a PC relative offset when generating a shared library.
   relocs->advance(pfdeend - pcontents);
 
-  // Find the section index for code that this FDE describes.
-  // If we have discarded the section, we can also discard the FDE.
+  // Find the section index for code that this FDE describes.  If
+  // that section is discarded, we can also discard the FDE, but we
+  // don't check that until the section is added.
   unsigned int fde_shndx;
   const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
   if (symndx >= symbols_size / sym_size)
@@ -1075,10 +1326,8 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   bool is_ordinary;
   fde_shndx = object->adjust_sym_shndx(symndx, sym.get_st_shndx(),
 				       &is_ordinary);
-  bool is_discarded = (is_ordinary
-		       && fde_shndx != elfcpp::SHN_UNDEF
-		       && fde_shndx < object->shnum()
-		       && !object->is_section_included(fde_shndx));
+  if (!is_ordinary || fde_shndx >= object->shnum())
+    fde_shndx = elfcpp::SHN_UNDEF;
 
   // Fetch the address range field from the FDE. The offset and size
   // of the field depends on the PC encoding given in the CIE, but
@@ -1101,17 +1350,25 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
       gold_unreachable();
     }
 
-  if (is_discarded || address_range == 0)
+  if (address_range == 0)
     {
       // This FDE applies to a discarded function.  We
       // can discard this FDE.
-      object->add_merge_mapping(this, shndx, (pfde - 8) - pcontents,
-                                pfdeend - (pfde - 8), -1);
+      parsed->entries_.push_back(
+	  Parsed_eh_frame_section::Entry(
+	      Parsed_eh_frame_section::ENTRY_DISCARDED_FDE,
+	      (pfde - 8) - pcontents, pfdeend - (pfde - 8), cie_index,
+	      NULL, 0));
       return true;
     }
 
-  cie->add_fde(new Fde(object, shndx, (pfde - 8) - pcontents,
-		       pfde, pfdeend - pfde));
+  Fde* fde = new Fde(object, shndx, (pfde - 8) - pcontents,
+		     pfde, pfdeend - pfde);
+  parsed->entries_.push_back(
+      Parsed_eh_frame_section::Entry(Parsed_eh_frame_section::ENTRY_FDE,
+				     (pfde - 8) - pcontents,
+				     pfdeend - (pfde - 8), cie_index,
+				     fde, fde_shndx));
 
   return true;
 }
@@ -1295,6 +1552,18 @@ Eh_frame::add_ehframe_input_section<32, false>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Parsed_eh_frame_section*
+Eh_frame::parse_ehframe_input_section<32, false>(
+    Sized_relobj_file<32, false>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_32_BIG
@@ -1309,6 +1578,18 @@ Eh_frame::add_ehframe_input_section<32, true>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Parsed_eh_frame_section*
+Eh_frame::parse_ehframe_input_section<32, true>(
+    Sized_relobj_file<32, true>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_64_LITTLE
@@ -1323,6 +1604,18 @@ Eh_frame::add_ehframe_input_section<64, false>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Parsed_eh_frame_section*
+Eh_frame::parse_ehframe_input_section<64, false>(
+    Sized_relobj_file<64, false>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 #ifdef HAVE_TARGET_64_BIG
@@ -1337,6 +1630,18 @@ Eh_frame::add_ehframe_input_section<64, true>(
     unsigned int shndx,
     unsigned int reloc_shndx,
     unsigned int reloc_type);
+
+template
+Parsed_eh_frame_section*
+Eh_frame::parse_ehframe_input_section<64, true>(
+    Sized_relobj_file<64, true>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
 #endif
 
 } // End namespace gold.
@@ -29,6 +29,7 @@
 
 #include "output.h"
 #include "merge.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -37,6 +38,7 @@ template<int size, bool big_endian>
 class Track_relocs;
 
 class Eh_frame;
+class Parsed_eh_frame_section;
 
 // This class manages the .eh_frame_hdr section, which holds the data
 // for the PT_GNU_EH_FRAME segment.  gcc's unwind support code uses
@@ -63,6 +65,17 @@ class Eh_frame_hdr : public Output_section_data
       this->fde_offsets_.push_back(std::make_pair(fde_offset, fde_encoding));
   }
 
+  // Prepare to find and sort the FDE addresses in chunks, once the
+  // .eh_frame section has been written to OF.  Return the number of
+  // chunks.
+  unsigned int
+  prepare_sort_chunks(Output_file* of);
+
+  // Find the addresses of the FDEs in chunk CHUNK, and sort them.
+  // This may be called for different chunks in parallel.
+  void
+  sort_chunk(unsigned int chunk);
+
  protected:
   // Set the final data size.
   void
@@ -91,48 +104,16 @@ class Eh_frame_hdr : public Output_section_data
   typedef std::vector<Fde_offset> Fde_offsets;
 
   // When writing out the header, we convert the FDE offsets into FDE
-  // addresses.  This is a list of pairs of the offset from the header
-  // to the FDE PC and to the FDE itself.
-  template<int size>
-  class Fde_addresses
-  {
-   public:
-    typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
-    typedef typename std::pair<Address, Address> Fde_address;
-    typedef typename std::vector<Fde_address> Fde_address_list;
-    typedef typename Fde_address_list::iterator iterator;
-
-    Fde_addresses(unsigned int reserve)
-      : fde_addresses_()
-    { this->fde_addresses_.reserve(reserve); }
-
-    void
-    push_back(Address pc_address, Address fde_address)
-    {
-      this->fde_addresses_.push_back(std::make_pair(pc_address, fde_address));
-    }
-
-    iterator
-    begin()
-    { return this->fde_addresses_.begin(); }
-
-    iterator
-    end()
-    { return this->fde_addresses_.end(); }
+  // addresses: the output address of the FDE PC and of the FDE
+  // itself.  These are sorted by PC, and then by FDE address, so that
+  // the order does not depend on how the sorting was split up.
+  typedef std::pair<uint64_t, uint64_t> Fde_address;
 
-   private:
-    Fde_address_list fde_addresses_;
-  };
+  // The list of FDE addresses.
+  typedef std::vector<Fde_address> Fde_addresses;
 
-  // Compare Fde_address objects.
-  template<int size>
-  struct Fde_address_compare
-  {
-    bool
-    operator()(const typename Fde_addresses<size>::Fde_address& f1,
-	       const typename Fde_addresses<size>::Fde_address& f2) const
-    { return f1.first < f2.first; }
-  };
+  // The number of FDEs in each chunk sorted by sort_chunk.
+  static const size_t fde_sort_chunk_size = 16384;
 
   // Return the PC to which an FDE refers.
   template<int size, bool big_endian>
@@ -141,12 +122,12 @@ class Eh_frame_hdr : public Output_section_data
 	     const unsigned char* eh_frame_contents,
 	     section_offset_type fde_offset, unsigned char fde_encoding);
 
-  // Convert Fde_offsets to Fde_addresses.
+  // Set the entries of fde_addresses_ from START to END from the
+  // corresponding entries of fde_offsets_, reading the .eh_frame
+  // section contents from OF.
   template<int size, bool big_endian>
   void
-  get_fde_addresses(Output_file* of,
-		    const Fde_offsets* fde_offsets,
-		    Fde_addresses<size>* fde_addresses);
+  get_fde_addresses(Output_file* of, size_t start, size_t end);
 
   // The .eh_frame section.
   Output_section* eh_frame_section_;
@@ -154,11 +135,55 @@ class Eh_frame_hdr : public Output_section_data
   const Eh_frame* eh_frame_data_;
   // Data from the FDEs in the .eh_frame sections.
   Fde_offsets fde_offsets_;
+  // The addresses of the FDEs, once they have been found.
+  Fde_addresses fde_addresses_;
+  // The output file used by sort_chunk.
+  Output_file* sort_output_file_;
+  // Whether the chunks of fde_addresses_ have been sorted.
+  bool sorted_chunks_;
   // Whether we found any .eh_frame sections which we could not
   // process.
   bool any_unrecognized_eh_frame_sections_;
 };
 
+// This task finds the PCs of the FDEs for the .eh_frame_hdr section
+// and sorts them in parallel, by queuing a task for each chunk.  It
+// runs once the .eh_frame section has been written and relocated, and
+// SORT_BLOCKER is unblocked when all the chunks are sorted.
+
+class Eh_frame_hdr_sort_task : public Task
+{
+ public:
+  Eh_frame_hdr_sort_task(Eh_frame_hdr* eh_frame_hdr, Output_file* of,
+			 Task_token* input_sections_blocker,
+			 Task_token* sort_blocker)
+    : eh_frame_hdr_(eh_frame_hdr), of_(of),
+      input_sections_blocker_(input_sections_blocker),
+      sort_blocker_(sort_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Eh_frame_hdr_sort_task"; }
+
+ private:
+  Eh_frame_hdr* eh_frame_hdr_;
+  Output_file* of_;
+  Task_token* input_sections_blocker_;
+  Task_token* sort_blocker_;
+};
+
 // This class holds an FDE.
 
 class Fde
@@ -379,6 +404,11 @@ class Eh_frame : public Output_section_data
   set_eh_frame_hdr(Eh_frame_hdr* hdr)
   { this->eh_frame_hdr_ = hdr; }
 
+  // Return the associated Eh_frame_hdr, if any.
+  Eh_frame_hdr*
+  eh_frame_hdr() const
+  { return this->eh_frame_hdr_; }
+
   // Add the input section SHNDX in OBJECT.  SYMBOLS is the contents
   // of the symbol table section (size SYMBOLS_SIZE), SYMBOL_NAMES is
   // the symbol names section (size SYMBOL_NAMES_SIZE).  RELOC_SHNDX
@@ -396,6 +426,26 @@ class Eh_frame : public Output_section_data
 			    unsigned int shndx, unsigned int reloc_shndx,
 			    unsigned int reloc_type);
 
+  // Read the CIEs and FDEs in the input section SHNDX in OBJECT
+  // without adding them.  The arguments are as for
+  // add_ehframe_input_section.  This does not refer to any Eh_frame,
+  // so it may be called for different objects in parallel.
+  template<int size, bool big_endian>
+  static Parsed_eh_frame_section*
+  parse_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
+			      const unsigned char* symbols,
+			      section_size_type symbols_size,
+			      const unsigned char* symbol_names,
+			      section_size_type symbol_names_size,
+			      unsigned int shndx, unsigned int reloc_shndx,
+			      unsigned int reloc_type);
+
+  // Add an input section read by parse_ehframe_input_section, merging
+  // its CIEs with those already seen.  This takes ownership of
+  // PARSED.
+  Eh_frame_section_disposition
+  add_parsed_ehframe_input_section(Parsed_eh_frame_section* parsed);
+
   // Add a CIE and an FDE for a PLT section, to permit unwinding
   // through a PLT.  The FDE data should start with 8 bytes of zero,
   // which will be replaced by a 4 byte PC relative reference to the
@@ -444,36 +494,33 @@ class Eh_frame : public Output_section_data
   // A list of unmergeable CIEs.
   typedef std::vector<Cie*> Unmergeable_cie_offsets;
 
-  // A mapping from offsets to CIEs.  This is used while reading an
-  // input section.
-  typedef std::map<uint64_t, Cie*> Offsets_to_cie;
-
-  // A list of CIEs, and a bool indicating whether the CIE is
-  // mergeable.
-  typedef std::vector<std::pair<Cie*, bool> > New_cies;
+  // A mapping from offsets to the index of a CIE in a
+  // Parsed_eh_frame_section.  This is used while reading an input
+  // section.
+  typedef std::map<uint64_t, unsigned int> Offsets_to_cie;
 
   // Skip an LEB128.
   static bool
   skip_leb128(const unsigned char**, const unsigned char*);
 
-  // The implementation of add_ehframe_input_section.
+  // The implementation of parse_ehframe_input_section.
   template<int size, bool big_endian>
-  bool
-  do_add_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
-			       const unsigned char* symbols,
-			       section_size_type symbols_size,
-			       const unsigned char* symbol_names,
-			       section_size_type symbol_names_size,
-			       unsigned int shndx,
-			       unsigned int reloc_shndx,
-			       unsigned int reloc_type,
-			       const unsigned char* pcontents,
-			       section_size_type contents_len,
-			       New_cies*);
+  static bool
+  do_parse_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
+				 const unsigned char* symbols,
+				 section_size_type symbols_size,
+				 const unsigned char* symbol_names,
+				 section_size_type symbol_names_size,
+				 unsigned int shndx,
+				 unsigned int reloc_shndx,
+				 unsigned int reloc_type,
+				 const unsigned char* pcontents,
+				 section_size_type contents_len,
+				 Parsed_eh_frame_section*);
 
   // Read a CIE.
   template<int size, bool big_endian>
-  bool
+  static bool
   read_cie(Sized_relobj_file<size, big_endian>* object,
 	   unsigned int shndx,
 	   const unsigned char* symbols,
@@ -485,11 +532,11 @@ class Eh_frame : public Output_section_data
 	   const unsigned char* pcieend,
 	   Track_relocs<size, big_endian>* relocs,
 	   Offsets_to_cie* cies,
-	   New_cies* new_cies);
+	   Parsed_eh_frame_section* parsed);
 
   // Read an FDE.
   template<int size, bool big_endian>
-  bool
+  static bool
   read_fde(Sized_relobj_file<size, big_endian>* object,
 	   unsigned int shndx,
 	   const unsigned char* symbols,
@@ -499,7 +546,8 @@ class Eh_frame : public Output_section_data
 	   const unsigned char* pfde,
 	   const unsigned char* pfdeend,
 	   Track_relocs<size, big_endian>* relocs,
-	   Offsets_to_cie* cies);
+	   Offsets_to_cie* cies,
+	   Parsed_eh_frame_section* parsed);
 
   // Template version of write function.
   template<int size, bool big_endian>
@@ -521,6 +569,91 @@ class Eh_frame : public Output_section_data
   section_size_type final_data_size_;
 };
 
+// This class holds the CIEs and FDEs read from one input .eh_frame
+// section before they are added to the Eh_frame.  Reading a section
+// only looks at the object which contains it, so when using threads
+// the sections may be read in parallel; the CIEs are then merged with
+// those seen in earlier sections by
+// Eh_frame::add_parsed_ehframe_input_section, which must be called in
+// input order.
+
+class Parsed_eh_frame_section
+{
+ public:
+  Parsed_eh_frame_section(Relobj* object, unsigned int shndx)
+    : object_(object), shndx_(shndx),
+      disposition_(Eh_frame::EH_UNRECOGNIZED_SECTION), cies_(), entries_()
+  { }
+
+  ~Parsed_eh_frame_section();
+
+  // The object which holds the section.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // The section index.
+  unsigned int
+  shndx() const
+  { return this->shndx_; }
+
+ private:
+  friend class Eh_frame;
+
+  // The kinds of entries in the section.
+  enum Entry_kind
+  {
+    // The first copy of a CIE in this section.
+    ENTRY_CIE,
+    // A CIE which is the same as an earlier one in this section.
+    ENTRY_DUPLICATE_CIE,
+    // An FDE.
+    ENTRY_FDE,
+    // An FDE for a function which has been discarded.
+    ENTRY_DISCARDED_FDE
+  };
+
+  // A CIE or FDE in the section, in the order in which they appear.
+  struct Entry
+  {
+    Entry(Entry_kind k, section_offset_type off, section_size_type len,
+	  unsigned int index, Fde* f, unsigned int code)
+      : kind(k), input_offset(off), length(len), cie_index(index), fde(f),
+	code_shndx(code)
+    { }
+
+    Entry_kind kind;
+    // The offset in the input section, and the length including the
+    // length field itself.
+    section_offset_type input_offset;
+    section_size_type length;
+    // The index in cies_ of the CIE, or of the CIE used by the FDE.
+    unsigned int cie_index;
+    // For ENTRY_FDE, the FDE.
+    Fde* fde;
+    // For ENTRY_FDE, the index of the section holding the code which
+    // the FDE describes, if the FDE should be discarded along with
+    // it, or 0.
+    unsigned int code_shndx;
+  };
+
+  // The class is not copyable.
+  Parsed_eh_frame_section(const Parsed_eh_frame_section&);
+  Parsed_eh_frame_section& operator=(const Parsed_eh_frame_section&);
+
+  // The object which holds the section.
+  Relobj* object_;
+  // The section index.
+  unsigned int shndx_;
+  // What to do with the section.
+  Eh_frame::Eh_frame_section_disposition disposition_;
+  // The CIEs in the section, and whether each may be merged with
+  // CIEs in other sections.
+  std::vector<std::pair<Cie*, bool> > cies_;
+  // The CIEs and FDEs in the section.
+  std::vector<Entry> entries_;
+};
+
 } // End namespace gold.
 
 #endif // !defined(GOLD_EHFRAME_H)
@@ -39,6 +39,7 @@
 #include <sys/stat.h>
 #include "filenames.h"
 
+#include "elfcpp.h"
 #include "debug.h"
 #include "parameters.h"
 #include "options.h"
@@ -858,6 +859,168 @@ File_read::print_stats()
 	  program_name, File_read::maximum_mapped_bytes);
 }
 
+// Ask the kernel to start reading SIZE bytes at OFFSET in DESCRIPTOR
+// into the page cache.  This is only a hint, so errors are ignored.
+
+static void
+prefetch_range(int descriptor, off_t offset, off_t size)
+{
+#ifdef HAVE_POSIX_FADVISE
+  if (size > 0)
+    ::posix_fadvise(descriptor, offset, size, POSIX_FADV_WILLNEED);
+#else
+  (void) descriptor;
+  (void) offset;
+  (void) size;
+#endif
+}
+
+// Prefetch the section headers, the section names, the symbol tables
+// and the relocations of the ELF file DESCRIPTOR of size FILE_SIZE,
+// whose ELF header is EHDR_BUF.
+
+template<int size, bool big_endian>
+static void
+prefetch_elf_sections(int descriptor, off_t file_size,
+		      const unsigned char* ehdr_buf)
+{
+  const int shdr_size = elfcpp::Elf_sizes<size>::shdr_size;
+  elfcpp::Ehdr<size, big_endian> ehdr(ehdr_buf);
+  off_t shoff = ehdr.get_e_shoff();
+  if (shoff <= 0
+      || ehdr.get_e_shentsize() != shdr_size
+      || shoff > file_size - shdr_size)
+    return;
+
+  // Handle extended section numbering as Object::read_section_data
+  // does.
+  unsigned char shdr0_buf[shdr_size];
+  if (::pread(descriptor, shdr0_buf, shdr_size, shoff) != shdr_size)
+    return;
+  elfcpp::Shdr<size, big_endian> shdr0(shdr0_buf);
+  off_t shnum = ehdr.get_e_shnum();
+  if (shnum == 0)
+    shnum = shdr0.get_sh_size();
+  unsigned int shstrndx = ehdr.get_e_shstrndx();
+  if (shstrndx == elfcpp::SHN_XINDEX)
+    shstrndx = shdr0.get_sh_link();
+
+  // The section count comes from the file, so check it before using
+  // it to size anything; Read_symbols will report a bad file.
+  if (shnum <= 0 || shnum > (file_size - shoff) / shdr_size)
+    return;
+  off_t shdrs_size = shnum * shdr_size;
+  std::vector<unsigned char> shdrs(shdrs_size);
+  if (::pread(descriptor, &shdrs[0], shdrs_size, shoff) != shdrs_size)
+    return;
+
+  for (off_t i = 0; i < shnum; ++i)
+    {
+      elfcpp::Shdr<size, big_endian> shdr(&shdrs[i * shdr_size]);
+      unsigned int link = shdr.get_sh_link();
+      switch (shdr.get_sh_type())
+	{
+	case elfcpp::SHT_SYMTAB:
+	case elfcpp::SHT_DYNSYM:
+	  // The symbol names.
+	  if (link < shnum)
+	    {
+	      elfcpp::Shdr<size, big_endian> strtab(&shdrs[link * shdr_size]);
+	      prefetch_range(descriptor, strtab.get_sh_offset(),
+			     strtab.get_sh_size());
+	    }
+	  // Fall through.
+	case elfcpp::SHT_SYMTAB_SHNDX:
+	case elfcpp::SHT_REL:
+	case elfcpp::SHT_RELA:
+	  prefetch_range(descriptor, shdr.get_sh_offset(), shdr.get_sh_size());
+	  break;
+	default:
+	  if (i == shstrndx)
+	    prefetch_range(descriptor, shdr.get_sh_offset(),
+			   shdr.get_sh_size());
+	  break;
+	}
+    }
+}
+
+// Prefetch the start of the file NAME.
+
+void
+File_read::prefetch(const std::string& name)
+{
+  int descriptor = open_descriptor(-1, name.c_str(), O_RDONLY);
+  if (descriptor < 0)
+    return;
+
+  // Enough for the ELF header, or for the archive magic string and the
+  // header of the archive symbol table.
+  const int header_size = 68;
+  unsigned char buf[header_size];
+  struct stat statbuf;
+  ssize_t got = 0;
+  if (::fstat(descriptor, &statbuf) == 0 && S_ISREG(statbuf.st_mode))
+    got = ::pread(descriptor, buf, header_size, 0);
+
+  if (got >= elfcpp::Elf_sizes<32>::ehdr_size
+      && buf[elfcpp::EI_MAG0] == elfcpp::ELFMAG0
+      && buf[elfcpp::EI_MAG1] == elfcpp::ELFMAG1
+      && buf[elfcpp::EI_MAG2] == elfcpp::ELFMAG2
+      && buf[elfcpp::EI_MAG3] == elfcpp::ELFMAG3)
+    {
+      int size = buf[elfcpp::EI_CLASS] == elfcpp::ELFCLASS64 ? 64 : 32;
+      bool big_endian = buf[elfcpp::EI_DATA] == elfcpp::ELFDATA2MSB;
+      if (size == 32)
+	{
+	  if (big_endian)
+	    {
+#ifdef HAVE_TARGET_32_BIG
+	      prefetch_elf_sections<32, true>(descriptor, statbuf.st_size, buf);
+#endif
+	    }
+	  else
+	    {
+#ifdef HAVE_TARGET_32_LITTLE
+	      prefetch_elf_sections<32, false>(descriptor, statbuf.st_size,
+					       buf);
+#endif
+	    }
+	}
+      else if (got >= elfcpp::Elf_sizes<64>::ehdr_size)
+	{
+	  if (big_endian)
+	    {
+#ifdef HAVE_TARGET_64_BIG
+	      prefetch_elf_sections<64, true>(descriptor, statbuf.st_size, buf);
+#endif
+	    }
+	  else
+	    {
+#ifdef HAVE_TARGET_64_LITTLE
+	      prefetch_elf_sections<64, false>(descriptor, statbuf.st_size,
+					       buf);
+#endif
+	    }
+	}
+    }
+  else if (got == header_size
+	   && memcmp(buf, "!<arch>\n", 8) == 0
+	   && buf[8] == '/'
+	   && (buf[9] == ' ' || memcmp(buf + 9, "SYM64/", 6) == 0))
+    {
+      // A regular archive whose first member is the archive symbol
+      // table.  The member size is a decimal string in the ar_size
+      // field of the archive header, at offset 48 of the header.
+      char size_string[11];
+      memcpy(size_string, buf + 8 + 48, 10);
+      size_string[10] = '\0';
+      off_t armap_size = strtol(size_string, NULL, 10);
+      prefetch_range(descriptor, 8, 60 + armap_size);
+    }
+
+  release_descriptor(descriptor, true);
+}
+
 // Class File_view.
 
 File_view::~File_view()
@@ -994,7 +1157,8 @@ bool
 Input_file::find_file(const Dirsearch& dirpath, int* pindex,
 		      const Input_file_argument* input_argument,
 		      bool* is_in_sysroot,
-		      std::string* found_name, std::string* namep)
+		      std::string* found_name, std::string* namep,
+		      bool report_errors)
 {
   std::string name;
 
@@ -1044,9 +1208,10 @@ Input_file::find_file(const Dirsearch& dirpath, int* pindex,
       name = dirpath.find(names, is_in_sysroot, pindex, found_name);
       if (name.empty())
 	{
-	  gold_error(_("cannot find %s%s"),
-		     input_argument->is_lib() ? "-l" : "",
-		     input_argument->name());
+	  if (report_errors)
+	    gold_error(_("cannot find %s%s"),
+		       input_argument->is_lib() ? "-l" : "",
+		       input_argument->name());
 	  return false;
 	}
       *namep = name;
@@ -1069,8 +1234,9 @@ Input_file::find_file(const Dirsearch& dirpath, int* pindex,
 			  is_in_sysroot, &index, found_name);
       if (name.empty())
 	{
-	  gold_error(_("cannot find %s"),
-		     input_argument->name());
+	  if (report_errors)
+	    gold_error(_("cannot find %s"),
+		       input_argument->name());
 	  return false;
 	}
       *namep = name;
@@ -1086,7 +1252,8 @@ Input_file::open(const Dirsearch& dirpath, const Task* task, int* pindex)
 {
   std::string name;
   if (!Input_file::find_file(dirpath, pindex, this->input_argument_,
-			     &this->is_in_sysroot_, &this->found_name_, &name))
+			     &this->is_in_sysroot_, &this->found_name_, &name,
+			     true))
     return false;
 
   // Now that we've figured out where the file lives, try to open it.
@@ -207,6 +207,24 @@ class File_read
   static void
   print_stats();
 
+  // Ask the kernel to start reading the parts of the file NAME which
+  // the linker will need first into the page cache, without waiting
+  // for them.  For an ELF file these are the section headers, the
+  // section names, the symbol tables and the relocations.  For an
+  // archive this is the archive symbol table.  This is used for
+  // --prefetch-inputs.
+  static void
+  prefetch(const std::string& name);
+
+  // Return whether the file contents were provided in memory, in
+  // which case there is no file descriptor to read them from.
+  bool
+  contents_are_in_memory() const
+  {
+    return (this->whole_file_view_ != NULL
+	    && this->whole_file_view_->is_permanent_view());
+  }
+
   // Return the open file descriptor (for plugins).
   int
   descriptor()
@@ -576,12 +594,14 @@ class Input_file
 			std::string filename, std::string* found_name,
 			std::string* namep);
 
-  // Find the actual file.
+  // Find the actual file.  If REPORT_ERRORS is false, don't give an
+  // error if a file which has to be searched for is not found.
   static bool
   find_file(const Dirsearch& dirpath, int* pindex,
 	    const Input_file_argument* input_argument,
 	    bool* is_in_sysroot,
-	    std::string* found_name, std::string* namep);
+	    std::string* found_name, std::string* namep,
+	    bool report_errors);
 
  private:
   Input_file(const Input_file&);
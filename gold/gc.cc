@@ -22,9 +22,15 @@
 
 
 #include "gold.h"
+
+#include <cstdio>
+
 #include "object.h"
 #include "gc.h"
 #include "symtab.h"
+#include "parameters.h"
+#include "gold-threads.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -34,6 +40,7 @@ namespace gold
 void 
 Garbage_collection::do_transitive_closure()
 {
+  this->start_closure_time();
   while (!this->worklist().empty())
     {
       // Add elements from the work list to the referenced list
@@ -62,6 +69,209 @@ Garbage_collection::do_transitive_closure()
         }
     }
   this->worklist_ready();
+  this->stop_closure_time();
+}
+
+// The number of shards of the referenced sections when computing the
+// transitive closure in parallel.
+
+static const unsigned int gc_referenced_shard_count = 64;
+
+// The number of sections given to each Gc_mark_task.  A task which
+// finds more than twice this many sections still to be scanned hands
+// this many of them to a new task, so that idle threads pick them up.
+
+static const unsigned int gc_mark_batch_size = 256;
+
+// This task marks the sections reachable from a list of sections.
+
+class Gc_mark_task : public Task
+{
+ public:
+  Gc_mark_task(Garbage_collection* gc,
+	       Garbage_collection::Worklist_type* worklist,
+	       Task_token* blocker)
+    : gc_(gc), worklist_(worklist), blocker_(blocker)
+  { }
+
+  ~Gc_mark_task()
+  { delete this->worklist_; }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  { this->gc_->mark_reachable_sections(this->worklist_, workqueue,
+				       this->blocker_); }
+
+  std::string
+  get_name() const
+  { return "Gc_mark_task"; }
+
+ private:
+  Garbage_collection* gc_;
+  Garbage_collection::Worklist_type* worklist_;
+  Task_token* blocker_;
+};
+
+// Queue the tasks which compute the transitive closure in parallel.
+// The sections on the work list are marked here, and then divided
+// among the tasks.
+
+void
+Garbage_collection::queue_transitive_closure_tasks(Workqueue* workqueue,
+						   Task_token* blocker)
+{
+  this->start_closure_time();
+
+  gold_assert(this->referenced_shards_.empty());
+  this->referenced_shards_.resize(gc_referenced_shard_count);
+  for (unsigned int i = 0; i < gc_referenced_shard_count; ++i)
+    this->referenced_shards_[i].lock = new Lock();
+
+  std::vector<Worklist_type*> worklists;
+  for (Worklist_type::const_iterator p = this->work_list_.begin();
+       p != this->work_list_.end();
+       ++p)
+    {
+      if (!this->mark_section(*p))
+	continue;
+      if (worklists.empty() || worklists.back()->size() >= gc_mark_batch_size)
+	worklists.push_back(new Worklist_type());
+      worklists.back()->push_back(*p);
+    }
+  Worklist_type().swap(this->work_list_);
+
+  blocker->add_blockers(worklists.size());
+  for (std::vector<Worklist_type*>::const_iterator p = worklists.begin();
+       p != worklists.end();
+       ++p)
+    workqueue->queue(new Gc_mark_task(this, *p, blocker));
+}
+
+// Mark the section ID as referenced.  This may be called by several
+// threads at once.
+
+bool
+Garbage_collection::mark_section(const Section_id& id)
+{
+  Section_id_hash hash;
+  Referenced_shard& shard(this->referenced_shards_[hash(id)
+						   % gc_referenced_shard_count]);
+  Hold_lock hl(*shard.lock);
+  return shard.sections.insert(id).second;
+}
+
+// Mark the sections reachable from those in WORKLIST.  Each section
+// is added to a work list only by the thread which marks it, so each
+// section is scanned once.
+
+void
+Garbage_collection::mark_reachable_sections(Worklist_type* worklist,
+					    Workqueue* workqueue,
+					    Task_token* blocker)
+{
+  while (!worklist->empty())
+    {
+      Section_id entry = worklist->back();
+      worklist->pop_back();
+      // The map is not modified while computing the transitive
+      // closure, so it is safe to look things up in it.
+      Section_ref::const_iterator find_it =
+	this->section_reloc_map_.find(entry);
+      if (find_it == this->section_reloc_map_.end())
+	continue;
+      const Sections_reachable& v(find_it->second);
+      for (Sections_reachable::const_iterator it_v = v.begin();
+	   it_v != v.end();
+	   ++it_v)
+	{
+	  if (this->mark_section(*it_v))
+	    worklist->push_back(*it_v);
+	}
+
+      // Hand the oldest sections on our list to another task.
+      if (worklist->size() >= 2 * gc_mark_batch_size)
+	{
+	  Worklist_type* other =
+	    new Worklist_type(worklist->begin(),
+			      worklist->begin() + gc_mark_batch_size);
+	  worklist->erase(worklist->begin(),
+			  worklist->begin() + gc_mark_batch_size);
+	  workqueue->add_blocker(blocker);
+	  workqueue->queue(new Gc_mark_task(this, other, blocker));
+	}
+    }
+}
+
+// Collect the sections marked by the Gc_mark_tasks into the
+// referenced list.
+
+void
+Garbage_collection::finish_transitive_closure()
+{
+  for (std::vector<Referenced_shard>::iterator p =
+	 this->referenced_shards_.begin();
+       p != this->referenced_shards_.end();
+       ++p)
+    {
+      this->referenced_list_.insert(p->sections.begin(), p->sections.end());
+      delete p->lock;
+    }
+  std::vector<Referenced_shard>().swap(this->referenced_shards_);
+  this->worklist_ready();
+  this->stop_closure_time();
+}
+
+// Record the time at which the transitive closure started.
+
+void
+Garbage_collection::start_closure_time()
+{
+  Timer* timer = parameters->timer();
+  if (timer != NULL)
+    this->closure_time_ = timer->get_elapsed_time();
+}
+
+// Record the time spent computing the transitive closure.
+
+void
+Garbage_collection::stop_closure_time()
+{
+  Timer* timer = parameters->timer();
+  if (timer == NULL)
+    return;
+  Timer::TimeStats now = timer->get_elapsed_time();
+  this->closure_time_.wall = now.wall - this->closure_time_.wall;
+  this->closure_time_.user = now.user - this->closure_time_.user;
+  this->closure_time_.sys = now.sys - this->closure_time_.sys;
+  this->has_closure_time_ = true;
+}
+
+// Print statistics about the transitive closure.
+
+void
+Garbage_collection::print_stats() const
+{
+  if (!this->has_closure_time_)
+    return;
+  const Timer::TimeStats& elapsed(this->closure_time_);
+  fprintf(stderr,
+	  _("%s: gc transitive closure run time: " \
+	    "(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
+	  program_name,
+	  elapsed.user / 1000, (elapsed.user % 1000) * 1000,
+	  elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
+	  elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
+  fprintf(stderr, _("%s: gc referenced sections: %llu\n"),
+	  program_name,
+	  static_cast<unsigned long long>(this->referenced_list_.size()));
 }
 
 } // End namespace gold.
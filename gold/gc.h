@@ -29,6 +29,7 @@
 #include "symtab.h"
 #include "object.h"
 #include "icf.h"
+#include "timer.h"
 
 namespace gold
 {
@@ -41,6 +42,9 @@ class Sized_relobj_file;
 class Output_section;
 class General_options;
 class Layout;
+class Workqueue;
+class Task_token;
+class Lock;
 
 class Garbage_collection
 {
@@ -55,7 +59,7 @@ class Garbage_collection
   typedef std::map<std::string, Sections_reachable> Cident_section_map;
 
   Garbage_collection()
-  : is_worklist_ready_(false)
+  : is_worklist_ready_(false), referenced_shards_(), has_closure_time_(false)
   { }
 
   // Accessor methods for the private members.
@@ -83,6 +87,29 @@ class Garbage_collection
   void
   do_transitive_closure();
 
+  // Queue the tasks which compute the transitive closure of all
+  // referenced sections in parallel, starting from the work list.
+  // BLOCKER is blocked until they are all complete, after which
+  // finish_transitive_closure must be called.
+  void
+  queue_transitive_closure_tasks(Workqueue*, Task_token* blocker);
+
+  // Mark the sections reachable from those in WORKLIST, which have
+  // already been marked.  This is called by the tasks queued by
+  // queue_transitive_closure_tasks, and may queue more of them.
+  void
+  mark_reachable_sections(Worklist_type* worklist, Workqueue*,
+			  Task_token* blocker);
+
+  // Collect the sections marked by the tasks queued by
+  // queue_transitive_closure_tasks.
+  void
+  finish_transitive_closure();
+
+  // Print statistics about the transitive closure for --stats.
+  void
+  print_stats() const;
+
   bool
   is_section_garbage(Relobj* obj, unsigned int shndx)
   { return (this->referenced_list().find(Section_id(obj, shndx))
@@ -110,12 +137,41 @@ class Garbage_collection
   }
 
  private:
+  // While the transitive closure is computed in parallel, the
+  // referenced sections are split by hash code into shards, each of
+  // which has its own lock.
+  struct Referenced_shard
+  {
+    Lock* lock;
+    Sections_reachable sections;
+  };
+
+  // Mark the section ID as referenced when computing the transitive
+  // closure in parallel.  Return false if it was already marked.
+  bool
+  mark_section(const Section_id& id);
+
+  // Record the time at which the transitive closure started.
+  void
+  start_closure_time();
+
+  // Record the time spent computing the transitive closure.
+  void
+  stop_closure_time();
 
   Worklist_type work_list_;
   bool is_worklist_ready_;
   Section_ref section_reloc_map_;
   Sections_reachable referenced_list_;
   Cident_section_map cident_sections_;
+  // The referenced sections while computing the transitive closure
+  // in parallel.
+  std::vector<Referenced_shard> referenced_shards_;
+  // Whether closure_time_ is valid, for --stats.
+  bool has_closure_time_;
+  // The time spent computing the transitive closure, for --stats.
+  // This is the start time until stop_closure_time is called.
+  Timer::TimeStats closure_time_;
 };
 
 // Data to pass between successive invocations of do_layout
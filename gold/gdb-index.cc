@@ -28,6 +28,7 @@
 #include "object.h"
 #include "output.h"
 #include "demangle.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -171,6 +172,256 @@ mapped_index_string_hash(const unsigned char* str)
   return r;
 }
 
+class Gdb_index_info_reader;
+
+// The entries for the .gdb_index section found by scanning the
+// .debug_info and .debug_types sections of a single object.  The
+// compilation and type unit indexes used here are local to the
+// object; Gdb_index::add_entries adjusts them when it adds the
+// entries to the index.  When using threads, the sections of each
+// object are scanned by a separate Gdb_index_scan_task, and the
+// entries are added to the index in input order, so that the
+// contents of the section do not depend on the order in which the
+// tasks run.
+
+class Gdb_index_object_entries
+{
+ public:
+  // A symbol found in a pubnames table or a DIE.
+  struct Symbol_entry
+  {
+    Symbol_entry(int index, const char* n, size_t len, size_t shash,
+		 unsigned int hval, uint8_t f)
+      : cu_index(index), name(n), length(len), string_hash(shash),
+	hashval(hval), flags(f)
+    { }
+    int cu_index;
+    const char* name;
+    size_t length;
+    size_t string_hash;
+    unsigned int hashval;
+    uint8_t flags;
+  };
+
+  Gdb_index_object_entries(Relobj* object)
+    : object_(object), sections_(), symbols_view_(NULL), symbols_size_(0),
+      comp_units_(), type_units_(), ranges_(), symbol_entries_(),
+      names_(), cu_pubname_map_(), cu_pubtype_map_(),
+      pubnames_table_(NULL), pubtypes_table_(NULL), pubnames_mapped_(false),
+      stmt_list_offset_(-1), cu_count_(0), cu_nopubnames_count_(0),
+      tu_count_(0), tu_nopubnames_count_(0)
+  { }
+
+  // The view of the symbols is released by scan_sections, while the
+  // object is locked.
+  ~Gdb_index_object_entries()
+  {
+    delete this->pubnames_table_;
+    delete this->pubtypes_table_;
+  }
+
+  // Return the object.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // Record a .debug_info or .debug_types section to scan later.
+  // SYMBOLS_VIEW is a lasting view of the symbol table, which we take
+  // over; it is only passed with the first section of an object.
+  void
+  add_section(bool is_type_unit, File_view* symbols_view,
+	      off_t symbols_size, unsigned int shndx,
+	      unsigned int reloc_shndx, unsigned int reloc_type);
+
+  // Scan the sections recorded by add_section.
+  void
+  scan_sections();
+
+  // Scan a .debug_info or .debug_types section.
+  void
+  scan_section(bool is_type_unit, const unsigned char* symbols,
+	       off_t symbols_size, unsigned int shndx,
+	       unsigned int reloc_shndx, unsigned int reloc_type);
+
+  // Add a compilation unit.
+  int
+  add_comp_unit(off_t cu_offset, off_t cu_length)
+  {
+    this->comp_units_.push_back(Gdb_index::Comp_unit(cu_offset, cu_length));
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a type unit.
+  int
+  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  {
+    this->type_units_.push_back(Gdb_index::Type_unit(tu_offset, type_offset,
+						     signature));
+    return this->type_units_.size() - 1;
+  }
+
+  // Add an address range.
+  void
+  add_address_range_list(unsigned int cu_index, Dwarf_range_list* ranges)
+  {
+    this->ranges_.push_back(Gdb_index::Per_cu_range_list(this->object_,
+							  cu_index, ranges));
+  }
+
+  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
+  // the high-byte of the cu_index field.
+  void
+  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
+
+  // Return the offset into the pubnames table for the cu at the given
+  // offset.
+  off_t
+  find_pubname_offset(off_t cu_offset);
+
+  // Return the offset into the pubtypes table for the cu at the
+  // given offset.
+  off_t
+  find_pubtype_offset(off_t cu_offset);
+
+  // Return TRUE if we have already processed the pubnames and types
+  // set of the CUs and TUS associated with the statement list at
+  // OFFSET.
+  bool
+  pubnames_read(off_t offset) const
+  { return this->stmt_list_offset_ == offset; }
+
+  // Record that we have already read the pubnames associated with
+  // OFFSET.
+  void
+  set_pubnames_read(off_t offset)
+  { this->stmt_list_offset_ = offset; }
+
+  // Return a pointer to the given table.
+  Dwarf_pubnames_table*
+  pubnames_table()
+  { return this->pubnames_table_; }
+
+  Dwarf_pubnames_table*
+  pubtypes_table()
+  { return this->pubtypes_table_; }
+
+  // Count a compilation or type unit.
+  void
+  count_unit(bool is_type_unit)
+  {
+    if (is_type_unit)
+      ++this->tu_count_;
+    else
+      ++this->cu_count_;
+  }
+
+  // Count a compilation or type unit without pubnames or pubtypes.
+  void
+  count_unit_without_pubnames(bool is_type_unit)
+  {
+    if (is_type_unit)
+      ++this->tu_nopubnames_count_;
+    else
+      ++this->cu_nopubnames_count_;
+  }
+
+  // Accessors used by Gdb_index::add_entries.
+
+  const std::vector<Gdb_index::Comp_unit>&
+  comp_units() const
+  { return this->comp_units_; }
+
+  const std::vector<Gdb_index::Type_unit>&
+  type_units() const
+  { return this->type_units_; }
+
+  const std::vector<Gdb_index::Per_cu_range_list>&
+  ranges() const
+  { return this->ranges_; }
+
+  const std::vector<Symbol_entry>&
+  symbol_entries() const
+  { return this->symbol_entries_; }
+
+  // Add the statistics for this object to the totals, and clear them.
+  void
+  add_stats();
+
+  // Clear the entries once they have been added to the index.  The
+  // state used to read the pubnames sections is kept, as there may
+  // be more sections to scan for this object.
+  void
+  clear_entries();
+
+ private:
+  Gdb_index_object_entries(const Gdb_index_object_entries&);
+  Gdb_index_object_entries& operator=(const Gdb_index_object_entries&);
+
+  // A section recorded by add_section.
+  struct Debug_info_section
+  {
+    Debug_info_section(bool is_tu, unsigned int sec, unsigned int rsec,
+		       unsigned int rtype)
+      : is_type_unit(is_tu), shndx(sec), reloc_shndx(rsec), reloc_type(rtype)
+    { }
+    bool is_type_unit;
+    unsigned int shndx;
+    unsigned int reloc_shndx;
+    unsigned int reloc_type;
+  };
+
+  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
+
+  // Create a map from dies to pubnames.
+  Dwarf_pubnames_table*
+  map_pubtable_to_dies(unsigned int attr,
+		       Gdb_index_info_reader* dwinfo,
+		       const unsigned char* symbols,
+		       off_t symbols_size);
+
+  // Wrapper for map_pubtable_to_dies
+  void
+  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
+				 const unsigned char* symbols,
+				 off_t symbols_size);
+
+  // The object.
+  Relobj* object_;
+  // The sections to scan.
+  std::vector<Debug_info_section> sections_;
+  // A view of the symbol table of the object, if there are sections
+  // to scan.
+  File_view* symbols_view_;
+  off_t symbols_size_;
+  // The list of DWARF compilation units.
+  std::vector<Gdb_index::Comp_unit> comp_units_;
+  // The list of DWARF type units.
+  std::vector<Gdb_index::Type_unit> type_units_;
+  // The list of address ranges.
+  std::vector<Gdb_index::Per_cu_range_list> ranges_;
+  // The list of symbols.
+  std::vector<Symbol_entry> symbol_entries_;
+  // The symbol names; the names found in the DIEs are temporary.
+  Stringpool names_;
+  // Maps from the offset of a cu to the offset of its set in the
+  // pubnames and pubtypes tables.
+  Pubname_offset_map cu_pubname_map_;
+  Pubname_offset_map cu_pubtype_map_;
+  // Tables to store the pubnames section of the object.
+  Dwarf_pubnames_table* pubnames_table_;
+  Dwarf_pubnames_table* pubtypes_table_;
+  // Whether the pubnames tables have been read.
+  bool pubnames_mapped_;
+  // The stmt list offset of the CUs and TUs associated with the last
+  // read pubnames and pubtypes sets.
+  off_t stmt_list_offset_;
+  // Statistics.
+  unsigned int cu_count_;
+  unsigned int cu_nopubnames_count_;
+  unsigned int tu_count_;
+  unsigned int tu_nopubnames_count_;
+};
+
 // A specialization of Dwarf_info_reader, for building the .gdb_index.
 
 class Gdb_index_info_reader : public Dwarf_info_reader
@@ -183,15 +434,20 @@ class Gdb_index_info_reader : public Dwarf_info_reader
 			unsigned int shndx,
 			unsigned int reloc_shndx,
 			unsigned int reloc_type,
-			Gdb_index* gdb_index)
+			Gdb_index_object_entries* entries)
     : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
 			reloc_shndx, reloc_type),
-      gdb_index_(gdb_index), cu_index_(0), cu_language_(0)
+      entries_(entries), cu_index_(0), cu_language_(0)
   { }
 
   ~Gdb_index_info_reader()
   { this->clear_declarations(); }
 
+  // Add to the usage statistics.
+  static void
+  add_stats(unsigned int cu_count, unsigned int cu_nopubnames_count,
+	    unsigned int tu_count, unsigned int tu_nopubnames_count);
+
   // Print usage statistics.
   static void
   print_stats();
@@ -285,8 +541,8 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   void
   clear_declarations();
 
-  // The Gdb_index section.
-  Gdb_index* gdb_index_;
+  // The entries for the object being scanned.
+  Gdb_index_object_entries* entries_;
   // The current CU index (negative for a TU).
   int cu_index_;
   // The language of the current CU or TU.
@@ -321,8 +577,8 @@ void
 Gdb_index_info_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
 					      Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_cu_count;
-  this->cu_index_ = this->gdb_index_->add_comp_unit(cu_offset, cu_length);
+  this->entries_->count_unit(false);
+  this->cu_index_ = this->entries_->add_comp_unit(cu_offset, cu_length);
   this->visit_top_die(root_die);
 }
 
@@ -333,10 +589,10 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 				       off_t type_offset, uint64_t signature,
 				       Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_tu_count;
+  this->entries_->count_unit(true);
   // Use a negative index to flag this as a TU instead of a CU.
-  this->cu_index_ = -1 - this->gdb_index_->add_type_unit(tu_offset, type_offset,
-							 signature);
+  this->cu_index_ = -1 - this->entries_->add_type_unit(tu_offset, type_offset,
+						       signature);
   this->visit_top_die(root_die);
 }
 
@@ -380,10 +636,8 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 			     this->object()->name().c_str());
 		return;
 	      }
-	    if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	      ++Gdb_index_info_reader::dwarf_cu_nopubnames_count;
-	    else
-	      ++Gdb_index_info_reader::dwarf_tu_nopubnames_count;
+	    this->entries_->count_unit_without_pubnames(
+		die->tag() != elfcpp::DW_TAG_compile_unit);
 	    this->visit_children(die, NULL);
 	  }
 	break;
@@ -437,8 +691,8 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	    // If the DIE is not a declaration, add it to the index.
 	    std::string full_name = this->get_qualified_name(die, context);
 	    if (!full_name.empty())
-	      this->gdb_index_->add_symbol(this->cu_index_,
-                                           full_name.c_str(), 0);
+	      this->entries_->add_symbol(this->cu_index_,
+					 full_name.c_str(), 0);
 	  }
 	break;
       case elfcpp::DW_TAG_typedef:
@@ -477,8 +731,8 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	      if (full_name.empty())
 		full_name = this->get_qualified_name(die, context);
 	      if (!full_name.empty())
-		this->gdb_index_->add_symbol(this->cu_index_,
-					     full_name.c_str(), 0);
+		this->entries_->add_symbol(this->cu_index_,
+					   full_name.c_str(), 0);
 	    }
 
 	  // We're interested in the children only for namespaces and
@@ -825,8 +1079,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
     {
       Dwarf_range_list* ranges = this->read_range_list(shndx, ranges_offset);
       if (ranges != NULL)
-	this->gdb_index_->add_address_range_list(this->object(),
-						 this->cu_index_, ranges);
+	this->entries_->add_address_range_list(this->cu_index_, ranges);
       return;
     }
 
@@ -851,8 +1104,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
         {
 	  Dwarf_range_list* ranges = new Dwarf_range_list();
 	  ranges->add(shndx, low_pc, high_pc);
-	  this->gdb_index_->add_address_range_list(this->object(),
-						   this->cu_index_, ranges);
+	  this->entries_->add_address_range_list(this->cu_index_, ranges);
         }
     }
 }
@@ -877,7 +1129,7 @@ Gdb_index_info_reader::read_pubtable(Dwarf_pubnames_table* table, off_t offset)
       if (name == NULL)
         break;
 
-      this->gdb_index_->add_symbol(this->cu_index_, name, flag_byte);
+      this->entries_->add_symbol(this->cu_index_, name, flag_byte);
     }
   return true;
 }
@@ -916,8 +1168,7 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
           // have read. If it does, then no need to read the pubnames.
           // If it doesn't, then the caller will have to parse the
           // dies manually to find the names.
-          return this->gdb_index_->pubnames_read(this->object(),
-                                                 stmt_list_off);
+          return this->entries_->pubnames_read(stmt_list_off);
         }
       else
         {
@@ -928,10 +1179,10 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
 
   // We found the attribute, so we can check if the corresponding
   // pubnames have been read.
-  if (this->gdb_index_->pubnames_read(this->object(), stmt_list_off))
+  if (this->entries_->pubnames_read(stmt_list_off))
     return true;
 
-  this->gdb_index_->set_pubnames_read(this->object(), stmt_list_off);
+  this->entries_->set_pubnames_read(stmt_list_off);
 
   // We have an attribute, and the pubnames haven't been read, so read
   // them.
@@ -939,12 +1190,12 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
   // In some of the cases, we could rely on the previous value of
   // offset here, but sorting out which cases complicates the logic
   // enough that it isn't worth it. So just look up the offset again.
-  offset = this->gdb_index_->find_pubname_offset(this->cu_offset());
-  names = this->read_pubtable(this->gdb_index_->pubnames_table(), offset);
+  offset = this->entries_->find_pubname_offset(this->cu_offset());
+  names = this->read_pubtable(this->entries_->pubnames_table(), offset);
 
   bool types = false;
-  offset = this->gdb_index_->find_pubtype_offset(this->cu_offset());
-  types = this->read_pubtable(this->gdb_index_->pubtypes_table(), offset);
+  offset = this->entries_->find_pubtype_offset(this->cu_offset());
+  types = this->read_pubtable(this->entries_->pubtypes_table(), offset);
   return names || types;
 }
 
@@ -964,6 +1215,20 @@ Gdb_index_info_reader::clear_declarations()
   this->declarations_.clear();
 }
 
+// Add to the usage statistics.
+
+void
+Gdb_index_info_reader::add_stats(unsigned int cu_count,
+				 unsigned int cu_nopubnames_count,
+				 unsigned int tu_count,
+				 unsigned int tu_nopubnames_count)
+{
+  Gdb_index_info_reader::dwarf_cu_count += cu_count;
+  Gdb_index_info_reader::dwarf_cu_nopubnames_count += cu_nopubnames_count;
+  Gdb_index_info_reader::dwarf_tu_count += tu_count;
+  Gdb_index_info_reader::dwarf_tu_nopubnames_count += tu_nopubnames_count;
+}
+
 // Print usage statistics.
 void
 Gdb_index_info_reader::print_stats()
@@ -978,41 +1243,75 @@ Gdb_index_info_reader::print_stats()
           program_name, Gdb_index_info_reader::dwarf_tu_nopubnames_count);
 }
 
-// Class Gdb_index.
+// Class Gdb_index_object_entries.
 
-// Construct the .gdb_index section.
+// Record a .debug_info or .debug_types section to scan later.
 
-Gdb_index::Gdb_index(Output_section* gdb_index_section)
-  : Output_section_data(4),
-    pubnames_table_(NULL),
-    pubtypes_table_(NULL),
-    gdb_index_section_(gdb_index_section),
-    comp_units_(),
-    type_units_(),
-    ranges_(),
-    cu_vector_list_(),
-    cu_vector_offsets_(NULL),
-    stringpool_(),
-    tu_offset_(0),
-    addr_offset_(0),
-    symtab_offset_(0),
-    cu_pool_offset_(0),
-    stringpool_offset_(0),
-    pubnames_object_(NULL),
-    stmt_list_offset_(-1)
+void
+Gdb_index_object_entries::add_section(bool is_type_unit,
+				      File_view* symbols_view,
+				      off_t symbols_size,
+				      unsigned int shndx,
+				      unsigned int reloc_shndx,
+				      unsigned int reloc_type)
 {
-  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+  if (symbols_view != NULL)
+    {
+      gold_assert(this->symbols_view_ == NULL);
+      this->symbols_view_ = symbols_view;
+    }
+  if (this->sections_.empty())
+    this->symbols_size_ = symbols_size;
+  else
+    gold_assert(symbols_size == this->symbols_size_);
+  this->sections_.push_back(Debug_info_section(is_type_unit, shndx,
+					       reloc_shndx, reloc_type));
 }
 
-Gdb_index::~Gdb_index()
+// Scan the sections recorded by add_section.  The object must be
+// locked by the caller.
+
+void
+Gdb_index_object_entries::scan_sections()
 {
-  // Free the memory used by the symbol table.
-  delete this->gdb_symtab_;
-  // Free the memory used by the CU vectors.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
-    delete this->cu_vector_list_[i];
+  const unsigned char* symbols = (this->symbols_view_ != NULL
+				  ? this->symbols_view_->data()
+				  : NULL);
+  for (std::vector<Debug_info_section>::const_iterator p =
+	 this->sections_.begin();
+       p != this->sections_.end();
+       ++p)
+    this->scan_section(p->is_type_unit, symbols, this->symbols_size_,
+		       p->shndx, p->reloc_shndx, p->reloc_type);
+
+  // We no longer need the symbols or the pubnames tables.
+  this->sections_.clear();
+  delete this->symbols_view_;
+  this->symbols_view_ = NULL;
+  delete this->pubnames_table_;
+  this->pubnames_table_ = NULL;
+  delete this->pubtypes_table_;
+  this->pubtypes_table_ = NULL;
 }
 
+// Scan a .debug_info or .debug_types section.
+
+void
+Gdb_index_object_entries::scan_section(bool is_type_unit,
+				       const unsigned char* symbols,
+				       off_t symbols_size,
+				       unsigned int shndx,
+				       unsigned int reloc_shndx,
+				       unsigned int reloc_type)
+{
+  Gdb_index_info_reader dwinfo(is_type_unit, this->object_,
+			       symbols, symbols_size,
+			       shndx, reloc_shndx,
+			       reloc_type, this);
+  if (!this->pubnames_mapped_)
+    this->map_pubnames_and_types_to_dies(&dwinfo, symbols, symbols_size);
+  dwinfo.parse();
+}
 
 // Scan the pubnames and pubtypes sections and build a map of the
 // various cus and tus they refer to, so we can process the entries
@@ -1020,11 +1319,10 @@ Gdb_index::~Gdb_index()
 // Return the just-read table so it can be cached.
 
 Dwarf_pubnames_table*
-Gdb_index::map_pubtable_to_dies(unsigned int attr,
-                                Gdb_index_info_reader* dwinfo,
-                                Relobj* object,
-                                const unsigned char* symbols,
-                                off_t symbols_size)
+Gdb_index_object_entries::map_pubtable_to_dies(unsigned int attr,
+					       Gdb_index_info_reader* dwinfo,
+					       const unsigned char* symbols,
+					       off_t symbols_size)
 {
   uint64_t section_offset = 0;
   Dwarf_pubnames_table* table;
@@ -1042,7 +1340,7 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
     }
 
   map->clear();
-  if (!table->read_section(object, symbols, symbols_size))
+  if (!table->read_section(this->object_, symbols, symbols_size))
     return NULL;
 
   while (table->read_header(section_offset))
@@ -1057,30 +1355,29 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
 // Wrapper for map_pubtable_to_dies
 
 void
-Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                          Relobj* object,
-                                          const unsigned char* symbols,
-                                          off_t symbols_size)
+Gdb_index_object_entries::map_pubnames_and_types_to_dies(
+    Gdb_index_info_reader* dwinfo,
+    const unsigned char* symbols,
+    off_t symbols_size)
 {
-  // This is a new object, so reset the relevant variables.
-  this->pubnames_object_ = object;
+  this->pubnames_mapped_ = true;
   this->stmt_list_offset_ = -1;
 
   delete this->pubnames_table_;
   this->pubnames_table_
       = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubnames, dwinfo,
-                                   object, symbols, symbols_size);
+                                   symbols, symbols_size);
   delete this->pubtypes_table_;
   this->pubtypes_table_
       = this->map_pubtable_to_dies(elfcpp::DW_AT_GNU_pubtypes, dwinfo,
-                                   object, symbols, symbols_size);
+                                   symbols, symbols_size);
 }
 
 // Given a cu_offset, find the associated section of the pubnames
 // table.
 
 off_t
-Gdb_index::find_pubname_offset(off_t cu_offset)
+Gdb_index_object_entries::find_pubname_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
   if (it != this->cu_pubname_map_.end())
@@ -1092,7 +1389,7 @@ Gdb_index::find_pubname_offset(off_t cu_offset)
 // table.
 
 off_t
-Gdb_index::find_pubtype_offset(off_t cu_offset)
+Gdb_index_object_entries::find_pubtype_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
   if (it != this->cu_pubtype_map_.end())
@@ -1100,36 +1397,297 @@ Gdb_index::find_pubtype_offset(off_t cu_offset)
   return -1;
 }
 
+// Add a symbol.  We compute both hash codes here, so that this work
+// is done by the scanning task rather than while adding the entries
+// to the index.
+
+void
+Gdb_index_object_entries::add_symbol(int cu_index, const char* sym_name,
+				     uint8_t flags)
+{
+  size_t len = strlen(sym_name);
+  size_t hash_code = string_hash<char>(sym_name, len);
+  const char* name = this->names_.add_with_length_and_hash(sym_name, len,
+							  hash_code,
+							  true, NULL);
+  unsigned int hashval = mapped_index_string_hash(
+      reinterpret_cast<const unsigned char*>(name));
+  this->symbol_entries_.push_back(Symbol_entry(cu_index, name, len,
+					       hash_code, hashval, flags));
+}
+
+// Add the statistics for this object to the totals.
+
+void
+Gdb_index_object_entries::add_stats()
+{
+  Gdb_index_info_reader::add_stats(this->cu_count_,
+				   this->cu_nopubnames_count_,
+				   this->tu_count_,
+				   this->tu_nopubnames_count_);
+  this->cu_count_ = 0;
+  this->cu_nopubnames_count_ = 0;
+  this->tu_count_ = 0;
+  this->tu_nopubnames_count_ = 0;
+}
+
+// Clear the entries once they have been added to the index.
+
+void
+Gdb_index_object_entries::clear_entries()
+{
+  this->comp_units_.clear();
+  this->type_units_.clear();
+  this->ranges_.clear();
+  this->symbol_entries_.clear();
+  this->names_.clear();
+}
+
+// A task which scans the .debug_info and .debug_types sections of a
+// single object.
+
+class Gdb_index_scan_task : public Task
+{
+ public:
+  Gdb_index_scan_task(Gdb_index_object_entries* entries, Task_token* blocker)
+    : entries_(entries), blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->entries_->object()->is_locked())
+      return this->entries_->object()->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    tl->add(this, this->entries_->object()->token());
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->entries_->scan_sections();
+    this->entries_->object()->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_scan_task " + this->entries_->object()->name(); }
+
+ private:
+  Gdb_index_object_entries* entries_;
+  Task_token* blocker_;
+};
+
+// A task which adds the entries found by the Gdb_index_scan_task
+// tasks to the index, once they have all run.
+
+class Gdb_index_add_entries_task : public Task
+{
+ public:
+  Gdb_index_add_entries_task(Gdb_index* gdb_index, Task_token* this_blocker,
+			     Task_token* next_blocker)
+    : gdb_index_(gdb_index), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Gdb_index_add_entries_task()
+  { delete this->this_blocker_; }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->gdb_index_->add_object_entries(); }
+
+  std::string
+  get_name() const
+  { return "Gdb_index_add_entries_task"; }
+
+ private:
+  Gdb_index* gdb_index_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
+// Class Gdb_index.
+
+// Construct the .gdb_index section.
+
+Gdb_index::Gdb_index(Output_section* gdb_index_section)
+  : Output_section_data(4),
+    gdb_index_section_(gdb_index_section),
+    comp_units_(),
+    type_units_(),
+    ranges_(),
+    cu_vector_list_(),
+    cu_vector_offsets_(NULL),
+    stringpool_(),
+    tu_offset_(0),
+    addr_offset_(0),
+    symtab_offset_(0),
+    cu_pool_offset_(0),
+    stringpool_offset_(0),
+    object_entries_()
+{
+  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+}
+
+Gdb_index::~Gdb_index()
+{
+  // Free the memory used by the symbol table.
+  delete this->gdb_symtab_;
+  // Free the memory used by the CU vectors.
+  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+    delete this->cu_vector_list_[i];
+  for (unsigned int i = 0; i < this->object_entries_.size(); ++i)
+    delete this->object_entries_[i];
+}
+
 // Scan a .debug_info or .debug_types input section.
 
 void
 Gdb_index::scan_debug_info(bool is_type_unit,
 			   Relobj* object,
 			   const unsigned char* symbols,
+			   File_view* symbols_view,
 			   off_t symbols_size,
 			   unsigned int shndx,
 			   unsigned int reloc_shndx,
 			   unsigned int reloc_type)
 {
-  Gdb_index_info_reader dwinfo(is_type_unit, object,
-			       symbols, symbols_size,
-			       shndx, reloc_shndx,
-			       reloc_type, this);
-  if (object != this->pubnames_object_)
-    map_pubnames_and_types_to_dies(&dwinfo, object, symbols, symbols_size);
-  dwinfo.parse();
+  Gdb_index_object_entries* entries;
+  if (!this->object_entries_.empty()
+      && this->object_entries_.back()->object() == object)
+    entries = this->object_entries_.back();
+  else
+    {
+      // When not using threads, the entries of the previous object
+      // have already been added to the index.
+      if (!parameters->options().threads()
+	  && !this->object_entries_.empty())
+	{
+	  delete this->object_entries_.back();
+	  this->object_entries_.pop_back();
+	}
+      entries = new Gdb_index_object_entries(object);
+      this->object_entries_.push_back(entries);
+    }
+
+  if (parameters->options().threads())
+    entries->add_section(is_type_unit, symbols_view, symbols_size, shndx,
+			 reloc_shndx, reloc_type);
+  else
+    {
+      entries->scan_section(is_type_unit, symbols, symbols_size, shndx,
+			    reloc_shndx, reloc_type);
+      this->add_entries(entries);
+    }
+}
+
+// Queue a task to scan the sections of each object, and a task to
+// add the entries to the index when they are done.
+
+void
+Gdb_index::queue_scan_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  if (this->object_entries_.empty())
+    return;
+
+  Task_token* scan_blocker = new Task_token(true);
+  scan_blocker->add_blockers(this->object_entries_.size());
+  for (unsigned int i = 0; i < this->object_entries_.size(); ++i)
+    workqueue->queue(new Gdb_index_scan_task(this->object_entries_[i],
+					     scan_blocker));
+
+  workqueue->add_blocker(blocker);
+  workqueue->queue(new Gdb_index_add_entries_task(this, scan_blocker,
+						  blocker));
+}
+
+// Add the entries of each object to the index.  This is done in
+// input order so that the layout of the hash table and of the string
+// pool does not depend on the order in which the objects were
+// scanned.
+
+void
+Gdb_index::add_object_entries()
+{
+  for (unsigned int i = 0; i < this->object_entries_.size(); ++i)
+    {
+      this->add_entries(this->object_entries_[i]);
+      delete this->object_entries_[i];
+    }
+  this->object_entries_.clear();
+}
+
+// Add the entries found in one object to the index.  The CU and TU
+// indexes in the entries are local to the object.
+
+void
+Gdb_index::add_entries(Gdb_index_object_entries* entries)
+{
+  int cu_base = this->comp_units_.size();
+  int tu_base = this->type_units_.size();
+
+  this->comp_units_.insert(this->comp_units_.end(),
+			   entries->comp_units().begin(),
+			   entries->comp_units().end());
+  this->type_units_.insert(this->type_units_.end(),
+			   entries->type_units().begin(),
+			   entries->type_units().end());
+
+  for (std::vector<Per_cu_range_list>::const_iterator p =
+	 entries->ranges().begin();
+       p != entries->ranges().end();
+       ++p)
+    {
+      int cu_index = static_cast<int>(p->cu_index);
+      cu_index = cu_index < 0 ? cu_index - tu_base : cu_index + cu_base;
+      this->ranges_.push_back(Per_cu_range_list(p->object, cu_index,
+						p->ranges));
+    }
+
+  typedef std::vector<Gdb_index_object_entries::Symbol_entry> Symbol_entries;
+  for (Symbol_entries::const_iterator p = entries->symbol_entries().begin();
+       p != entries->symbol_entries().end();
+       ++p)
+    {
+      int cu_index = p->cu_index < 0 ? p->cu_index - tu_base
+				     : p->cu_index + cu_base;
+      this->add_symbol(cu_index, p->name, p->length, p->string_hash,
+		       p->hashval, p->flags);
+    }
+
+  entries->add_stats();
+  entries->clear_entries();
 }
 
 // Add a symbol.
 
 void
-Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+Gdb_index::add_symbol(int cu_index, const char* sym_name, size_t sym_len,
+		      size_t string_hash, unsigned int hashval, uint8_t flags)
 {
-  unsigned int hash = mapped_index_string_hash(
-      reinterpret_cast<const unsigned char*>(sym_name));
   Gdb_symbol* sym = new Gdb_symbol();
-  this->stringpool_.add(sym_name, true, &sym->name_key);
-  sym->hashval = hash;
+  this->stringpool_.add_with_length_and_hash(sym_name, sym_len, string_hash,
+					     true, &sym->name_key);
+  sym->hashval = hashval;
   sym->cu_vector_index = 0;
 
   Gdb_symbol* found = this->gdb_symtab_->add(sym);
@@ -1156,32 +1714,16 @@ Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
     cu_vec->push_back(std::make_pair(cu_index, flags));
 }
 
-// Return TRUE if we have already processed the pubnames associated
-// with the statement list at the given OFFSET.
-
-bool
-Gdb_index::pubnames_read(const Relobj* object, off_t offset)
-{
-  bool ret = (this->pubnames_object_ == object
-	      && this->stmt_list_offset_ == offset);
-  return ret;
-}
-
-// Record that we have processed the pubnames associated with the
-// statement list for OBJECT at the given OFFSET.
-
-void
-Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
-{
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = offset;
-}
-
 // Set the size of the .gdb_index section.
 
 void
 Gdb_index::set_final_data_size()
 {
+  // All the entries have been added to the index by now.
+  for (unsigned int i = 0; i < this->object_entries_.size(); ++i)
+    delete this->object_entries_[i];
+  this->object_entries_.clear();
+
   // Finalize the string pool.
   this->stringpool_.set_string_offsets();
 
@@ -42,8 +42,10 @@ class Sized_relobj;
 class Dwarf_range_list;
 template <typename T>
 class Gdb_hashtab;
-class Gdb_index_info_reader;
-class Dwarf_pubnames_table;
+class Gdb_index_object_entries;
+class Workqueue;
+class Task_token;
+class File_view;
 
 // This class manages the .gdb_index section, which is a fast
 // lookup table for DWARF information used by the gdb debugger.
@@ -52,77 +54,66 @@ class Dwarf_pubnames_table;
 class Gdb_index : public Output_section_data
 {
  public:
+  // An entry in the compilation unit list.
+  struct Comp_unit
+  {
+    Comp_unit(off_t off, off_t len)
+      : cu_offset(off), cu_length(len)
+    { }
+    uint64_t cu_offset;
+    uint64_t cu_length;
+  };
+
+  // An entry in the type unit list.
+  struct Type_unit
+  {
+    Type_unit(off_t off, off_t toff, uint64_t sig)
+      : tu_offset(off), type_offset(toff), type_signature(sig)
+    { }
+    uint64_t tu_offset;
+    uint64_t type_offset;
+    uint64_t type_signature;
+  };
+
+  // An entry in the address range list.
+  struct Per_cu_range_list
+  {
+    Per_cu_range_list(Relobj* obj, uint32_t index, Dwarf_range_list* r)
+      : object(obj), cu_index(index), ranges(r)
+    { }
+    Relobj* object;
+    uint32_t cu_index;
+    Dwarf_range_list* ranges;
+  };
+
   Gdb_index(Output_section* gdb_index_section);
 
   ~Gdb_index();
 
-  // Scan a .debug_info or .debug_types input section.
+  // Scan a .debug_info or .debug_types input section.  When using
+  // threads, the section is only recorded here, and is scanned later
+  // by the tasks queued by queue_scan_tasks, using SYMBOLS_VIEW, a
+  // lasting view of the symbols which we take over.  It is passed
+  // with the first section of each object.
   void scan_debug_info(bool is_type_unit,
 		       Relobj* object,
 		       const unsigned char* symbols,
+		       File_view* symbols_view,
 		       off_t symbols_size,
 		       unsigned int shndx,
 		       unsigned int reloc_shndx,
 		       unsigned int reloc_type);
 
-  // Add a compilation unit.
-  int
-  add_comp_unit(off_t cu_offset, off_t cu_length)
-  {
-    this->comp_units_.push_back(Comp_unit(cu_offset, cu_length));
-    return this->comp_units_.size() - 1;
-  }
-
-  // Add a type unit.
-  int
-  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
-  {
-    this->type_units_.push_back(Type_unit(tu_offset, type_offset, signature));
-    return this->type_units_.size() - 1;
-  }
-
-  // Add an address range.
+  // Queue the tasks which scan the recorded sections of each object,
+  // and the task which adds the results to the index.  BLOCKER is
+  // blocked until they are all complete.
   void
-  add_address_range_list(Relobj* object, unsigned int cu_index,
-			 Dwarf_range_list* ranges)
-  {
-    this->ranges_.push_back(Per_cu_range_list(object, cu_index, ranges));
-  }
+  queue_scan_tasks(Workqueue*, Task_token* blocker);
 
-  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
-  // the high-byte of the cu_index field.
+  // Add the entries found by scanning the sections of each object to
+  // the index, in input order.
   void
-  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
-
-  // Return the offset into the pubnames table for the cu at the given
-  // offset.
-  off_t
-  find_pubname_offset(off_t cu_offset);
-
-  // Return the offset into the pubtypes table for the cu at the
-  // given offset.
-  off_t
-  find_pubtype_offset(off_t cu_offset);
-
-  // Return TRUE if we have already processed the pubnames and types
-  // set for OBJECT of the CUs and TUS associated with the statement
-  // list at OFFSET.
-  bool
-  pubnames_read(const Relobj* object, off_t offset);
-
-  // Record that we have already read the pubnames associated with
-  // OBJECT and OFFSET.
-  void
-  set_pubnames_read(const Relobj* object, off_t offset);
-
-  // Return a pointer to the given table.
-  Dwarf_pubnames_table*
-  pubnames_table()
-  { return pubnames_table_; }
-
-  Dwarf_pubnames_table*
-  pubtypes_table()
-  { return pubtypes_table_; }
+  add_object_entries();
 
   // Print usage statistics.
   static void
@@ -148,54 +139,7 @@ class Gdb_index : public Output_section_data
   do_print_to_mapfile(Mapfile* mapfile) const
   { mapfile->print_output_data(this, _("** gdb_index")); }
 
-  // Create a map from dies to pubnames.
-  Dwarf_pubnames_table*
-  map_pubtable_to_dies(unsigned int attr,
-                       Gdb_index_info_reader* dwinfo,
-                       Relobj* object,
-                       const unsigned char* symbols,
-                       off_t symbols_size);
-
-  // Wrapper for map_pubtable_to_dies
-  void
-  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                 Relobj* object,
-                                 const unsigned char* symbols,
-                                 off_t symbols_size);
-
  private:
-  // An entry in the compilation unit list.
-  struct Comp_unit
-  {
-    Comp_unit(off_t off, off_t len)
-      : cu_offset(off), cu_length(len)
-    { }
-    uint64_t cu_offset;
-    uint64_t cu_length;
-  };
-
-  // An entry in the type unit list.
-  struct Type_unit
-  {
-    Type_unit(off_t off, off_t toff, uint64_t sig)
-      : tu_offset(off), type_offset(toff), type_signature(sig)
-    { }
-    uint64_t tu_offset;
-    uint64_t type_offset;
-    uint64_t type_signature;
-  };
-
-  // An entry in the address range list.
-  struct Per_cu_range_list
-  {
-    Per_cu_range_list(Relobj* obj, uint32_t index, Dwarf_range_list* r)
-      : object(obj), cu_index(index), ranges(r)
-    { }
-    Relobj* object;
-    uint32_t cu_index;
-    Dwarf_range_list* ranges;
-  };
-
   // A symbol table entry.
   struct Gdb_symbol
   {
@@ -216,20 +160,17 @@ class Gdb_index : public Output_section_data
 
   typedef std::vector<std::pair<int, uint8_t> > Cu_vector;
 
-  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
-  Pubname_offset_map cu_pubname_map_;
-  Pubname_offset_map cu_pubtype_map_;
-
-  // Scan the given pubtable and build a map of the various dies it
-  // refers to, so we can process the entries when we encounter the
-  // die.
+  // Add the entries found in one object to the index.
   void
-  map_pubtable_to_dies(Dwarf_pubnames_table* table,
-                       Pubname_offset_map* map);
+  add_entries(Gdb_index_object_entries*);
 
-  // Tables to store the pubnames section of the current object.
-  Dwarf_pubnames_table* pubnames_table_;
-  Dwarf_pubnames_table* pubtypes_table_;
+  // Add a symbol.  STRING_HASH is the hash code of the name used by
+  // the string pool, and HASHVAL is the hash code used by gdb.  FLAGS
+  // are the gdb_index version 7 flags to be stored in the high-byte
+  // of the cu_index field.
+  void
+  add_symbol(int cu_index, const char* sym_name, size_t sym_len,
+	     size_t string_hash, unsigned int hashval, uint8_t flags);
 
   // The .gdb_index section.
   Output_section* gdb_index_section_;
@@ -253,10 +194,8 @@ class Gdb_index : public Output_section_data
   off_t symtab_offset_;
   off_t cu_pool_offset_;
   off_t stringpool_offset_;
-  // Object, stmt list offset of the CUs and TUs associated with the
-  // last read pubnames and pubtypes sections.
-  const Relobj* pubnames_object_;
-  off_t stmt_list_offset_;
+  // The entries for each object with debug info, in input order.
+  std::vector<Gdb_index_object_entries*> object_entries_;
 };
 
 } // End namespace gold.
@@ -39,10 +39,13 @@
 #include "common.h"
 #include "object.h"
 #include "layout.h"
+#include "merge.h"
 #include "reloc.h"
 #include "defstd.h"
 #include "plugin.h"
 #include "gc.h"
+#include "compressed_output.h"
+#include "ehframe.h"
 #include "icf.h"
 #include "incremental.h"
 #include "timer.h"
@@ -59,6 +62,16 @@ process_incremental_input(Incremental_binary*, unsigned int, Input_objects*,
 			  Symbol_table*, Layout*, Dirsearch*, Mapfile*,
 			  Task_token*, Task_token*);
 
+static void
+queue_middle_icf_tasks(const General_options&, const Task*,
+		       const Input_objects*, Symbol_table*, Layout*,
+		       Workqueue*, Mapfile*);
+
+static void
+queue_middle_layout_tasks(const General_options&, const Task*,
+			  const Input_objects*, Symbol_table*, Layout*,
+			  Workqueue*, Mapfile*);
+
 void
 gold_exit(Exit_status status)
 {
@@ -134,6 +147,77 @@ Middle_runner::run(Workqueue* workqueue, const Task* task)
 		     this->layout_, workqueue, this->mapfile_);
 }
 
+// This class arranges to finish the transitive closure of referenced
+// sections for --gc-sections, once it has been computed by multiple
+// threads, and then to queue the rest of the middle tasks.
+
+class Gc_closure_runner : public Task_function_runner
+{
+ public:
+  Gc_closure_runner(const General_options& options,
+		    const Input_objects* input_objects,
+		    Symbol_table* symtab,
+		    Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Gc_closure_runner::run(Workqueue* workqueue, const Task* task)
+{
+  this->symtab_->gc()->finish_transitive_closure();
+  queue_middle_icf_tasks(this->options_, task, this->input_objects_,
+			 this->symtab_, this->layout_, workqueue,
+			 this->mapfile_);
+}
+
+// This class arranges to find the identical sections for --icf, once
+// their contents have been computed by multiple threads, and then to
+// queue the rest of the middle tasks.
+
+class Icf_runner : public Task_function_runner
+{
+ public:
+  Icf_runner(const General_options& options,
+	     const Input_objects* input_objects,
+	     Symbol_table* symtab,
+	     Layout* layout, Mapfile* mapfile)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Mapfile* mapfile_;
+};
+
+void
+Icf_runner::run(Workqueue* workqueue, const Task* task)
+{
+  this->symtab_->icf()->find_identical_sections(this->input_objects_,
+						this->symtab_);
+  queue_middle_layout_tasks(this->options_, task, this->input_objects_,
+			    this->symtab_, this->layout_, workqueue,
+			    this->mapfile_);
+}
+
 // This class arranges the tasks to process the relocs for garbage collection.
 
 class Gc_runner : public Task_function_runner
@@ -230,6 +314,11 @@ queue_initial_tasks(const General_options& options,
   Task_token* this_blocker = NULL;
   if (ibase == NULL)
     {
+      // With --prefetch-inputs, start reading the input files before
+      // the Read_symbols tasks need them.
+      if (options.prefetch_inputs())
+	workqueue->queue(new Prefetch_inputs(&cmdline, &search_path));
+
       // Normal link.  Queue a Read_symbols task for each input file
       // on the command line.
       for (Command_line::const_iterator p = cmdline.begin();
@@ -397,10 +486,10 @@ process_incremental_input(Incremental_binary* ibase,
 							  input_file_index,
 							  input_type,
 							  input_reader);
-	      return new Add_symbols(input_objects, symtab, layout,
-				     search_path, 0, mapfile, input_argument,
-				     obj, lib, NULL, this_blocker,
-				     next_blocker);
+	      return new Read_incremental_symbols(input_objects, symtab,
+						  layout, input_argument,
+						  obj, lib, this_blocker,
+						  next_blocker);
 	    }
 	}
     }
@@ -422,9 +511,16 @@ process_incremental_input(Incremental_binary* ibase,
 						  input_file_index,
 						  input_type,
 						  input_reader);
-      return new Add_symbols(input_objects, symtab, layout, search_path, 0,
-			     mapfile, input_argument, obj, NULL, NULL,
-			     this_blocker, next_blocker);
+      // The symbols of an unchanged shared library are read as they
+      // are added; those of an unchanged object are read first, in
+      // parallel with the other input files.
+      if (input_type == INCREMENTAL_INPUT_SHARED_LIBRARY)
+	return new Add_symbols(input_objects, symtab, layout, search_path, 0,
+			       mapfile, input_argument, obj, NULL, NULL,
+			       this_blocker, next_blocker);
+      return new Read_incremental_symbols(input_objects, symtab, layout,
+					  input_argument, obj, NULL,
+					  this_blocker, next_blocker);
     }
 }
 
@@ -513,18 +609,82 @@ queue_middle_tasks(const General_options& options,
       // Symbols named with -u should not be considered garbage.
       symtab->gc_mark_undef_symbols(layout);
       gold_assert(symtab->gc() != NULL);
+      if (parameters->options().threads())
+	{
+	  // Do the transitive closure on all references in parallel.
+	  // Gc_closure_runner then queues the rest of the middle tasks.
+	  Task_token* blocker = new Task_token(true);
+	  symtab->gc()->queue_transitive_closure_tasks(workqueue, blocker);
+	  workqueue->queue(new Task_function(
+			     new Gc_closure_runner(options, input_objects,
+						   symtab, layout, mapfile),
+			     blocker,
+			     "Task_function Gc_closure_runner"));
+	  return;
+	}
       // Do a transitive closure on all references to determine the worklist.
       symtab->gc()->do_transitive_closure();
     }
 
+  queue_middle_icf_tasks(options, task, input_objects, symtab, layout,
+			 workqueue, mapfile);
+}
+
+// Queue up the middle tasks which follow garbage collection.  This is
+// called by queue_middle_tasks, or by Gc_closure_runner once the
+// referenced sections have been found.
+
+static void
+queue_middle_icf_tasks(const General_options& options,
+		       const Task* task,
+		       const Input_objects* input_objects,
+		       Symbol_table* symtab,
+		       Layout* layout,
+		       Workqueue* workqueue,
+		       Mapfile* mapfile)
+{
   // If identical code folding (--icf) is chosen it makes sense to do it
   // only after garbage collection (--gc-sections) as we do not want to
   // be folding sections that will be garbage.
   if (parameters->options().icf_enabled())
     {
+      if (parameters->options().threads())
+	{
+	  // Compute the contents of the sections that might be folded
+	  // in parallel.  Icf_runner then finds the identical sections
+	  // and queues the rest of the middle tasks.
+	  Task_token* blocker = new Task_token(true);
+	  symtab->icf()->queue_section_contents_tasks(input_objects, symtab,
+						      workqueue, blocker);
+	  workqueue->queue(new Task_function(new Icf_runner(options,
+							    input_objects,
+							    symtab,
+							    layout,
+							    mapfile),
+					     blocker,
+					     "Task_function Icf_runner"));
+	  return;
+	}
       symtab->icf()->find_identical_sections(input_objects, symtab);
     }
 
+  queue_middle_layout_tasks(options, task, input_objects, symtab, layout,
+			    workqueue, mapfile);
+}
+
+// Queue up the rest of the middle set of tasks.  This is called by
+// queue_middle_icf_tasks, or by Icf_runner once the identical sections
+// have been found.
+
+static void
+queue_middle_layout_tasks(const General_options& options,
+			  const Task* task,
+			  const Input_objects* input_objects,
+			  Symbol_table* symtab,
+			  Layout* layout,
+			  Workqueue* workqueue,
+			  Mapfile* mapfile)
+{
   // Call Object::layout for the second time to determine the
   // output_sections for all referenced input sections.  When
   // --gc-sections or --icf is turned on, or when certain input
@@ -710,6 +870,19 @@ queue_middle_tasks(const General_options& options,
 						 this_blocker));
     }
 
+  // Merge the strings in SHF_MERGE|SHF_STRINGS sections in parallel,
+  // while the relocations are being read.  The Scan_relocs tasks, and
+  // therefore the layout task, wait for the merge to complete.
+  if (parameters->options().threads()
+      && parameters->options().merge_string_shards() > 1)
+    {
+      Task_token* next_blocker = new Task_token(true);
+      next_blocker->add_blocker();
+      workqueue->queue(new Merge_strings_task(layout, this_blocker,
+					      next_blocker));
+      this_blocker = next_blocker;
+    }
+
   // If doing garbage collection, the relocations have already been read.
   // Otherwise, read and scan the relocations.
   if (parameters->options().gc_sections()
@@ -771,6 +944,12 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
+  // When using threads, scan the debug info for the .gdb_index
+  // section in parallel with the relocations.  The layout task waits
+  // for the index to be complete.
+  if (parameters->options().threads())
+    layout->queue_gdb_index_tasks(workqueue, this_blocker);
+
   // When all those tasks are complete, we can start laying out the
   // output file.
   workqueue->queue(new Task_function(new Layout_task_runner(options,
@@ -805,6 +984,11 @@ queue_final_tasks(const General_options& options,
 
   bool any_postprocessing_sections = layout->any_postprocessing_sections();
 
+  // When using threads, start computing a sha1 or md5 build ID while
+  // the sections which depend on the input sections are written.
+  bool hash_build_id_prefix = (parameters->options().threads()
+			       && layout->has_build_id_file_hash());
+
   // Use a blocker to wait until all the input sections have been
   // written out.
   Task_token* input_sections_blocker = NULL;
@@ -827,7 +1011,7 @@ queue_final_tasks(const General_options& options,
   // Relocate_tasks.
   final_blocker->add_blockers(3);
   final_blocker->add_blockers(input_objects->number_of_relobjs());
-  if (!any_postprocessing_sections)
+  if (!any_postprocessing_sections && !hash_build_id_prefix)
     final_blocker->add_blocker();
 
   // Queue a task to write out the symbol table.
@@ -857,14 +1041,42 @@ queue_final_tasks(const General_options& options,
 				       output_sections_blocker,
 				       final_blocker));
 
+  // When using threads, find and sort the FDE addresses for the
+  // .eh_frame_hdr section in parallel before it is written.
+  Eh_frame_hdr* eh_frame_hdr = NULL;
+  if (parameters->options().threads())
+    eh_frame_hdr = layout->eh_frame_hdr();
+
   // Queue a task to write out the output sections which depend on
   // input sections.  If there are any sections which require
   // postprocessing, then we need to do this last, since it may resize
   // the output file.
   if (!any_postprocessing_sections)
     {
+      if (hash_build_id_prefix)
+	{
+	  // Hash the start of the file once everything but the
+	  // sections written by Write_after_input_sections_task is
+	  // done, while that task runs.
+	  Task_token* new_final_blocker = new Task_token(true);
+	  new_final_blocker->add_blockers(2);
+	  workqueue->queue(new Build_id_hash_task(layout, of, final_blocker,
+						  new_final_blocker));
+	  final_blocker = new_final_blocker;
+	}
+
+      Task_token* after_input_blocker = input_sections_blocker;
+      if (eh_frame_hdr != NULL)
+	{
+	  after_input_blocker = new Task_token(true);
+	  after_input_blocker->add_blocker();
+	  workqueue->queue(new Eh_frame_hdr_sort_task(eh_frame_hdr, of,
+						      input_sections_blocker,
+						      after_input_blocker));
+	}
+
       Task* t = new Write_after_input_sections_task(layout, of,
-						    input_sections_blocker,
+						    after_input_blocker,
 						    final_blocker);
       workqueue->queue(t);
     }
@@ -872,6 +1084,41 @@ queue_final_tasks(const General_options& options,
     {
       Task_token* new_final_blocker = new Task_token(true);
       new_final_blocker->add_blocker();
+
+      // When using threads, compress the debug sections in parallel
+      // before their final sizes are set, and hash the start of the
+      // file for the build ID and sort the .eh_frame_hdr table at the
+      // same time.  All must be done before
+      // Write_after_input_sections_task resizes the file.
+      Task_token* after_input_blocker = NULL;
+      if (parameters->options().threads()
+	  && !layout->compressed_sections().empty())
+	{
+	  after_input_blocker = new Task_token(true);
+	  after_input_blocker->add_blocker();
+	  workqueue->queue(new Compress_sections_task(layout, final_blocker,
+						      after_input_blocker));
+	}
+      if (hash_build_id_prefix)
+	{
+	  if (after_input_blocker == NULL)
+	    after_input_blocker = new Task_token(true);
+	  after_input_blocker->add_blocker();
+	  workqueue->queue(new Build_id_hash_task(layout, of, final_blocker,
+						  after_input_blocker));
+	}
+      if (eh_frame_hdr != NULL)
+	{
+	  if (after_input_blocker == NULL)
+	    after_input_blocker = new Task_token(true);
+	  after_input_blocker->add_blocker();
+	  workqueue->queue(new Eh_frame_hdr_sort_task(eh_frame_hdr, of,
+						      final_blocker,
+						      after_input_blocker));
+	}
+      if (after_input_blocker != NULL)
+	final_blocker = after_input_blocker;
+
       Task* t = new Write_after_input_sections_task(layout, of,
 						    final_blocker,
 						    new_final_blocker);
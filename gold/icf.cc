@@ -147,6 +147,7 @@
 #include "demangle.h"
 #include "elfcpp.h"
 #include "int_encoding.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -155,51 +156,35 @@ namespace gold
 // sections has unique contents.  Such unique sections or groups can be
 // declared final and need not be processed any further.
 // Parameters :
-// ID_SECTION : Vector mapping a section index to a Section_id pair.
+// FIRST_ITERATION : true if this is being called before the first
+//                   iteration of icf, in which case the checksum of
+//                   the section's text alone is used.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
+// SECTION_CONTENTS : Contains the checksums of the section's text and of
+//                    the section's text and relocs to sections that
+//                    cannot be folded.
 
 static void
-preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
+preprocess_for_unique_sections(bool first_iteration,
                                std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+                               const Icf::Section_contents_list&
+                                 section_contents)
 {
   Unordered_map<uint32_t, unsigned int> uniq_map;
   std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
     uniq_map_insert;
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < section_contents.size(); i++)
     {
       if ((*is_secn_or_group_unique)[i])
         continue;
 
       uint32_t cksum;
-      Section_id secn = id_section[i];
-      section_size_type plen;
-      if (section_contents == NULL)
-        {
-          // Lock the object so we can read from it.  This is only called
-          // single-threaded from queue_middle_tasks, so it is OK to lock.
-          // Unfortunately we have no way to pass in a Task token.
-          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-          Task_lock_obj<Object> tl(dummy_task, secn.first);
-          const unsigned char* contents;
-          contents = secn.first->section_contents(secn.second,
-                                                  &plen,
-                                                  false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
-        }
+      if (first_iteration)
+        cksum = section_contents[i].contents_cksum;
       else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
+        cksum = section_contents[i].fixed_cksum;
       uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
       if (uniq_map_insert.second)
         {
@@ -252,57 +237,64 @@ get_rel_addend(const unsigned char* reloc_addend_ptr,
     }
 }
 
-// This returns the buffer containing the section's contents, both
-// text and relocs.  Relocs are differentiated as those pointing to
-// sections that could be folded and those that cannot.  Only relocs
-// pointing to sections that could be folded are recomputed on
-// subsequent invocations of this function.
+// This computes the part of a section's contents, both text and
+// relocs, that does not change between iterations.  Relocs are
+// differentiated as those pointing to sections that could be folded
+// and those that cannot.  Relocs pointing to sections that could be
+// folded are only recorded here; get_tracked_contents turns them into
+// contents using the current kept sections.  The object containing
+// the section must be locked.
 // Parameters  :
-// FIRST_ITERATION    : true if it is the first invocation.
 // SECN               : Section for which contents are desired.
-// SECTION_NUM        : Unique section number of this section.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
-// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
+// MAY_READ_OTHER_OBJECTS : false if the contents of other objects,
+//                          which may be locked by other tasks, must
+//                          not be read.  In that case this returns
+//                          false, doing nothing, if they are needed.
 // SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
 //                      sections.
 
-static std::string
-get_section_contents(bool first_iteration,
-                     const Section_id& secn,
-                     unsigned int section_num,
-                     unsigned int* num_tracked_relocs,
-                     Symbol_table* symtab,
-                     const std::vector<unsigned int>& kept_section_id,
-                     std::vector<std::string>* section_contents)
+static bool
+get_fixed_section_contents(const Section_id& secn,
+                           Symbol_table* symtab,
+                           bool may_read_other_objects,
+                           Icf::Section_contents* section_contents)
 {
-  // Lock the object so we can read from it.  This is only called
-  // single-threaded from queue_middle_tasks, so it is OK to lock.
-  // Unfortunately we have no way to pass in a Task token.
-  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-  Task_lock_obj<Object> tl(dummy_task, secn.first);
+  Icf::Reloc_info_list& reloc_info_list =
+    symtab->icf()->reloc_info_list();
+
+  Icf::Reloc_info_list::iterator it_reloc_info_list =
+    reloc_info_list.find(secn);
+
+  // The contents of merge sections pointed to by relocs are hashed
+  // below.  Those may be in other objects.
+  if (!may_read_other_objects
+      && it_reloc_info_list != reloc_info_list.end()
+      && parameters->target().can_icf_inline_merge_sections())
+    {
+      const Icf::Sections_reachable_info &v =
+        (it_reloc_info_list->second).section_info;
+      for (Icf::Sections_reachable_info::const_iterator it_v = v.begin();
+           it_v != v.end();
+           ++it_v)
+        {
+          if (it_v->first != NULL
+              && it_v->first != secn.first
+              && ((it_v->first->section_flags(it_v->second)
+                   & elfcpp::SHF_MERGE) != 0))
+            return false;
+        }
+    }
 
   section_size_type plen;
-  const unsigned char* contents = NULL;
-  if (first_iteration)
-    contents = secn.first->section_contents(secn.second, &plen, false);
+  const unsigned char* contents;
+  contents = secn.first->section_contents(secn.second, &plen, false);
 
   // The buffer to hold all the contents including relocs.  A checksum
   // is then computed on this buffer.
   std::string buffer;
-  std::string icf_reloc_buffer;
-
-  if (num_tracked_relocs)
-    *num_tracked_relocs = 0;
-
-  Icf::Reloc_info_list& reloc_info_list = 
-    symtab->icf()->reloc_info_list();
 
-  Icf::Reloc_info_list::iterator it_reloc_info_list =
-    reloc_info_list.find(secn);
-
-  buffer.clear();
-  icf_reloc_buffer.clear();
+  section_contents->tracked_secns.clear();
+  section_contents->tracked_addends.clear();
 
   // Process relocs and put them into the buffer.
 
@@ -327,8 +319,7 @@ get_section_contents(bool first_iteration,
 
       for (; it_v != v.end(); ++it_v, ++it_s, ++it_a, ++it_o, ++it_addend_size)
         {
-	  if (first_iteration
-	      && it_v->first != NULL)
+	  if (it_v->first != NULL)
 	    {
 	      Symbol_location loc;
 	      loc.object = it_v->first;
@@ -364,15 +355,12 @@ get_section_contents(bool first_iteration,
 	  // object is NULL.
 	  if (it_v->first == NULL)
             {
-	      if (first_iteration)
-                {
-		  // If the symbol name is available, use it.
-                  if ((*it_s) != NULL)
-                      buffer.append((*it_s)->name());
-                  // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
-		}
+	      // If the symbol name is available, use it.
+	      if ((*it_s) != NULL)
+		  buffer.append((*it_s)->name());
+	      // Append the addend.
+	      buffer.append(addend_str);
+	      buffer.append("@");
 	      continue;
 	    }
 
@@ -383,12 +371,9 @@ get_section_contents(bool first_iteration,
           if (reloc_secn.first == secn.first
               && reloc_secn.second == secn.second)
             {
-              if (first_iteration)
-                {
-                  buffer.append("R");
-                  buffer.append(addend_str);
-                  buffer.append("@");
-                }
+	      buffer.append("R");
+	      buffer.append(addend_str);
+	      buffer.append("@");
               continue;
             }
           Icf::Uniq_secn_id_map& section_id_map =
@@ -403,30 +388,16 @@ get_section_contents(bool first_iteration,
               && section_id_map_it != section_id_map.end())
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
-
-              char kept_section_str[10];
-              unsigned int secn_id = section_id_map_it->second;
-              snprintf(kept_section_str, sizeof(kept_section_str), "%u",
-                       kept_section_id[secn_id]);
-              if (first_iteration)
-                {
-                  buffer.append("ICF_R");
-                  buffer.append(addend_str);
-                }
-              icf_reloc_buffer.append(kept_section_str);
-              // Append the addend.
-              icf_reloc_buffer.append(addend_str);
-              icf_reloc_buffer.append("@");
+              // Record it for get_tracked_contents.
+              section_contents->tracked_secns.push_back(
+                section_id_map_it->second);
+              section_contents->tracked_addends.push_back(addend_str);
+	      buffer.append("ICF_R");
+	      buffer.append(addend_str);
             }
           else
             {
               // This is a reloc to a section that cannot be folded.
-              // Process it only in the first iteration.
-              if (!first_iteration)
-                continue;
-
               uint64_t secn_flags = (it_v->first)->section_flags(it_v->second);
               // This reloc points to a merge section.  Hash the
               // contents of this section.
@@ -541,23 +512,94 @@ get_section_contents(bool first_iteration,
         }
     }
 
-  if (first_iteration)
+  buffer.append("Contents = ");
+  buffer.append(reinterpret_cast<const char*>(contents), plen);
+
+  section_contents->contents_cksum = xcrc32(contents, plen, 0xffffffff);
+  section_contents->fixed_contents.swap(buffer);
+  section_contents->fixed_cksum =
+    xcrc32(reinterpret_cast<const unsigned char*>(
+             section_contents->fixed_contents.data()),
+           section_contents->fixed_contents.length(), 0xffffffff);
+  return true;
+}
+
+// This computes the part of a section's contents that depends on which
+// sections are folded, from the relocs recorded by
+// get_fixed_section_contents, and returns the checksum of all the
+// section's contents.  After the first iteration, this is only
+// recomputed if the kept section of one of the sections pointed to by
+// the relocs has changed.
+// Parameters  :
+// FIRST_ITERATION    : true if it is the first invocation.
+// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
+// SECTION_CONTENTS   : The section's contents.
+
+static uint32_t
+get_tracked_contents(bool first_iteration,
+                     const std::vector<unsigned int>& kept_section_id,
+                     Icf::Section_contents* section_contents)
+{
+  const std::vector<unsigned int>& secns = section_contents->tracked_secns;
+  std::vector<unsigned int>* kept_secns =
+    &section_contents->tracked_kept_secns;
+
+  if (!first_iteration)
     {
-      buffer.append("Contents = ");
-      buffer.append(reinterpret_cast<const char*>(contents), plen);
-      // Store the section contents that dont change to avoid recomputing
-      // during the next call to this function.
-      (*section_contents)[section_num] = buffer;
+      unsigned int i;
+      for (i = 0; i < secns.size(); ++i)
+        if (kept_section_id[secns[i]] != (*kept_secns)[i])
+          break;
+      if (i == secns.size())
+        return section_contents->cksum;
     }
-  else
+
+  std::string* buffer = &section_contents->tracked_contents;
+  buffer->clear();
+  kept_secns->resize(secns.size());
+  for (unsigned int i = 0; i < secns.size(); ++i)
     {
-      gold_assert(buffer.empty());
-      // Reuse the contents computed in the previous iteration.
-      buffer.append((*section_contents)[section_num]);
+      unsigned int kept_section = kept_section_id[secns[i]];
+      (*kept_secns)[i] = kept_section;
+      char kept_section_str[10];
+      snprintf(kept_section_str, sizeof(kept_section_str), "%u",
+               kept_section);
+      buffer->append(kept_section_str);
+      // Append the addend.
+      buffer->append(section_contents->tracked_addends[i]);
+      buffer->append("@");
     }
 
-  buffer.append(icf_reloc_buffer);
-  return buffer;
+  // CRC32 can be continued from the checksum of the fixed contents.
+  section_contents->cksum =
+    xcrc32(reinterpret_cast<const unsigned char*>(buffer->data()),
+           buffer->length(), section_contents->fixed_cksum);
+  return section_contents->cksum;
+}
+
+// This returns whether two sections have the same contents, which are
+// their fixed contents followed by their tracked contents.
+
+static bool
+section_contents_equal(const Icf::Section_contents& a,
+                       const Icf::Section_contents& b)
+{
+  const std::string& a1 = a.fixed_contents;
+  const std::string& a2 = a.tracked_contents;
+  const std::string& b1 = b.fixed_contents;
+  const std::string& b2 = b.tracked_contents;
+
+  if (a1.length() + a2.length() != b1.length() + b2.length())
+    return false;
+  if (a1.length() > b1.length())
+    return section_contents_equal(b, a);
+
+  // The tracked contents of A start within the fixed contents of B.
+  size_t len = a1.length();
+  size_t overlap = b1.length() - len;
+  return (a1.compare(0, len, b1, 0, len) == 0
+          && a2.compare(0, overlap, b1, len, overlap) == 0
+          && a2.compare(overlap, std::string::npos, b2) == 0);
 }
 
 // This function computes a checksum on each section to detect and form
@@ -575,86 +617,57 @@ get_section_contents(bool first_iteration,
 //
 // Parameters  :
 // ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
-// ID_SECTION         : Vector mapping a section to an unique integer.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
+// SECTION_CONTENTS   : The contents of each section.
 
 static bool
 match_sections(unsigned int iteration_num,
-               Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
                std::vector<unsigned int>* kept_section_id,
-               const std::vector<Section_id>& id_section,
                std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+               Icf::Section_contents_list* section_contents)
 {
   Unordered_multimap<uint32_t, unsigned int> section_cksum;
   std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
             Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
   bool converged = true;
 
-  if (iteration_num == 1)
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   NULL);
-  else
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   section_contents);
-
-  std::vector<std::string> full_section_contents;
+  preprocess_for_unique_sections(iteration_num == 1,
+                                 is_secn_or_group_unique,
+                                 *section_contents);
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < section_contents->size(); i++)
     {
-      full_section_contents.push_back("");
+      Icf::Section_contents* this_secn_contents = &(*section_contents)[i];
       if ((*is_secn_or_group_unique)[i])
-        continue;
-
-      Section_id secn = id_section[i];
-      std::string this_secn_contents;
-      uint32_t cksum;
-      if (iteration_num == 1)
         {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, secn, i, &num_relocs,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
-          (*num_tracked_relocs)[i] = num_relocs;
+          // The contents of unique sections are not needed again.
+          std::string().swap(this_secn_contents->fixed_contents);
+          continue;
         }
-      else
+
+      if (iteration_num != 1 && (*kept_section_id)[i] != i)
         {
-          if ((*kept_section_id)[i] != i)
+          // This section is already folded into something.  See
+          // if it should point to a different kept section.
+          unsigned int kept_section = (*kept_section_id)[i];
+          if (kept_section != (*kept_section_id)[kept_section])
             {
-              // This section is already folded into something.  See
-              // if it should point to a different kept section.
-              unsigned int kept_section = (*kept_section_id)[i];
-              if (kept_section != (*kept_section_id)[kept_section])
-                {
-                  (*kept_section_id)[i] = (*kept_section_id)[kept_section];
-                }
-              continue;
+              (*kept_section_id)[i] = (*kept_section_id)[kept_section];
             }
-          this_secn_contents = get_section_contents(false, secn, i, NULL,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
+          continue;
         }
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
+      uint32_t cksum = get_tracked_contents(iteration_num == 1,
+                                            *kept_section_id,
+                                            this_secn_contents);
       size_t count = section_cksum.count(cksum);
 
       if (count == 0)
         {
           // Start a group with this cksum.
           section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
         }
       else
         {
@@ -664,12 +677,8 @@ match_sections(unsigned int iteration_num,
           for (it = key_range.first; it != key_range.second; ++it)
             {
               unsigned int kept_section = it->second;
-              if (full_section_contents[kept_section].length()
-                  != this_secn_contents.length())
-                  continue;
-              if (memcmp(full_section_contents[kept_section].c_str(),
-                         this_secn_contents.c_str(),
-                         this_secn_contents.length()) != 0)
+              if (!section_contents_equal((*section_contents)[kept_section],
+                                          *this_secn_contents))
                   continue;
               (*kept_section_id)[i] = kept_section;
               converged = false;
@@ -679,12 +688,11 @@ match_sections(unsigned int iteration_num,
             {
               // Create a new group for this cksum.
               section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
             }
         }
       // If there are no relocs to foldable sections do not process
       // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
+      if (iteration_num == 1 && this_secn_contents->tracked_secns.empty())
         (*is_secn_or_group_unique)[i] = true;
     }
 
@@ -709,22 +717,78 @@ is_function_ctor_or_dtor(const std::string& section_name)
   return false;
 }
 
-// This is the main ICF function called in gold.cc.  This does the
-// initialization and calls match_sections repeatedly (twice by default)
-// which computes the crc checksums and detects identical functions.
+// Returns the index just past the run of sections in ID_SECTION,
+// starting at FIRST, which are all in the same object.
+
+static unsigned int
+object_sections_end(const std::vector<Section_id>& id_section,
+                    unsigned int first)
+{
+  unsigned int last = first + 1;
+  while (last < id_section.size()
+         && id_section[last].first == id_section[first].first)
+    ++last;
+  return last;
+}
+
+// This task computes the contents of the sections in one object that
+// might be folded.
+
+class Icf_section_contents_task : public Task
+{
+ public:
+  Icf_section_contents_task(Symbol_table* symtab, Relobj* object,
+                            unsigned int first, unsigned int last,
+                            Task_token* blocker)
+    : symtab_(symtab), object_(object), first_(first), last_(last),
+      blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->object_->is_locked())
+      return this->object_->token();
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    tl->add(this, this->object_->token());
+    tl->add(this, this->blocker_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    this->symtab_->icf()->compute_section_contents(this->symtab_,
+                                                   this->first_, this->last_,
+                                                   false);
+    this->object_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Icf_section_contents_task " + this->object_->name(); }
+
+ private:
+  Symbol_table* symtab_;
+  Relobj* object_;
+  unsigned int first_;
+  unsigned int last_;
+  Task_token* blocker_;
+};
+
+// Decide which sections are possible candidates for folding.
 
 void
-Icf::find_identical_sections(const Input_objects* input_objects,
-                             Symbol_table* symtab)
+Icf::select_candidate_sections(const Input_objects* input_objects,
+                               Symbol_table* symtab)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
-  std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
 
-  // Decide which sections are possible candidates first.
-
   for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
        p != input_objects->relobj_end();
        ++p)
@@ -758,12 +822,90 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
-          is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
+          this->section_contents_.push_back(Section_contents());
           section_num++;
         }
     }
+}
+
+// Queue an Icf_section_contents_task for each object with sections
+// that might be folded.  This is used when running with threads.
+
+void
+Icf::queue_section_contents_tasks(const Input_objects* input_objects,
+                                  Symbol_table* symtab,
+                                  Workqueue* workqueue,
+                                  Task_token* blocker)
+{
+  this->select_candidate_sections(input_objects, symtab);
+
+  std::vector<std::pair<unsigned int, unsigned int> > ranges;
+  for (unsigned int first = 0;
+       first < this->id_section_.size();
+       first = ranges.back().second)
+    ranges.push_back(std::make_pair(first,
+                                    object_sections_end(this->id_section_,
+                                                        first)));
+
+  blocker->add_blockers(ranges.size());
+  for (unsigned int i = 0; i < ranges.size(); ++i)
+    workqueue->queue(new Icf_section_contents_task(
+                       symtab, this->id_section_[ranges[i].first].first,
+                       ranges[i].first, ranges[i].second, blocker));
+}
+
+// Compute the contents of the sections numbered FIRST up to LAST.
+
+void
+Icf::compute_section_contents(Symbol_table* symtab, unsigned int first,
+                              unsigned int last, bool may_read_other_objects)
+{
+  for (unsigned int i = first; i < last; ++i)
+    {
+      Section_contents* section_contents = &this->section_contents_[i];
+      if (!section_contents->is_computed)
+        section_contents->is_computed =
+          get_fixed_section_contents(this->id_section_[i], symtab,
+                                     may_read_other_objects,
+                                     section_contents);
+    }
+}
+
+// This is the main ICF function called in gold.cc.  This does the
+// initialization and calls match_sections repeatedly (twice by default)
+// which computes the crc checksums and detects identical functions.
+
+void
+Icf::find_identical_sections(const Input_objects* input_objects,
+                             Symbol_table* symtab)
+{
+  // Decide which sections are possible candidates first, unless
+  // queue_section_contents_tasks has already done so.
+  if (this->id_section_.empty())
+    this->select_candidate_sections(input_objects, symtab);
+
+  // Compute the contents of the sections which were not computed by
+  // an Icf_section_contents_task.
+  for (unsigned int first = 0, last;
+       first < this->id_section_.size();
+       first = last)
+    {
+      last = object_sections_end(this->id_section_, first);
+      unsigned int i = first;
+      while (i < last && this->section_contents_[i].is_computed)
+        ++i;
+      if (i == last)
+        continue;
+
+      // Lock the object so we can read from it.  This is only called
+      // single-threaded from queue_middle_tasks, so it is OK to lock.
+      // Unfortunately we have no way to pass in a Task token.
+      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+      Task_lock_obj<Object> tl(dummy_task, this->id_section_[first].first);
+      this->compute_section_contents(symtab, i, last, true);
+    }
+
+  std::vector<bool> is_secn_or_group_unique(this->id_section_.size(), false);
 
   unsigned int num_iterations = 0;
 
@@ -777,12 +919,13 @@ Icf::find_identical_sections(const Input_objects* input_objects,
   while (!converged && (num_iterations < max_iterations))
     {
       num_iterations++;
-      converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
-                                 this->id_section_, &is_secn_or_group_unique,
-                                 &section_contents);
+      converged = match_sections(num_iterations, &this->kept_section_id_,
+                                 &is_secn_or_group_unique,
+                                 &this->section_contents_);
     }
 
+  Section_contents_list().swap(this->section_contents_);
+
   if (parameters->options().print_icf_sections())
     {
       if (converged)
@@ -35,6 +35,8 @@ namespace gold
 class Object;
 class Input_objects;
 class Symbol_table;
+class Workqueue;
+class Task_token;
 
 class Icf
 {
@@ -64,9 +66,36 @@ class Icf
   typedef Unordered_map<Section_id, Reloc_info,
                         Section_id_hash> Reloc_info_list;
 
+  struct Section_contents
+  {
+    // The checksum of the section's text alone.
+    uint32_t contents_cksum;
+    // The section's text and relocs to sections that cannot be
+    // folded.  This does not change between iterations.
+    std::string fixed_contents;
+    // The checksum of FIXED_CONTENTS.
+    uint32_t fixed_cksum;
+    // The section number and stringified addend of each reloc to a
+    // section that might be folded.
+    std::vector<unsigned int> tracked_secns;
+    std::vector<std::string> tracked_addends;
+    // The kept sections of TRACKED_SECNS when TRACKED_CONTENTS was
+    // last computed.
+    std::vector<unsigned int> tracked_kept_secns;
+    // The relocs to sections that might be folded, using the kept
+    // sections in TRACKED_KEPT_SECNS.
+    std::string tracked_contents;
+    // The checksum of FIXED_CONTENTS followed by TRACKED_CONTENTS.
+    uint32_t cksum;
+    // Whether FIXED_CONTENTS has been computed.
+    bool is_computed;
+  };
+
+  typedef std::vector<Section_contents> Section_contents_list;
+
   Icf()
   : id_section_(), section_id_(), kept_section_id_(),
-    fptr_section_id_(),
+    section_contents_(), fptr_section_id_(),
     icf_ready_(false),
     reloc_info_list_()
   { }
@@ -82,6 +111,23 @@ class Icf
   find_identical_sections(const Input_objects* input_objects,
                           Symbol_table* symtab);
 
+  // Queue tasks to compute the contents of the sections that might
+  // be folded, one task per object.  Each task holds BLOCKER.
+  // find_identical_sections should be called once they have run.
+  void
+  queue_section_contents_tasks(const Input_objects* input_objects,
+                               Symbol_table* symtab,
+                               Workqueue* workqueue,
+                               Task_token* blocker);
+
+  // Compute the contents of the sections numbered FIRST up to LAST,
+  // which must all be in one object, which must be locked.  If
+  // MAY_READ_OTHER_OBJECTS is false, skip sections whose contents
+  // depend on the contents of other objects.
+  void
+  compute_section_contents(Symbol_table* symtab, unsigned int first,
+                           unsigned int last, bool may_read_other_objects);
+
   // This is set when ICF has been run and the groups of
   // identical sections have been formed.
   void
@@ -143,6 +189,10 @@ class Icf
   { return this->section_id_; }
 
  private:
+  // Decide which sections are candidates for folding.
+  void
+  select_candidate_sections(const Input_objects* input_objects,
+                            Symbol_table* symtab);
 
   // Maps integers to sections.
   std::vector<Section_id> id_section_;
@@ -152,6 +202,10 @@ class Icf
   // section.  If the id's are the same then this section is
   // not folded.
   std::vector<unsigned int> kept_section_id_;
+  // Given a section id, this holds the contents used to decide
+  // whether it is identical to other sections.  This is only used
+  // while finding identical sections.
+  Section_contents_list section_contents_;
   // Given a section id, this says if the pointer to this
   // function is taken in which case it is dangerous to fold
   // this function.
@@ -732,13 +732,15 @@ void
 Sized_incremental_binary<size, big_endian>::do_apply_incremental_relocs(
     const Symbol_table* symtab,
     Layout* layout,
-    Output_file* of)
+    Output_file* of,
+    unsigned int first,
+    unsigned int last)
 {
   typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
   typedef typename elfcpp::Elf_types<size>::Elf_Swxword Addend;
   Incremental_symtab_reader<big_endian> isymtab(this->symtab_reader());
   Incremental_relocs_reader<size, big_endian> irelocs(this->relocs_reader());
-  unsigned int nglobals = isymtab.symbol_count();
+  gold_assert(first <= last && last <= isymtab.symbol_count());
   const unsigned int incr_reloc_size = irelocs.reloc_size;
 
   Relocate_info<size, big_endian> relinfo;
@@ -753,7 +755,7 @@ Sized_incremental_binary<size, big_endian>::do_apply_incremental_relocs(
   Sized_target<size, big_endian>* target =
       parameters->sized_target<size, big_endian>();
 
-  for (unsigned int i = 0; i < nglobals; i++)
+  for (unsigned int i = first; i < last; i++)
     {
       const Symbol* gsym = this->global_symbol(i);
 
@@ -2004,7 +2006,8 @@ Sized_relobj_incr<size, big_endian>::Sized_relobj_incr(
     local_symbol_index_(0), local_symbol_offset_(0), local_dynsym_offset_(0),
     symbols_(), defined_count_(0), incr_reloc_offset_(-1U),
     incr_reloc_count_(0), incr_reloc_output_index_(0), incr_relocs_(NULL),
-    local_symbols_()
+    local_symbols_(), global_symbols_(), first_global_(0),
+    globals_read_(false)
 {
   if (this->input_reader_.is_in_system_directory())
     this->set_is_in_system_directory();
@@ -2013,13 +2016,81 @@ Sized_relobj_incr<size, big_endian>::Sized_relobj_incr(
   ibase->set_input_object(input_file_index, this);
 }
 
-// Read the symbols.
+// Read the global symbols from the base file's incremental info and
+// symbol table.  This only reads from the base file, so it can run in
+// parallel for all the unchanged objects; do_add_symbols then adds the
+// symbols to the symbol table in input file order.
 
 template<int size, bool big_endian>
 void
 Sized_relobj_incr<size, big_endian>::do_read_symbols(Read_symbols_data*)
 {
-  gold_unreachable();
+  gold_assert(!this->globals_read_);
+
+  unsigned int nsyms = this->input_reader_.get_global_symbol_count();
+  this->global_symbols_.resize(nsyms);
+
+  Incremental_binary::View symtab_view(NULL);
+  unsigned int symtab_count;
+  elfcpp::Elf_strtab strtab(NULL, 0);
+  this->ibase_->get_symtab_view(&symtab_view, &symtab_count, &strtab);
+
+  Incremental_symtab_reader<big_endian> isymtab(this->ibase_->symtab_reader());
+  unsigned int isym_count = isymtab.symbol_count();
+  this->first_global_ = symtab_count - isym_count;
+
+  for (unsigned int i = 0; i < nsyms; ++i)
+    {
+      Global_symbol& gs(this->global_symbols_[i]);
+      Incremental_global_symbol_reader<big_endian> info =
+	  this->input_reader_.get_global_symbol_reader(i);
+      gs.output_symndx = info.output_symndx();
+      gs.base_sym = symtab_view.data() + gs.output_symndx * sym_size;
+      elfcpp::Sym<size, big_endian> gsym(gs.base_sym);
+      if (!strtab.get_c_string(gsym.get_st_name(), &gs.name))
+	gs.name = "";
+
+      typename elfcpp::Elf_types<size>::Elf_Addr v = gsym.get_st_value();
+      unsigned int shndx = gsym.get_st_shndx();
+      elfcpp::STB st_bind = gsym.get_st_bind();
+      elfcpp::STT st_type = gsym.get_st_type();
+
+      // Local hidden symbols start out as globals, but get converted to
+      // to local during output.
+      if (st_bind == elfcpp::STB_LOCAL)
+	st_bind = elfcpp::STB_GLOBAL;
+
+      gs.input_shndx = info.shndx();
+      if (gs.input_shndx == 0 || gs.input_shndx == -1U)
+	{
+	  shndx = elfcpp::SHN_UNDEF;
+	  v = 0;
+	}
+      else if (shndx != elfcpp::SHN_ABS)
+	{
+	  // Find the input section and calculate the section-relative value.
+	  gold_assert(shndx != elfcpp::SHN_UNDEF);
+	  Output_section* os = this->ibase_->output_section(shndx);
+	  gold_assert(os != NULL && os->has_fixed_layout());
+	  typename Input_entry_reader::Input_section_info sect =
+	      this->input_reader_.get_input_section(gs.input_shndx - 1);
+	  gold_assert(sect.output_shndx == shndx);
+	  if (st_type != elfcpp::STT_TLS)
+	    v -= os->address();
+	  v -= sect.sh_offset;
+	  shndx = gs.input_shndx;
+	}
+
+      elfcpp::Sym_write<size, big_endian> osym(gs.sym);
+      osym.put_st_name(0);
+      osym.put_st_value(v);
+      osym.put_st_size(gsym.get_st_size());
+      osym.put_st_info(st_bind, st_type);
+      osym.put_st_other(gsym.get_st_other());
+      osym.put_st_shndx(shndx);
+    }
+
+  this->globals_read_ = true;
 }
 
 // Lay out the input sections.
@@ -2093,7 +2164,7 @@ Sized_relobj_incr<size, big_endian>::do_layout(
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(false, this, NULL, 0, i, 0, 0);
+      layout->add_to_gdb_index(false, this, NULL, NULL, 0, i, 0, 0);
     }
   for (std::vector<unsigned int>::const_iterator p
 	   = debug_types_sections.begin();
@@ -2101,7 +2172,7 @@ Sized_relobj_incr<size, big_endian>::do_layout(
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(true, this, 0, 0, i, 0, 0);
+      layout->add_to_gdb_index(true, this, 0, NULL, 0, i, 0, 0);
     }
 }
 
@@ -2122,87 +2193,35 @@ Sized_relobj_incr<size, big_endian>::do_add_symbols(
     Read_symbols_data*,
     Layout*)
 {
-  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
-  unsigned char symbuf[sym_size];
-  elfcpp::Sym<size, big_endian> sym(symbuf);
-  elfcpp::Sym_write<size, big_endian> osym(symbuf);
-
   typedef typename elfcpp::Elf_types<size>::Elf_WXword Elf_size_type;
 
-  unsigned int nsyms = this->input_reader_.get_global_symbol_count();
-  this->symbols_.resize(nsyms);
-
-  Incremental_binary::View symtab_view(NULL);
-  unsigned int symtab_count;
-  elfcpp::Elf_strtab strtab(NULL, 0);
-  this->ibase_->get_symtab_view(&symtab_view, &symtab_count, &strtab);
+  if (!this->globals_read_)
+    this->do_read_symbols(NULL);
 
-  Incremental_symtab_reader<big_endian> isymtab(this->ibase_->symtab_reader());
-  unsigned int isym_count = isymtab.symbol_count();
-  unsigned int first_global = symtab_count - isym_count;
+  unsigned int nsyms = this->global_symbols_.size();
+  this->symbols_.resize(nsyms);
 
-  const unsigned char* sym_p;
   for (unsigned int i = 0; i < nsyms; ++i)
     {
-      Incremental_global_symbol_reader<big_endian> info =
-	  this->input_reader_.get_global_symbol_reader(i);
-      unsigned int output_symndx = info.output_symndx();
-      sym_p = symtab_view.data() + output_symndx * sym_size;
-      elfcpp::Sym<size, big_endian> gsym(sym_p);
-      const char* name;
-      if (!strtab.get_c_string(gsym.get_st_name(), &name))
-	name = "";
-
-      typename elfcpp::Elf_types<size>::Elf_Addr v = gsym.get_st_value();
-      unsigned int shndx = gsym.get_st_shndx();
-      elfcpp::STB st_bind = gsym.get_st_bind();
-      elfcpp::STT st_type = gsym.get_st_type();
-
-      // Local hidden symbols start out as globals, but get converted to
-      // to local during output.
-      if (st_bind == elfcpp::STB_LOCAL)
-	st_bind = elfcpp::STB_GLOBAL;
-
-      unsigned int input_shndx = info.shndx();
-      if (input_shndx == 0 || input_shndx == -1U)
-	{
-	  shndx = elfcpp::SHN_UNDEF;
-	  v = 0;
-	}
-      else if (shndx != elfcpp::SHN_ABS)
-	{
-	  // Find the input section and calculate the section-relative value.
-	  gold_assert(shndx != elfcpp::SHN_UNDEF);
-	  Output_section* os = this->ibase_->output_section(shndx);
-	  gold_assert(os != NULL && os->has_fixed_layout());
-	  typename Input_entry_reader::Input_section_info sect =
-	      this->input_reader_.get_input_section(input_shndx - 1);
-	  gold_assert(sect.output_shndx == shndx);
-	  if (st_type != elfcpp::STT_TLS)
-	    v -= os->address();
-	  v -= sect.sh_offset;
-	  shndx = input_shndx;
-	}
-
-      osym.put_st_name(0);
-      osym.put_st_value(v);
-      osym.put_st_size(gsym.get_st_size());
-      osym.put_st_info(st_bind, st_type);
-      osym.put_st_other(gsym.get_st_other());
-      osym.put_st_shndx(shndx);
+      const Global_symbol& gs(this->global_symbols_[i]);
+      elfcpp::Sym<size, big_endian> sym(gs.sym);
+      elfcpp::Sym<size, big_endian> gsym(gs.base_sym);
+      const char* name = gs.name;
 
       Symbol* res = symtab->add_from_incrobj(this, name, NULL, &sym);
 
-      if (shndx != elfcpp::SHN_UNDEF)
+      if (sym.get_st_shndx() != elfcpp::SHN_UNDEF)
 	++this->defined_count_;
 
       // If this is a linker-defined symbol that hasn't yet been defined,
       // define it now.
-      if (input_shndx == -1U && !res->is_defined())
+      if (gs.input_shndx == -1U && !res->is_defined())
 	{
-	  shndx = gsym.get_st_shndx();
-	  v = gsym.get_st_value();
+	  unsigned int shndx = gsym.get_st_shndx();
+	  typename elfcpp::Elf_types<size>::Elf_Addr v = gsym.get_st_value();
 	  Elf_size_type symsize = gsym.get_st_size();
+	  elfcpp::STB st_bind = sym.get_st_bind();
+	  elfcpp::STT st_type = sym.get_st_type();
 	  if (shndx == elfcpp::SHN_ABS)
 	    {
 	      symtab->define_as_constant(name, NULL,
@@ -2227,8 +2246,12 @@ Sized_relobj_incr<size, big_endian>::do_add_symbols(
 	}
 
       this->symbols_[i] = res;
-      this->ibase_->add_global_symbol(output_symndx - first_global, res);
+      this->ibase_->add_global_symbol(gs.output_symndx - this->first_global_,
+				      res);
     }
+
+  // The symbols are in the symbol table now.
+  std::vector<Global_symbol>().swap(this->global_symbols_);
 }
 
 // Return TRUE if we should include this object from an archive library.
@@ -1474,11 +1474,20 @@ class Incremental_binary
   emit_copy_relocs(Symbol_table* symtab)
   { this->do_emit_copy_relocs(symtab); }
 
-  // Apply incremental relocations for symbols whose values have changed.
+  // Return the number of global symbols in the incremental symbol table.
+  unsigned int
+  global_symbol_count() const
+  { return this->do_global_symbol_count(); }
+
+  // Apply incremental relocations for symbols whose values have changed,
+  // looking at global symbols FIRST up to but not including LAST.  The
+  // relocations for different symbols patch different places in the
+  // output file, so separate ranges may be handled in parallel.
   void
   apply_incremental_relocs(const Symbol_table* symtab, Layout* layout,
-			   Output_file* of)
-  { this->do_apply_incremental_relocs(symtab, layout, of); }
+			   Output_file* of, unsigned int first,
+			   unsigned int last)
+  { this->do_apply_incremental_relocs(symtab, layout, of, first, last); }
 
   // Functions and types for the elfcpp::Elf_file interface.  This
   // permit us to use Incremental_binary as the File template parameter for
@@ -1560,9 +1569,14 @@ class Incremental_binary
   virtual void
   do_emit_copy_relocs(Symbol_table* symtab) = 0;
 
+  // Return the number of global symbols in the incremental symbol table.
+  virtual unsigned int
+  do_global_symbol_count() const = 0;
+
   // Apply incremental relocations for symbols whose values have changed.
   virtual void
-  do_apply_incremental_relocs(const Symbol_table*, Layout*, Output_file*) = 0;
+  do_apply_incremental_relocs(const Symbol_table*, Layout*, Output_file*,
+			      unsigned int first, unsigned int last) = 0;
 
   virtual unsigned int
   do_input_file_count() const = 0;
@@ -1694,10 +1708,16 @@ class Sized_incremental_binary : public Incremental_binary
   virtual void
   do_emit_copy_relocs(Symbol_table* symtab);
 
+  // Return the number of global symbols in the incremental symbol table.
+  virtual unsigned int
+  do_global_symbol_count() const
+  { return this->symtab_reader_.symbol_count(); }
+
   // Apply incremental relocations for symbols whose values have changed.
   virtual void
   do_apply_incremental_relocs(const Symbol_table* symtab, Layout* layout,
-			      Output_file* of);
+			      Output_file* of, unsigned int first,
+			      unsigned int last);
 
   // Proxy class for a sized Incremental_input_entry_reader.
 
@@ -1859,6 +1879,22 @@ class Sized_relobj_incr : public Sized_relobj<size, big_endian>
     unsigned int needs_dynsym_entry : 1;
   };
 
+  // A global symbol read from the base file by do_read_symbols, ready
+  // to be added to the symbol table by do_add_symbols.
+  struct Global_symbol
+  {
+    // The symbol name.  This points into the base file's string table.
+    const char* name;
+    // The entry in the base file's symbol table.
+    const unsigned char* base_sym;
+    // The index of BASE_SYM in the base file's symbol table.
+    unsigned int output_symndx;
+    // The input section index: 0 if undefined, -1U if linker-defined.
+    unsigned int input_shndx;
+    // The symbol to add, with a section-relative value.
+    unsigned char sym[sym_size];
+  };
+
   // Return TRUE if this is an incremental (unchanged) input file.
   bool
   do_is_incremental() const
@@ -2047,6 +2083,13 @@ class Sized_relobj_incr : public Sized_relobj<size, big_endian>
   unsigned char* incr_relocs_;
   // The local symbols.
   std::vector<Local_symbol> local_symbols_;
+  // The global symbols, from do_read_symbols until do_add_symbols.
+  std::vector<Global_symbol> global_symbols_;
+  // The index of the first forced-local or global symbol in the base
+  // file's symbol table.
+  unsigned int first_global_;
+  // TRUE if do_read_symbols has filled in global_symbols_.
+  bool globals_read_;
 };
 
 // An incremental Dynobj.  This class represents a shared object that has
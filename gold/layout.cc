@@ -235,6 +235,69 @@ Free_list::print_stats()
 	  program_name, Free_list::num_allocate_visits);
 }
 
+// A Build_id_hash computes the sha1 or md5 checksum of the output
+// file for the build ID, which may be done in more than one piece.
+
+class Build_id_hash
+{
+ public:
+  Build_id_hash(const char* style)
+    : is_md5_(strcmp(style, "md5") == 0), hashed_size_(0)
+  {
+    if (this->is_md5_)
+      md5_init_ctx(&this->md5_ctx_);
+    else
+      sha1_init_ctx(&this->sha1_ctx_);
+  }
+
+  // The number of bytes at the start of the file which have been
+  // hashed.
+  off_t
+  hashed_size() const
+  { return this->hashed_size_; }
+
+  // Hash the next SIZE bytes of the file, starting at HASHED_SIZE.
+  // Read the file in blocks, so that a streamed output file is not
+  // read back into memory all at once.
+  void
+  hash(Output_file* of, off_t size)
+  {
+    while (size > 0)
+      {
+	off_t len = std::min(size, static_cast<off_t>(block_size));
+	const unsigned char* iv = of->get_input_view(this->hashed_size_, len);
+	if (this->is_md5_)
+	  md5_process_bytes(iv, len, &this->md5_ctx_);
+	else
+	  sha1_process_bytes(iv, len, &this->sha1_ctx_);
+	of->free_input_view(this->hashed_size_, len, iv);
+	this->hashed_size_ += len;
+	size -= len;
+      }
+  }
+
+  // Write the checksum to DST.
+  void
+  finish(unsigned char* dst)
+  {
+    if (this->is_md5_)
+      md5_finish_ctx(&this->md5_ctx_, dst);
+    else
+      sha1_finish_ctx(&this->sha1_ctx_, dst);
+  }
+
+ private:
+  // The most hash reads at once.
+  static const size_t block_size = 16 << 20;
+
+  // Whether this is an md5 rather than a sha1 checksum.
+  bool is_md5_;
+  // The number of bytes hashed so far.
+  off_t hashed_size_;
+  struct md5_ctx md5_ctx_;
+  struct sha1_ctx sha1_ctx_;
+};
+
 // A Hash_task computes the MD5 checksum of an array of char.
 
 class Hash_task : public Task
@@ -357,6 +420,11 @@ Layout::Relaxation_debug_check::verify_sections(
 
 // Layout_task_runner methods.
 
+// The number of global symbols whose incremental relocations are
+// applied by each Incremental_relocs_task.
+
+static const unsigned int incremental_relocs_chunk_size = 4096;
+
 // Lay out the sections.  This is called after all the input objects
 // have been read.
 
@@ -400,9 +468,43 @@ Layout_task_runner::run(Workqueue* workqueue, const Task* task)
       // incremental information from the file before (possibly)
       // overwriting it.
       if (parameters->incremental_update())
-	layout->incremental_base()->apply_incremental_relocs(this->symtab_,
-							     this->layout_,
-							     of);
+	{
+	  Incremental_binary* ibase = layout->incremental_base();
+	  unsigned int nglobals = ibase->global_symbol_count();
+
+	  // With threads, split the global symbols into ranges and
+	  // apply each range in its own task.  The output file is
+	  // resized once they have all finished.
+	  if (this->options_.threads()
+	      && nglobals > incremental_relocs_chunk_size)
+	    {
+	      Task_token* relocs_blocker = new Task_token(true);
+	      for (unsigned int first = 0;
+		   first < nglobals;
+		   first += incremental_relocs_chunk_size)
+		{
+		  unsigned int last = std::min(nglobals,
+					       (first
+						+ incremental_relocs_chunk_size));
+		  relocs_blocker->add_blocker();
+		  workqueue->queue(new Incremental_relocs_task(this->symtab_,
+							       layout, of,
+							       first, last,
+							       relocs_blocker));
+		}
+	      workqueue->queue(new Task_function(
+		  new Resize_output_task_runner(this->options_,
+						this->input_objects_,
+						this->symtab_, layout, of,
+						file_size),
+		  relocs_blocker,
+		  "Task_function Resize_output_task_runner"));
+	      return;
+	    }
+
+	  ibase->apply_incremental_relocs(this->symtab_, layout, of, 0,
+					  nglobals);
+	}
 
       of->resize(file_size);
     }
@@ -412,6 +514,33 @@ Layout_task_runner::run(Workqueue* workqueue, const Task* task)
 			  this->symtab_, layout, workqueue, of);
 }
 
+// Incremental_relocs_task methods.
+
+// Apply the incremental relocations for our range of global symbols.
+
+void
+Incremental_relocs_task::run(Workqueue*)
+{
+  this->layout_->incremental_base()->apply_incremental_relocs(this->symtab_,
+							      this->layout_,
+							      this->of_,
+							      this->first_,
+							      this->last_);
+}
+
+// Resize_output_task_runner methods.
+
+// All the incremental relocations have been applied, so the output
+// file can be resized and the final tasks queued.
+
+void
+Resize_output_task_runner::run(Workqueue* workqueue, const Task*)
+{
+  this->of_->resize(this->file_size_);
+  gold::queue_final_tasks(this->options_, this->input_objects_,
+			  this->symtab_, this->layout_, workqueue, this->of_);
+}
+
 // Layout methods.
 
 Layout::Layout(int number_of_input_files, Script_options* script_options)
@@ -425,6 +554,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     segment_list_(),
     section_list_(),
     unattached_section_list_(),
+    compressed_sections_(),
     special_output_list_(),
     relax_output_list_(),
     section_headers_(NULL),
@@ -445,6 +575,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     eh_frame_hdr_section_(NULL),
     gdb_index_data_(NULL),
     build_id_note_(NULL),
+    build_id_hash_(NULL),
     debug_abbrev_(NULL),
     debug_info_(NULL),
     group_signatures_(),
@@ -1407,6 +1538,7 @@ Layout::layout_eh_frame(Sized_relobj_file<size, big_endian>* object,
 			unsigned int shndx,
 			const elfcpp::Shdr<size, big_endian>& shdr,
 			unsigned int reloc_shndx, unsigned int reloc_type,
+			Parsed_eh_frame_section* parsed,
 			off_t* off)
 {
   gold_assert(shdr.get_sh_type() == elfcpp::SHT_PROGBITS
@@ -1415,7 +1547,10 @@ Layout::layout_eh_frame(Sized_relobj_file<size, big_endian>* object,
 
   Output_section* os = this->make_eh_frame_section(object);
   if (os == NULL)
-    return NULL;
+    {
+      delete parsed;
+      return NULL;
+    }
 
   gold_assert(this->eh_frame_section_ == os);
 
@@ -1423,7 +1558,12 @@ Layout::layout_eh_frame(Sized_relobj_file<size, big_endian>* object,
 
   Eh_frame::Eh_frame_section_disposition disp =
       Eh_frame::EH_UNRECOGNIZED_SECTION;
-  if (!parameters->incremental())
+  if (parsed != NULL)
+    {
+      gold_assert(!parameters->incremental());
+      disp = this->eh_frame_data_->add_parsed_ehframe_input_section(parsed);
+    }
+  else if (!parameters->incremental())
     {
       disp = this->eh_frame_data_->add_ehframe_input_section(object,
 							     symbols,
@@ -1490,6 +1630,16 @@ Layout::finalize_eh_frame_section()
     }
 }
 
+// Return the .eh_frame_hdr section data, if any.
+
+Eh_frame_hdr*
+Layout::eh_frame_hdr() const
+{
+  if (this->eh_frame_data_ == NULL)
+    return NULL;
+  return this->eh_frame_data_->eh_frame_hdr();
+}
+
 // Create and return the magic .eh_frame section.  Create
 // .eh_frame_hdr also if appropriate.  OBJECT is the object with the
 // input .eh_frame section; it may be NULL.
@@ -1578,6 +1728,7 @@ void
 Layout::add_to_gdb_index(bool is_type_unit,
 			 Sized_relobj<size, big_endian>* object,
 			 const unsigned char* symbols,
+			 File_view* symbols_view,
 			 off_t symbols_size,
 			 unsigned int shndx,
 			 unsigned int reloc_shndx,
@@ -1598,8 +1749,18 @@ Layout::add_to_gdb_index(bool is_type_unit,
     }
 
   this->gdb_index_data_->scan_debug_info(is_type_unit, object, symbols,
-					 symbols_size, shndx, reloc_shndx,
-					 reloc_type);
+					 symbols_view, symbols_size, shndx,
+					 reloc_shndx, reloc_type);
+}
+
+// Queue the tasks which scan the .debug_info and .debug_types
+// sections for the .gdb_index section.
+
+void
+Layout::queue_gdb_index_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  if (this->gdb_index_data_ != NULL)
+    this->gdb_index_data_->queue_scan_tasks(workqueue, blocker);
 }
 
 // Add POSD to an output section using NAME, TYPE, and FLAGS.  Return
@@ -1645,8 +1806,13 @@ Layout::make_output_section(const char* name, elfcpp::Elf_Word type,
   if ((flags & elfcpp::SHF_ALLOC) == 0
       && strcmp(parameters->options().compress_debug_sections(), "none") != 0
       && is_compressible_debug_section(name))
-    os = new Output_compressed_section(&parameters->options(), name, type,
-				       flags);
+    {
+      Output_compressed_section* cos =
+	new Output_compressed_section(&parameters->options(), name, type,
+				      flags);
+      this->compressed_sections_.push_back(cos);
+      os = cos;
+    }
   else if ((flags & elfcpp::SHF_ALLOC) == 0
 	   && parameters->options().strip_debug_non_line()
 	   && strcmp(".debug_abbrev", name) == 0)
@@ -2684,6 +2850,17 @@ off_t
 Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
 		 Target* target, const Task* task)
 {
+  // Finish merging the strings merged in parallel, which releases the
+  // input file views they used.
+  if (parameters->options().threads()
+      && parameters->options().merge_string_shards() > 1)
+    {
+      for (Section_list::iterator p = this->section_list_.begin();
+	   p != this->section_list_.end();
+	   ++p)
+	(*p)->finish_merge_tasks(task);
+    }
+
   target->finalize_sections(this, input_objects, symtab);
 
   this->count_local_symbols(task, input_objects);
@@ -5398,9 +5575,48 @@ Layout::write_sections_after_input_sections(Output_file* of)
   this->section_headers_->write(of);
 }
 
+// Return whether the build ID is a sha1 or md5 checksum of the whole
+// output file.
+
+bool
+Layout::has_build_id_file_hash() const
+{
+  if (this->build_id_note_ == NULL)
+    return false;
+  const char* style = parameters->options().build_id();
+  return strcmp(style, "sha1") == 0 || strcmp(style, "md5") == 0;
+}
+
+// Hash the start of the output file for the build ID, up to the first
+// section written by write_sections_after_input_sections.  Sections
+// which require postprocessing are placed after the current end of
+// the file.  The build ID note is still zero, as write_build_id
+// expects.
+
+void
+Layout::hash_build_id_prefix(Output_file* of)
+{
+  gold_assert(this->has_build_id_file_hash() && this->build_id_hash_ == NULL);
+
+  off_t end = this->output_file_size_;
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    {
+      if ((*p)->after_input_sections() && (*p)->is_offset_valid())
+	end = std::min(end, (*p)->offset());
+    }
+  if (this->section_headers_ != NULL
+      && this->section_headers_->is_offset_valid())
+    end = std::min(end, this->section_headers_->offset());
+
+  this->build_id_hash_ = new Build_id_hash(parameters->options().build_id());
+  this->build_id_hash_->hash(of, end);
+}
+
 // If a tree-style build ID was requested, the parallel part of that computation
 // is already done, and the final hash-of-hashes is computed here.  For other
-// types of build IDs, all the work is done here.
+// types of build IDs, the rest of the work is done here.
 
 void
 Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
@@ -5414,20 +5630,22 @@ Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
 
   if (array_of_hashes == NULL)
     {
-      const size_t output_file_size = this->output_file_size();
-      const unsigned char* iv = of->get_input_view(0, output_file_size);
-      const char* style = parameters->options().build_id();
-
       // If we get here with style == "tree" then the output must be
       // too small for chunking, and we use SHA-1 in that case.
-      if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
-	sha1_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
-      else if (strcmp(style, "md5") == 0)
-	md5_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
-      else
+      const char* style = parameters->options().build_id();
+      if (strcmp(style, "sha1") != 0
+	  && strcmp(style, "tree") != 0
+	  && strcmp(style, "md5") != 0)
 	gold_unreachable();
 
-      of->free_input_view(0, output_file_size, iv);
+      // Only hash the rest of the file if hash_build_id_prefix has
+      // already hashed the start of it.
+      Build_id_hash whole_file_hash(style);
+      Build_id_hash* hash = this->build_id_hash_;
+      if (hash == NULL)
+	hash = &whole_file_hash;
+      hash->hash(of, this->output_file_size() - hash->hashed_size());
+      hash->finish(ov);
     }
   else
     {
@@ -5634,6 +5852,35 @@ Write_after_input_sections_task::run(Workqueue*)
   this->layout_->write_sections_after_input_sections(this->of_);
 }
 
+// Build_id_hash_task methods.
+
+// We can only run this task after everything but the sections written
+// after the input sections is complete.
+
+Task_token*
+Build_id_hash_task::is_runnable()
+{
+  if (this->input_blocker_->is_blocked())
+    return this->input_blocker_;
+  return NULL;
+}
+
+// We need to unlock FINAL_BLOCKER when finished.
+
+void
+Build_id_hash_task::locks(Task_locker* tl)
+{
+  tl->add(this, this->final_blocker_);
+}
+
+// Run the task.
+
+void
+Build_id_hash_task::run(Workqueue*)
+{
+  this->layout_->hash_build_id_prefix(this->of_);
+}
+
 // Build IDs can be computed as a "flat" sha1 or md5 of a string of bytes,
 // or as a "tree" where each chunk of the string is hashed and then those
 // hashes are put into a (much smaller) string which is hashed with sha1.
@@ -5884,6 +6131,7 @@ Layout::layout_eh_frame<32, false>(Sized_relobj_file<32, false>* object,
 				   const elfcpp::Shdr<32, false>& shdr,
 				   unsigned int reloc_shndx,
 				   unsigned int reloc_type,
+				   Parsed_eh_frame_section* parsed,
 				   off_t* off);
 #endif
 
@@ -5899,6 +6147,7 @@ Layout::layout_eh_frame<32, true>(Sized_relobj_file<32, true>* object,
 				  const elfcpp::Shdr<32, true>& shdr,
 				  unsigned int reloc_shndx,
 				  unsigned int reloc_type,
+				  Parsed_eh_frame_section* parsed,
 				  off_t* off);
 #endif
 
@@ -5914,6 +6163,7 @@ Layout::layout_eh_frame<64, false>(Sized_relobj_file<64, false>* object,
 				   const elfcpp::Shdr<64, false>& shdr,
 				   unsigned int reloc_shndx,
 				   unsigned int reloc_type,
+				   Parsed_eh_frame_section* parsed,
 				   off_t* off);
 #endif
 
@@ -5929,6 +6179,7 @@ Layout::layout_eh_frame<64, true>(Sized_relobj_file<64, true>* object,
 				  const elfcpp::Shdr<64, true>& shdr,
 				  unsigned int reloc_shndx,
 				  unsigned int reloc_type,
+				  Parsed_eh_frame_section* parsed,
 				  off_t* off);
 #endif
 
@@ -5938,6 +6189,7 @@ void
 Layout::add_to_gdb_index(bool is_type_unit,
 			 Sized_relobj<32, false>* object,
 			 const unsigned char* symbols,
+			 File_view* symbols_view,
 			 off_t symbols_size,
 			 unsigned int shndx,
 			 unsigned int reloc_shndx,
@@ -5950,6 +6202,7 @@ void
 Layout::add_to_gdb_index(bool is_type_unit,
 			 Sized_relobj<32, true>* object,
 			 const unsigned char* symbols,
+			 File_view* symbols_view,
 			 off_t symbols_size,
 			 unsigned int shndx,
 			 unsigned int reloc_shndx,
@@ -5962,6 +6215,7 @@ void
 Layout::add_to_gdb_index(bool is_type_unit,
 			 Sized_relobj<64, false>* object,
 			 const unsigned char* symbols,
+			 File_view* symbols_view,
 			 off_t symbols_size,
 			 unsigned int shndx,
 			 unsigned int reloc_shndx,
@@ -5974,6 +6228,7 @@ void
 Layout::add_to_gdb_index(bool is_type_unit,
 			 Sized_relobj<64, true>* object,
 			 const unsigned char* symbols,
+			 File_view* symbols_view,
 			 off_t symbols_size,
 			 unsigned int shndx,
 			 unsigned int reloc_shndx,
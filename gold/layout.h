@@ -40,6 +40,7 @@ namespace gold
 {
 
 class General_options;
+class File_view;
 class Incremental_inputs;
 class Incremental_binary;
 class Input_objects;
@@ -57,7 +58,11 @@ class Output_data_dynamic;
 class Output_symtab_xindex;
 class Output_reduced_debug_abbrev_section;
 class Output_reduced_debug_info_section;
+class Output_compressed_section;
+class Build_id_hash;
 class Eh_frame;
+class Eh_frame_hdr;
+class Parsed_eh_frame_section;
 class Gdb_index;
 class Target;
 struct Timespec;
@@ -198,6 +203,76 @@ class Layout_task_runner : public Task_function_runner
   Mapfile* mapfile_;
 };
 
+// This task applies the incremental relocations for a range of the
+// global symbols in the base file of an incremental update, in
+// parallel with the tasks for the other ranges.
+
+class Incremental_relocs_task : public Task
+{
+ public:
+  // FIRST and LAST are the range of global symbols.  FINAL_BLOCKER is
+  // released when the task completes.
+  Incremental_relocs_task(const Symbol_table* symtab, Layout* layout,
+			  Output_file* of, unsigned int first,
+			  unsigned int last, Task_token* final_blocker)
+    : symtab_(symtab), layout_(layout), of_(of), first_(first),
+      last_(last), final_blocker_(final_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Incremental_relocs_task"; }
+
+ private:
+  const Symbol_table* symtab_;
+  Layout* layout_;
+  Output_file* of_;
+  unsigned int first_;
+  unsigned int last_;
+  Task_token* final_blocker_;
+};
+
+// This task function runs after the incremental relocations have
+// been applied.  It resizes the output file and queues the final
+// tasks.
+
+class Resize_output_task_runner : public Task_function_runner
+{
+ public:
+  Resize_output_task_runner(const General_options& options,
+			    const Input_objects* input_objects,
+			    const Symbol_table* symtab, Layout* layout,
+			    Output_file* of, off_t file_size)
+    : options_(options), input_objects_(input_objects), symtab_(symtab),
+      layout_(layout), of_(of), file_size_(file_size)
+  { }
+
+  // Run the operation.
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  const General_options& options_;
+  const Input_objects* input_objects_;
+  const Symbol_table* symtab_;
+  Layout* layout_;
+  Output_file* of_;
+  off_t file_size_;
+};
+
 // This class holds information about the comdat group or
 // .gnu.linkonce section that will be kept for a given signature.
 
@@ -625,8 +700,11 @@ class Layout
   // .eh_frame section in OBJECT.  SHDR is the section header.
   // RELOC_SHNDX is the index of a relocation section which applies to
   // this section, or 0 if none, or -1U if more than one.  RELOC_TYPE
-  // is the type of the relocation section if there is one.  This
-  // returns the output section, and sets *OFFSET to the offset.
+  // is the type of the relocation section if there is one.  PARSED,
+  // if not NULL, is the section as already read by
+  // Eh_frame::parse_ehframe_input_section; this takes ownership of
+  // it.  This returns the output section, and sets *OFFSET to the
+  // offset.
   template<int size, bool big_endian>
   Output_section*
   layout_eh_frame(Sized_relobj_file<size, big_endian>* object,
@@ -637,6 +715,7 @@ class Layout
 		  unsigned int shndx,
 		  const elfcpp::Shdr<size, big_endian>& shdr,
 		  unsigned int reloc_shndx, unsigned int reloc_type,
+		  Parsed_eh_frame_section* parsed,
 		  off_t* offset);
 
   // After processing all input files, we call this to make sure that
@@ -645,6 +724,10 @@ class Layout
   void
   finalize_eh_frame_section();
 
+  // Return the .eh_frame_hdr section data, or NULL if there is none.
+  Eh_frame_hdr*
+  eh_frame_hdr() const;
+
   // Add .eh_frame information for a PLT.  The FDE must start with a
   // 4-byte PC-relative reference to the start of the PLT, followed by
   // a 4-byte size of PLT.
@@ -654,17 +737,26 @@ class Layout
 		       size_t fde_length);
 
   // Scan a .debug_info or .debug_types section, and add summary
-  // information to the .gdb_index section.
+  // information to the .gdb_index section.  SYMBOLS_VIEW, if not
+  // NULL, is a lasting view of SYMBOLS which the .gdb_index section
+  // takes over; see Gdb_index::scan_debug_info.
   template<int size, bool big_endian>
   void
   add_to_gdb_index(bool is_type_unit,
 		   Sized_relobj<size, big_endian>* object,
 		   const unsigned char* symbols,
+		   File_view* symbols_view,
 		   off_t symbols_size,
 		   unsigned int shndx,
 		   unsigned int reloc_shndx,
 		   unsigned int reloc_type);
 
+  // Queue the tasks which scan the .debug_info and .debug_types
+  // sections recorded by add_to_gdb_index when using threads.
+  // BLOCKER is blocked until the .gdb_index section is complete.
+  void
+  queue_gdb_index_tasks(Workqueue*, Task_token* blocker);
+
   // Handle a GNU stack note.  This is called once per input object
   // file.  SEEN_GNU_STACK is true if the object file has a
   // .note.GNU-stack section.  GNU_STACK_FLAGS is the section flags
@@ -801,6 +893,14 @@ class Layout
   any_postprocessing_sections() const
   { return this->any_postprocessing_sections_; }
 
+  // The list of compressed debug sections.
+  typedef std::vector<Output_compressed_section*> Compressed_section_list;
+
+  // Return the compressed debug sections.
+  const Compressed_section_list&
+  compressed_sections() const
+  { return this->compressed_sections_; }
+
   // Return the size of the output file.
   off_t
   output_file_size() const
@@ -906,6 +1006,17 @@ class Layout
   void
   add_target_specific_dynamic_tag(elfcpp::DT tag, unsigned int val);
 
+  // Return whether the build ID is a sha1 or md5 checksum of the
+  // whole output file, which hash_build_id_prefix may start early.
+  bool
+  has_build_id_file_hash() const;
+
+  // Hash the part of the output file which precedes everything
+  // written by write_sections_after_input_sections, for the build ID.
+  // This may run while those sections are being written.
+  void
+  hash_build_id_prefix(Output_file*);
+
   // Compute and write out the build ID if needed.
   void
   write_build_id(Output_file*, unsigned char*, size_t) const;
@@ -1339,6 +1450,8 @@ class Layout
   // The list of output sections which are not attached to any output
   // segment.
   Section_list unattached_section_list_;
+  // The list of compressed debug sections.
+  Compressed_section_list compressed_sections_;
   // The list of unattached Output_data objects which require special
   // handling because they are not Output_sections.
   Data_list special_output_list_;
@@ -1382,6 +1495,9 @@ class Layout
   Gdb_index* gdb_index_data_;
   // The space for the build ID checksum if there is one.
   Output_section_data* build_id_note_;
+  // The build ID checksum of the start of the output file, if
+  // hash_build_id_prefix has been called.
+  Build_id_hash* build_id_hash_;
   // The output section containing dwarf abbreviations
   Output_reduced_debug_abbrev_section* debug_abbrev_;
   // The output section containing the dwarf debug info tree
@@ -1598,6 +1714,42 @@ class Write_after_input_sections_task : public Task
   Task_token* final_blocker_;
 };
 
+// This task hashes the start of the output file for a sha1 or md5
+// build ID, once everything but the sections handled by
+// Write_after_input_sections_task has been written.  It runs at the
+// same time as that task, or as the compression of debug sections.
+
+class Build_id_hash_task : public Task
+{
+ public:
+  Build_id_hash_task(Layout* layout, Output_file* of,
+		     Task_token* input_blocker, Task_token* final_blocker)
+    : layout_(layout), of_(of), input_blocker_(input_blocker),
+      final_blocker_(final_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Build_id_hash_task"; }
+
+ private:
+  Layout* layout_;
+  Output_file* of_;
+  Task_token* input_blocker_;
+  Task_token* final_blocker_;
+};
+
 // This task function handles computation of the build id.
 // When using --build-id=tree, it schedules the tasks that
 // compute the hashes for each chunk of the file. This task
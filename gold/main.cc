@@ -251,6 +251,8 @@ main(int argc, char** argv)
   // Run the main task processing loop.
   workqueue.process(0);
 
+  workqueue.write_task_trace();
+
   if (command_line.options().print_output_format())
     print_output_format();
 
@@ -298,6 +300,8 @@ main(int argc, char** argv)
       File_read::print_stats();
       Archive::print_stats();
       Lib_group::print_stats();
+      if (parameters->options().gc_sections())
+	gc.print_stats();
       fprintf(stderr, _("%s: output file size: %lld bytes\n"),
 	      program_name, static_cast<long long>(layout.output_file_size()));
       symtab.print_stats();
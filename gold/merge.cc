@@ -25,6 +25,8 @@
 #include <cstdlib>
 #include <algorithm>
 
+#include "parameters.h"
+#include "options.h"
 #include "merge.h"
 #include "compressed_output.h"
 
@@ -431,6 +433,18 @@ Output_merge_data::do_print_merge_stats(const char* section_name)
 
 // Class Output_merge_string.
 
+template<typename Char_type>
+Output_merge_string<Char_type>::Output_merge_string(uint64_t addralign)
+  : Output_merge_base(sizeof(Char_type), addralign), stringpool_(addralign),
+    merged_strings_lists_(), input_count_(0), input_size_(0),
+    merge_in_parallel_(parameters->options().threads()
+		       && parameters->options().merge_string_shards() > 1),
+    pending_strings_added_(false), hashed_blocker_(NULL), shard_count_(0),
+    shard_strings_()
+{
+  this->stringpool_.set_no_zero_null();
+}
+
 // Add an input section to a merged string section.
 
 template<typename Char_type>
@@ -472,6 +486,49 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
       new Merged_strings_list(object, shndx);
   this->merged_strings_lists_.push_back(merged_strings_list);
   Merged_strings& merged_strings = merged_strings_list->merged_strings;
+  Pending_strings& pending_strings = merged_strings_list->pending_strings;
+
+  // When merging in parallel, the strings are not added to the
+  // Stringpool until after the merge tasks have run, so we need to
+  // keep the section contents.  We keep a view of the input file
+  // when we can, and only copy decompressed contents which the
+  // object will discard.
+  if (this->merge_in_parallel_)
+    {
+      File_view* view = NULL;
+      if (!is_new && !object->section_is_compressed(shndx, NULL))
+	{
+	  section_size_type view_len;
+	  view = object->section_contents_lasting_view(shndx, &view_len);
+	  gold_assert(view == NULL || view_len == sec_len);
+	}
+
+      const unsigned char* contents;
+      if (view != NULL)
+	{
+	  merged_strings_list->view = view;
+	  contents = view->data();
+	}
+      else if (is_new)
+	{
+	  merged_strings_list->contents = pdata;
+	  contents = pdata;
+	}
+      else
+	{
+	  unsigned char* copy = new unsigned char[sec_len];
+	  memcpy(copy, pdata, sec_len);
+	  merged_strings_list->contents = copy;
+	  contents = copy;
+	}
+      is_new = false;
+
+      const Char_type* pcontents = reinterpret_cast<const Char_type*>(contents);
+      pend0 = pcontents + (pend0 - p);
+      pend = pcontents + (pend - p);
+      p = pcontents;
+      pdata = contents;
+    }
 
   // Count the number of non-null strings in the section and size the list.
   size_t count = 0;
@@ -485,7 +542,10 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
     }
   if (pend0 < pend)
     ++count;
-  merged_strings.reserve(count + 1);
+  if (this->merge_in_parallel_)
+    pending_strings.reserve(count + 1);
+  else
+    merged_strings.reserve(count + 1);
 
   // The index I is in bytes, not characters.
   section_size_type i = 0;
@@ -507,17 +567,23 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 	      != init_align_modulo))
 	  has_misaligned_strings = true;
 
-      Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
+      if (this->merge_in_parallel_)
+	pending_strings.push_back(Pending_string(p, i, len));
+      else
+	{
+	  Stringpool::Key key;
+	  this->stringpool_.add_with_length(p, len, true, &key);
 
-      merged_strings.push_back(Merged_string(i, key));
+	  merged_strings.push_back(Merged_string(i, key));
+	}
       p += len + 1;
       i += (len + 1) * sizeof(Char_type);
     }
 
   // Record the last offset in the input section so that we can
   // compute the length of the last string.
-  merged_strings.push_back(Merged_string(i, 0));
+  if (!this->merge_in_parallel_)
+    merged_strings.push_back(Merged_string(i, 0));
 
   this->input_count_ += count;
   this->input_size_ += i;
@@ -545,6 +611,9 @@ template<typename Char_type>
 section_size_type
 Output_merge_string<Char_type>::finalize_merged_data()
 {
+  if (this->merge_in_parallel_)
+    this->add_pending_strings();
+
   this->stringpool_.set_string_offsets();
 
   for (typename Merged_strings_lists::const_iterator l =
@@ -584,6 +653,317 @@ Output_merge_string<Char_type>::finalize_merged_data()
   return this->stringpool_.get_strtab_size();
 }
 
+// Return the shard to use for a hash code.  The low bits of the hash
+// code are also used to pick a bucket in the hash tables, so we use
+// the high bits here.
+
+static inline unsigned int
+merge_string_shard(size_t hash_code, unsigned int shard_count)
+{
+  return (hash_code >> 16) % shard_count;
+}
+
+// Compute the hash codes of the pending strings in the input
+// sections FIRST up to LAST, which make up group GROUP, and sort them
+// into shards by hash code.  This is the first, embarrassingly
+// parallel, step of merging the strings in parallel.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::hash_pending_strings(size_t group,
+						     size_t first,
+						     size_t last)
+{
+  gold_assert(last <= this->merged_strings_lists_.size());
+  const unsigned int shard_count = this->shard_count_;
+  std::vector<Pending_string*>* shards =
+    &this->shard_strings_[group * shard_count];
+  for (size_t i = first; i < last; ++i)
+    {
+      Pending_strings& pending_strings =
+	this->merged_strings_lists_[i]->pending_strings;
+      for (typename Pending_strings::iterator p = pending_strings.begin();
+	   p != pending_strings.end();
+	   ++p)
+	{
+	  p->hash_code = string_hash<Char_type>(p->string, p->length);
+	  shards[merge_string_shard(p->hash_code, shard_count)].push_back(&*p);
+	}
+    }
+}
+
+// Find the first occurrence of each pending string in shard SHARD.
+// The strings of each group were put in the shard in input order, so
+// this looks at them in the order in which they would have been added
+// to the Stringpool when not merging in parallel.  Each string
+// belongs to exactly one shard, so the shards can run in parallel
+// without locking.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::dedup_pending_strings(unsigned int shard)
+{
+  const unsigned int shard_count = this->shard_count_;
+  const size_t group_count = this->shard_strings_.size() / shard_count;
+
+  size_t count = 0;
+  for (size_t g = 0; g < group_count; ++g)
+    count += this->shard_strings_[g * shard_count + shard].size();
+
+  Pending_string_set first_strings;
+  first_strings.rehash(count + 1);
+  for (size_t g = 0; g < group_count; ++g)
+    {
+      std::vector<Pending_string*>& strings =
+	this->shard_strings_[g * shard_count + shard];
+      for (typename std::vector<Pending_string*>::iterator p = strings.begin();
+	   p != strings.end();
+	   ++p)
+	{
+	  std::pair<typename Pending_string_set::iterator, bool> ins =
+	    first_strings.insert(*p);
+	  (*p)->first = *ins.first;
+	}
+      std::vector<Pending_string*>().swap(strings);
+    }
+}
+
+// Add the pending strings to the Stringpool, in order.  If the merge
+// tasks have run, only the first occurrence of each string is looked
+// up in the Stringpool; later occurrences reuse its key.  The
+// resulting Stringpool is the same as if we had added every string
+// as we saw it.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::add_pending_strings()
+{
+  if (this->pending_strings_added_)
+    return;
+  this->pending_strings_added_ = true;
+
+  for (typename Merged_strings_lists::const_iterator l =
+	 this->merged_strings_lists_.begin();
+       l != this->merged_strings_lists_.end();
+       ++l)
+    {
+      Pending_strings& pending_strings = (*l)->pending_strings;
+      Merged_strings& merged_strings = (*l)->merged_strings;
+      gold_assert(merged_strings.empty());
+      merged_strings.reserve(pending_strings.size() + 1);
+      section_offset_type end_offset = 0;
+      for (typename Pending_strings::iterator p = pending_strings.begin();
+	   p != pending_strings.end();
+	   ++p)
+	{
+	  Stringpool::Key key;
+	  if (p->first == NULL)
+	    this->stringpool_.add_with_length(p->string, p->length, true, &key);
+	  else if (p->first == &*p)
+	    {
+	      this->stringpool_.add_with_length_and_hash(p->string, p->length,
+							 p->hash_code, true,
+							 &key);
+	      p->stringpool_key = key;
+	    }
+	  else
+	    {
+	      key = p->first->stringpool_key;
+	      gold_assert(key != 0);
+	    }
+	  merged_strings.push_back(Merged_string(p->offset, key));
+	  end_offset = p->offset + (p->length + 1) * sizeof(Char_type);
+	}
+
+      // Record the last offset in the input section so that we can
+      // compute the length of the last string.
+      merged_strings.push_back(Merged_string(end_offset, 0));
+    }
+
+  // The strings are now in the Stringpool, so we no longer need the
+  // copies of the section contents.  The views are released by
+  // do_finish_merge_tasks, which can lock the objects.
+  for (typename Merged_strings_lists::const_iterator l =
+	 this->merged_strings_lists_.begin();
+       l != this->merged_strings_lists_.end();
+       ++l)
+    {
+      Pending_strings().swap((*l)->pending_strings);
+      delete[] (*l)->contents;
+      (*l)->contents = NULL;
+    }
+
+  std::vector<std::vector<Pending_string*> >().swap(this->shard_strings_);
+  delete this->hashed_blocker_;
+  this->hashed_blocker_ = NULL;
+}
+
+// Add the strings found by the merge tasks to the Stringpool, and
+// release the views of the input sections which held them.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::do_finish_merge_tasks(const Task* task)
+{
+  if (!this->merge_in_parallel_)
+    return;
+
+  this->add_pending_strings();
+
+  for (typename Merged_strings_lists::const_iterator l =
+	 this->merged_strings_lists_.begin();
+       l != this->merged_strings_lists_.end();
+       ++l)
+    {
+      if ((*l)->view == NULL)
+	continue;
+      Task_lock_obj<Object> tl(task, (*l)->object);
+      delete (*l)->view;
+      (*l)->view = NULL;
+    }
+}
+
+// A task to compute the hash codes of the strings in a range of
+// input sections.
+
+template<typename Char_type>
+class Merge_string_hash_task : public Task
+{
+ public:
+  Merge_string_hash_task(Output_merge_string<Char_type>* pomsd,
+			 size_t group, size_t first, size_t last,
+			 Task_token* blocker)
+    : pomsd_(pomsd), group_(group), first_(first), last_(last),
+      blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  {
+    this->pomsd_->hash_pending_strings(this->group_, this->first_,
+				       this->last_);
+  }
+
+  std::string
+  get_name() const
+  { return "Merge_string_hash_task"; }
+
+ private:
+  Output_merge_string<Char_type>* pomsd_;
+  size_t group_;
+  size_t first_;
+  size_t last_;
+  Task_token* blocker_;
+};
+
+// A task to find the first occurrence of the strings in a shard.
+// This waits until all the strings have been hashed.
+
+template<typename Char_type>
+class Merge_string_shard_task : public Task
+{
+ public:
+  Merge_string_shard_task(Output_merge_string<Char_type>* pomsd,
+			  unsigned int shard, Task_token* hashed_blocker,
+			  Task_token* blocker)
+    : pomsd_(pomsd), shard_(shard), hashed_blocker_(hashed_blocker),
+      blocker_(blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->hashed_blocker_->is_blocked())
+      return this->hashed_blocker_;
+    return NULL;
+  }
+
+  // Unblock BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->pomsd_->dedup_pending_strings(this->shard_); }
+
+  std::string
+  get_name() const
+  { return "Merge_string_shard_task"; }
+
+ private:
+  Output_merge_string<Char_type>* pomsd_;
+  unsigned int shard_;
+  Task_token* hashed_blocker_;
+  Task_token* blocker_;
+};
+
+// Queue the tasks to merge the strings in parallel.  We split the
+// input sections into groups of roughly equal size, and hash each
+// group and sort its strings into shards by hash code in parallel.
+// Then we find the first occurrence of each string in each shard.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::do_queue_merge_tasks(Workqueue* workqueue,
+						     Task_token* blocker)
+{
+  if (!this->merge_in_parallel_
+      || this->merged_strings_lists_.empty()
+      || this->hashed_blocker_ != NULL)
+    return;
+
+  const unsigned int shard_count =
+    parameters->options().merge_string_shards();
+  const size_t group_size = this->input_size_ / (shard_count * 4) + 1;
+
+  std::vector<std::pair<size_t, size_t> > groups;
+  size_t first = 0;
+  size_t size = 0;
+  const size_t list_count = this->merged_strings_lists_.size();
+  for (size_t i = 0; i < list_count; ++i)
+    {
+      const Pending_strings& pending_strings =
+	this->merged_strings_lists_[i]->pending_strings;
+      if (!pending_strings.empty())
+	size += (pending_strings.back().offset
+		 + (pending_strings.back().length + 1) * sizeof(Char_type));
+      if (size >= group_size || i + 1 == list_count)
+	{
+	  groups.push_back(std::make_pair(first, i + 1));
+	  first = i + 1;
+	  size = 0;
+	}
+    }
+
+  this->shard_count_ = shard_count;
+  this->shard_strings_.resize(groups.size() * shard_count);
+
+  this->hashed_blocker_ = new Task_token(true);
+  this->hashed_blocker_->add_blockers(groups.size());
+  for (size_t i = 0; i < groups.size(); ++i)
+    workqueue->queue(new Merge_string_hash_task<Char_type>(this, i,
+							   groups[i].first,
+							   groups[i].second,
+							   this->hashed_blocker_));
+
+  for (unsigned int shard = 0; shard < shard_count; ++shard)
+    {
+      workqueue->add_blocker(blocker);
+      workqueue->queue(new Merge_string_shard_task<Char_type>(
+	  this, shard, this->hashed_blocker_, blocker));
+    }
+}
+
 template<typename Char_type>
 void
 Output_merge_string<Char_type>::set_final_data_size()
@@ -657,6 +1037,45 @@ Output_merge_string<Char_type>::do_print_merge_stats(const char* section_name)
   this->stringpool_.print_stats(buf);
 }
 
+// Class Merge_strings_task.
+
+Merge_strings_task::~Merge_strings_task()
+{
+  if (this->this_blocker_ != NULL)
+    delete this->this_blocker_;
+}
+
+// We can run as soon as THIS_BLOCKER_ is released.
+
+Task_token*
+Merge_strings_task::is_runnable()
+{
+  if (this->this_blocker_ != NULL && this->this_blocker_->is_blocked())
+    return this->this_blocker_;
+  return NULL;
+}
+
+// We unblock NEXT_BLOCKER_ when done.  The tasks we queue also hold
+// it.
+
+void
+Merge_strings_task::locks(Task_locker* tl)
+{
+  tl->add(this, this->next_blocker_);
+}
+
+// Queue the merge tasks for each output section.
+
+void
+Merge_strings_task::run(Workqueue* workqueue)
+{
+  const Layout::Section_list& sections(this->layout_->section_list());
+  for (Layout::Section_list::const_iterator p = sections.begin();
+       p != sections.end();
+       ++p)
+    (*p)->queue_merge_tasks(workqueue, this->next_blocker_);
+}
+
 // Instantiate the templates we need.
 
 template
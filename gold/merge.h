@@ -29,10 +29,13 @@
 
 #include "stringpool.h"
 #include "output.h"
+#include "workqueue.h"
 
 namespace gold
 {
 
+class File_view;
+
 // For each object with merge sections, we store an Object_merge_map.
 // This is used to map locations in input sections to a merged output
 // section.  The output section itself is not recorded here--it can be
@@ -216,6 +219,22 @@ class Output_merge_base : public Output_section_data
     gold_assert(this->first_relobj_ != NULL);
     return this->first_shndx_;
   }
+
+  // Queue tasks to do part of the merging in parallel.  Each task
+  // queued must add a blocker to BLOCKER, which is released when the
+  // task completes.  This is called after all input sections have
+  // been added and before the final data size is set.
+  void
+  queue_merge_tasks(Workqueue* workqueue, Task_token* blocker)
+  { this->do_queue_merge_tasks(workqueue, blocker); }
+
+  // Finish the merging done by the tasks queued by
+  // queue_merge_tasks, and release any input file views they used.
+  // TASK is the task which is running, used to lock the input
+  // objects.
+  void
+  finish_merge_tasks(const Task* task)
+  { this->do_finish_merge_tasks(task); }
  
   // Set of merged input sections.
   typedef Unordered_set<Section_id, Section_id_hash> Input_sections;
@@ -253,6 +272,16 @@ class Output_merge_base : public Output_section_data
   do_set_keeps_input_sections()
   { this->keeps_input_sections_ = true; }
 
+  // This may be overridden by the child class.
+  virtual void
+  do_queue_merge_tasks(Workqueue*, Task_token*)
+  { }
+
+  // This may be overridden by the child class.
+  virtual void
+  do_finish_merge_tasks(const Task*)
+  { }
+
   // Record the merged input section for script processing.
   void
   record_input_section(Relobj* relobj, unsigned int shndx);
@@ -400,12 +429,18 @@ template<typename Char_type>
 class Output_merge_string : public Output_merge_base
 {
  public:
-  Output_merge_string(uint64_t addralign)
-    : Output_merge_base(sizeof(Char_type), addralign), stringpool_(addralign),
-      merged_strings_lists_(), input_count_(0), input_size_(0)
-  {
-    this->stringpool_.set_no_zero_null();
-  }
+  Output_merge_string(uint64_t addralign);
+
+  // Compute the hash codes of the strings in the input sections
+  // FIRST up to LAST, which make up group GROUP, and sort them into
+  // shards.  This is called by Merge_string_hash_task.
+  void
+  hash_pending_strings(size_t group, size_t first, size_t last);
+
+  // Find the first occurrence of each string whose hash code puts it
+  // in shard SHARD.  This is called by Merge_string_shard_task.
+  void
+  dedup_pending_strings(unsigned int shard);
 
  protected:
   // Add an input section.
@@ -461,11 +496,24 @@ class Output_merge_string : public Output_merge_base
     Output_merge_base::do_set_keeps_input_sections();
   }
 
+  // Queue the tasks which merge the strings in parallel.
+  void
+  do_queue_merge_tasks(Workqueue*, Task_token*);
+
+  // Add the merged strings to the Stringpool and release the views.
+  void
+  do_finish_merge_tasks(const Task*);
+
  private:
   // The name of the string type, for stats.
   const char*
   string_name();
 
+  // Add the strings found by the merge tasks to the Stringpool.  This
+  // does nothing if they have already been added.
+  void
+  add_pending_strings();
+
   // As we see input sections, we build a mapping from object, section
   // index and offset to strings.
   struct Merged_string
@@ -482,6 +530,59 @@ class Output_merge_string : public Output_merge_base
 
   typedef std::vector<Merged_string> Merged_strings;
 
+  // When merging in parallel, we record the strings of each input
+  // section here, and only add them to the Stringpool once the merge
+  // tasks have found the first occurrence of each string.
+  struct Pending_string
+  {
+    // The string, in the section contents we have saved.
+    const Char_type* string;
+    // The offset in the input section.
+    section_offset_type offset;
+    // The length of the string in characters.
+    size_t length;
+    // The hash code of the string, as computed by string_hash.
+    size_t hash_code;
+    // The first occurrence of this string in any input section, or
+    // NULL if the merge tasks have not looked at this string.
+    const Pending_string* first;
+    // The key in the Stringpool.  This is only set for the first
+    // occurrence of a string.
+    Stringpool::Key stringpool_key;
+
+    Pending_string(const Char_type* stringa, section_offset_type offseta,
+		   size_t lengtha)
+      : string(stringa), offset(offseta), length(lengtha), hash_code(0),
+	first(NULL), stringpool_key(0)
+    { }
+  };
+
+  typedef std::vector<Pending_string> Pending_strings;
+
+  // Hash and equality functions for finding the first occurrence of
+  // a Pending_string.
+  struct Pending_string_hash
+  {
+    size_t
+    operator()(const Pending_string* ps) const
+    { return ps->hash_code; }
+  };
+
+  struct Pending_string_eq
+  {
+    bool
+    operator()(const Pending_string* ps1, const Pending_string* ps2) const
+    {
+      return (ps1->hash_code == ps2->hash_code
+	      && ps1->length == ps2->length
+	      && memcmp(ps1->string, ps2->string,
+			ps1->length * sizeof(Char_type)) == 0);
+    }
+  };
+
+  typedef Unordered_set<const Pending_string*, Pending_string_hash,
+			Pending_string_eq> Pending_string_set;
+
   struct Merged_strings_list
   {
     // The input object where the strings were found.
@@ -490,10 +591,20 @@ class Output_merge_string : public Output_merge_base
     unsigned int shndx;
     // The list of merged strings.
     Merged_strings merged_strings;
+    // When merging in parallel, the view of the input section, or
+    // the decompressed contents of the input section, which we own,
+    // and the strings we have not yet added to the Stringpool.
+    File_view* view;
+    const unsigned char* contents;
+    Pending_strings pending_strings;
 
     Merged_strings_list(Relobj* objecta, unsigned int shndxa)
-      : object(objecta), shndx(shndxa), merged_strings()
+      : object(objecta), shndx(shndxa), merged_strings(), view(NULL),
+	contents(NULL), pending_strings()
     { }
+
+    ~Merged_strings_list()
+    { delete[] this->contents; }
   };
 
   typedef std::vector<Merged_strings_list*> Merged_strings_lists;
@@ -507,6 +618,58 @@ class Output_merge_string : public Output_merge_base
   size_t input_count_;
   // The total size of input sections.
   size_t input_size_;
+  // Whether to defer adding strings to the Stringpool so that the
+  // merge tasks can find duplicates in parallel.
+  bool merge_in_parallel_;
+  // Whether the pending strings have been added to the Stringpool.
+  bool pending_strings_added_;
+  // When merging in parallel, the blocker which is released when all
+  // the strings have been hashed.
+  Task_token* hashed_blocker_;
+  // When merging in parallel, the number of shards.
+  unsigned int shard_count_;
+  // When merging in parallel, the strings of each group of input
+  // sections in each shard, in input order.  The strings of group G
+  // in shard S are at index G * shard_count_ + S.
+  std::vector<std::vector<Pending_string*> > shard_strings_;
+};
+
+// This task queues the tasks which merge the strings in the
+// Output_merge_string sections in parallel.  It runs after all the
+// input sections have been laid out.  The tasks it queues and the
+// task itself hold NEXT_BLOCKER, so anything waiting for NEXT_BLOCKER
+// will not run until all the strings have been merged.
+
+class Merge_strings_task : public Task
+{
+ public:
+  Merge_strings_task(Layout* layout, Task_token* this_blocker,
+		     Task_token* next_blocker)
+    : layout_(layout), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
+  { }
+
+  ~Merge_strings_task();
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Merge_strings_task"; }
+
+ private:
+  Layout* layout_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
 };
 
 } // End namespace gold.
@@ -42,6 +42,7 @@
 #include "compressed_output.h"
 #include "incremental.h"
 #include "merge.h"
+#include "ehframe.h"
 
 namespace gold
 {
@@ -182,6 +183,19 @@ Object::section_contents(unsigned int shndx, section_size_type* plen,
 			 bool cache)
 { return this->do_section_contents(shndx, plen, cache); }
 
+// Copy part of the underlying file straight to the output file.
+
+bool
+Object::copy_to_output_file(off_t start, section_size_type size,
+			    Output_file* of, off_t output_offset)
+{
+  File_read& file(this->input_file()->file());
+  if (file.contents_are_in_memory())
+    return false;
+  return of->copy_from_descriptor(file.descriptor(), this->offset_ + start,
+				  output_offset, size);
+}
+
 // Read the section data into SD.  This is code common to Sized_relobj_file
 // and Sized_dynobj, so we put it into Object.
 
@@ -477,6 +491,7 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
     kept_comdat_sections_(),
     has_eh_frame_(false),
     discarded_eh_frame_shndx_(-1U),
+    parsed_eh_frame_sections_(),
     is_deferred_layout_(false),
     deferred_layout_(),
     deferred_layout_relocs_(),
@@ -488,6 +503,11 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
 template<int size, bool big_endian>
 Sized_relobj_file<size, big_endian>::~Sized_relobj_file()
 {
+  for (typename std::vector<Parsed_eh_frame_section*>::iterator p =
+	 this->parsed_eh_frame_sections_.begin();
+       p != this->parsed_eh_frame_sections_.end();
+       ++p)
+    delete *p;
 }
 
 // Set up an object file based on the file header.  This sets up the
@@ -918,6 +938,46 @@ Sized_relobj_file<size, big_endian>::base_read_symbols(Read_symbols_data* sd)
   sd->symbol_names = fvstrtab;
   sd->symbol_names_size =
     convert_to_section_size_type(strtabshdr.get_sh_size());
+
+  // When using threads, read the .eh_frame sections now.  We don't do
+  // this if layout may be deferred for a plugin, as the symbols are
+  // read again then.
+  if (parameters->options().threads()
+      && this->has_eh_frame_
+      && !parameters->options().relocatable()
+      && !parameters->incremental()
+      && !parameters->options().has_plugins()
+      && this->parsed_eh_frame_sections_.empty())
+    this->parse_eh_frame_sections(sd);
+
+  // When using threads the Read_symbols tasks run in parallel but the
+  // Add_symbols tasks do not, so split off any version and hash the
+  // names of the external symbols now.
+  if (parameters->options().threads())
+    {
+      const unsigned char* psyms = (fvsymtab->data()
+				    + sd->external_symbols_offset);
+      const char* names = reinterpret_cast<const char*>(fvstrtab->data());
+      size_t extcount = extsize / sym_size;
+      sd->symbol_name_hashes.resize(extcount);
+      for (size_t i = 0; i < extcount; ++i, psyms += sym_size)
+	{
+	  elfcpp::Sym<size, big_endian> sym(psyms);
+	  unsigned int st_name = sym.get_st_name();
+	  Symbol_name_hash* psnh = &sd->symbol_name_hashes[i];
+	  if (st_name >= sd->symbol_names_size)
+	    {
+	      // This is reported by Symbol_table::add_from_relobj.
+	      psnh->length = 0;
+	      psnh->hash_code = 0;
+	      continue;
+	    }
+	  const char* name = names + st_name;
+	  const char* ver = strchr(name, '@');
+	  psnh->length = ver != NULL ? ver - name : strlen(name);
+	  psnh->hash_code = string_hash<char>(name, psnh->length);
+	}
+    }
 }
 
 // Return the section index of symbol SYM.  Set *VALUE to its value in
@@ -1273,6 +1333,71 @@ Sized_relobj_file<size, big_endian>::layout_section(
     this->set_relocs_must_follow_section_writes();
 }
 
+// Read the .eh_frame sections, using the symbols in SD.  The
+// results are used by layout_eh_frame_section.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::parse_eh_frame_sections(
+    const Read_symbols_data* sd)
+{
+  const unsigned int shnum = this->shnum();
+  const unsigned char* const pshdrs = sd->section_headers->data();
+  const char* const names =
+    reinterpret_cast<const char*>(sd->section_names->data());
+
+  // Find the .eh_frame sections, and the relocation sections which
+  // apply to them, the same way that do_layout does.
+  std::vector<unsigned int> shndxes;
+  const unsigned char* p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      unsigned int sh_name = shdr.get_sh_name();
+      if (sh_name < sd->section_names_size
+	  && strcmp(names + sh_name, ".eh_frame") == 0
+	  && this->check_eh_frame_flags(&shdr))
+	shndxes.push_back(i);
+    }
+  if (shndxes.empty())
+    return;
+
+  std::vector<unsigned int> reloc_shndx(shndxes.size(), 0);
+  std::vector<unsigned int> reloc_type(shndxes.size(), elfcpp::SHT_NULL);
+  p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      unsigned int sh_type = shdr.get_sh_type();
+      if (sh_type != elfcpp::SHT_REL && sh_type != elfcpp::SHT_RELA)
+	continue;
+      unsigned int target_shndx = this->adjust_shndx(shdr.get_sh_info());
+      for (size_t j = 0; j < shndxes.size(); ++j)
+	{
+	  if (shndxes[j] != target_shndx)
+	    continue;
+	  if (reloc_shndx[j] != 0)
+	    reloc_shndx[j] = -1U;
+	  else
+	    {
+	      reloc_shndx[j] = i;
+	      reloc_type[j] = sh_type;
+	    }
+	}
+    }
+
+  for (size_t j = 0; j < shndxes.size(); ++j)
+    this->parsed_eh_frame_sections_.push_back(
+	Eh_frame::parse_ehframe_input_section(this,
+					      sd->symbols->data(),
+					      sd->symbols_size,
+					      sd->symbol_names->data(),
+					      sd->symbol_names_size,
+					      shndxes[j],
+					      reloc_shndx[j],
+					      reloc_type[j]));
+}
+
 // Layout an input .eh_frame section.
 
 template<int size, bool big_endian>
@@ -1290,6 +1415,21 @@ Sized_relobj_file<size, big_endian>::layout_eh_frame_section(
 {
   gold_assert(this->has_eh_frame_);
 
+  // Use the section contents read by parse_eh_frame_sections, if any.
+  Parsed_eh_frame_section* parsed = NULL;
+  for (typename std::vector<Parsed_eh_frame_section*>::iterator p =
+	 this->parsed_eh_frame_sections_.begin();
+       p != this->parsed_eh_frame_sections_.end();
+       ++p)
+    {
+      if ((*p)->shndx() == shndx)
+	{
+	  parsed = *p;
+	  this->parsed_eh_frame_sections_.erase(p);
+	  break;
+	}
+    }
+
   off_t offset;
   Output_section* os = layout->layout_eh_frame(this,
 					       symbols_data,
@@ -1300,6 +1440,7 @@ Sized_relobj_file<size, big_endian>::layout_eh_frame_section(
 					       shdr,
 					       reloc_shndx,
 					       reloc_type,
+					       parsed,
 					       &offset);
   this->output_sections()[shndx] = os;
   if (os == NULL || offset == -1)
@@ -1867,17 +2008,34 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
     }
 
   // When building a .gdb_index section, scan the .debug_info and
-  // .debug_types sections.
+  // .debug_types sections.  When using threads, they are scanned
+  // after the symbols read here have been released, so we give the
+  // index a lasting view of the symbols, which ends where the symbol
+  // table ends.
   gold_assert(!is_pass_one
 	      || (debug_info_sections.empty() && debug_types_sections.empty()));
+  File_view* symbols_view = NULL;
+  if (parameters->options().threads()
+      && symbols_size > 0
+      && (!debug_info_sections.empty() || !debug_types_sections.empty()))
+    {
+      typename This::Shdr symtabshdr(shdrs
+				     + this->symtab_shndx_ * This::shdr_size);
+      off_t symtab_end = (symtabshdr.get_sh_offset()
+			  + symtabshdr.get_sh_size());
+      symbols_view = this->get_lasting_view(symtab_end - symbols_size,
+					    symbols_size, true, false);
+    }
   for (std::vector<unsigned int>::const_iterator p
 	   = debug_info_sections.begin();
        p != debug_info_sections.end();
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(false, this, symbols_data, symbols_size,
-			       i, reloc_shndx[i], reloc_type[i]);
+      layout->add_to_gdb_index(false, this, symbols_data, symbols_view,
+			       symbols_size, i, reloc_shndx[i],
+			       reloc_type[i]);
+      symbols_view = NULL;
     }
   for (std::vector<unsigned int>::const_iterator p
 	   = debug_types_sections.begin();
@@ -1885,8 +2043,10 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
        ++p)
     {
       unsigned int i = *p;
-      layout->add_to_gdb_index(true, this, symbols_data, symbols_size,
-			       i, reloc_shndx[i], reloc_type[i]);
+      layout->add_to_gdb_index(true, this, symbols_data, symbols_view,
+			       symbols_size, i, reloc_shndx[i],
+			       reloc_type[i]);
+      symbols_view = NULL;
     }
 
   if (is_pass_two)
@@ -2020,10 +2180,13 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
 
   const char* sym_names =
     reinterpret_cast<const char*>(sd->symbol_names->data());
+  const Symbol_name_hash* name_hashes = NULL;
+  if (sd->symbol_name_hashes.size() == symcount)
+    name_hashes = &sd->symbol_name_hashes[0];
   symtab->add_from_relobj(this,
 			  sd->symbols->data() + sd->external_symbols_offset,
 			  symcount, this->local_symbol_count_,
-			  sym_names, sd->symbol_names_size,
+			  sym_names, sd->symbol_names_size, name_hashes,
 			  &this->symbols_,
 			  &this->defined_count_);
 
@@ -2031,6 +2194,7 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
   sd->symbols = NULL;
   delete sd->symbol_names;
   sd->symbol_names = NULL;
+  std::vector<Symbol_name_hash>().swap(sd->symbol_name_hashes);
 }
 
 // Find out if this object, that is a member of a lib group, should be included
@@ -48,11 +48,23 @@ class Pluginobj;
 class Dynobj;
 class Object_merge_map;
 class Relocatable_relocs;
+class Parsed_eh_frame_section;
 struct Symbols_data;
 
 template<typename Stringpool_char>
 class Stringpool_template;
 
+// The length and hash code of the name of an external symbol, not
+// including any version.  See Read_symbols_data::symbol_name_hashes.
+
+struct Symbol_name_hash
+{
+  // Length of the name in bytes, up to any '@'.
+  size_t length;
+  // The value of gold::string_hash for the name.
+  size_t hash_code;
+};
+
 // Data to pass from read_symbols() to add_symbols().
 
 struct Read_symbols_data
@@ -82,6 +94,12 @@ struct Read_symbols_data
   File_view* symbol_names;
   // Size of symbol name data in bytes.
   section_size_type symbol_names_size;
+  // The lengths and hash codes of the names of the external symbols.
+  // These are computed while reading the symbols, which happens in
+  // parallel when using threads, so that adding the symbols to the
+  // symbol table, which is serialized, does less work.  This is
+  // empty if they were not computed.
+  std::vector<Symbol_name_hash> symbol_name_hashes;
 
   // Version information.  This is only used on dynamic objects.
   // Version symbol data (from SHT_GNU_versym section).
@@ -552,6 +570,14 @@ class Object
   const unsigned char*
   section_contents(unsigned int shndx, section_size_type* plen, bool cache);
 
+  // Return a lasting view of the contents of a section, ignoring any
+  // compression.  Set *PLEN to the size.  This returns NULL if the
+  // object can not provide one.  The view must be deleted while the
+  // object is locked.
+  File_view*
+  section_contents_lasting_view(unsigned int shndx, section_size_type* plen)
+  { return this->do_section_contents_lasting_view(shndx, plen); }
+
   // Adjust a symbol's section index as needed.  SYMNDX is the index
   // of the symbol and SHNDX is the symbol's section from
   // get_st_shndx.  This returns the section index.  It sets
@@ -746,6 +772,13 @@ class Object
   read_multiple(const File_read::Read_multiple& rm)
   { this->input_file()->file().read_multiple(this->offset_, rm); }
 
+  // Copy SIZE bytes at START in the underlying file to OUTPUT_OFFSET
+  // in OF without reading them into memory.  Return false if that
+  // can't be done.
+  bool
+  copy_to_output_file(off_t start, section_size_type size, Output_file* of,
+		      off_t output_offset);
+
   // Stop caching views in the underlying file.
   void
   clear_view_cache_marks()
@@ -909,6 +942,12 @@ class Object
   do_section_contents(unsigned int shndx, section_size_type* plen,
 		      bool cache) = 0;
 
+  // Return a lasting view of the contents of a section.  This may be
+  // overridden by the child class.
+  virtual File_view*
+  do_section_contents_lasting_view(unsigned int, section_size_type*)
+  { return NULL; }
+
   // Get the size of a section--implemented by child class.
   virtual uint64_t
   do_section_size(unsigned int shndx) = 0;
@@ -2457,6 +2496,18 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
     return this->get_view(loc.file_offset, *plen, true, cache);
   }
 
+  // Return a lasting view of the contents of a section.
+  File_view*
+  do_section_contents_lasting_view(unsigned int shndx,
+				   section_size_type* plen)
+  {
+    Object::Location loc(this->elf_file_.section_contents(shndx));
+    *plen = convert_to_section_size_type(loc.data_size);
+    if (*plen == 0)
+      return NULL;
+    return this->get_lasting_view(loc.file_offset, *plen, true, false);
+  }
+
   // Return section flags.
   uint64_t
   do_section_flags(unsigned int shndx);
@@ -2631,6 +2682,11 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
                  const typename This::Shdr& shdr, unsigned int reloc_shndx,
                  unsigned int reloc_type);
 
+  // When using threads, read the .eh_frame sections while reading
+  // the symbols, so that different objects are read in parallel.
+  void
+  parse_eh_frame_sections(const Read_symbols_data* sd);
+
   // Layout an input .eh_frame section.
   void
   layout_eh_frame_section(Layout* layout, const unsigned char* symbols_data,
@@ -2838,6 +2894,9 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   // If this object has a GNU style .eh_frame section that is discarded in
   // output, record the index here.  Otherwise it is -1U.
   unsigned int discarded_eh_frame_shndx_;
+  // The .eh_frame sections read by parse_eh_frame_sections which have
+  // not yet been laid out.
+  std::vector<Parsed_eh_frame_section*> parsed_eh_frame_sections_;
   // True if the layout of this object was deferred, waiting for plugin
   // replacement files.
   bool is_deferred_layout_;
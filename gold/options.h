@@ -649,6 +649,11 @@ class General_options
 	      N_("(aarch64 only) Do not apply link-time values "
 	         "for dynamic relocations"));
 
+  DEFINE_string(archive_cache, options::TWO_DASHES, '\0', NULL,
+		N_("Cache archive symbol tables in DIRECTORY "
+		   "(never pruned)"),
+		N_("DIRECTORY"));
+
   DEFINE_bool(as_needed, options::TWO_DASHES, '\0', false,
 	      N_("Only set DT_NEEDED for shared libraries if used"),
 	      N_("Always DT_NEEDED for shared libraries"));
@@ -664,6 +669,10 @@ class General_options
   DEFINE_string(format, options::TWO_DASHES, 'b', "elf",
 		N_("Set input format"), ("[elf,binary]"));
 
+  DEFINE_bool(batch_relocs, options::TWO_DASHES, '\0', false,
+	      N_("Apply simple relocations in batches by type"),
+	      N_("Apply relocations one at a time (default)"));
+
   DEFINE_bool(Bdynamic, options::ONE_DASH, '\0', true,
 	      N_("-l searches for shared libraries"), NULL);
   DEFINE_bool_alias(Bstatic, Bdynamic, options::ONE_DASH, '\0',
@@ -705,6 +714,24 @@ class General_options
 	      ("[none,zlib,zlib-gnu,zlib-gabi]"),
 	      {"none", "zlib", "zlib-gnu", "zlib-gabi"});
 
+  DEFINE_uint64(compress_debug_sections_chunk_size, options::TWO_DASHES,
+		'\0', 0,
+		N_("Chunk size for '--compress-debug-sections'; chunks are "
+		   "compressed in parallel with '--threads', but compress "
+		   "slightly worse.  0 means one chunk.  The default is "
+		   "1 MiB with '--threads', otherwise one chunk"),
+		N_("SIZE"));
+
+  DEFINE_bool(copy_file_range, options::TWO_DASHES, '\0', false,
+	      N_("Let the kernel copy input sections which need no changes "
+		 "directly to the output file"),
+	      N_("Copy all input sections through memory (default)"));
+
+  DEFINE_uint64(copy_file_range_min_size, options::TWO_DASHES, '\0',
+		64 << 10,
+		N_("Minimum size of an input section for '--copy-file-range'"),
+		N_("SIZE"));
+
   DEFINE_bool(copy_dt_needed_entries, options::TWO_DASHES, '\0', false,
 	      N_("Not supported"),
 	      N_("Do not copy DT_NEEDED tags from shared libraries"));
@@ -949,6 +976,11 @@ class General_options
 	      N_("Map the output file for writing (default)."),
 	      N_("Do not map the output file for writing."));
 
+  DEFINE_bool(stream_output_file, options::TWO_DASHES, '\0', false,
+	      N_("Write the output file piece by piece in file offset "
+		 "order, without keeping it all in memory"),
+	      N_("Do not stream the output file (default)"));
+
   DEFINE_bool(print_map, options::TWO_DASHES, 'M', false,
 	      N_("Write map file on standard output"), NULL);
   DEFINE_string(Map, options::ONE_DASH, '\0', NULL, N_("Write map file"),
@@ -1022,6 +1054,11 @@ class General_options
 		 " (default)."),
 	      N_("Use fallocate or ftruncate to reserve space."));
 
+  DEFINE_bool(prefetch_inputs, options::TWO_DASHES, '\0', false,
+	      N_("Start reading the symbol tables and relocations of the "
+		 "input files in advance"),
+	      N_("Read input files only when they are needed (default)"));
+
   DEFINE_bool(preread_archive_symbols, options::TWO_DASHES, '\0', false,
 	      N_("Preread archive symbols when multi-threaded"), NULL);
 
@@ -1155,6 +1192,11 @@ class General_options
   DEFINE_bool(trace, options::TWO_DASHES, 't', false,
 	      N_("Print the name of each input file"), NULL);
 
+  DEFINE_string(trace_tasks, options::TWO_DASHES, '\0', NULL,
+		N_("Write a trace of the tasks run by the linker to FILE, "
+		   "in Chrome trace event format"),
+		N_("FILE"));
+
   DEFINE_special(script, options::TWO_DASHES, 'T',
 		 N_("Read linker script"), N_("FILE"));
 
@@ -1169,6 +1211,13 @@ class General_options
 	      N_("Number of threads to use in middle pass"), N_("COUNT"));
   DEFINE_uint(thread_count_final, options::TWO_DASHES, '\0', 0,
 	      N_("Number of threads to use in final pass"), N_("COUNT"));
+  DEFINE_bool(work_stealing, options::TWO_DASHES, '\0', false,
+	      N_("Give each thread its own queue of tasks, taking tasks "
+		 "from other threads when it runs out"),
+	      N_("Use one queue of tasks for all threads (default)"));
+  DEFINE_uint(merge_string_shards, options::TWO_DASHES, '\0', 16,
+	      N_("Number of shards to use when merging strings with "
+		 "--threads; 1 to merge strings serially"), N_("COUNT"));
 
   DEFINE_uint64(Tbss, options::ONE_DASH, '\0', -1U,
 		N_("Set the address of the bss segment"), N_("ADDRESS"));
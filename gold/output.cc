@@ -44,6 +44,7 @@
 #include "merge.h"
 #include "descriptors.h"
 #include "layout.h"
+#include "gold-threads.h"
 #include "output.h"
 
 // For systems without mmap support.
@@ -4055,6 +4056,31 @@ Output_section::print_merge_stats()
     p->print_merge_stats(this->name_);
 }
 
+// Queue the tasks to merge strings in parallel for the merge sections
+// in this output section.
+
+void
+Output_section::queue_merge_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  for (Input_section_list::iterator p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    if (p->is_merge_section())
+      p->output_merge_base()->queue_merge_tasks(workqueue, blocker);
+}
+
+// Finish the merging done by the tasks queued by queue_merge_tasks.
+
+void
+Output_section::finish_merge_tasks(const Task* task)
+{
+  for (Input_section_list::iterator p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    if (p->is_merge_section())
+      p->output_merge_base()->finish_merge_tasks(task);
+}
+
 // Set a fixed layout for the section.  Used for incremental update links.
 
 void
@@ -4939,7 +4965,13 @@ Output_file::Output_file(const char* name)
     base_(NULL),
     map_is_anonymous_(false),
     map_is_allocated_(false),
-    is_temporary_(false)
+    is_temporary_(false),
+    is_streamed_(false),
+    stream_lock_(NULL),
+    streamed_page_refs_(),
+    streamed_page_states_(),
+    streamed_ranges_(),
+    streamed_bytes_(0)
 {
 }
 
@@ -5100,7 +5132,26 @@ Output_file::resize(off_t file_size)
   // If the mmap is mapping an anonymous memory buffer, this is easy:
   // just mremap to the new size.  If it's mapping to a file, we want
   // to unmap to flush to the file, then remap after growing the file.
-  if (this->map_is_anonymous_)
+  if (this->is_streamed_)
+    {
+      // Nothing has a view at this point, so the map can move.  The
+      // file has to grow as well, since released pages are read back
+      // from it.
+      void* base = ::mremap(this->base_, this->file_size_, file_size,
+			    MREMAP_MAYMOVE);
+      if (base == MAP_FAILED)
+	gold_fatal(_("%s: mremap: %s"), this->name_, strerror(errno));
+      int err = gold_fallocate(this->o_, 0, file_size);
+      if (err != 0)
+	gold_fatal(_("%s: %s"), this->name_, strerror(err));
+      this->base_ = static_cast<unsigned char*>(base);
+      this->file_size_ = file_size;
+      size_t pages = ((file_size + stream_page_size - 1)
+		      / stream_page_size);
+      this->streamed_page_refs_.resize(pages, 0);
+      this->streamed_page_states_.resize(pages, STREAMED_PAGE_RESIDENT);
+    }
+  else if (this->map_is_anonymous_)
     {
       void* base;
       if (!this->map_is_allocated_)
@@ -5131,6 +5182,42 @@ Output_file::resize(off_t file_size)
     }
 }
 
+// Copy SIZE bytes from DESCRIPTOR at IN_OFFSET to the output file at
+// OUT_OFFSET using copy_file_range.  The output file is mapped shared,
+// so the data is then visible in the output views.  This can fail if
+// the kernel or file systems do not support it; the caller then
+// writes the data itself.
+
+bool
+Output_file::copy_from_descriptor(int descriptor, off_t in_offset,
+				  off_t out_offset, size_t size)
+{
+#ifdef HAVE_COPY_FILE_RANGE
+  // An anonymous map is written to the file when it is closed, or for
+  // --stream-output-file when the view is finished, which would
+  // overwrite anything copied now.
+  if (this->map_is_anonymous_ || this->is_streamed_ || this->o_ < 0)
+    return false;
+
+  gold_assert(out_offset >= 0
+	      && out_offset + static_cast<off_t>(size) <= this->file_size_);
+
+  loff_t in = in_offset;
+  loff_t out = out_offset;
+  while (size > 0)
+    {
+      ssize_t len = ::copy_file_range(descriptor, &in, this->o_, &out,
+				      size, 0);
+      if (len <= 0)
+	return false;
+      size -= len;
+    }
+  return true;
+#else
+  return false;
+#endif
+}
+
 // Map an anonymous block of memory which will later be written to the
 // file.  Return whether the map succeeded.
 
@@ -5202,11 +5289,275 @@ Output_file::map_no_anonymous(bool writable)
   return true;
 }
 
+// Set up to write the file with --stream-output-file.  The file is
+// built in an anonymous map, as when it can't be mapped, but the
+// parts of it which are finished are written out and their pages
+// released during the link, so that the whole file is never in
+// memory at once.  The map only reserves address space.  Return
+// whether the file can be streamed.
+
+bool
+Output_file::map_streamed()
+{
+#ifndef MADV_DONTNEED
+  return false;
+#else
+  // Pages are written with pwrite and read back with pread, so this
+  // only works for a regular file.
+  const int o = this->o_;
+  struct stat statbuf;
+  if (o == STDOUT_FILENO || o == STDERR_FILENO
+      || ::fstat(o, &statbuf) != 0
+      || !S_ISREG(statbuf.st_mode)
+      || this->is_temporary_)
+    return false;
+
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+  flags |= MAP_NORESERVE;
+#endif
+  void* base = ::mmap(NULL, this->file_size_, PROT_READ | PROT_WRITE,
+		      flags, -1, 0);
+  if (base == MAP_FAILED)
+    return false;
+
+  // As in map_no_anonymous, make sure that we have the disk space.
+  // This also sets the size of the file, so that the parts of it
+  // which are never written read back as zero.
+  int err = gold_fallocate(o, 0, this->file_size_);
+  if (err != 0)
+    gold_fatal(_("%s: %s"), this->name_, strerror(err));
+
+  this->base_ = static_cast<unsigned char*>(base);
+  this->map_is_anonymous_ = false;
+  this->is_streamed_ = true;
+  this->stream_lock_ = new Lock();
+  size_t pages = (this->file_size_ + stream_page_size - 1) / stream_page_size;
+  this->streamed_page_refs_.resize(pages, 0);
+  this->streamed_page_states_.resize(pages, STREAMED_PAGE_RESIDENT);
+  return true;
+#endif
+}
+
+// Start a view of a streamed file.  Count the view against each of
+// its pages, so that they are not released while it is in use, and
+// read back any of them which were released.
+
+void
+Output_file::get_streamed_view(off_t start, size_t size, bool keep)
+{
+  if (size == 0)
+    return;
+  size_t first = start / stream_page_size;
+  size_t last = (start + size - 1) / stream_page_size;
+
+  Hold_lock hl(*this->stream_lock_);
+  this->restore_streamed_pages(first, last);
+  for (size_t i = first; i <= last; ++i)
+    {
+      if (keep)
+	this->streamed_page_states_[i] = STREAMED_PAGE_KEPT;
+      else
+	++this->streamed_page_refs_[i];
+    }
+}
+
+// Finish a view of a streamed file.  Its bytes are final, so queue
+// them to be written.  Once enough are queued, write them all.
+
+void
+Output_file::write_streamed_view(off_t start, size_t size)
+{
+  if (size == 0)
+    return;
+  off_t end = start + static_cast<off_t>(size);
+  size_t first = start / stream_page_size;
+  size_t last = (end - 1) / stream_page_size;
+
+  Hold_lock hl(*this->stream_lock_);
+  for (size_t i = first; i <= last; ++i)
+    {
+      gold_assert(this->streamed_page_refs_[i] > 0);
+      --this->streamed_page_refs_[i];
+    }
+
+  // Merge the range with any queued ranges it overlaps or touches.
+  Streamed_ranges::iterator p = this->streamed_ranges_.lower_bound(start);
+  if (p != this->streamed_ranges_.begin())
+    {
+      Streamed_ranges::iterator prev = p;
+      --prev;
+      if (prev->second >= start)
+	p = prev;
+    }
+  while (p != this->streamed_ranges_.end() && p->first <= end)
+    {
+      start = std::min(start, p->first);
+      end = std::max(end, p->second);
+      this->streamed_ranges_.erase(p++);
+    }
+  this->streamed_ranges_.insert(std::make_pair(start, end));
+
+  this->streamed_bytes_ += size;
+  if (this->streamed_bytes_ >= stream_buffer_size)
+    this->flush_streamed_views();
+}
+
+// Copy part of a streamed file, reading back any released pages from
+// the file.  This is used to read the file, as for the build ID,
+// without bringing released pages back into memory.
+
+const unsigned char*
+Output_file::read_streamed_view(off_t start, size_t size)
+{
+  gold_assert(start >= 0
+	      && start + static_cast<off_t>(size) <= this->file_size_);
+  unsigned char* buf =
+    static_cast<unsigned char*>(malloc(std::max(size, size_t(1))));
+  if (buf == NULL)
+    gold_nomem();
+
+  Hold_lock hl(*this->stream_lock_);
+  off_t end = start + static_cast<off_t>(size);
+  off_t off = start;
+  while (off < end)
+    {
+      size_t page = off / stream_page_size;
+      off_t page_end = std::min(static_cast<off_t>((page + 1)
+						   * stream_page_size),
+				end);
+      size_t len = page_end - off;
+      unsigned char* p = buf + (off - start);
+      if (this->streamed_page_states_[page] != STREAMED_PAGE_RELEASED)
+	memcpy(p, this->base_ + off, len);
+      else
+	{
+	  ssize_t got = ::pread(this->o_, p, len, off);
+	  if (got < 0)
+	    gold_fatal(_("%s: pread: %s"), this->name_, strerror(errno));
+	  if (static_cast<size_t>(got) != len)
+	    gold_fatal(_("%s: pread: unexpected end of file"), this->name_);
+	}
+      off = page_end;
+    }
+  return buf;
+}
+
+// Read back the released pages from FIRST to LAST.
+
+void
+Output_file::restore_streamed_pages(size_t first, size_t last)
+{
+  size_t i = first;
+  while (i <= last)
+    {
+      if (this->streamed_page_states_[i] != STREAMED_PAGE_RELEASED)
+	{
+	  ++i;
+	  continue;
+	}
+      size_t j = i + 1;
+      while (j <= last
+	     && this->streamed_page_states_[j] == STREAMED_PAGE_RELEASED)
+	++j;
+
+      off_t off = i * stream_page_size;
+      off_t end = std::min(static_cast<off_t>(j * stream_page_size),
+			   this->file_size_);
+      while (off < end)
+	{
+	  ssize_t got = ::pread(this->o_, this->base_ + off, end - off, off);
+	  if (got < 0)
+	    gold_fatal(_("%s: pread: %s"), this->name_, strerror(errno));
+	  if (got == 0)
+	    gold_fatal(_("%s: pread: unexpected end of file"), this->name_);
+	  off += got;
+	}
+
+      for (; i < j; ++i)
+	this->streamed_page_states_[i] = STREAMED_PAGE_RESIDENT;
+    }
+}
+
+// Write the bytes from START to END of the map to the file.
+
+void
+Output_file::write_streamed_range(off_t start, off_t end)
+{
+  while (start < end)
+    {
+      ssize_t len = ::pwrite(this->o_, this->base_ + start, end - start,
+			     start);
+      if (len < 0)
+	gold_fatal(_("%s: pwrite: %s"), this->name_, strerror(errno));
+      if (len == 0)
+	gold_fatal(_("%s: pwrite: unexpected 0 return-value"), this->name_);
+      start += len;
+    }
+}
+
+// Write the queued ranges in file offset order.  Then release every
+// page they touch which has no view in progress and is not kept.
+// Nothing else on such a page can differ from the file: any other
+// bytes on it were either written here, written by an earlier flush,
+// or never written at all.
+
+void
+Output_file::flush_streamed_views()
+{
+  for (Streamed_ranges::const_iterator p = this->streamed_ranges_.begin();
+       p != this->streamed_ranges_.end();
+       ++p)
+    this->write_streamed_range(p->first, p->second);
+
+  for (Streamed_ranges::const_iterator p = this->streamed_ranges_.begin();
+       p != this->streamed_ranges_.end();
+       ++p)
+    {
+      size_t first = p->first / stream_page_size;
+      size_t last = (p->second - 1) / stream_page_size;
+      size_t i = first;
+      while (i <= last)
+	{
+	  if (this->streamed_page_refs_[i] != 0
+	      || this->streamed_page_states_[i] != STREAMED_PAGE_RESIDENT)
+	    {
+	      ++i;
+	      continue;
+	    }
+	  size_t j = i;
+	  while (j <= last
+		 && this->streamed_page_refs_[j] == 0
+		 && this->streamed_page_states_[j] == STREAMED_PAGE_RESIDENT)
+	    {
+	      this->streamed_page_states_[j] = STREAMED_PAGE_RELEASED;
+	      ++j;
+	    }
+	  off_t off = i * stream_page_size;
+	  off_t end = std::min(static_cast<off_t>(j * stream_page_size),
+			       this->file_size_);
+#ifdef MADV_DONTNEED
+	  if (::madvise(this->base_ + off, end - off, MADV_DONTNEED) != 0)
+	    gold_fatal(_("%s: madvise: %s"), this->name_, strerror(errno));
+#endif
+	  i = j;
+	}
+    }
+
+  this->streamed_ranges_.clear();
+  this->streamed_bytes_ = 0;
+}
+
 // Map the file into memory.
 
 void
 Output_file::map()
 {
+  if (parameters->options().stream_output_file()
+      && !parameters->incremental()
+      && this->map_streamed())
+    return;
+
   if (parameters->options().mmap_output_file()
       && this->map_no_anonymous(true))
     return;
@@ -5229,7 +5580,7 @@ Output_file::map()
 void
 Output_file::unmap()
 {
-  if (this->map_is_anonymous_)
+  if (this->map_is_anonymous_ || this->is_streamed_)
     {
       // We've already written out the data, so there is no reason to
       // waste time unmapping or freeing the memory.
@@ -5247,6 +5598,32 @@ Output_file::unmap()
 void
 Output_file::close()
 {
+  // Write what is left of a streamed file: the views not yet written,
+  // and the pages kept for input/output views.
+  if (this->is_streamed_)
+    {
+      Hold_lock hl(*this->stream_lock_);
+      this->flush_streamed_views();
+      size_t pages = this->streamed_page_states_.size();
+      size_t i = 0;
+      while (i < pages)
+	{
+	  if (this->streamed_page_states_[i] != STREAMED_PAGE_KEPT)
+	    {
+	      ++i;
+	      continue;
+	    }
+	  size_t j = i + 1;
+	  while (j < pages
+		 && this->streamed_page_states_[j] == STREAMED_PAGE_KEPT)
+	    ++j;
+	  off_t end = std::min(static_cast<off_t>(j * stream_page_size),
+			       this->file_size_);
+	  this->write_streamed_range(i * stream_page_size, end);
+	  i = j;
+	}
+    }
+
   // If the map isn't file-backed, we need to write it now.
   if (this->map_is_anonymous_ && !this->is_temporary_)
     {
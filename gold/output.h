@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <list>
+#include <map>
 #include <vector>
 
 #include "elfcpp.h"
@@ -36,6 +37,7 @@ namespace gold
 {
 
 class General_options;
+class Lock;
 class Object;
 class Symbol;
 class Output_merge_base;
@@ -95,12 +97,18 @@ class Output_file
   { return this->name_; }
 
   // We currently always use mmap which makes the view handling quite
-  // simple.  In the future we may support other approaches.
+  // simple.  With --stream-output-file the map is anonymous, and the
+  // parts of it which are finished are written out and released
+  // during the link; see write_streamed_view.
 
   // Write data to the output file.
   void
   write(off_t offset, const void* data, size_t len)
-  { memcpy(this->base_ + offset, data, len); }
+  {
+    unsigned char* view = this->get_output_view(offset, len);
+    memcpy(view, data, len);
+    this->write_output_view(offset, len, view);
+  }
 
   // Get a buffer to use to write to the file, given the offset into
   // the file and the size.
@@ -109,22 +117,43 @@ class Output_file
   {
     gold_assert(start >= 0
 		&& start + static_cast<off_t>(size) <= this->file_size_);
+    if (this->is_streamed_)
+      this->get_streamed_view(start, size, false);
     return this->base_ + start;
   }
 
   // VIEW must have been returned by get_output_view.  Write the
   // buffer to the file, passing in the offset and the size.
   void
-  write_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_output_view(off_t start, size_t size, unsigned char*)
+  {
+    if (this->is_streamed_)
+      this->write_streamed_view(start, size);
+  }
+
+  // Copy SIZE bytes at offset IN_OFFSET in the file open on
+  // DESCRIPTOR to offset OUT_OFFSET in the output file, letting the
+  // kernel move the data without reading it into memory.  Return
+  // false if that can't be done, in which case the data must be
+  // written some other way.
+  bool
+  copy_from_descriptor(int descriptor, off_t in_offset, off_t out_offset,
+		       size_t size);
 
   // Get a read/write buffer.  This is used when we want to write part
   // of the file, read it in, and write it again.
   unsigned char*
   get_input_output_view(off_t start, size_t size)
-  { return this->get_output_view(start, size); }
+  {
+    gold_assert(start >= 0
+		&& start + static_cast<off_t>(size) <= this->file_size_);
+    if (this->is_streamed_)
+      this->get_streamed_view(start, size, true);
+    return this->base_ + start;
+  }
 
-  // Write a read/write buffer back to the file.
+  // Write a read/write buffer back to the file.  A streamed file
+  // keeps these views in memory until it is closed.
   void
   write_input_output_view(off_t, size_t, unsigned char*)
   { }
@@ -133,12 +162,19 @@ class Output_file
   // of the file back it in.
   const unsigned char*
   get_input_view(off_t start, size_t size)
-  { return this->get_output_view(start, size); }
+  {
+    if (this->is_streamed_)
+      return this->read_streamed_view(start, size);
+    return this->get_output_view(start, size);
+  }
 
   // Release a read bfufer.
   void
-  free_input_view(off_t, size_t, const unsigned char*)
-  { }
+  free_input_view(off_t, size_t, const unsigned char* view)
+  {
+    if (this->is_streamed_)
+      free(const_cast<unsigned char*>(view));
+  }
 
  private:
   // Map the file into memory or, if that fails, allocate anonymous
@@ -158,6 +194,62 @@ class Output_file
   void
   unmap();
 
+  // Map anonymous memory for --stream-output-file.  Return whether
+  // the file can be streamed.
+  bool
+  map_streamed();
+
+  // Start a view of SIZE bytes at START of a streamed file.  If KEEP
+  // is true, the view is an input/output view, which gold tends to
+  // take again and again, and its pages are kept until the file is
+  // closed.
+  void
+  get_streamed_view(off_t start, size_t size, bool keep);
+
+  // Finish a view started by get_streamed_view.
+  void
+  write_streamed_view(off_t start, size_t size);
+
+  // Return a copy of SIZE bytes at START of a streamed file, which the
+  // caller must free.
+  const unsigned char*
+  read_streamed_view(off_t start, size_t size);
+
+  // Read back pages FIRST to LAST of a streamed file which have been
+  // released.  The caller must hold stream_lock_.
+  void
+  restore_streamed_pages(size_t first, size_t last);
+
+  // Write the bytes from START to END of a streamed file.
+  void
+  write_streamed_range(off_t start, off_t end);
+
+  // Write the finished views of a streamed file and release their
+  // pages.  The caller must hold stream_lock_.
+  void
+  flush_streamed_views();
+
+  // The state of a page of a streamed file.
+  enum Streamed_page_state
+  {
+    // The page is in memory.
+    STREAMED_PAGE_RESIDENT,
+    // The page has been written to the file and released.
+    STREAMED_PAGE_RELEASED,
+    // The page is in memory until the file is closed.
+    STREAMED_PAGE_KEPT
+  };
+
+  // The byte ranges of finished views which have not been written
+  // yet, as a map from the start of each range to its end.
+  typedef std::map<off_t, off_t> Streamed_ranges;
+
+  // The unit in which a streamed file is released.  This must be a
+  // multiple of the system page size.
+  static const size_t stream_page_size = 64 * 1024;
+  // Finished views are written once they add up to this many bytes.
+  static const size_t stream_buffer_size = 32 << 20;
+
   // File name.
   const char* name_;
   // File descriptor.
@@ -172,6 +264,19 @@ class Output_file
   bool map_is_allocated_;
   // True if this is a temporary file which should not be output.
   bool is_temporary_;
+  // True if the file is written with --stream-output-file.
+  bool is_streamed_;
+  // Protects the fields below, which are only used with
+  // --stream-output-file.
+  Lock* stream_lock_;
+  // The number of unfinished views of each page.
+  std::vector<unsigned int> streamed_page_refs_;
+  // The state of each page.
+  std::vector<unsigned char> streamed_page_states_;
+  // The finished views which have not been written.
+  Streamed_ranges streamed_ranges_;
+  // The total size of streamed_ranges_.
+  size_t streamed_bytes_;
 };
 
 // An abtract class for data which has to go into the output file.
@@ -4090,6 +4195,16 @@ class Output_section : public Output_data
   void
   print_merge_stats();
 
+  // Queue tasks to merge the strings in merge sections in parallel.
+  // Each task holds a blocker on BLOCKER.
+  void
+  queue_merge_tasks(Workqueue*, Task_token* blocker);
+
+  // Finish the merging done by the tasks queued by queue_merge_tasks.
+  // TASK is used to lock the input objects.
+  void
+  finish_merge_tasks(const Task* task);
+
   // Set a fixed layout for the section.  Used for incremental update links.
   void
   set_fixed_layout(uint64_t sh_addr, off_t sh_offset, off_t sh_size,
@@ -167,6 +167,9 @@ static enum ld_plugin_status
 get_input_section_size(const struct ld_plugin_section section,
                        uint64_t* secsize);
 
+static enum ld_plugin_status
+allow_concurrent_claim_file();
+
 };
 
 #endif // ENABLE_PLUGINS
@@ -211,7 +214,7 @@ Plugin::load()
   sscanf(ver, "%d.%d", &major, &minor);
 
   // Allocate and populate a transfer vector.
-  const int tv_fixed_size = 29;
+  const int tv_fixed_size = 30;
 
   int tv_size = this->args_.size() + tv_fixed_size;
   ld_plugin_tv* tv = new ld_plugin_tv[tv_size];
@@ -345,6 +348,10 @@ Plugin::load()
   tv[i].tv_tag = LDPT_GET_INPUT_SECTION_SIZE;
   tv[i].tv_u.tv_get_input_section_size = get_input_section_size;
 
+  ++i;
+  tv[i].tv_tag = LDPT_ALLOW_CONCURRENT_CLAIM_FILE;
+  tv[i].tv_u.tv_allow_concurrent_claim_file = allow_concurrent_claim_file;
+
   ++i;
   tv[i].tv_tag = LDPT_NULL;
   tv[i].tv_u.tv_val = 0;
@@ -452,6 +459,7 @@ Plugin_manager::~Plugin_manager()
     delete *obj;
   this->objects_.clear();
   delete this->lock_;
+  delete this->serial_claim_file_lock_;
 }
 
 // Load all plugin libraries.
@@ -464,6 +472,34 @@ Plugin_manager::load_plugins(Layout* layout)
        this->current_ != this->plugins_.end();
        ++this->current_)
     (*this->current_)->load();
+
+  // The claim-file handlers are called from the Read_symbols tasks.
+  // When using threads, the handlers of plugins which allow it are
+  // called for several files at once.  The others, and all handlers
+  // when not using threads, are called one at a time.
+  if (!parameters->options().threads())
+    return;
+  bool any_concurrent = false;
+  bool any_serial = false;
+  for (Plugin_list::const_iterator p = this->plugins_.begin();
+       p != this->plugins_.end();
+       ++p)
+    {
+      if (!(*p)->has_claim_file_handler())
+	continue;
+      if ((*p)->allows_concurrent_claim_file())
+	any_concurrent = true;
+      else
+	any_serial = true;
+    }
+  if (any_concurrent)
+    {
+      bool lock_initialized = this->initialize_lock_.initialize();
+      gold_assert(lock_initialized);
+      this->concurrent_claim_file_ = true;
+      if (any_serial)
+	this->serial_claim_file_lock_ = new Lock();
+    }
 }
 
 // Call the plugin claim-file handlers in turn to see if any claim the file.
@@ -475,43 +511,69 @@ Plugin_manager::claim_file(Input_file* input_file, off_t offset,
   bool lock_initialized = this->initialize_lock_.initialize();
 
   gold_assert(lock_initialized);
-  Hold_lock hl(*this->lock_);
-  if (this->in_replacement_phase_)
-    return NULL;
 
-  unsigned int handle = this->objects_.size();
-  this->input_file_ = input_file;
-  this->plugin_input_file_.name = input_file->filename().c_str();
-  this->plugin_input_file_.fd = input_file->file().descriptor();
-  this->plugin_input_file_.offset = offset;
-  this->plugin_input_file_.filesize = filesize;
-  this->plugin_input_file_.handle = reinterpret_cast<void*>(handle);
-  if (elf_object != NULL)
+  // Unless the handlers may be called concurrently, hold the lock
+  // until they have all been called.  Otherwise only hold it while
+  // allocating the handle, and let other Read_symbols tasks call the
+  // handlers for their own files meanwhile.
+  Hold_optional_lock hl(this->concurrent_claim_file_ ? NULL : this->lock_);
+
+  Claim_input claim;
+  unsigned int handle;
+  {
+    Hold_optional_lock hlc(this->claim_lock());
+    if (this->in_replacement_phase_)
+      return NULL;
+
+    handle = this->objects_.size();
+    claim.input_file = input_file;
+    claim.plugin_input_file.name = input_file->filename().c_str();
+    claim.plugin_input_file.fd = input_file->file().descriptor();
+    claim.plugin_input_file.offset = offset;
+    claim.plugin_input_file.filesize = filesize;
+    claim.plugin_input_file.handle = reinterpret_cast<void*>(handle);
+    // Reserve the handle.  If this is not an ELF object, the entry
+    // stays NULL unless the file is claimed.
     this->objects_.push_back(elf_object);
-  this->in_claim_file_handler_ = true;
+    this->claim_inputs_.resize(handle + 1);
+    this->claim_inputs_[handle] = &claim;
+  }
 
-  for (this->current_ = this->plugins_.begin();
-       this->current_ != this->plugins_.end();
-       ++this->current_)
+  bool claimed = false;
+  for (Plugin_list::iterator p = this->plugins_.begin();
+       p != this->plugins_.end();
+       ++p)
     {
-      if ((*this->current_)->claim_file(&this->plugin_input_file_))
-        {
-	  this->any_claimed_ = true;
-	  this->in_claim_file_handler_ = false;
+      // A plugin which does not allow concurrent calls still has its
+      // handler called for one file at a time.
+      Hold_optional_lock hls((*p)->allows_concurrent_claim_file()
+			     ? NULL
+			     : this->serial_claim_file_lock_);
+      if ((*p)->claim_file(&claim.plugin_input_file))
+	{
+	  claimed = true;
+	  break;
+	}
+    }
 
-          if (this->objects_.size() > handle
-              && this->objects_[handle]->pluginobj() != NULL)
-            return this->objects_[handle]->pluginobj();
+  Pluginobj* obj = NULL;
+  if (claimed)
+    {
+      Object* claimed_object = this->object(handle);
+      if (claimed_object != NULL)
+	obj = claimed_object->pluginobj();
 
-          // If the plugin claimed the file but did not call the
-          // add_symbols callback, we need to create the Pluginobj now.
-          Pluginobj* obj = this->make_plugin_object(handle);
-          return obj;
-        }
+      // If the plugin claimed the file but did not call the
+      // add_symbols callback, we need to create the Pluginobj now.
+      if (obj == NULL)
+	obj = this->make_plugin_object(handle);
     }
 
-  this->in_claim_file_handler_ = false;
-  return NULL;
+  Hold_optional_lock hlc(this->claim_lock());
+  if (claimed)
+    this->any_claimed_ = true;
+  this->claim_inputs_[handle] = NULL;
+  return obj;
 }
 
 // Save an archive.  This is used so that a plugin can add a file
@@ -747,22 +809,27 @@ Plugin_manager::cleanup()
 Pluginobj*
 Plugin_manager::make_plugin_object(unsigned int handle)
 {
+  Hold_optional_lock hl(this->claim_lock());
+
+  // This can only be done while the claim-file handlers are running
+  // for the file.
+  if (handle >= this->claim_inputs_.size()
+      || this->claim_inputs_[handle] == NULL)
+    return NULL;
+
   // Make sure we aren't asked to make an object for the same handle twice.
-  if (this->objects_.size() != handle
+  if (this->objects_[handle] != NULL
       && this->objects_[handle]->pluginobj() != NULL)
     return NULL;
 
-  Pluginobj* obj = make_sized_plugin_object(this->input_file_,
-                                            this->plugin_input_file_.offset,
-                                            this->plugin_input_file_.filesize);
-
+  const Claim_input* claim = this->claim_inputs_[handle];
+  Pluginobj* obj = make_sized_plugin_object(claim->input_file,
+                                            claim->plugin_input_file.offset,
+                                            claim->plugin_input_file.filesize);
 
-  // If the elf object for this file was pushed into the objects_ vector, delete
-  // it to make room for the Pluginobj as this file is claimed.
-  if (this->objects_.size() != handle)
-    this->objects_.pop_back();
-
-  this->objects_.push_back(obj);
+  // If the elf object for this file was put in the objects_ vector,
+  // replace it with the Pluginobj, as this file is claimed.
+  this->objects_[handle] = obj;
   return obj;
 }
 
@@ -826,13 +893,14 @@ Plugin_manager::get_view(unsigned int handle, const void **viewp)
   off_t offset;
   size_t filesize;
   Input_file *input_file;
-  if (this->in_claim_file_handler_)
+  const Claim_input* claim = this->claim_input(handle);
+  if (claim != NULL)
     {
       // We are being called from the claim_file hook.
-      const struct ld_plugin_input_file &f = this->plugin_input_file_;
+      const struct ld_plugin_input_file &f = claim->plugin_input_file;
       offset = f.offset;
       filesize = f.filesize;
-      input_file = this->input_file_;
+      input_file = claim->input_file;
     }
   else
     {
@@ -1656,7 +1724,8 @@ get_input_section_count(const void* handle, unsigned int* count)
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(
+	  static_cast<unsigned int>(reinterpret_cast<intptr_t>(handle))))
     return LDPS_ERR;
 
   Object* obj = parameters->options().plugins()->get_elf_object(handle);
@@ -1678,7 +1747,8 @@ get_input_section_type(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(
+	  static_cast<unsigned int>(reinterpret_cast<intptr_t>(section.handle))))
     return LDPS_ERR;
 
   Object* obj
@@ -1701,7 +1771,8 @@ get_input_section_name(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(
+	  static_cast<unsigned int>(reinterpret_cast<intptr_t>(section.handle))))
     return LDPS_ERR;
 
   Object* obj
@@ -1730,7 +1801,8 @@ get_input_section_contents(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(
+	  static_cast<unsigned int>(reinterpret_cast<intptr_t>(section.handle))))
     return LDPS_ERR;
 
   Object* obj
@@ -1759,7 +1831,8 @@ get_input_section_alignment(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(
+	  static_cast<unsigned int>(reinterpret_cast<intptr_t>(section.handle))))
     return LDPS_ERR;
 
   Object* obj
@@ -1782,7 +1855,8 @@ get_input_section_size(const struct ld_plugin_section section,
 {
   gold_assert(parameters->options().has_plugins());
 
-  if (!parameters->options().plugins()->in_claim_file_handler())
+  if (!parameters->options().plugins()->in_claim_file_handler(
+	  static_cast<unsigned int>(reinterpret_cast<intptr_t>(section.handle))))
     return LDPS_ERR;
 
   Object* obj
@@ -1795,6 +1869,17 @@ get_input_section_size(const struct ld_plugin_section section,
   return LDPS_OK;
 }
 
+// Specify that the plugin's claim-file handler may be called
+// concurrently for different input files.
+
+static enum ld_plugin_status
+allow_concurrent_claim_file()
+{
+  gold_assert(parameters->options().has_plugins());
+  parameters->options().plugins()->allow_concurrent_claim_file();
+  return LDPS_OK;
+}
+
 
 // Specify the ordering of sections in the final layout. The sections are
 // specified as (handle,shndx) pairs in the two arrays in the order in
@@ -60,7 +60,8 @@ class Plugin
       claim_file_handler_(NULL),
       all_symbols_read_handler_(NULL),
       cleanup_handler_(NULL),
-      cleanup_done_(false)
+      cleanup_done_(false),
+      allows_concurrent_claim_file_(false)
   { }
 
   ~Plugin()
@@ -97,6 +98,21 @@ class Plugin
   set_cleanup_handler(ld_plugin_cleanup_handler handler)
   { this->cleanup_handler_ = handler; }
 
+  // Note that the claim-file handler may be called concurrently.
+  void
+  set_allows_concurrent_claim_file()
+  { this->allows_concurrent_claim_file_ = true; }
+
+  // Return TRUE if the claim-file handler may be called concurrently.
+  bool
+  allows_concurrent_claim_file() const
+  { return this->allows_concurrent_claim_file_; }
+
+  // Return TRUE if there is a claim-file handler.
+  bool
+  has_claim_file_handler() const
+  { return this->claim_file_handler_ != NULL; }
+
   // Add an argument
   void
   add_option(const char* arg)
@@ -120,6 +136,9 @@ class Plugin
   ld_plugin_cleanup_handler cleanup_handler_;
   // TRUE if the cleanup handlers have been called.
   bool cleanup_done_;
+  // TRUE if the plugin called the allow_concurrent_claim_file
+  // interface.
+  bool allows_concurrent_claim_file_;
 };
 
 // A manager class for plugins.
@@ -128,14 +147,14 @@ class Plugin_manager
 {
  public:
   Plugin_manager(const General_options& options)
-    : plugins_(), objects_(), deferred_layout_objects_(), input_file_(NULL),
-      plugin_input_file_(), rescannable_(), undefined_symbols_(),
+    : plugins_(), objects_(), deferred_layout_objects_(), claim_inputs_(),
+      rescannable_(), undefined_symbols_(),
       any_claimed_(false), in_replacement_phase_(false), any_added_(false),
-      in_claim_file_handler_(false),
+      concurrent_claim_file_(false),
       options_(options), workqueue_(NULL), task_(NULL), input_objects_(NULL),
       symtab_(NULL), layout_(NULL), dirpath_(NULL), mapfile_(NULL),
       this_blocker_(NULL), extra_search_path_(), lock_(NULL),
-      initialize_lock_(&lock_)
+      initialize_lock_(&lock_), serial_claim_file_lock_(NULL)
   { this->current_ = plugins_.end(); }
 
   ~Plugin_manager();
@@ -167,10 +186,11 @@ class Plugin_manager
   Object*
   get_elf_object(const void* handle);
 
-  // True if the claim_file handler of the plugins is being called.
+  // True if the claim_file handler of the plugins is being called for
+  // the file with this handle.
   bool
-  in_claim_file_handler()
-  { return in_claim_file_handler_; }
+  in_claim_file_handler(unsigned int handle) const
+  { return this->claim_input(handle) != NULL; }
 
   // Let the plugin manager save an archive for later rescanning.
   // This takes ownership of the Archive pointer.
@@ -226,6 +246,15 @@ class Plugin_manager
     (*this->current_)->set_cleanup_handler(handler);
   }
 
+  // Note that the current plugin's claim-file handler may be called
+  // concurrently.
+  void
+  allow_concurrent_claim_file()
+  {
+    gold_assert(this->current_ != plugins_.end());
+    (*this->current_)->set_allows_concurrent_claim_file();
+  }
+
   // Make a new Pluginobj object.  This is called when the plugin calls
   // the add_symbols API.
   Pluginobj*
@@ -235,6 +264,7 @@ class Plugin_manager
   Object*
   object(unsigned int handle) const
   {
+    Hold_optional_lock hl(this->claim_lock());
     if (handle >= this->objects_.size())
       return NULL;
     return this->objects_[handle];
@@ -343,9 +373,34 @@ class Plugin_manager
   // The list of regular objects whose layout has been deferred.
   Deferred_layout_list deferred_layout_objects_;
 
-  // The file currently up for claim by the plugins.
-  Input_file* input_file_;
-  struct ld_plugin_input_file plugin_input_file_;
+  // A file up for claim by the plugins.
+  struct Claim_input
+  {
+    Input_file* input_file;
+    struct ld_plugin_input_file plugin_input_file;
+  };
+
+  // Return the file up for claim with this handle, or NULL if the
+  // claim-file handlers are not running for it.
+  const Claim_input*
+  claim_input(unsigned int handle) const
+  {
+    Hold_optional_lock hl(this->claim_lock());
+    if (handle >= this->claim_inputs_.size())
+      return NULL;
+    return this->claim_inputs_[handle];
+  }
+
+  // Return the lock to hold while looking at objects_ and
+  // claim_inputs_.  When the claim-file handlers are called one at a
+  // time, claim_file holds lock_ while they run, and this returns NULL.
+  Lock*
+  claim_lock() const
+  { return this->concurrent_claim_file_ ? this->lock_ : NULL; }
+
+  // For each handle, the file up for claim while the claim-file
+  // handlers are running for it, and NULL otherwise.
+  std::vector<const Claim_input*> claim_inputs_;
 
   // A list of archives and input groups being saved for possible
   // later rescanning.
@@ -365,8 +420,10 @@ class Plugin_manager
   // Whether any input files or libraries were added by a plugin.
   bool any_added_;
 
-  // Set to true when the claim_file handler of a plugin is called.
-  bool in_claim_file_handler_;
+  // Whether the claim-file handlers may be called for several files
+  // at once.  This is true when using threads and some plugin with a
+  // claim-file handler allows it.
+  bool concurrent_claim_file_;
 
   const General_options& options_;
   Workqueue* workqueue_;
@@ -383,6 +440,11 @@ class Plugin_manager
   std::string extra_search_path_;
   Lock* lock_;
   Initialize_lock initialize_lock_;
+  // When concurrent_claim_file_ is true, the lock held while calling
+  // the claim-file handlers of plugins which do not allow it, so that
+  // they are still called one at a time.  NULL if every plugin with a
+  // claim-file handler allows it.
+  Lock* serial_claim_file_lock_;
 };
 
 
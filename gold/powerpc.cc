@@ -4639,6 +4639,7 @@ Stub_table<size, big_endian>::do_write(Output_file* of)
       memcpy (p, this->targ_->savres_section()->contents(),
 	      this->targ_->savres_section()->data_size());
     }
+  of->write_output_view(off, oview_size, oview);
 }
 
 // Write out .glink.
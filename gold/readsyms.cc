@@ -84,6 +84,67 @@ class Unblock_token : public Task
   Task_token* next_blocker_;
 };
 
+// Class Prefetch_inputs.
+
+// We have to wait until the search path is complete to find the
+// libraries.
+
+Task_token*
+Prefetch_inputs::is_runnable()
+{
+  if (this->dirpath_->token()->is_blocked())
+    return this->dirpath_->token();
+  return NULL;
+}
+
+// Prefetch each input file, in command line order.
+
+void
+Prefetch_inputs::run(Workqueue*)
+{
+  for (Command_line::const_iterator p = this->cmdline_->begin();
+       p != this->cmdline_->end();
+       ++p)
+    this->prefetch_argument(&*p);
+}
+
+// Prefetch the file named by INPUT_ARGUMENT, or the files in the group
+// or lib.  We only look for the first file with a given name; if
+// Read_symbols skips an incompatible file it will read the next one
+// without help.  Errors are reported by Read_symbols.
+
+void
+Prefetch_inputs::prefetch_argument(const Input_argument* input_argument)
+{
+  if (input_argument->is_group())
+    {
+      const Input_file_group* group = input_argument->group();
+      for (Input_file_group::const_iterator p = group->begin();
+	   p != group->end();
+	   ++p)
+	this->prefetch_argument(&*p);
+    }
+  else if (input_argument->is_lib())
+    {
+      const Input_file_lib* lib = input_argument->lib();
+      for (Input_file_lib::const_iterator p = lib->begin();
+	   p != lib->end();
+	   ++p)
+	this->prefetch_argument(&*p);
+    }
+  else
+    {
+      int dirindex = 0;
+      bool is_in_sysroot;
+      std::string found_name;
+      std::string name;
+      if (Input_file::find_file(*this->dirpath_, &dirindex,
+				&input_argument->file(), &is_in_sysroot,
+				&found_name, &name, false))
+	File_read::prefetch(name);
+    }
+}
+
 // Class read_symbols.
 
 Read_symbols::~Read_symbols()
@@ -676,6 +737,23 @@ Read_member::run(Workqueue*)
   // processed from scratch.
 }
 
+// Class Read_incremental_symbols.
+
+// Read the symbols from the base file, then queue the task which adds
+// them to the symbol table.
+
+void
+Read_incremental_symbols::run(Workqueue* workqueue)
+{
+  this->object_->read_symbols(NULL);
+  workqueue->queue_next(new Add_symbols(this->input_objects_, this->symtab_,
+					this->layout_, NULL, 0, NULL,
+					this->input_argument_, this->object_,
+					this->library_, NULL,
+					this->this_blocker_,
+					this->next_blocker_));
+}
+
 // Class Check_script.
 
 Check_script::~Check_script()
@@ -38,6 +38,45 @@ class Input_group;
 class Archive;
 class Finish_group;
 
+// This Task is used for --prefetch-inputs.  It asks the kernel to
+// start reading the symbol tables and relocations of each input file
+// on the command line, so that the Read_symbols tasks, which run at
+// the same time, are less likely to wait for the disk.
+
+class Prefetch_inputs : public Task
+{
+ public:
+  // CMDLINE holds the list of input files, and DIRPATH is the list of
+  // directories to search for libraries.
+  Prefetch_inputs(const Command_line* cmdline, Dirsearch* dirpath)
+    : cmdline_(cmdline), dirpath_(dirpath)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Prefetch_inputs"; }
+
+ private:
+  // Prefetch the files named by INPUT_ARGUMENT, which may be a group.
+  void
+  prefetch_argument(const Input_argument* input_argument);
+
+  const Command_line* cmdline_;
+  Dirsearch* dirpath_;
+};
+
 // This Task is responsible for reading the symbols from an input
 // file.  This also includes reading the relocations so that we can
 // check for any that require a PLT and/or a GOT.  After the data has
@@ -221,6 +260,55 @@ class Read_member : public Task
   Task_token* next_blocker_;
 };
 
+// This Task is responsible for reading the symbols of an object file
+// that has not changed since the last incremental link.  The symbols
+// are read from the incremental information in the base file, so
+// these tasks can run in parallel; each one queues an Add_symbols
+// task, which adds the symbols to the symbol table in order.
+
+class Read_incremental_symbols : public Task
+{
+ public:
+  // THIS_BLOCKER and NEXT_BLOCKER are passed on to the Add_symbols
+  // task.
+  Read_incremental_symbols(Input_objects* input_objects,
+			   Symbol_table* symtab, Layout* layout,
+			   const Input_argument* input_argument,
+			   Object* object, Incremental_library* library,
+			   Task_token* this_blocker, Task_token* next_blocker)
+    : input_objects_(input_objects), symtab_(symtab), layout_(layout),
+      input_argument_(input_argument), object_(object), library_(library),
+      this_blocker_(this_blocker), next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Read_incremental_symbols " + this->object_->name(); }
+
+ private:
+  Input_objects* input_objects_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  const Input_argument* input_argument_;
+  Object* object_;
+  Incremental_library* library_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
 // This Task is responsible for processing an input script file that has
 // not changed since the last incremental link.
 
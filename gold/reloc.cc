@@ -687,6 +687,28 @@ Sized_relobj_file<size, big_endian>::write_sections(const Layout* layout,
   File_read::Read_multiple rm;
   bool is_sorted = true;
 
+  // With --copy-file-range we let the kernel copy large sections
+  // which we will not change to the output file.  We need to know
+  // which sections have relocations to find them.
+  std::vector<bool> has_relocs;
+  if (parameters->options().copy_file_range())
+    {
+      has_relocs.resize(shnum, false);
+      const unsigned char* p = pshdrs + This::shdr_size;
+      for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+	{
+	  typename This::Shdr shdr(p);
+	  if (shdr.get_sh_type() == elfcpp::SHT_REL
+	      || shdr.get_sh_type() == elfcpp::SHT_RELA)
+	    {
+	      unsigned int target_shndx =
+		this->adjust_shndx(shdr.get_sh_info());
+	      if (target_shndx < shnum)
+		has_relocs[target_shndx] = true;
+	    }
+	}
+    }
+
   const unsigned char* p = pshdrs + This::shdr_size;
   for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
     {
@@ -790,6 +812,13 @@ Sized_relobj_file<size, big_endian>::write_sections(const Layout* layout,
       gold_assert(output_offset == invalid_address
 		  || output_offset + view_size <= output_section_size);
 
+      bool is_ctors_reverse_view =
+	(!parameters->options().relocatable()
+	 && view_size > size / 8
+	 && (strcmp(os->name(), ".init_array") == 0
+	     || strcmp(os->name(), ".fini_array") == 0)
+	 && layout->is_ctors_in_init_array(this, i));
+
       unsigned char* view;
       if (os->requires_postprocessing())
 	{
@@ -814,10 +843,23 @@ Sized_relobj_file<size, big_endian>::write_sections(const Layout* layout,
 	      if (!must_decompress)
 		{
 		  off_t sh_offset = shdr.get_sh_offset();
-		  if (!rm.empty() && rm.back().file_offset > sh_offset)
-		    is_sorted = false;
-		  rm.push_back(File_read::Read_multiple_entry(sh_offset,
-							      view_size, view));
+		  bool copied = false;
+		  if (!has_relocs.empty()
+		      && !has_relocs[i]
+		      && !is_ctors_reverse_view
+		      && (shdr.get_sh_flags() & elfcpp::SHF_EXECINSTR) == 0
+		      && (view_size
+			  >= parameters->options().copy_file_range_min_size()))
+		    copied = this->copy_to_output_file(sh_offset, view_size,
+						       of, view_start);
+		  if (!copied)
+		    {
+		      if (!rm.empty() && rm.back().file_offset > sh_offset)
+			is_sorted = false;
+		      rm.push_back(File_read::Read_multiple_entry(sh_offset,
+								  view_size,
+								  view));
+		    }
 		}
 	    }
 	}
@@ -842,12 +884,7 @@ Sized_relobj_file<size, big_endian>::write_sections(const Layout* layout,
       pvs->view_size = view_size;
       pvs->is_input_output_view = output_offset == invalid_address;
       pvs->is_postprocessing_view = os->requires_postprocessing();
-      pvs->is_ctors_reverse_view =
-	(!parameters->options().relocatable()
-	 && view_size > size / 8
-	 && (strcmp(os->name(), ".init_array") == 0
-	     || strcmp(os->name(), ".fini_array") == 0)
-	 && layout->is_ctors_in_init_array(this, i));
+      pvs->is_ctors_reverse_view = is_ctors_reverse_view;
     }
 
   // Actually read the data.
@@ -241,6 +241,19 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 						      size_t length,
 						      bool copy,
 						      Key* pkey)
+{
+  return this->add_with_length_and_hash(s, length, string_hash(s, length),
+					copy, pkey);
+}
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_with_length_and_hash(
+    const Stringpool_char* s,
+    size_t length,
+    size_t hash_code,
+    bool copy,
+    Key* pkey)
 {
   typedef std::pair<typename String_set_type::iterator, bool> Insert_type;
 
@@ -252,7 +265,7 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
       // When we don't need to copy the string, we can call insert
       // directly.
 
-      std::pair<Hashkey, Hashval> element(Hashkey(s, length), k);
+      std::pair<Hashkey, Hashval> element(Hashkey(s, length, hash_code), k);
 
       Insert_type ins = this->string_set_.insert(element);
 
@@ -279,7 +292,7 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
   // canonicalize it by copying it into the canonical list. The hash
   // code will only be computed once.
 
-  Hashkey hk(s, length);
+  Hashkey hk(s, length, hash_code);
   typename String_set_type::const_iterator p = this->string_set_.find(hk);
   if (p != this->string_set_.end())
     {
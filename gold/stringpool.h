@@ -229,6 +229,14 @@ class Stringpool_template
   const Stringpool_char*
   add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey);
 
+  // Add string S of length LEN characters to the pool, where
+  // HASH_CODE is the value of gold::string_hash for S.  This is for
+  // callers which have already computed the hash code, possibly in
+  // another thread.
+  const Stringpool_char*
+  add_with_length_and_hash(const Stringpool_char* s, size_t len,
+			   size_t hash_code, bool copy, Key* pkey);
+
   // If the string S is present in the pool, return the canonical
   // string pointer.  Otherwise, return NULL.  If PKEY is not NULL,
   // set *PKEY to the key.
@@ -353,6 +361,10 @@ class Stringpool_template
     Hashkey(const Stringpool_char* s, size_t len)
       : string(s), length(len), hash_code(string_hash(s, len))
     { }
+
+    Hashkey(const Stringpool_char* s, size_t len, size_t hash)
+      : string(s), length(len), hash_code(hash)
+    { }
   };
 
   // Hash function.  This is trivial, since we have already computed
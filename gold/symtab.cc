@@ -1154,6 +1154,7 @@ Symbol_table::add_from_relobj(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_hash* name_hashes,
     typename Sized_relobj_file<size, big_endian>::Symbols* sympointers,
     size_t* defined)
 {
@@ -1213,7 +1214,14 @@ Symbol_table::add_from_relobj(
       // In an object file, an '@' in the name separates the symbol
       // name from the version name.  If there are two '@' characters,
       // this is the default version.
-      const char* ver = strchr(name, '@');
+      const char* ver;
+      if (name_hashes == NULL)
+	ver = strchr(name, '@');
+      else
+	{
+	  size_t len = name_hashes[i].length;
+	  ver = name[len] == '@' ? name + len : NULL;
+	}
       Stringpool::Key ver_key = 0;
       int namelen = 0;
       // IS_DEFAULT_VERSION: is the version default?
@@ -1246,7 +1254,10 @@ Symbol_table::add_from_relobj(
       // about a common symbol?
       else
 	{
-	  namelen = strlen(name);
+	  if (name_hashes == NULL)
+	    namelen = strlen(name);
+	  else
+	    namelen = name_hashes[i].length;
 	  if (!this->version_script_.empty()
 	      && st_shndx != elfcpp::SHN_UNDEF)
 	    {
@@ -1318,8 +1329,16 @@ Symbol_table::add_from_relobj(
         }
 
       Stringpool::Key name_key;
-      name = this->namepool_.add_with_length(name, namelen, true,
-					     &name_key);
+      if (name_hashes == NULL)
+	name = this->namepool_.add_with_length(name, namelen, true,
+					       &name_key);
+      else
+	{
+	  size_t hash_code = name_hashes[i].hash_code;
+	  name = this->namepool_.add_with_length_and_hash(name, namelen,
+							  hash_code, true,
+							  &name_key);
+	}
 
       Sized_symbol<size>* res;
       res = this->add_from_object(relobj, name, name_key, ver, ver_key,
@@ -3613,6 +3632,7 @@ Symbol_table::add_from_relobj<32, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_hash* name_hashes,
     Sized_relobj_file<32, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3627,6 +3647,7 @@ Symbol_table::add_from_relobj<32, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_hash* name_hashes,
     Sized_relobj_file<32, true>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3641,6 +3662,7 @@ Symbol_table::add_from_relobj<64, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_hash* name_hashes,
     Sized_relobj_file<64, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3655,6 +3677,7 @@ Symbol_table::add_from_relobj<64, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_hash* name_hashes,
     Sized_relobj_file<64, true>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -23,6 +23,8 @@
 #ifndef GOLD_TARGET_RELOC_H
 #define GOLD_TARGET_RELOC_H
 
+#include <algorithm>
+
 #include "elfcpp.h"
 #include "symtab.h"
 #include "object.h"
@@ -224,6 +226,178 @@ issue_undefined_symbol_error(const Symbol* sym)
   return true;
 }
 
+// Apply relocation I of a section, which is at PRELOCS.  This is the
+// body of the loop in relocate_section, below.  RELOCATE is the
+// target's Relocate object for the section, and COMDAT_BEHAVIOR
+// records how to handle references to discarded sections, once
+// determined.
+
+template<int size, bool big_endian, typename Target_type,
+	 typename Relocate,
+	 typename Relocate_comdat_behavior,
+	 typename Classify_reloc>
+inline void
+relocate_one_reloc(
+    const Relocate_info<size, big_endian>* relinfo,
+    Target_type* target,
+    Relocate* relocate,
+    Comdat_behavior* comdat_behavior,
+    size_t i,
+    const unsigned char* prelocs,
+    Output_section* output_section,
+    bool needs_special_offset_handling,
+    unsigned char* view,
+    typename elfcpp::Elf_types<size>::Elf_Addr view_address,
+    section_size_type view_size,
+    const Reloc_symbol_changes* reloc_symbol_changes)
+{
+  typedef typename Classify_reloc::Reltype Reltype;
+
+  Sized_relobj_file<size, big_endian>* object = relinfo->object;
+  unsigned int local_count = object->local_symbol_count();
+
+  Reltype reloc(prelocs);
+
+  section_offset_type offset =
+    convert_to_section_size_type(reloc.get_r_offset());
+
+  if (needs_special_offset_handling)
+    {
+      offset = output_section->output_offset(relinfo->object,
+					     relinfo->data_shndx,
+					     offset);
+      if (offset == -1)
+	return;
+    }
+
+  unsigned int r_sym = Classify_reloc::get_r_sym(&reloc);
+
+  const Sized_symbol<size>* sym;
+
+  Symbol_value<size> symval;
+  const Symbol_value<size> *psymval;
+  bool is_defined_in_discarded_section;
+  unsigned int shndx;
+  if (r_sym < local_count
+      && (reloc_symbol_changes == NULL
+	  || (*reloc_symbol_changes)[i] == NULL))
+    {
+      sym = NULL;
+      psymval = object->local_symbol(r_sym);
+
+      // If the local symbol belongs to a section we are discarding,
+      // and that section is a debug section, try to find the
+      // corresponding kept section and map this symbol to its
+      // counterpart in the kept section.  The symbol must not
+      // correspond to a section we are folding.
+      bool is_ordinary;
+      shndx = psymval->input_shndx(&is_ordinary);
+      is_defined_in_discarded_section =
+	(is_ordinary
+	 && shndx != elfcpp::SHN_UNDEF
+	 && !object->is_section_included(shndx)
+	 && !relinfo->symtab->is_section_folded(object, shndx));
+    }
+  else
+    {
+      const Symbol* gsym;
+      if (reloc_symbol_changes != NULL
+	  && (*reloc_symbol_changes)[i] != NULL)
+	gsym = (*reloc_symbol_changes)[i];
+      else
+	{
+	  gsym = object->global_symbol(r_sym);
+	  gold_assert(gsym != NULL);
+	  if (gsym->is_forwarder())
+	    gsym = relinfo->symtab->resolve_forwards(gsym);
+	}
+
+      sym = static_cast<const Sized_symbol<size>*>(gsym);
+      if (sym->has_symtab_index() && sym->symtab_index() != -1U)
+	symval.set_output_symtab_index(sym->symtab_index());
+      else
+	symval.set_no_output_symtab_entry();
+      symval.set_output_value(sym->value());
+      if (gsym->type() == elfcpp::STT_TLS)
+	symval.set_is_tls_symbol();
+      else if (gsym->type() == elfcpp::STT_GNU_IFUNC)
+	symval.set_is_ifunc_symbol();
+      psymval = &symval;
+
+      is_defined_in_discarded_section =
+	(gsym->is_defined_in_discarded_section()
+	 && gsym->is_undefined());
+      shndx = 0;
+    }
+
+  Symbol_value<size> symval2;
+  if (is_defined_in_discarded_section)
+    {
+      if (*comdat_behavior == CB_UNDETERMINED)
+	{
+	  std::string name = object->section_name(relinfo->data_shndx);
+	  Relocate_comdat_behavior relocate_comdat_behavior;
+	  *comdat_behavior = relocate_comdat_behavior.get(name.c_str());
+	}
+      if (*comdat_behavior == CB_PRETEND)
+	{
+	  // FIXME: This case does not work for global symbols.
+	  // We have no place to store the original section index.
+	  // Fortunately this does not matter for comdat sections,
+	  // only for sections explicitly discarded by a linker
+	  // script.
+	  bool found;
+	  typename elfcpp::Elf_types<size>::Elf_Addr value =
+	    object->map_to_kept_section(shndx, &found);
+	  if (found)
+	    symval2.set_output_value(value + psymval->input_value());
+	  else
+	    symval2.set_output_value(0);
+	}
+      else
+	{
+	  if (*comdat_behavior == CB_WARNING)
+	    gold_warning_at_location(relinfo, i, offset,
+				     _("relocation refers to discarded "
+				       "section"));
+	  symval2.set_output_value(0);
+	}
+      symval2.set_no_output_symtab_entry();
+      psymval = &symval2;
+    }
+
+  // If OFFSET is out of range, still let the target decide to
+  // ignore the relocation.  Pass in NULL as the VIEW argument so
+  // that it can return quickly without trashing an invalid memory
+  // address.
+  unsigned char *v = view + offset;
+  if (offset < 0 || static_cast<section_size_type>(offset) >= view_size)
+    v = NULL;
+
+  if (!relocate->relocate(relinfo, Classify_reloc::sh_type, target,
+			 output_section, i, prelocs, sym, psymval,
+			 v, view_address + offset, view_size))
+    return;
+
+  if (v == NULL)
+    {
+      gold_error_at_location(relinfo, i, offset,
+			     _("reloc has bad offset %zu"),
+			     static_cast<size_t>(offset));
+      return;
+    }
+
+  if (issue_undefined_symbol_error(sym))
+    gold_undefined_symbol_at_location(sym, relinfo, i, offset);
+  else if (sym != NULL
+	   && sym->visibility() != elfcpp::STV_DEFAULT
+	   && (sym->is_strong_undefined() || sym->is_from_dynobj()))
+    visibility_error(sym);
+
+  if (sym != NULL && sym->has_warning())
+    relinfo->symtab->issue_warning(sym, relinfo, i, offset);
+}
+
 // This function implements the generic part of relocation processing.
 // The template parameter Relocate must be a class type which provides
 // a single function, relocate(), which implements the machine
@@ -271,157 +445,260 @@ relocate_section(
     section_size_type view_size,
     const Reloc_symbol_changes* reloc_symbol_changes)
 {
-  typedef typename Classify_reloc::Reltype Reltype;
   const int reloc_size = Classify_reloc::reloc_size;
   Relocate relocate;
-  Relocate_comdat_behavior relocate_comdat_behavior;
-
-  Sized_relobj_file<size, big_endian>* object = relinfo->object;
-  unsigned int local_count = object->local_symbol_count();
 
   Comdat_behavior comdat_behavior = CB_UNDETERMINED;
 
   for (size_t i = 0; i < reloc_count; ++i, prelocs += reloc_size)
+    relocate_one_reloc<size, big_endian, Target_type, Relocate,
+		       Relocate_comdat_behavior, Classify_reloc>(
+      relinfo, target, &relocate, &comdat_behavior, i, prelocs,
+      output_section, needs_special_offset_handling, view, view_address,
+      view_size, reloc_symbol_changes);
+}
+
+// A relocation which relocate_section_batched applies with one of the
+// target's relocation kernels.
+
+template<int size>
+struct Batched_reloc
+{
+  // The offset of the relocation in the view.
+  section_size_type offset;
+  // The value of the symbol plus the addend.
+  typename elfcpp::Elf_types<size>::Elf_Addr value;
+  // The index of the relocation in the section.
+  size_t relnum;
+};
+
+// Apply the batched relocations from P to PEND, which all use the
+// kernel implemented by the class type Kernel, to VIEW, whose address
+// is VIEW_ADDRESS.  Kernel provides a single static function,
+// apply(), which applies one relocation and returns false if the
+// value overflows.  The indexes of those relocations are stored at
+// SLOW, so that they are applied again by the target's Relocate
+// class, which reports the error.  This returns the end of the
+// indexes stored at SLOW.
+
+template<int size, typename Kernel>
+inline size_t*
+apply_batched_relocs(unsigned char* view,
+		     typename elfcpp::Elf_types<size>::Elf_Addr view_address,
+		     const Batched_reloc<size>* p,
+		     const Batched_reloc<size>* pend,
+		     size_t* slow)
+{
+  for (; p < pend; ++p)
+    if (!Kernel::apply(view + p->offset, p->value, view_address + p->offset))
+      *slow++ = p->relnum;
+  return slow;
+}
+
+// A kernel for apply_batched_relocs which stores a VALSIZE bit value,
+// relative to the address of the relocation if PCREL is true, and
+// checks it for overflow as Relocate_functions does for CHECK.
+
+template<int size, int valsize, bool big_endian, bool pcrel,
+	 typename Relocate_functions<size, big_endian>::Overflow_check check>
+struct Batched_reloc_kernel
+{
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+  typedef typename elfcpp::Swap<valsize, big_endian>::Valtype Valtype;
+  typedef Relocate_functions<size, big_endian> Reloc_funcs;
+
+  static inline bool
+  apply(unsigned char* view, Address value, Address address)
+  {
+    if (pcrel)
+      value -= address;
+    Valtype* wv = reinterpret_cast<Valtype*>(view);
+    elfcpp::Swap<valsize, big_endian>::writeval(wv, value);
+    switch (check)
+      {
+      case Reloc_funcs::CHECK_SIGNED:
+	if (size == 32)
+	  return !Bits<valsize>::has_overflow32(value);
+	else
+	  return !Bits<valsize>::has_overflow(value);
+      case Reloc_funcs::CHECK_UNSIGNED:
+	if (size == 32)
+	  return !Bits<valsize>::has_unsigned_overflow32(value);
+	else
+	  return !Bits<valsize>::has_unsigned_overflow(value);
+      case Reloc_funcs::CHECK_NONE:
+	return true;
+      default:
+	gold_unreachable();
+      }
+  }
+};
+
+// This is like relocate_section, but the relocations which need no
+// target specific handling are applied in batches of the same type,
+// without going through the target's Relocate class.  It is only
+// used for SHT_RELA sections.
+
+// The template parameter Reloc_kernels is a class type which
+// provides a constant, kernel_count, and two static functions.
+// kernel() returns the kernel to use for a relocation type against a
+// global symbol or, if the symbol is NULL, a local symbol, given the
+// addend; it returns -1 if the relocation must go through Relocate.
+// apply() applies a run of relocations which use the same kernel,
+// normally by calling apply_batched_relocs.
+
+// Relocations against TLS or IFUNC symbols, symbols which are not
+// defined in a regular object, symbols with warnings, and symbols in
+// discarded sections always go through Relocate.  The relocations
+// are handled in blocks; within a block, the batched relocations are
+// sorted by kernel and applied first, and the others are then applied
+// in order.  If input offsets must be mapped to output
+// offsets, or there are symbol changes for -fsplit-stack, we just
+// call relocate_section.
+
+template<int size, bool big_endian, typename Target_type,
+	 typename Relocate,
+	 typename Relocate_comdat_behavior,
+	 typename Classify_reloc,
+	 typename Reloc_kernels>
+inline void
+relocate_section_batched(
+    const Relocate_info<size, big_endian>* relinfo,
+    Target_type* target,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    Output_section* output_section,
+    bool needs_special_offset_handling,
+    unsigned char* view,
+    typename elfcpp::Elf_types<size>::Elf_Addr view_address,
+    section_size_type view_size,
+    const Reloc_symbol_changes* reloc_symbol_changes)
+{
+  if (needs_special_offset_handling
+      || reloc_symbol_changes != NULL
+      || !parameters->options().batch_relocs())
     {
-      Reltype reloc(prelocs);
+      relocate_section<size, big_endian, Target_type, Relocate,
+		       Relocate_comdat_behavior, Classify_reloc>(
+	relinfo, target, prelocs, reloc_count, output_section,
+	needs_special_offset_handling, view, view_address, view_size,
+	reloc_symbol_changes);
+      return;
+    }
 
-      section_offset_type offset =
-	convert_to_section_size_type(reloc.get_r_offset());
+  typedef typename Classify_reloc::Reltype Reltype;
+  const int reloc_size = Classify_reloc::reloc_size;
+  const int kernel_count = Reloc_kernels::kernel_count;
 
-      if (needs_special_offset_handling)
-	{
-	  offset = output_section->output_offset(relinfo->object,
-						 relinfo->data_shndx,
-						 offset);
-	  if (offset == -1)
-	    continue;
-	}
+  gold_assert(Classify_reloc::sh_type == elfcpp::SHT_RELA);
 
-      unsigned int r_sym = Classify_reloc::get_r_sym(&reloc);
+  Sized_relobj_file<size, big_endian>* object = relinfo->object;
+  unsigned int local_count = object->local_symbol_count();
 
-      const Sized_symbol<size>* sym;
+  Relocate relocate;
+  Comdat_behavior comdat_behavior = CB_UNDETERMINED;
 
-      Symbol_value<size> symval;
-      const Symbol_value<size> *psymval;
-      bool is_defined_in_discarded_section;
-      unsigned int shndx;
-      if (r_sym < local_count
-	  && (reloc_symbol_changes == NULL
-	      || (*reloc_symbol_changes)[i] == NULL))
-	{
-	  sym = NULL;
-	  psymval = object->local_symbol(r_sym);
-
-          // If the local symbol belongs to a section we are discarding,
-          // and that section is a debug section, try to find the
-          // corresponding kept section and map this symbol to its
-          // counterpart in the kept section.  The symbol must not
-          // correspond to a section we are folding.
-	  bool is_ordinary;
-	  shndx = psymval->input_shndx(&is_ordinary);
-	  is_defined_in_discarded_section =
-	    (is_ordinary
-	     && shndx != elfcpp::SHN_UNDEF
-	     && !object->is_section_included(shndx)
-	     && !relinfo->symtab->is_section_folded(object, shndx));
-	}
-      else
+  // Work through the relocations in blocks, so that the batches stay
+  // in the cache.  Within a block, sort the relocations which can
+  // use a kernel by kernel, keeping them in order within a kernel,
+  // and apply each run.  Then apply the others in order.
+  const size_t block_size = 256;
+  Batched_reloc<size> batches[kernel_count][block_size];
+  size_t batch_counts[kernel_count];
+  size_t slow[block_size];
+
+  for (size_t block = 0; block < reloc_count; block += block_size)
+    {
+      size_t block_end = std::min(reloc_count, block + block_size);
+      for (int k = 0; k < kernel_count; ++k)
+	batch_counts[k] = 0;
+      size_t slow_count = 0;
+
+      const unsigned char* preloc = prelocs + block * reloc_size;
+      for (size_t i = block; i < block_end; ++i, preloc += reloc_size)
 	{
-	  const Symbol* gsym;
-	  if (reloc_symbol_changes != NULL
-	      && (*reloc_symbol_changes)[i] != NULL)
-	    gsym = (*reloc_symbol_changes)[i];
+	  Reltype reloc(preloc);
+
+	  section_offset_type offset =
+	    convert_to_section_size_type(reloc.get_r_offset());
+	  unsigned int r_sym = Classify_reloc::get_r_sym(&reloc);
+	  unsigned int r_type = Classify_reloc::get_r_type(&reloc);
+	  typename elfcpp::Elf_types<size>::Elf_Swxword addend =
+	    Classify_reloc::get_r_addend(&reloc);
+
+	  int kernel = -1;
+	  typename elfcpp::Elf_types<size>::Elf_Addr value = 0;
+	  if (offset < 0
+	      || static_cast<section_size_type>(offset) >= view_size)
+	    ;
+	  else if (r_sym < local_count)
+	    {
+	      const Symbol_value<size>* psymval = object->local_symbol(r_sym);
+	      bool is_ordinary;
+	      unsigned int shndx = psymval->input_shndx(&is_ordinary);
+	      if (!psymval->is_tls_symbol()
+		  && !psymval->is_ifunc_symbol()
+		  && (!is_ordinary
+		      || shndx == elfcpp::SHN_UNDEF
+		      || object->is_section_included(shndx)
+		      || relinfo->symtab->is_section_folded(object, shndx)))
+		{
+		  kernel = Reloc_kernels::kernel(target, r_type, NULL, psymval,
+						 addend);
+		  if (kernel >= 0)
+		    value = psymval->value(object, addend);
+		}
+	    }
 	  else
 	    {
-	      gsym = object->global_symbol(r_sym);
+	      const Symbol* gsym = object->global_symbol(r_sym);
 	      gold_assert(gsym != NULL);
 	      if (gsym->is_forwarder())
 		gsym = relinfo->symtab->resolve_forwards(gsym);
+	      const Sized_symbol<size>* sym =
+		static_cast<const Sized_symbol<size>*>(gsym);
+	      if (sym->is_defined()
+		  && !sym->is_from_dynobj()
+		  && !sym->is_placeholder()
+		  && !sym->has_warning()
+		  && sym->type() != elfcpp::STT_TLS
+		  && sym->type() != elfcpp::STT_GNU_IFUNC)
+		{
+		  kernel = Reloc_kernels::kernel(target, r_type, sym, NULL,
+						 addend);
+		  if (kernel >= 0)
+		    value = sym->value() + addend;
+		}
 	    }
 
-	  sym = static_cast<const Sized_symbol<size>*>(gsym);
-	  if (sym->has_symtab_index() && sym->symtab_index() != -1U)
-	    symval.set_output_symtab_index(sym->symtab_index());
-	  else
-	    symval.set_no_output_symtab_entry();
-	  symval.set_output_value(sym->value());
-	  if (gsym->type() == elfcpp::STT_TLS)
-	    symval.set_is_tls_symbol();
-	  else if (gsym->type() == elfcpp::STT_GNU_IFUNC)
-	    symval.set_is_ifunc_symbol();
-	  psymval = &symval;
-
-	  is_defined_in_discarded_section =
-	    (gsym->is_defined_in_discarded_section()
-	     && gsym->is_undefined());
-	  shndx = 0;
-	}
-
-      Symbol_value<size> symval2;
-      if (is_defined_in_discarded_section)
-	{
-	  if (comdat_behavior == CB_UNDETERMINED)
+	  if (kernel < 0)
 	    {
-	      std::string name = object->section_name(relinfo->data_shndx);
-	      comdat_behavior = relocate_comdat_behavior.get(name.c_str());
+	      slow[slow_count++] = i;
+	      continue;
 	    }
-	  if (comdat_behavior == CB_PRETEND)
-	    {
-	      // FIXME: This case does not work for global symbols.
-	      // We have no place to store the original section index.
-	      // Fortunately this does not matter for comdat sections,
-	      // only for sections explicitly discarded by a linker
-	      // script.
-	      bool found;
-	      typename elfcpp::Elf_types<size>::Elf_Addr value =
-		object->map_to_kept_section(shndx, &found);
-	      if (found)
-		symval2.set_output_value(value + psymval->input_value());
-	      else
-		symval2.set_output_value(0);
-	    }
-	  else
-	    {
-	      if (comdat_behavior == CB_WARNING)
-		gold_warning_at_location(relinfo, i, offset,
-					 _("relocation refers to discarded "
-					   "section"));
-	      symval2.set_output_value(0);
-	    }
-	  symval2.set_no_output_symtab_entry();
-	  psymval = &symval2;
-	}
-
-      // If OFFSET is out of range, still let the target decide to
-      // ignore the relocation.  Pass in NULL as the VIEW argument so
-      // that it can return quickly without trashing an invalid memory
-      // address.
-      unsigned char *v = view + offset;
-      if (offset < 0 || static_cast<section_size_type>(offset) >= view_size)
-	v = NULL;
-
-      if (!relocate.relocate(relinfo, Classify_reloc::sh_type, target,
-			     output_section, i, prelocs, sym, psymval,
-			     v, view_address + offset, view_size))
-	continue;
 
-      if (v == NULL)
-	{
-	  gold_error_at_location(relinfo, i, offset,
-				 _("reloc has bad offset %zu"),
-				 static_cast<size_t>(offset));
-	  continue;
+	  Batched_reloc<size>* br = &batches[kernel][batch_counts[kernel]++];
+	  br->offset = offset;
+	  br->value = value;
+	  br->relnum = i;
 	}
 
-      if (issue_undefined_symbol_error(sym))
-	gold_undefined_symbol_at_location(sym, relinfo, i, offset);
-      else if (sym != NULL
-	       && sym->visibility() != elfcpp::STV_DEFAULT
-	       && (sym->is_strong_undefined() || sym->is_from_dynobj()))
-	visibility_error(sym);
-
-      if (sym != NULL && sym->has_warning())
-	relinfo->symtab->issue_warning(sym, relinfo, i, offset);
+      size_t batched_slow_count = slow_count;
+      for (int k = 0; k < kernel_count; ++k)
+	if (batch_counts[k] > 0)
+	  slow_count = Reloc_kernels::apply(k, view, view_address,
+					    batches[k],
+					    batches[k] + batch_counts[k],
+					    slow + slow_count) - slow;
+      if (slow_count != batched_slow_count)
+	std::sort(slow, slow + slow_count);
+
+      for (size_t j = 0; j < slow_count; ++j)
+	relocate_one_reloc<size, big_endian, Target_type, Relocate,
+			   Relocate_comdat_behavior, Classify_reloc>(
+	  relinfo, target, &relocate, &comdat_behavior, slow[j],
+	  prelocs + slow[j] * reloc_size, output_section, false, view,
+	  view_address, view_size, NULL);
     }
 }
 
@@ -0,0 +1,45 @@
+#!/bin/sh
+
+# aarch64_branch_threads.sh -- test AArch64 branch stubs with --threads.
+
+# Copyright (C) 2016 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# With --threads the branch relocations which may need a stub are
+# recorded by the parallel Scan_relocs tasks.  The Makefile links
+# aarch64_branch_threads_1.o and aarch64_branch_threads_2.o with and
+# without --threads and checks that the outputs are identical.  This
+# checks that the branches out of range did get stubs, so that the
+# comparison covers the stub layout.
+
+check()
+{
+    file=$1
+
+    found_stub=`grep -e "br[ 	]*x16" "$file"`
+    if test -z "$found_stub"; then
+	echo "No branch stubs were generated"
+	echo ""
+	echo "Actual output below:"
+	cat "$file"
+	exit 1
+    fi
+}
+
+check aarch64_branch_threads.stdout
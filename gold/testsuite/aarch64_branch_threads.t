@@ -0,0 +1,33 @@
+/* aarch64_branch_threads.t -- linker script to test AArch64 stubs
+   with --threads.
+
+   Copyright (C) 2016 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* Put .text.far out of the 128 MiB range of BL and B from .text, so
+   that all the branches between them need stubs.  */
+
+SECTIONS
+{
+  . = 0x400000;
+
+  .text : { *(.text) }
+  . = 0x10000000;
+  .text.far : { *(.text.far) }
+}
@@ -0,0 +1,22 @@
+	.text
+	.global	_start
+	.type	_start, %function
+_start:
+	bl	far_1
+	bl	far_2
+	bl	near_2
+	b	far_3
+
+	.section .text.far,"ax",%progbits
+	.global	far_1
+	.type	far_1, %function
+far_1:
+	bl	_start
+	bl	near_2
+	ret
+
+	.global	far_3
+	.type	far_3, %function
+far_3:
+	bl	far_1
+	ret
@@ -0,0 +1,15 @@
+	.text
+	.global	near_2
+	.type	near_2, %function
+near_2:
+	bl	far_1
+	bl	far_2
+	bl	_start
+	b	far_3
+
+	.section .text.far,"ax",%progbits
+	.global	far_2
+	.type	far_2, %function
+far_2:
+	bl	near_2
+	b	_start
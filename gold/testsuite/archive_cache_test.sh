@@ -0,0 +1,42 @@
+#!/bin/sh
+
+# archive_cache_test.sh -- test --archive-cache.
+
+# Copyright (C) 2016 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The first link starts with an empty cache, so it reads the symbol
+# tables of the archives and writes them to the cache; the second link
+# reads them all from the cache.  The two links should produce the
+# same output.
+
+if test "`grep -c 'archive cache misses: 0' archive_cache_test.stdout`" != 1
+then
+    echo "Archive cache was not used:"
+    cat archive_cache_test.stdout
+    exit 1
+fi
+
+if ! cmp -s archive_cache_test_1 archive_cache_test_2
+then
+    echo "Output differs when archive symbol tables are read from the cache"
+    exit 1
+fi
+
+exit 0
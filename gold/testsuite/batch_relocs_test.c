@@ -0,0 +1,68 @@
+/* batch_relocs_test.c -- many simple relocations for gold
+
+   Copyright (C) 2016 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This is used by batch_relocs_test.sh to check that applying
+   relocations in batches gives the same result as applying them one at
+   a time.  It defines 1000 variables, and refers to each of them with
+   an absolute data relocation, a PC relative code relocation, and an
+   absolute code relocation.  */
+
+#define R10(m, p) \
+  m(p##0) m(p##1) m(p##2) m(p##3) m(p##4) \
+  m(p##5) m(p##6) m(p##7) m(p##8) m(p##9)
+#define R100(m, p) \
+  R10(m, p##0) R10(m, p##1) R10(m, p##2) R10(m, p##3) R10(m, p##4) \
+  R10(m, p##5) R10(m, p##6) R10(m, p##7) R10(m, p##8) R10(m, p##9)
+#define R1000(m, p) \
+  R100(m, p##0) R100(m, p##1) R100(m, p##2) R100(m, p##3) R100(m, p##4) \
+  R100(m, p##5) R100(m, p##6) R100(m, p##7) R100(m, p##8) R100(m, p##9)
+
+#define DEFINE(v) int v = 1;
+#define ADDRESSES R1000(ADDRESS, v)
+#define ADDRESS(v) &v,
+#define VALUES R1000(VALUE, v)
+#define VALUE(v) + v
+#define ABSOLUTES R1000(ABSOLUTE, v)
+#define ABSOLUTE(v) ^ (long) &v
+
+R1000(DEFINE, v)
+
+int *addresses[] =
+{
+  ADDRESSES
+};
+
+int
+batch_relocs_test_values(void)
+{
+  return (0 VALUES);
+}
+
+long
+batch_relocs_test_absolutes(void)
+{
+  return (0 ABSOLUTES);
+}
+
+void
+batch_relocs_test_start(void)
+{
+}
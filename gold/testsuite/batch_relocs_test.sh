@@ -0,0 +1,34 @@
+#!/bin/sh
+
+# batch_relocs_test.sh -- test --batch-relocs
+
+# Copyright (C) 2016 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# batch_relocs_test_1 is linked with --batch-relocs and
+# batch_relocs_test_2 with --no-batch-relocs.  Applying the
+# relocations in batches must produce exactly the same output file.
+
+if ! cmp -s batch_relocs_test_1 batch_relocs_test_2
+then
+    echo "Output differs when relocations are applied in batches"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,34 @@
+#!/bin/sh
+
+# dwp_test_threads.sh -- Test the dwp tool with --threads.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# With --threads, dwp reads and decompresses the input files in
+# parallel, but still adds them to the output in command-line order,
+# so the output should be identical to the serial output.
+
+if ! cmp -s dwp_test_1.dwp dwp_test_threads.dwp
+then
+    echo "Output differs when dwp uses threads"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,33 @@
+#!/bin/sh
+
+# gdb_index_test_threads.sh -- test --gdb-index with --threads
+
+# Copyright (C) 2016 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Scanning the debug info for --gdb-index in parallel must build
+# exactly the same index as scanning it serially.
+
+if ! cmp -s gdb_index_test_1.stdout gdb_index_test_threads.stdout
+then
+    echo "gdb_index_test_1.stdout and gdb_index_test_threads.stdout differ"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,133 @@
+#!/bin/sh
+
+# incremental_update_threads.sh -- run incremental updates with and
+# without --threads.
+
+# Copyright (C) 2016 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This links NOBJS small objects with --incremental-full, changes some
+# of them, and updates the link with --incremental-update, once
+# without and once with --threads.  It also links the changed objects
+# from scratch.  For each program it prints the exit status, and it
+# prints whether the code, data and symbols of the two updated
+# programs are the same.  The files differ in the command line saved
+# for the next update.  The results are checked by
+# incremental_update_threads_test.sh.
+
+# Usage: incremental_update_threads.sh CC LDDIR READELF [NOBJS [CHANGED]]
+
+cc="$1"
+lddir=`cd "$2" && pwd`
+readelf="$3"
+nobjs=${4:-20}
+changed=${5:-5}
+dir=incremental_update_threads.dir
+
+# Link the unchanged objects with --incremental-full, replace the
+# first $changed of them with their new versions, and update the link
+# into OUTPUT.  EXTRA holds any other linker options.
+# Usage: update OUTPUT EXTRA
+update()
+{
+    rm -f $dir/link/*
+    cp -p $dir/v1/*.o $dir/link/
+    (cd $dir/link \
+     && $cc -B$lddir/ $nopie -Wl,-z,norelro \
+	    -Wl,--incremental-full,--incremental-patch=100 $2 \
+	    -o $1 *.o) || return 1
+    i=1
+    while test $i -le $changed; do
+	cp -p $dir/v2/o$i.o $dir/link/
+	i=`expr $i + 1`
+    done
+    (cd $dir/link \
+     && $cc -B$lddir/ $nopie -Wl,-z,norelro -Wl,--incremental-update $2 \
+	    -o $1 *.o) || return 1
+    mv -f $dir/link/$1 $dir/$1
+    $readelf -W -l -s -x .text -x .data $dir/$1 > $dir/$1.dump || return 1
+}
+
+# Print the exit status of PROGRAM.
+status()
+{
+    $dir/$1
+    echo "$1: $?"
+}
+
+rm -rf $dir
+mkdir $dir $dir/v1 $dir/v2 $dir/link $dir/full
+
+# Each object defines a variable and two functions, and calls a
+# function in the next object.  The new version of each object changes
+# the size of one of its functions.
+i=1
+while test $i -le $nobjs; do
+    next=`expr $i % $nobjs + 1`
+    cat > $dir/v1/o$i.c <<EOF
+int g$i = $i;
+int f$i (int x) { return x + g$i; }
+extern int f$next (int);
+int h$i (int x) { return x > 0 ? f$next (x - 1) : 0; }
+EOF
+    sed -e "s/return x + g$i;/return x * 3 + g$i;/" \
+	< $dir/v1/o$i.c > $dir/v2/o$i.c
+    i=`expr $i + 1`
+done
+cat > $dir/v1/main.c <<EOF
+extern int h1 (int);
+int main (void) { return h1 ($nobjs) & 0x7f; }
+EOF
+
+# Incremental updates of position independent executables do not run,
+# so build ordinary executables if the compiler makes PIEs by default.
+nopie=
+if $cc -no-pie -o $dir/main $dir/v1/main.c -Dh1=abs > /dev/null 2>&1; then
+    nopie=-no-pie
+fi
+
+(cd $dir/v1 && $cc -O0 -g0 -fno-pie -ffunction-sections -c *.c) || exit 1
+(cd $dir/v2 && $cc -O0 -g0 -fno-pie -ffunction-sections -c *.c) || exit 1
+
+# The incremental update decides which objects have changed by their
+# timestamps, so make the unchanged ones older.
+touch -t 202001010000 $dir/v1/*.o
+
+# The objects as they are after the change, for the full link.
+cp -p $dir/v1/*.o $dir/full/
+i=1
+while test $i -le $changed; do
+    cp -p $dir/v2/o$i.o $dir/full/
+    i=`expr $i + 1`
+done
+(cd $dir/full && $cc -B$lddir/ $nopie -o ../full_link *.o) || exit 1
+
+update update_serial "" || exit 1
+update update_threads "-Wl,--threads" || exit 1
+
+status full_link
+status update_serial
+status update_threads
+if cmp -s $dir/update_serial.dump $dir/update_threads.dump; then
+    echo "updates: same"
+else
+    echo "updates: differ"
+fi
+
+exit 0
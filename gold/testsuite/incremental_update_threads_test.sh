@@ -0,0 +1,49 @@
+#!/bin/sh
+
+# incremental_update_threads_test.sh -- test --incremental-update
+# with --threads.
+
+# Copyright (C) 2016 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# incremental_update_threads.sh updates a link of many objects with
+# and without --threads.  Both updated programs must behave like the
+# program linked from scratch, and the two must be the same file.
+
+file=incremental_update_threads_test.stdout
+
+full=`sed -n -e 's/^full_link: //p' $file`
+for prog in update_serial update_threads
+do
+    got=`sed -n -e "s/^$prog: //p" $file`
+    if test -z "$full" || test "$got" != "$full"
+    then
+	echo "$prog exits with '$got', the full link with '$full'"
+	cat $file
+	exit 1
+    fi
+done
+
+if ! grep -q '^updates: same$' $file
+then
+    echo "Incremental update differs with --threads"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,40 @@
+#!/bin/sh
+
+# merge_string_threads.sh -- test merging strings with --threads
+
+# Copyright (C) 2016 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# Merging the strings in SHF_MERGE|SHF_STRINGS sections in parallel
+# must produce exactly the same output as merging them serially,
+# both with and without -O2 suffix merging.
+
+check_same()
+{
+    if ! cmp -s "$1" "$2"
+    then
+	echo "$1 and $2 differ"
+	exit 1
+    fi
+}
+
+check_same merge_string_threads_1.so merge_string_threads_2.so
+check_same merge_string_threads_3.so merge_string_threads_4.so
+
+exit 0
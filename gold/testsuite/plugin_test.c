@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
 #include "plugin-api.h"
 
 struct claimed_file
@@ -68,6 +70,11 @@ static ld_plugin_get_input_section_name get_input_section_name = NULL;
 static ld_plugin_get_input_section_contents get_input_section_contents = NULL;
 static ld_plugin_update_section_order update_section_order = NULL;
 static ld_plugin_allow_section_ordering allow_section_ordering = NULL;
+static ld_plugin_allow_concurrent_claim_file allow_concurrent_claim_file = NULL;
+
+/* The claim file hook may be called from several threads at once if
+   the plugin is given the "concurrent_claim_file" option.  */
+static pthread_mutex_t claimed_files_lock = PTHREAD_MUTEX_INITIALIZER;
 
 #define MAXOPTS 10
 
@@ -158,6 +165,10 @@ onload(struct ld_plugin_tv *tv)
 	case LDPT_ALLOW_SECTION_ORDERING:
 	  allow_section_ordering = *entry->tv_u.tv_allow_section_ordering;
 	  break;
+	case LDPT_ALLOW_CONCURRENT_CLAIM_FILE:
+	  allow_concurrent_claim_file =
+	    *entry->tv_u.tv_allow_concurrent_claim_file;
+	  break;
         default:
           break;
         }
@@ -247,6 +258,23 @@ onload(struct ld_plugin_tv *tv)
       return LDPS_ERR;
     }
 
+  for (i = 0; i < nopts; ++i)
+    {
+      if (strcmp(opts[i], "concurrent_claim_file") != 0)
+        continue;
+      if (allow_concurrent_claim_file == NULL)
+        {
+          fprintf(stderr,
+                  "tv_allow_concurrent_claim_file interface missing\n");
+          return LDPS_ERR;
+        }
+      if ((*allow_concurrent_claim_file)() != LDPS_OK)
+        {
+          (*message)(LDPL_ERROR, "error allowing concurrent claim file");
+          return LDPS_ERR;
+        }
+    }
+
   return LDPS_OK;
 }
 
@@ -257,6 +285,7 @@ claim_file_hook (const struct ld_plugin_input_file* file, int* claimed)
   off_t end_offset;
   char buf[160];
   struct claimed_file* claimed_file;
+  struct claimed_file** pprev;
   struct ld_plugin_symbol* syms;
   int nsyms = 0;
   int maxsyms = 0;
@@ -389,11 +418,29 @@ claim_file_hook (const struct ld_plugin_input_file* file, int* claimed)
   claimed_file->nsyms = nsyms;
   claimed_file->syms = syms;
   claimed_file->next = NULL;
-  if (last_claimed_file == NULL)
-    first_claimed_file = claimed_file;
+
+  /* Keep the list in handle order, which is the order of the files on
+     the command line, whichever thread gets here first.  */
+  pthread_mutex_lock(&claimed_files_lock);
+  if (last_claimed_file == NULL
+      || ((uintptr_t)last_claimed_file->handle
+          < (uintptr_t)claimed_file->handle))
+    {
+      if (last_claimed_file == NULL)
+        first_claimed_file = claimed_file;
+      else
+        last_claimed_file->next = claimed_file;
+      last_claimed_file = claimed_file;
+    }
   else
-    last_claimed_file->next = claimed_file;
-  last_claimed_file = claimed_file;
+    {
+      pprev = &first_claimed_file;
+      while ((uintptr_t)(*pprev)->handle < (uintptr_t)claimed_file->handle)
+        pprev = &(*pprev)->next;
+      claimed_file->next = *pprev;
+      *pprev = claimed_file;
+    }
+  pthread_mutex_unlock(&claimed_files_lock);
 
   (*message)(LDPL_INFO, "%s: claiming file, adding %d symbols",
              file->name, nsyms);
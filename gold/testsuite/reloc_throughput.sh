@@ -0,0 +1,113 @@
+#!/bin/sh
+
+# reloc_throughput.sh -- measure how quickly gold applies relocations
+
+# Copyright (C) 2016 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This is a benchmark, not a test, and make check does not run it.
+# Run it with "make reloc-throughput" in the testsuite directory.
+
+# It assembles NOBJS x86_64 objects.  Each defines 1000 global
+# symbols and has 40000 relocations: R_X86_64_64, R_X86_64_32 and
+# R_X86_64_PC32 against the symbols of the next object, and
+# R_X86_64_64 against local symbols.  Almost all of the link time is
+# then spent applying relocations.  The objects are linked ITERATIONS
+# times with --batch-relocs and ITERATIONS times with
+# --no-batch-relocs, and the fastest link of each kind is reported.
+# The two outputs must be identical.
+
+# Usage: reloc_throughput.sh AS LD [NOBJS [ITERATIONS]]
+
+as="$1"
+ld="$2"
+nobjs=${3:-40}
+iterations=${4:-7}
+dir=reloc_throughput.dir
+
+# Print the current time in milliseconds.
+now()
+{
+    t=`date +%s%N`
+    case "$t" in
+    *N*) echo "date +%s%N is not supported" 1>&2; exit 1 ;;
+    esac
+    expr $t / 1000000
+}
+
+# Link the objects ITERATIONS times into $dir/OUTPUT with OPTION, and
+# print the time of the fastest link in milliseconds.
+# Usage: best_link OUTPUT OPTION
+best_link()
+{
+    best=
+    i=0
+    while test $i -lt $iterations; do
+	start=`now`
+	$ld -e 0 -o $dir/$1 $2 $dir/*.o || exit 1
+	time=`expr \`now\` - $start`
+	if test -z "$best" || test $time -lt $best; then
+	    best=$time
+	fi
+	i=`expr $i + 1`
+    done
+    echo $best
+}
+
+rm -rf $dir
+mkdir $dir || exit 1
+
+i=0
+while test $i -lt $nobjs; do
+    awk -v i=$i -v n=$nobjs 'BEGIN {
+	next_obj = (i + 1) % n
+	print " .data"
+	for (j = 0; j < 1000; j++) {
+	    print " .globl g" i "_" j
+	    print "g" i "_" j ": .quad 0"
+	}
+	print " .section .data.relocs,\"aw\",@progbits"
+	for (k = 0; k < 10; k++)
+	    for (j = 0; j < 1000; j++) {
+		sym = "g" next_obj "_" j
+		print " .quad " sym
+		print " .long " sym
+		print " .long " sym " - ."
+		print " .quad l" j
+	    }
+	for (j = 0; j < 1000; j++)
+	    print "l" j ": .byte 0"
+    }' > $dir/r$i.s || exit 1
+    $as --64 -o $dir/r$i.o $dir/r$i.s || exit 1
+    i=`expr $i + 1`
+done
+
+batch=`best_link batch --batch-relocs` || exit 1
+nobatch=`best_link nobatch --no-batch-relocs` || exit 1
+
+echo "fastest of $iterations links of $nobjs objects, `expr $nobjs \* 40000` relocations:"
+echo "  --batch-relocs:    $batch ms"
+echo "  --no-batch-relocs: $nobatch ms"
+
+if ! cmp -s $dir/batch $dir/nobatch; then
+    echo "output differs when relocations are applied in batches"
+    exit 1
+fi
+
+exit 0
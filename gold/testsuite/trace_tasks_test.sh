@@ -0,0 +1,47 @@
+#!/bin/sh
+
+# trace_tasks_test.sh -- test --trace-tasks.
+
+# Copyright (C) 2016 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The trace written by --trace-tasks should have one complete event
+# for every task run during the link, from reading the input files
+# through closing the output file.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected event in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual trace below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check trace_tasks_test.json '^{"traceEvents":\['
+check trace_tasks_test.json '"name":"Read_symbols basic_test.o","cat":"task","ph":"X"'
+check trace_tasks_test.json '"name":"Relocate_task basic_test.o","cat":"task","ph":"X"'
+check trace_tasks_test.json '"name":"Task_function Close_task_runner"'
+check trace_tasks_test.json '"args":{"blocked_us":[0-9]*,"queued_us":[0-9]*}'
+
+exit 0
@@ -0,0 +1,306 @@
+// workqueue_bench.cc -- time many tiny tasks through the Workqueue
+
+// Copyright (C) 2016 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This is a benchmark, not a test, and make check does not run it.
+// Run it with "make workqueue-bench" in the testsuite directory.
+
+// It measures the scheduling overhead of the Workqueue, with one
+// queue shared by all threads and with --work-stealing.  A number of
+// tasks each queue many tiny tasks, which do almost nothing, and a
+// final task waits for all of them behind a blocker, as gold does
+// for its per-object and per-chunk tasks.  Half of the tiny tasks
+// also take one of a few write locks.  For each thread count the
+// fastest of several runs with each scheduler is reported.
+
+// Usage: workqueue_bench [MAX_THREADS [ITERATIONS]]
+
+#include "gold.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <sys/time.h>
+
+#include "options.h"
+#include "parameters.h"
+#include "workqueue.h"
+
+using namespace gold;
+
+namespace
+{
+
+// The number of tasks which queue tiny tasks, the number of tiny
+// tasks each one queues, and the number of write locks the tiny
+// tasks share.
+
+const unsigned int spawn_count = 200;
+const unsigned int tiny_count = 1000;
+const unsigned int lock_count = 8;
+
+// A tiny task, which counts that it ran.  If LOCK is not NULL, the
+// task holds it while it runs, and counts without an atomic
+// operation.
+
+class Tiny_task : public Task
+{
+ public:
+  Tiny_task(Task_token* blocker, Task_token* lock, unsigned int* count)
+    : blocker_(blocker), lock_(lock), count_(count)
+  { }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->lock_ != NULL && !this->lock_->is_writable())
+      return this->lock_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  {
+    tl->add(this, this->blocker_);
+    if (this->lock_ != NULL)
+      tl->add(this, this->lock_);
+  }
+
+  void
+  run(Workqueue*)
+  {
+    if (this->lock_ != NULL)
+      ++*this->count_;
+    else
+      __sync_fetch_and_add(this->count_, 1);
+  }
+
+  std::string
+  get_name() const
+  { return "Tiny_task"; }
+
+ private:
+  Task_token* blocker_;
+  Task_token* lock_;
+  unsigned int* count_;
+};
+
+// A task which queues tiny tasks.  This holds the blocker until all
+// the tiny tasks have been queued.
+
+class Spawn_task : public Task
+{
+ public:
+  Spawn_task(Task_token* blocker, Task_token** locks, unsigned int* counts)
+    : blocker_(blocker), locks_(locks), counts_(counts)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    for (unsigned int i = 0; i < tiny_count; ++i)
+      {
+	Task_token* lock = NULL;
+	unsigned int* count = &this->counts_[lock_count];
+	if (i % 2 == 0)
+	  {
+	    lock = this->locks_[(i / 2) % lock_count];
+	    count = &this->counts_[(i / 2) % lock_count];
+	  }
+	workqueue->add_blocker(this->blocker_);
+	workqueue->queue(new Tiny_task(this->blocker_, lock, count));
+      }
+  }
+
+  std::string
+  get_name() const
+  { return "Spawn_task"; }
+
+ private:
+  Task_token* blocker_;
+  Task_token** locks_;
+  unsigned int* counts_;
+};
+
+// The task which waits for all the others.
+
+class Final_task : public Task
+{
+ public:
+  Final_task(Task_token* blocker, bool* done)
+    : blocker_(blocker), done_(done)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return this->blocker_->is_blocked() ? this->blocker_ : NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*)
+  { *this->done_ = true; }
+
+  std::string
+  get_name() const
+  { return "Final_task"; }
+
+ private:
+  Task_token* blocker_;
+  bool* done_;
+};
+
+// Run all the tasks on THREADS threads, with a Workqueue created with
+// OPTIONS.  Return the time taken in microseconds, or -1 if not all
+// the tiny tasks ran before the final task.  The tiny tasks which
+// take a write lock are counted without any other locking, so a lost
+// count also means that two tasks held the same lock at once.
+
+long
+run_tasks(const General_options& options, int threads)
+{
+  // Worker threads may still be on their way out when process
+  // returns, so, as in gold itself, the Workqueue is never deleted.
+  Workqueue* workqueue = new Workqueue(options);
+
+  // Each group of four Spawn_tasks shares a set of locks, and the
+  // counts for its tiny tasks.
+  const unsigned int group_count = spawn_count / 4;
+  Task_token blocker(true);
+  std::vector<Task_token*> locks(group_count * lock_count);
+  for (unsigned int i = 0; i < locks.size(); ++i)
+    locks[i] = new Task_token(false);
+  std::vector<unsigned int> counts(group_count * (lock_count + 1));
+  bool done = false;
+
+  struct timeval start;
+  ::gettimeofday(&start, NULL);
+
+  for (unsigned int i = 0; i < spawn_count; ++i)
+    {
+      unsigned int group = i / 4;
+      blocker.add_blocker();
+      workqueue->queue(new Spawn_task(&blocker, &locks[group * lock_count],
+				      &counts[group * (lock_count + 1)]));
+    }
+  workqueue->queue(new Final_task(&blocker, &done));
+
+  workqueue->set_thread_count(threads);
+  workqueue->process(0);
+
+  struct timeval end;
+  ::gettimeofday(&end, NULL);
+
+  unsigned int total = 0;
+  for (std::vector<unsigned int>::const_iterator p = counts.begin();
+       p != counts.end();
+       ++p)
+    total += *p;
+
+  for (unsigned int i = 0; i < locks.size(); ++i)
+    delete locks[i];
+
+  if (!done || total != spawn_count * tiny_count)
+    return -1;
+  return ((end.tv_sec - start.tv_sec) * 1000000
+	  + (end.tv_usec - start.tv_usec));
+}
+
+// Return the fastest of ITERATIONS runs of run_tasks, or -1 if any of
+// them failed.
+
+long
+best_run(const General_options& options, int threads, int iterations)
+{
+  long best = -1;
+  for (int i = 0; i < iterations; ++i)
+    {
+      long t = run_tasks(options, threads);
+      if (t < 0)
+	return -1;
+      if (best < 0 || t < best)
+	best = t;
+    }
+  return best;
+}
+
+} // End anonymous namespace.
+
+int
+main(int argc, char** argv)
+{
+  program_name = argv[0];
+
+#ifndef ENABLE_THREADS
+  fprintf(stderr, "%s: gold was built without thread support\n",
+	  program_name);
+  return 0;
+#else
+  int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+  int iterations = argc > 2 ? atoi(argv[2]) : 5;
+
+  const char* options_argv[] = { "--threads", "bench.o" };
+  Command_line cmdline;
+  cmdline.process(sizeof options_argv / sizeof options_argv[0],
+		  options_argv);
+  set_parameters_options(&cmdline.options());
+
+  // There can only be one set of General_options, so switch
+  // --work-stealing by processing it as more of the command line.
+  const char* stealing_argv[] = { "--work-stealing" };
+  const char* shared_argv[] = { "--no-work-stealing" };
+
+  printf("%u tasks, fastest of %d runs, in microseconds:\n",
+	 spawn_count * (tiny_count + 1) + 1, iterations);
+  printf("threads  shared queue  work stealing\n");
+
+  bool failed = false;
+  for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+      cmdline.process(1, shared_argv);
+      long shared = best_run(cmdline.options(), threads, iterations);
+
+      cmdline.process(1, stealing_argv);
+      long stealing = best_run(cmdline.options(), threads, iterations);
+
+      printf("%7d  %12ld  %13ld\n", threads, shared, stealing);
+      if (shared < 0 || stealing < 0)
+	failed = true;
+    }
+
+  if (failed)
+    {
+      fprintf(stderr, "%s: tasks did not all run before the final task\n",
+	      program_name);
+      return 1;
+    }
+  return 0;
+#endif
+}
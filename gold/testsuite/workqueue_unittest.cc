@@ -0,0 +1,216 @@
+// workqueue_unittest.cc -- test the Workqueue
+
+// Copyright (C) 2016 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This runs many tiny tasks through the Workqueue, the way gold runs
+// its per-chunk and per-object tasks, and checks that they all run
+// before the task which waits for them, with one queue for all
+// threads and with --work-stealing.
+
+#include "gold.h"
+
+#include <vector>
+
+#include "options.h"
+#include "parameters.h"
+#include "workqueue.h"
+
+#include "test.h"
+
+namespace gold_testsuite
+{
+
+using namespace gold;
+
+// The number of tasks which queue tiny tasks, and the number of tiny
+// tasks each one queues.
+
+static const unsigned int spawn_count = 100;
+static const unsigned int tiny_count = 500;
+
+// The number of threads to use.
+
+static const int thread_count = 4;
+
+// A tiny task, which just notes that it ran.
+
+class Tiny_task : public Task
+{
+ public:
+  Tiny_task(Task_token* blocker, unsigned char* done)
+    : blocker_(blocker), done_(done)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue*)
+  { *this->done_ = 1; }
+
+  std::string
+  get_name() const
+  { return "Tiny_task"; }
+
+ private:
+  Task_token* blocker_;
+  unsigned char* done_;
+};
+
+// A task which queues tiny tasks.  This holds the blocker until all
+// the tiny tasks have been queued.
+
+class Spawn_task : public Task
+{
+ public:
+  Spawn_task(Task_token* blocker, unsigned char* done)
+    : blocker_(blocker), done_(done)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->blocker_); }
+
+  void
+  run(Workqueue* workqueue)
+  {
+    for (unsigned int i = 0; i < tiny_count; ++i)
+      {
+	workqueue->add_blocker(this->blocker_);
+	workqueue->queue(new Tiny_task(this->blocker_, this->done_ + i));
+      }
+  }
+
+  std::string
+  get_name() const
+  { return "Spawn_task"; }
+
+ private:
+  Task_token* blocker_;
+  unsigned char* done_;
+};
+
+// The task which waits for all the others, and counts how many of
+// them ran.
+
+class Final_task : public Task
+{
+ public:
+  Final_task(Task_token* blocker, const std::vector<unsigned char>* done,
+	     unsigned int* count)
+    : blocker_(blocker), done_(done), count_(count)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return this->blocker_->is_blocked() ? this->blocker_ : NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*)
+  {
+    for (std::vector<unsigned char>::const_iterator p = this->done_->begin();
+	 p != this->done_->end();
+	 ++p)
+      *this->count_ += *p;
+  }
+
+  std::string
+  get_name() const
+  { return "Final_task"; }
+
+ private:
+  Task_token* blocker_;
+  const std::vector<unsigned char>* done_;
+  unsigned int* count_;
+};
+
+// Run all the tasks on a Workqueue created with OPTIONS.  Return the
+// number of tiny tasks which ran before the final task.
+
+static unsigned int
+run_tasks(const General_options& options, int threads)
+{
+  // Worker threads may still be on their way out when process
+  // returns, so, as in gold itself, the Workqueue is never deleted.
+  Workqueue* workqueue = new Workqueue(options);
+
+  std::vector<unsigned char> done(spawn_count * tiny_count);
+  unsigned int count = 0;
+  Task_token blocker(true);
+
+  for (unsigned int i = 0; i < spawn_count; ++i)
+    {
+      blocker.add_blocker();
+      workqueue->queue(new Spawn_task(&blocker, &done[i * tiny_count]));
+    }
+  workqueue->queue(new Final_task(&blocker, &done, &count));
+
+  // Threads with nothing to do exit, so start them after queuing the
+  // tasks.
+  workqueue->set_thread_count(threads);
+  workqueue->process(0);
+
+  return count;
+}
+
+bool
+Workqueue_test(Test_report*)
+{
+#ifdef ENABLE_THREADS
+  const char* argv[] = { "--threads", "test.o" };
+  int threads = thread_count;
+#else
+  const char* argv[] = { "test.o" };
+  int threads = 1;
+#endif
+  const char* stealing_argv[] = { "--work-stealing" };
+
+  Command_line cmdline;
+  cmdline.process(sizeof argv / sizeof argv[0], argv);
+  set_parameters_options(&cmdline.options());
+
+  CHECK(run_tasks(cmdline.options(), threads) == spawn_count * tiny_count);
+
+  // There can only be one set of General_options, so turn on
+  // --work-stealing by processing it as more of the command line.
+  // Without threads it has no effect.
+  cmdline.process(1, stealing_argv);
+  CHECK(cmdline.options().work_stealing());
+  CHECK(run_tasks(cmdline.options(), threads) == spawn_count * tiny_count);
+
+  return true;
+}
+
+Register_test workqueue_register("Workqueue", Workqueue_test);
+
+} // End namespace gold_testsuite.
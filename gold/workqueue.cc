@@ -22,6 +22,12 @@
 
 #include "gold.h"
 
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <sys/time.h>
+
 #include "debug.h"
 #include "options.h"
 #include "timer.h"
@@ -123,8 +129,22 @@ Workqueue::Workqueue(const General_options& options)
     running_(0),
     waiting_(0),
     condvar_(this->lock_),
-    threader_(NULL)
+    threader_(NULL),
+    run_queues_(NULL),
+    used_queues_(1),
+    next_queue_(0),
+    queued_(0),
+    pending_(0),
+    idle_(0),
+    idle_lock_(),
+    idle_condvar_(this->idle_lock_),
+    trace_(options.trace_tasks() != NULL),
+    trace_start_(0),
+    trace_events_()
 {
+  if (this->trace_)
+    this->trace_start_ = this->trace_time();
+
   bool threads = options.threads();
 #ifndef ENABLE_THREADS
   threads = false;
@@ -135,6 +155,8 @@ Workqueue::Workqueue(const General_options& options)
     {
 #ifdef ENABLE_THREADS
       this->threader_ = new Workqueue_threader_threadpool(this);
+      if (options.work_stealing())
+	this->run_queues_ = new Run_queue[run_queue_count];
 #else
       gold_unreachable();
 #endif
@@ -143,6 +165,19 @@ Workqueue::Workqueue(const General_options& options)
 
 Workqueue::~Workqueue()
 {
+  delete[] this->run_queues_;
+}
+
+// Return the current time in microseconds, relative to the creation
+// of the Workqueue.
+
+uint64_t
+Workqueue::trace_time() const
+{
+  struct timeval tv;
+  ::gettimeofday(&tv, NULL);
+  return (static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec
+	  - this->trace_start_);
 }
 
 // Add a task to the end of a specific queue, or put it on the list
@@ -153,6 +188,13 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
 {
   Hold_lock hl(this->lock_);
 
+  if (this->trace_)
+    {
+      uint64_t now = this->trace_time();
+      t->set_trace_queue_time(now);
+      t->set_trace_ready_time(now);
+    }
+
   Task_token* token = t->is_runnable();
   if (token != NULL)
     {
@@ -162,6 +204,17 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
 	token->add_waiting(t);
       ++this->waiting_;
     }
+  else if (this->run_queues_ != NULL)
+    {
+      // We don't know which thread is queuing the task, so we share
+      // the tasks out among the run queues.  Threads with nothing to
+      // do take lock_ only briefly, so we can wake them up while we
+      // hold it.
+      int i = this->next_queue_ % this->used_queues_;
+      this->next_queue_ = i + 1;
+      this->push_run_queue(t, front, i);
+      this->wake_idle_threads(1);
+    }
   else
     {
       if (front)
@@ -173,6 +226,94 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
     }
 }
 
+// Put the runnable task T on the run queues for THREAD_NUMBER, at the
+// front if FRONT is true.  This is only used with --work-stealing.
+// The workqueue lock must be held when this is called, since T is now
+// pending.  The caller must wake up any idle threads.
+
+void
+Workqueue::push_run_queue(Task* t, bool front, int thread_number)
+{
+  ++this->pending_;
+
+  Run_queue* q = &this->run_queues_[thread_number % this->used_queues_];
+  {
+    Hold_lock hl(q->lock);
+    Task_list* list = t->should_run_soon() ? &q->first_tasks : &q->tasks;
+    if (front)
+      list->push_front(t);
+    else
+      list->push_back(t);
+    ++q->count;
+  }
+
+  // Count the task after it is on the queue, so that a thread which
+  // sees the count can find the task.
+  __sync_fetch_and_add(&this->queued_, 1);
+}
+
+// Take a task from the run queues for THREAD_NUMBER.  If they are
+// empty, steal a task from the queues of the following threads in
+// turn.  Tasks which should run soon are
+// taken before other tasks on the same queues.  Return NULL if there
+// are no tasks.  The task may not be runnable.  This only needs the
+// locks on the run queues, and may be called with or without the
+// workqueue lock held.
+
+Task*
+Workqueue::pop_run_queue(int thread_number)
+{
+  int used = this->used_queues_;
+  int own = thread_number % used;
+  for (int i = 0; i < used; ++i)
+    {
+      if (this->queued_ == 0)
+	return NULL;
+
+      // Skip empty queues without taking their locks.
+      Run_queue* q = &this->run_queues_[(own + i) % used];
+      if (q->count == 0)
+	continue;
+
+      Task* t;
+      {
+	Hold_lock hl(q->lock);
+	t = q->first_tasks.pop_front();
+	if (t == NULL)
+	  t = q->tasks.pop_front();
+	if (t != NULL)
+	  --q->count;
+      }
+      if (t != NULL)
+	{
+	  __sync_fetch_and_sub(&this->queued_, 1);
+	  return t;
+	}
+    }
+  return NULL;
+}
+
+// Wake up threads which are waiting for a task, because we have put
+// COUNT tasks on the run queues.  This is only used with
+// --work-stealing.
+
+void
+Workqueue::wake_idle_threads(int count)
+{
+  // The atomic operation in push_run_queue which counted the tasks is
+  // a full barrier, so this read comes after it.  A thread going idle
+  // increments idle_ before it checks queued_, so one of us sees the
+  // other.
+  if (count == 0 || this->idle_ == 0)
+    return;
+
+  Hold_lock hl(this->idle_lock_);
+  if (count == 1)
+    this->idle_condvar_.signal();
+  else
+    this->idle_condvar_.broadcast();
+}
+
 // Add a task to the queue.
 
 void
@@ -242,6 +383,18 @@ Workqueue::find_runnable()
   return t;
 }
 
+// Return whether there are no runnable tasks queued.  Without
+// --work-stealing, the workqueue lock must be held when this is
+// called.
+
+bool
+Workqueue::queues_empty() const
+{
+  if (this->run_queues_ != NULL)
+    return this->queued_ == 0;
+  return this->first_tasks_.empty() && this->tasks_.empty();
+}
+
 // Find a runnable a task, and wait until we find one.  Return NULL if
 // we should exit.  The workqueue lock must be held when this is
 // called.
@@ -279,6 +432,69 @@ Workqueue::find_runnable_or_wait(int thread_number)
   return t;
 }
 
+// With --work-stealing, find a runnable task, waiting until we find
+// one, and get its locks into TL.  Return NULL if we should exit.
+// This is called without holding any lock.  Tasks are taken from the
+// run queues without the workqueue lock, which is only taken to check
+// the task's tokens and get its locks.
+
+Task*
+Workqueue::steal_runnable_or_wait(int thread_number, Task_locker* tl)
+{
+  while (true)
+    {
+      Task* t = this->pop_run_queue(thread_number);
+      if (t != NULL)
+	{
+	  Hold_lock hl(this->lock_);
+
+	  // The task was runnable when it was queued, but another
+	  // thread may have taken a lock it needs since then.
+	  Task_token* token = t->is_runnable();
+	  if (token != NULL)
+	    {
+	      token->add_waiting(t);
+	      ++this->waiting_;
+	      --this->pending_;
+	      continue;
+	    }
+
+	  // Get the locks for the task.  This must be called while we
+	  // are still holding the Workqueue lock.
+	  t->locks(tl);
+
+	  ++this->running_;
+	  return t;
+	}
+
+      if (this->should_cancel_thread(thread_number))
+	return NULL;
+
+      Hold_lock hl(this->idle_lock_);
+
+      // See the comment in wake_idle_threads.
+      __sync_fetch_and_add(&this->idle_, 1);
+      bool done = this->pending_ == 0;
+      if (!done && this->queued_ == 0)
+	{
+	  gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
+
+	  this->idle_condvar_.wait();
+
+	  gold_debug(DEBUG_TASK, "%3d awake", thread_number);
+
+	  done = this->pending_ == 0;
+	}
+      __sync_fetch_and_sub(&this->idle_, 1);
+
+      if (done)
+	{
+	  gold_assert(this->waiting_ == 0);
+	  return NULL;
+	}
+    }
+}
+
 // Find and run tasks.  If we can't find a runnable task, wait for one
 // to become available.  If we run a task, and it frees up another
 // runnable task, then run that one too.  This returns true if we
@@ -291,21 +507,28 @@ Workqueue::find_and_run_task(int thread_number)
   Task* t;
   Task_locker tl;
 
-  {
-    Hold_lock hl(this->lock_);
+  if (this->run_queues_ != NULL)
+    {
+      t = this->steal_runnable_or_wait(thread_number, &tl);
+      if (t == NULL)
+	return false;
+    }
+  else
+    {
+      Hold_lock hl(this->lock_);
 
-    // Find a runnable task.
-    t = this->find_runnable_or_wait(thread_number);
+      // Find a runnable task.
+      t = this->find_runnable_or_wait(thread_number);
 
-    if (t == NULL)
-      return false;
+      if (t == NULL)
+	return false;
 
-    // Get the locks for the task.  This must be called while we are
-    // still holding the Workqueue lock.
-    t->locks(&tl);
+      // Get the locks for the task.  This must be called while we are
+      // still holding the Workqueue lock.
+      t->locks(&tl);
 
-    ++this->running_;
-  }
+      ++this->running_;
+    }
 
   while (t != NULL)
     {
@@ -316,6 +539,15 @@ Workqueue::find_and_run_task(int thread_number)
       if (is_debugging_enabled(DEBUG_TASK))
         timer.start();
 
+      // Get the name now, since a Task may not be able to compute it
+      // after it has run.
+      uint64_t start_time = 0;
+      if (this->trace_)
+	{
+	  t->name();
+	  start_time = this->trace_time();
+	}
+
       t->run(this);
 
       if (is_debugging_enabled(DEBUG_TASK))
@@ -332,17 +564,59 @@ Workqueue::find_and_run_task(int thread_number)
         }
 
       Task* next;
+      int queued = 0;
+      bool done = false;
       {
 	Hold_lock hl(this->lock_);
 
 	--this->running_;
 
+	if (this->trace_)
+	  {
+	    Task_trace_event e;
+	    e.name = t->name();
+	    e.thread_number = thread_number;
+	    e.queue_time = t->trace_queue_time();
+	    e.ready_time = t->trace_ready_time();
+	    e.start_time = start_time;
+	    e.end_time = this->trace_time();
+	    this->trace_events_.push_back(e);
+	  }
+
 	// Release the locks for the task.  This must be done with the
 	// workqueue lock held.  Get the next Task to run if any.
-	next = this->release_locks(t, &tl);
+	next = this->release_locks(t, &tl, thread_number, &queued);
 
-	if (next == NULL)
-	  next = this->find_runnable();
+	if (this->run_queues_ == NULL)
+	  {
+	    if (next == NULL)
+	      next = this->find_runnable();
+	  }
+	else
+	  {
+	    // Take the next task from the run queues now, since we
+	    // need the workqueue lock to check it anyhow.
+	    while (next == NULL)
+	      {
+		next = this->pop_run_queue(thread_number);
+		if (next == NULL)
+		  break;
+		Task_token* token = next->is_runnable();
+		if (token != NULL)
+		  {
+		    token->add_waiting(next);
+		    ++this->waiting_;
+		    --this->pending_;
+		    next = NULL;
+		  }
+	      }
+
+	    // T is no longer pending.  This comes after queuing the
+	    // tasks it unblocked, so that the count only drops to zero
+	    // when there is nothing left to do.
+	    --this->pending_;
+	    done = this->pending_ == 0;
+	  }
 
 	// If we have another Task to run, get the Locks.  This must
 	// be called while we are still holding the Workqueue lock.
@@ -355,6 +629,16 @@ Workqueue::find_and_run_task(int thread_number)
 	  }
       }
 
+      // Tell the idle threads about the tasks we queued, or that
+      // there is nothing left to do.
+      if (done)
+	{
+	  Hold_lock hl(this->idle_lock_);
+	  this->idle_condvar_.broadcast();
+	}
+      else
+	this->wake_idle_threads(queued);
+
       // We are done with this task.
       delete t;
 
@@ -393,8 +677,14 @@ Workqueue::find_and_run_task(int thread_number)
 
 // Return true if we set *PRET to T, false otherwise.
 
+// With --work-stealing, T is queued on the run queues of
+// THREAD_NUMBER, the thread which released the lock, and we
+// increment *PQUEUED; the caller wakes up idle threads once it has
+// released the workqueue lock.
+
 bool
-Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
+Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret,
+			   int thread_number, int* pqueued)
 {
   Task_token* token = t->is_runnable();
 
@@ -405,6 +695,9 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
       return false;
     }
 
+  if (this->trace_)
+    t->set_trace_ready_time(this->trace_time());
+
   bool should_queue = false;
   bool should_return = false;
 
@@ -414,7 +707,7 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
     should_return = true;
   else if (t->should_run_soon())
     should_return = true;
-  else if (!this->first_tasks_.empty() || !this->tasks_.empty())
+  else if (!this->queues_empty())
     should_queue = true;
   else
     should_return = true;
@@ -423,10 +716,19 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
     {
       gold_assert(*pret == NULL);
       *pret = t;
+      if (this->run_queues_ != NULL)
+	++this->pending_;
       return true;
     }
   else if (should_queue)
     {
+      if (this->run_queues_ != NULL)
+	{
+	  this->push_run_queue(t, false, thread_number);
+	  ++*pqueued;
+	  return false;
+	}
+
       if (t->should_run_soon())
 	this->first_tasks_.push_back(t);
       else
@@ -440,11 +742,13 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
 
 // Release the locks associated with a Task.  Return the first
 // runnable Task that we find.  If we find more runnable tasks, add
-// them to the run queue and signal any other threads.  This must be
-// called with the Workqueue lock held.
+// them to the run queue and signal any other threads; with
+// --work-stealing, add the number of them to *PQUEUED instead.  This
+// must be called with the Workqueue lock held.
 
 Task*
-Workqueue::release_locks(Task* t, Task_locker* tl)
+Workqueue::release_locks(Task* t, Task_locker* tl, int thread_number,
+			 int* pqueued)
 {
   Task* ret = NULL;
   for (Task_locker::iterator p = tl->begin(); p != tl->end(); ++p)
@@ -460,7 +764,7 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	      while ((t = token->remove_first_waiting()) != NULL)
 		{
 		  --this->waiting_;
-		  this->return_or_queue(t, true, &ret);
+		  this->return_or_queue(t, true, &ret, thread_number, pqueued);
 		}
 	    }
 	}
@@ -477,7 +781,8 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	  while ((t = token->remove_first_waiting()) != NULL)
 	    {
 	      --this->waiting_;
-	      if (this->return_or_queue(t, false, &ret))
+	      if (this->return_or_queue(t, false, &ret, thread_number,
+					 pqueued))
 		break;
 	    }
 	}
@@ -504,9 +809,18 @@ Workqueue::set_thread_count(int threads)
 {
   Hold_lock hl(this->lock_);
 
+  if (this->run_queues_ != NULL && threads > this->used_queues_)
+    this->used_queues_ = std::min(threads,
+				  static_cast<int>(run_queue_count));
+
   this->threader_->set_thread_count(threads);
   // Wake up all the threads, since something has changed.
   this->condvar_.broadcast();
+  if (this->run_queues_ != NULL)
+    {
+      Hold_lock hli(this->idle_lock_);
+      this->idle_condvar_.broadcast();
+    }
 }
 
 // Add a new blocker to an existing Task_token.
@@ -518,4 +832,83 @@ Workqueue::add_blocker(Task_token* token)
   token->add_blocker();
 }
 
+// Write a JSON string to F, quoting as required.
+
+static void
+write_json_string(FILE* f, const std::string& s)
+{
+  putc('"', f);
+  for (std::string::const_iterator p = s.begin(); p != s.end(); ++p)
+    {
+      unsigned char c = *p;
+      if (c == '"' || c == '\\')
+	fprintf(f, "\\%c", c);
+      else if (c < 0x20)
+	fprintf(f, "\\u%04x", c);
+      else
+	putc(c, f);
+    }
+  putc('"', f);
+}
+
+// Write the tasks which have run to the --trace-tasks file, as
+// complete events in the Chrome trace event format.  The event for
+// each task also records how long the task waited for its blockers
+// and locks, and how long it then waited for a thread to run it.
+
+void
+Workqueue::write_task_trace()
+{
+  if (!this->trace_)
+    return;
+
+  const char* filename = parameters->options().trace_tasks();
+  FILE* f = ::fopen(filename, "w");
+  if (f == NULL)
+    {
+      gold_error(_("cannot open task trace file %s: %s"), filename,
+		 strerror(errno));
+      return;
+    }
+
+  fprintf(f, "{\"traceEvents\":[\n");
+
+  int max_thread = 0;
+  for (std::vector<Task_trace_event>::const_iterator p =
+	 this->trace_events_.begin();
+       p != this->trace_events_.end();
+       ++p)
+    {
+      if (p->thread_number > max_thread)
+	max_thread = p->thread_number;
+    }
+  for (int i = 0; i <= max_thread; ++i)
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+	    "\"tid\":%d,\"args\":{\"name\":\"thread %d\"}},\n", i, i);
+
+  for (std::vector<Task_trace_event>::const_iterator p =
+	 this->trace_events_.begin();
+       p != this->trace_events_.end();
+       ++p)
+    {
+      if (p != this->trace_events_.begin())
+	fprintf(f, ",\n");
+      fprintf(f, "{\"name\":");
+      write_json_string(f, p->name);
+      fprintf(f, ",\"cat\":\"task\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+	      "\"ts\":%llu,\"dur\":%llu,\"args\":{"
+	      "\"blocked_us\":%llu,\"queued_us\":%llu}}",
+	      p->thread_number,
+	      static_cast<unsigned long long>(p->start_time),
+	      static_cast<unsigned long long>(p->end_time - p->start_time),
+	      static_cast<unsigned long long>(p->ready_time - p->queue_time),
+	      static_cast<unsigned long long>(p->start_time - p->ready_time));
+    }
+
+  fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+  if (::fclose(f) != 0)
+    gold_error(_("%s: close: %s"), filename, strerror(errno));
+}
+
 } // End namespace gold.
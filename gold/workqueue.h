@@ -28,6 +28,7 @@
 #define GOLD_WORKQUEUE_H
 
 #include <string>
+#include <vector>
 
 #include "gold-threads.h"
 #include "token.h"
@@ -45,7 +46,8 @@ class Task
 {
  public:
   Task()
-    : list_next_(NULL), name_(), should_run_soon_(false)
+    : list_next_(NULL), name_(), should_run_soon_(false),
+      trace_queue_time_(0), trace_ready_time_(0)
   { }
   virtual ~Task()
   { }
@@ -96,6 +98,25 @@ class Task
   clear_list_next()
   { this->list_next_ = NULL; }
 
+  // The time at which the Task was queued, and the time at which it
+  // last became runnable.  These are only set by the Workqueue for
+  // --trace-tasks.
+  uint64_t
+  trace_queue_time() const
+  { return this->trace_queue_time_; }
+
+  void
+  set_trace_queue_time(uint64_t time)
+  { this->trace_queue_time_ = time; }
+
+  uint64_t
+  trace_ready_time() const
+  { return this->trace_ready_time_; }
+
+  void
+  set_trace_ready_time(uint64_t time)
+  { this->trace_ready_time_ = time; }
+
   // Return the name of the Task.  This is only used for debugging
   // purposes.
   const std::string&
@@ -127,6 +148,9 @@ class Task
   // Whether this Task should be executed soon.  This is used for
   // Tasks which can be run after some data is read.
   bool should_run_soon_;
+  // Times for --trace-tasks, in microseconds.
+  uint64_t trace_queue_time_;
+  uint64_t trace_ready_time_;
 };
 
 // An interface for Task_function.  This is a convenience class to run
@@ -233,7 +257,29 @@ class Workqueue
   void
   add_blocker(Task_token*);
 
+  // Write the trace of the tasks which have run to the file named by
+  // --trace-tasks, if any.  This is called after process returns.
+  void
+  write_task_trace();
+
  private:
+  // A Task which has run, recorded for --trace-tasks.  All times are
+  // in microseconds since the Workqueue was created.
+  struct Task_trace_event
+  {
+    // The Task name.
+    std::string name;
+    // The thread which ran the Task.
+    int thread_number;
+    // When the Task was queued.
+    uint64_t queue_time;
+    // When the Task's blockers and locks were last released.
+    uint64_t ready_time;
+    // When the Task started and finished running.
+    uint64_t start_time;
+    uint64_t end_time;
+  };
+
   // This class can not be copied.
   Workqueue(const Workqueue&);
   Workqueue& operator=(const Workqueue&);
@@ -254,22 +300,48 @@ class Workqueue
   Task*
   find_runnable_in_list(Task_list*);
 
+  // With --work-stealing, take a task from the per-thread run queues.
+  Task*
+  pop_run_queue(int thread_number);
+
+  // With --work-stealing, find a runnable task, or wait for one, and
+  // get its locks.
+  Task*
+  steal_runnable_or_wait(int thread_number, Task_locker*);
+
+  // Put a runnable task on the queue for THREAD_NUMBER.
+  void
+  push_run_queue(Task* t, bool front, int thread_number);
+
+  // Wake up threads waiting for a task with --work-stealing.
+  void
+  wake_idle_threads(int count);
+
+  // Return whether there are no runnable tasks queued.
+  bool
+  queues_empty() const;
+
   // Find an run a task.
   bool
   find_and_run_task(int);
 
   // Release the locks for a Task.  Return the next Task to run.
   Task*
-  release_locks(Task*, Task_locker*);
+  release_locks(Task*, Task_locker*, int thread_number, int* pqueued);
 
   // Store T into *PRET, or queue it as appropriate.
   bool
-  return_or_queue(Task* t, bool is_blocker, Task** pret);
+  return_or_queue(Task* t, bool is_blocker, Task** pret, int thread_number,
+		  int* pqueued);
 
   // Return whether to cancel this thread.
   bool
   should_cancel_thread(int thread_number);
 
+  // Return the current time for --trace-tasks.
+  uint64_t
+  trace_time() const;
+
   // Master Workqueue lock.  This controls access to the following
   // member variables.
   Lock lock_;
@@ -288,6 +360,66 @@ class Workqueue
   // The threading implementation.  This is set at construction time
   // and not changed thereafter.
   Workqueue_threader* threader_;
+
+  // With --work-stealing, runnable tasks are not kept in first_tasks_
+  // and tasks_, but in a pair of run queues for each thread.  A thread
+  // takes tasks from its own queues first, and takes them from the
+  // queues of the other threads when its own are empty.  Each pair of
+  // queues has its own lock, so threads may take tasks from the queues
+  // without holding lock_.  Task_tokens are still only touched with
+  // lock_ held: a task taken from a queue is checked, and its locks
+  // are taken, under lock_, and it goes back to waiting for its token
+  // if it is blocked.  A lock on a run queue may be taken while
+  // holding lock_, but not the other way around.
+  struct Run_queue
+  {
+    // Protects the lists.
+    Lock lock;
+    // Tasks to execute soon.
+    Task_list first_tasks;
+    // Other tasks.
+    Task_list tasks;
+    // The number of tasks on the lists.  This is only changed with
+    // the lock held, but may be read without it.
+    volatile int count;
+
+    Run_queue()
+      : lock(), first_tasks(), tasks(), count(0)
+    { }
+  };
+  static const int run_queue_count = 64;
+  // The run queues, or NULL if not using --work-stealing.
+  Run_queue* run_queues_;
+  // The number of run queues in use: the largest thread count we have
+  // seen, up to run_queue_count.  This only increases, and is only
+  // changed with lock_ held, but may be read without it.
+  volatile int used_queues_;
+  // The run queue for the next task queued by queue(), queue_soon()
+  // or queue_next().  Protected by lock_.
+  int next_queue_;
+  // The number of tasks on the run queues.  This is only changed with
+  // atomic operations, and may be read without holding any lock.
+  volatile int queued_;
+  // The number of tasks which are on the run queues, or have been
+  // taken from them, or are running.  When this drops to zero there
+  // is no more work to do.  This is only changed with lock_ held, but
+  // may be read without it.
+  volatile int pending_;
+  // The number of threads waiting on idle_condvar_.  This is only
+  // changed with atomic operations.
+  volatile int idle_;
+  // Lock and condition variable used by threads with nothing to do
+  // with --work-stealing.  The condition variable is signalled when
+  // a task is put on a run queue and when pending_ drops to zero.
+  Lock idle_lock_;
+  Condvar idle_condvar_;
+
+  // Whether we are recording tasks for --trace-tasks.
+  bool trace_;
+  // The time at which the Workqueue was created, for --trace-tasks.
+  uint64_t trace_start_;
+  // The tasks which have run, for --trace-tasks.
+  std::vector<Task_trace_event> trace_events_;
 };
 
 } // End namespace gold.
@@ -899,6 +899,39 @@ class Target_x86_64 : public Sized_target<size, false>
     bool skip_call_tls_get_addr_;
   };
 
+  // The relocation kernels used by relocate_section_batched.
+  class Relocate_kernels
+  {
+   public:
+    enum
+    {
+      KERNEL_64,
+      KERNEL_PC64,
+      KERNEL_32,
+      KERNEL_32S,
+      KERNEL_PC32
+    };
+
+    static const int kernel_count = KERNEL_PC32 + 1;
+
+    // Return the kernel to use for a relocation of type R_TYPE
+    // against GSYM, or against the local symbol PSYMVAL if GSYM is
+    // NULL, or -1 if the relocation must go through Relocate.
+    static inline int
+    kernel(const Target_x86_64*, unsigned int r_type,
+	   const Sized_symbol<size>* gsym, const Symbol_value<size>* psymval,
+	   typename elfcpp::Elf_types<size>::Elf_Swxword addend);
+
+    // Apply the relocations from P to PEND, which all use KERNEL, to
+    // VIEW at VIEW_ADDRESS.  Store the indexes of relocations which
+    // overflow at SLOW, and return the end of them.
+    static size_t*
+    apply(int kernel, unsigned char* view,
+	  typename elfcpp::Elf_types<size>::Elf_Addr view_address,
+	  const Batched_reloc<size>* p, const Batched_reloc<size>* pend,
+	  size_t* slow);
+  };
+
   // Check if relocation against this symbol is a candidate for
   // conversion from
   // mov foo@GOTPCREL(%rip), %reg
@@ -3481,6 +3514,103 @@ class X86_64_relocate_functions : public Relocate_functions<size, false>
   }
 };
 
+// Return the kernel to use for a relocation in
+// relocate_section_batched.
+
+template<int size>
+inline int
+Target_x86_64<size>::Relocate_kernels::kernel(
+    const Target_x86_64*,
+    unsigned int r_type,
+    const Sized_symbol<size>* gsym,
+    const Symbol_value<size>* psymval,
+    typename elfcpp::Elf_types<size>::Elf_Swxword addend)
+{
+  // x32 computes R_X86_64_PC32 with 64-bit arithmetic; leave it to
+  // Relocate.
+  if (size == 32)
+    return -1;
+
+  int kernel;
+  switch (r_type)
+    {
+    case elfcpp::R_X86_64_64:
+      kernel = KERNEL_64;
+      break;
+    case elfcpp::R_X86_64_PC64:
+      kernel = KERNEL_PC64;
+      break;
+    case elfcpp::R_X86_64_32:
+      kernel = KERNEL_32;
+      break;
+    case elfcpp::R_X86_64_32S:
+      kernel = KERNEL_32S;
+      break;
+    case elfcpp::R_X86_64_PC32:
+    case elfcpp::R_X86_64_PC32_BND:
+      // For a negative addend, pcrela32_check adds the addend to the
+      // value of a section symbol in a merged section, rather than
+      // looking up the value at the addend.
+      if (gsym == NULL && addend < 0 && !psymval->has_output_value())
+	return -1;
+      kernel = KERNEL_PC32;
+      break;
+    default:
+      return -1;
+    }
+
+  // A call to __tls_get_addr may be the second half of a TLS
+  // sequence, which Relocate must see.
+  if (gsym != NULL
+      && (gsym->use_plt_offset(Scan::get_reference_flags(r_type))
+	  || (gsym->type() == elfcpp::STT_FUNC
+	      && strcmp(gsym->name(), "__tls_get_addr") == 0)))
+    return -1;
+
+  return kernel;
+}
+
+// Apply a run of relocations in relocate_section_batched.
+
+template<int size>
+size_t*
+Target_x86_64<size>::Relocate_kernels::apply(
+    int kernel,
+    unsigned char* view,
+    typename elfcpp::Elf_types<size>::Elf_Addr view_address,
+    const Batched_reloc<size>* p,
+    const Batched_reloc<size>* pend,
+    size_t* slow)
+{
+  typedef Relocate_functions<size, false> Reloc_funcs;
+
+  switch (kernel)
+    {
+    case KERNEL_64:
+      return apply_batched_relocs<size, Batched_reloc_kernel<
+	size, 64, false, false, Reloc_funcs::CHECK_NONE> >(
+	view, view_address, p, pend, slow);
+    case KERNEL_PC64:
+      return apply_batched_relocs<size, Batched_reloc_kernel<
+	size, 64, false, true, Reloc_funcs::CHECK_NONE> >(
+	view, view_address, p, pend, slow);
+    case KERNEL_32:
+      return apply_batched_relocs<size, Batched_reloc_kernel<
+	size, 32, false, false, Reloc_funcs::CHECK_UNSIGNED> >(
+	view, view_address, p, pend, slow);
+    case KERNEL_32S:
+      return apply_batched_relocs<size, Batched_reloc_kernel<
+	size, 32, false, false, Reloc_funcs::CHECK_SIGNED> >(
+	view, view_address, p, pend, slow);
+    case KERNEL_PC32:
+      return apply_batched_relocs<size, Batched_reloc_kernel<
+	size, 32, false, true, Reloc_funcs::CHECK_SIGNED> >(
+	view, view_address, p, pend, slow);
+    default:
+      gold_unreachable();
+    }
+}
+
 // Perform a relocation.
 
 template<int size>
@@ -4501,9 +4631,9 @@ Target_x86_64<size>::relocate_section(
       Classify_reloc;
 
   gold_assert(sh_type == elfcpp::SHT_RELA);
-
-  gold::relocate_section<size, false, Target_x86_64<size>, Relocate,
-			 gold::Default_comdat_behavior, Classify_reloc>(
+  gold::relocate_section_batched<size, false, Target_x86_64<size>, Relocate,
+				 gold::Default_comdat_behavior, Classify_reloc,
+				 Relocate_kernels>(
     relinfo,
     this,
     prelocs,
@@ -592,6 +592,11 @@ struct bfd_link_info
   /* How many spare .dynamic DT_NULL entries should be added?  */
   unsigned int spare_dynamic_tags;
 
+  /* The number of threads on which to relocate input sections in the
+     final link.  0 or 1 means relocate them all on the calling
+     thread.  */
+  unsigned int thread_count;
+
   /* May be used to set DT_FLAGS for ELF. */
   bfd_vma flags;
 
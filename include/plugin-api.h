@@ -365,6 +365,17 @@ enum ld_plugin_status
 (*ld_plugin_get_input_section_size) (const struct ld_plugin_section section,
                                      uint64_t *secsize);
 
+/* The linker's interface for specifying that the plugin's claim_file
+   handler may be called for several input files at once, from
+   different threads.  The handler must then be thread safe, as must
+   its use of the add_symbols, get_view and get_input_section_*
+   interfaces, which may also be called concurrently for different
+   input files.  This should be invoked in the onload entry point.  */
+
+typedef
+enum ld_plugin_status
+(*ld_plugin_allow_concurrent_claim_file) (void);
+
 enum ld_plugin_level
 {
   LDPL_INFO,
@@ -407,7 +418,9 @@ enum ld_plugin_tag
   LDPT_UNIQUE_SEGMENT_FOR_SECTIONS = 27,
   LDPT_GET_SYMBOLS_V3 = 28,
   LDPT_GET_INPUT_SECTION_ALIGNMENT = 29,
-  LDPT_GET_INPUT_SECTION_SIZE = 30
+  LDPT_GET_INPUT_SECTION_SIZE = 30,
+  /* 31 to 35 are used by later versions of this interface.  */
+  LDPT_ALLOW_CONCURRENT_CLAIM_FILE = 36
 };
 
 /* The plugin transfer vector.  */
@@ -441,6 +454,7 @@ struct ld_plugin_tv
     ld_plugin_unique_segment_for_sections tv_unique_segment_for_sections;
     ld_plugin_get_input_section_alignment tv_get_input_section_alignment;
     ld_plugin_get_input_section_size tv_get_input_section_size;
+    ld_plugin_allow_concurrent_claim_file tv_allow_concurrent_claim_file;
   } tv_u;
 };
 
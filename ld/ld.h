@@ -169,6 +169,13 @@ typedef struct
   /* If set, display the target memory usage (per memory region).  */
   bfd_boolean print_memory_usage;
 
+  /* If TRUE, relocate the input files on several threads.  */
+  bfd_boolean threads;
+
+  /* The number of threads to use with --threads, or 0 to use one per
+     online processor.  */
+  unsigned int thread_count;
+
   /* Big or little endian as set on command line.  */
   enum endian_enum endian;
 
@@ -766,6 +766,343 @@ walk_wild_section_specs4_wild2 (lang_wild_statement_type *ptr,
     }
 }
 
+/* Index of section names to the wild statements which may match them.
+
+   Walking every wild statement over every section of every file is
+   quadratic, which hurts links with many sections.  So as each wild
+   statement is created its section specs are entered in an index:
+   literal names in a hash table, and other names in a trie under
+   their literal prefix, up to the first wildcard character.  The first
+   time a file is walked, each of its sections is looked up in the
+   index, and the statements and specs it matches are recorded.
+   Walking a statement over the file then only visits those.  */
+
+/* A section spec in the index.  */
+
+struct wild_index_ref
+{
+  struct wild_index_ref *next;
+  struct wildcard_list *spec;
+  /* The index_id of the statement, and the position of SPEC in its
+     section list.  */
+  unsigned int stmt_id;
+  unsigned int spec_pos;
+  /* Whether every name which reaches this entry matches SPEC, so
+     there is no need to call name_match.  */
+  bfd_boolean matches_all;
+};
+
+/* A literal section name in the index.  */
+
+struct wild_index_name
+{
+  const char *name;
+  struct wild_index_ref *refs;
+};
+
+/* A node of the trie of wildcard prefixes.  */
+
+struct wild_index_node
+{
+  struct wild_index_node *child;
+  struct wild_index_node *sibling;
+  struct wild_index_ref *refs;
+  unsigned char ch;
+};
+
+/* A section of a file matched by a spec of an indexed statement.  */
+
+struct wild_file_match
+{
+  unsigned int stmt_id;
+  unsigned int sec_pos;
+  unsigned int spec_pos;
+  asection *section;
+  struct wildcard_list *spec;
+};
+
+/* The matches for the sections of a file, sorted by statement, then
+   section, then spec, which is the order walk_wild_section_general
+   would find them in.  */
+
+struct wild_file_index
+{
+  /* The number of indexed statements, and the number of sections in
+     the file and its last section, when the matches were found.  */
+  unsigned int stmt_count;
+  unsigned int section_count;
+  asection *section_last;
+  size_t count;
+  size_t alloc;
+  struct wild_file_match *matches;
+};
+
+static htab_t wild_index_names;
+static struct wild_index_node wild_index_root;
+static unsigned int wild_index_stmt_count;
+
+static hashval_t
+wild_index_name_hash (const void *p)
+{
+  const struct wild_index_name *e = (const struct wild_index_name *) p;
+
+  return htab_hash_string (e->name);
+}
+
+static int
+wild_index_name_eq (const void *p1, const void *p2)
+{
+  const struct wild_index_name *e1 = (const struct wild_index_name *) p1;
+  const struct wild_index_name *e2 = (const struct wild_index_name *) p2;
+
+  return strcmp (e1->name, e2->name) == 0;
+}
+
+/* Enter the section specs of PTR in the index.  Statements with no
+   section list, or with a spec without a name, are left out; they
+   use PTR->walk_wild_section_handler.  */
+
+static void
+wild_index_add_statement (lang_wild_statement_type *ptr)
+{
+  struct wildcard_list *sec;
+  unsigned int spec_pos;
+
+  ptr->index_id = 0;
+  if (ptr->section_list == NULL)
+    return;
+  for (sec = ptr->section_list; sec != NULL; sec = sec->next)
+    if (sec->spec.name == NULL)
+      return;
+
+  if (wild_index_names == NULL)
+    wild_index_names = htab_create (64, wild_index_name_hash,
+				    wild_index_name_eq, NULL);
+
+  ptr->index_id = ++wild_index_stmt_count;
+  for (sec = ptr->section_list, spec_pos = 0;
+       sec != NULL;
+       sec = sec->next, spec_pos++)
+    {
+      const char *name = sec->spec.name;
+      size_t len = strcspn (name, "?*[\\");
+      struct wild_index_ref *ref;
+      struct wild_index_ref **refs;
+
+      ref = (struct wild_index_ref *) stat_alloc (sizeof (*ref));
+      ref->spec = sec;
+      ref->stmt_id = ptr->index_id;
+      ref->spec_pos = spec_pos;
+      if (name[len] == '\0')
+	{
+	  struct wild_index_name e;
+	  struct wild_index_name *entry;
+	  void **slot;
+
+	  e.name = name;
+	  slot = htab_find_slot (wild_index_names, &e, INSERT);
+	  if (*slot == NULL)
+	    {
+	      entry = (struct wild_index_name *) stat_alloc (sizeof (*entry));
+	      entry->name = name;
+	      entry->refs = NULL;
+	      *slot = entry;
+	    }
+	  entry = (struct wild_index_name *) *slot;
+	  refs = &entry->refs;
+	  ref->matches_all = TRUE;
+	}
+      else
+	{
+	  struct wild_index_node *node = &wild_index_root;
+	  size_t i;
+
+	  for (i = 0; i < len; i++)
+	    {
+	      struct wild_index_node *child;
+
+	      for (child = node->child; child != NULL; child = child->sibling)
+		if (child->ch == (unsigned char) name[i])
+		  break;
+	      if (child == NULL)
+		{
+		  child = ((struct wild_index_node *)
+			   stat_alloc (sizeof (*child)));
+		  child->child = NULL;
+		  child->refs = NULL;
+		  child->ch = name[i];
+		  child->sibling = node->child;
+		  node->child = child;
+		}
+	      node = child;
+	    }
+	  refs = &node->refs;
+	  ref->matches_all = name[len] == '*' && name[len + 1] == '\0';
+	}
+      ref->next = *refs;
+      *refs = ref;
+    }
+}
+
+/* Record the specs in REFS which match S, the SEC_POS'th section of a
+   file, in FI.  */
+
+static void
+wild_file_index_add (struct wild_file_index *fi,
+		     struct wild_index_ref *refs,
+		     asection *s,
+		     const char *sname,
+		     unsigned int sec_pos)
+{
+  for (; refs != NULL; refs = refs->next)
+    {
+      struct wild_file_match *m;
+
+      if (!refs->matches_all && name_match (refs->spec->spec.name, sname) != 0)
+	continue;
+
+      if (fi->count == fi->alloc)
+	{
+	  fi->alloc = fi->alloc == 0 ? 16 : fi->alloc * 2;
+	  fi->matches = (struct wild_file_match *)
+	      xrealloc (fi->matches, fi->alloc * sizeof (*fi->matches));
+	}
+      m = &fi->matches[fi->count++];
+      m->stmt_id = refs->stmt_id;
+      m->sec_pos = sec_pos;
+      m->spec_pos = refs->spec_pos;
+      m->section = s;
+      m->spec = refs->spec;
+    }
+}
+
+static int
+wild_file_match_compare (const void *a, const void *b)
+{
+  const struct wild_file_match *m1 = (const struct wild_file_match *) a;
+  const struct wild_file_match *m2 = (const struct wild_file_match *) b;
+
+  if (m1->stmt_id != m2->stmt_id)
+    return m1->stmt_id < m2->stmt_id ? -1 : 1;
+  if (m1->sec_pos != m2->sec_pos)
+    return m1->sec_pos < m2->sec_pos ? -1 : 1;
+  if (m1->spec_pos != m2->spec_pos)
+    return m1->spec_pos < m2->spec_pos ? -1 : 1;
+  return 0;
+}
+
+/* Return the matches for the sections of FILE, finding them if this
+   is the first walk over FILE, or if statements or sections have been
+   added since the last one.  */
+
+static struct wild_file_index *
+wild_file_index (lang_input_statement_type *file)
+{
+  bfd *abfd = file->the_bfd;
+  struct wild_file_index *fi = file->wild_index;
+  asection *s;
+  unsigned int sec_pos;
+
+  if (fi == NULL)
+    {
+      fi = (struct wild_file_index *) xmalloc (sizeof (*fi));
+      fi->alloc = 0;
+      fi->matches = NULL;
+      file->wild_index = fi;
+    }
+  else if (fi->stmt_count == wild_index_stmt_count
+	   && fi->section_count == abfd->section_count
+	   && fi->section_last == abfd->section_last)
+    return fi;
+
+  fi->stmt_count = wild_index_stmt_count;
+  fi->section_count = abfd->section_count;
+  fi->section_last = abfd->section_last;
+  fi->count = 0;
+
+  for (s = abfd->sections, sec_pos = 0; s != NULL; s = s->next, sec_pos++)
+    {
+      const char *sname = bfd_get_section_name (abfd, s);
+      struct wild_index_name e;
+      struct wild_index_name *entry;
+      struct wild_index_node *node;
+      const char *p;
+
+      e.name = sname;
+      entry = (struct wild_index_name *) htab_find (wild_index_names, &e);
+      if (entry != NULL)
+	wild_file_index_add (fi, entry->refs, s, sname, sec_pos);
+
+      /* Every prefix of the name which is in the trie, including the
+	 empty prefix at the root, may have matching specs.  */
+      node = &wild_index_root;
+      wild_file_index_add (fi, node->refs, s, sname, sec_pos);
+      for (p = sname; *p != '\0'; p++)
+	{
+	  for (node = node->child; node != NULL; node = node->sibling)
+	    if (node->ch == (unsigned char) *p)
+	      break;
+	  if (node == NULL)
+	    break;
+	  wild_file_index_add (fi, node->refs, s, sname, sec_pos);
+	}
+    }
+
+  qsort (fi->matches, fi->count, sizeof (*fi->matches),
+	 wild_file_match_compare);
+  return fi;
+}
+
+/* Walk an indexed statement over the sections of FILE which it may
+   match.  */
+
+static void
+walk_wild_section_indexed (lang_wild_statement_type *ptr,
+			   lang_input_statement_type *file,
+			   callback_t callback,
+			   void *data)
+{
+  struct wild_file_index *fi = wild_file_index (file);
+  size_t lo = 0;
+  size_t hi = fi->count;
+
+  /* Find the first match for PTR.  */
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (fi->matches[mid].stmt_id < ptr->index_id)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  for (; lo < fi->count && fi->matches[lo].stmt_id == ptr->index_id; lo++)
+    walk_wild_consider_section (ptr, file, fi->matches[lo].section,
+				fi->matches[lo].spec, callback, data);
+}
+
+/* Free the matches found for the input files.  */
+
+static void
+wild_file_index_free (void)
+{
+  LANG_FOR_EACH_INPUT_STATEMENT (f)
+    {
+      if (f->wild_index != NULL)
+	{
+	  free (f->wild_index->matches);
+	  free (f->wild_index);
+	  f->wild_index = NULL;
+	}
+    }
+  if (wild_index_names != NULL)
+    {
+      htab_delete (wild_index_names);
+      wild_index_names = NULL;
+    }
+}
+
 static void
 walk_wild_section (lang_wild_statement_type *ptr,
 		   lang_input_statement_type *file,
@@ -775,7 +1112,10 @@ walk_wild_section (lang_wild_statement_type *ptr,
   if (file->flags.just_syms)
     return;
 
-  (*ptr->walk_wild_section_handler) (ptr, file, callback, data);
+  if (ptr->index_id != 0 && file->the_bfd != NULL)
+    walk_wild_section_indexed (ptr, file, callback, data);
+  else
+    (*ptr->walk_wild_section_handler) (ptr, file, callback, data);
 }
 
 /* Returns TRUE when name1 is a wildcard spec that might match
@@ -821,6 +1161,7 @@ analyze_walk_wild_section_handler (lang_wild_statement_type *ptr)
   ptr->handler_data[2] = NULL;
   ptr->handler_data[3] = NULL;
   ptr->tree = NULL;
+  wild_index_add_statement (ptr);
 
   /* Count how many wildcard_specs there are, and how many of those
      actually use wildcards in the name.  Also, bail out if any of the
@@ -1432,6 +1773,7 @@ void
 lang_finish (void)
 {
   output_section_statement_table_free ();
+  wild_file_index_free ();
 }
 
 /*----------------------------------------------------------------------
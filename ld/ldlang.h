@@ -317,6 +317,10 @@ typedef struct lang_input_statement_struct
   const char *target;
 
   struct lang_input_statement_flags flags;
+
+  /* The sections of this file matched by indexed wild statements, or
+     NULL if the file has not been walked yet.  */
+  struct wild_file_index *wild_index;
 } lang_input_statement_type;
 
 typedef struct
@@ -380,6 +384,10 @@ struct lang_wild_statement_struct
   struct wildcard_list *handler_data[4];
   lang_section_bst_type *tree;
   struct flag_info *section_flag_list;
+
+  /* The number of this statement in the section name index, or zero
+     if it is not in the index.  */
+  unsigned int index_id;
 };
 
 struct any_statement_list {
@@ -144,6 +144,9 @@ enum option_values
   OPTION_PRINT_MEMORY_USAGE,
   OPTION_REQUIRE_DEFINED_SYMBOL,
   OPTION_ORPHAN_HANDLING,
+  OPTION_THREADS,
+  OPTION_NO_THREADS,
+  OPTION_THREAD_COUNT,
 };
 
 /* The initial parser states.  */
@@ -443,6 +443,26 @@ main (int argc, char **argv)
     check_nocrossrefs ();
   if (command_line.print_memory_usage)
     lang_print_memory_usage ();
+
+  /* The symbol table is freed when the output file is closed, so
+     report on it here.  */
+  if (config.stats)
+    {
+      struct bfd_hash_table_stats stats;
+      unsigned int i;
+
+      bfd_hash_table_stats (&link_info.hash->table, &stats);
+      fprintf (stderr, _("%s: symbol table: %u entries in %u slots, "
+			 "%u used, longest chain %u\n"),
+	       program_name, stats.count, stats.size, stats.used,
+	       stats.longest);
+      fprintf (stderr, _("%s: symbol table chain lengths:"), program_name);
+      for (i = 0; i < ARRAY_SIZE (stats.chains); i++)
+	fprintf (stderr, " %u%s:%u", i,
+		 i == ARRAY_SIZE (stats.chains) - 1 ? "+" : "",
+		 stats.chains[i]);
+      fprintf (stderr, "\n");
+    }
 #if 0
   {
     struct bfd_link_hash_entry *h;
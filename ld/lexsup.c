@@ -530,6 +530,14 @@ static const struct ld_option ld_options[] =
   { {"orphan-handling", required_argument, NULL, OPTION_ORPHAN_HANDLING},
     '\0', N_("=MODE"), N_("Control how orphan sections are handled."),
     TWO_DASHES },
+  { {"threads", no_argument, NULL, OPTION_THREADS},
+    '\0', NULL, N_("Relocate input files on multiple threads"), TWO_DASHES },
+  { {"no-threads", no_argument, NULL, OPTION_NO_THREADS},
+    '\0', NULL, N_("Relocate input files on one thread (default)"),
+    TWO_DASHES },
+  { {"thread-count", required_argument, NULL, OPTION_THREAD_COUNT},
+    '\0', N_("COUNT"), N_("Number of threads to use with --threads"),
+    TWO_DASHES },
 };
 
 #define OPTION_COUNT ARRAY_SIZE (ld_options)
@@ -1550,6 +1558,29 @@ parse_args (unsigned argc, char **argv)
 	    einfo (_("%P%F: invalid argument to option"
 		     " \"--orphan-handling\"\n"));
 	  break;
+
+	case OPTION_THREADS:
+#if BFD_SUPPORTS_THREADS
+	  command_line.threads = TRUE;
+#else
+	  einfo (_("%P: warning: this linker was built without thread"
+		   " support; --threads ignored\n"));
+#endif
+	  break;
+
+	case OPTION_NO_THREADS:
+	  command_line.threads = FALSE;
+	  break;
+
+	case OPTION_THREAD_COUNT:
+	  {
+	    char *end;
+
+	    command_line.thread_count = strtoul (optarg, &end, 0);
+	    if (*end != '\0' || command_line.thread_count == 0)
+	      einfo (_("%P%F: invalid number `%s'\n"), optarg);
+	  }
+	  break;
 	}
     }
 
@@ -1583,6 +1614,20 @@ parse_args (unsigned argc, char **argv)
       && command_line.check_section_addresses < 0)
     command_line.check_section_addresses = 0;
 
+  if (command_line.threads)
+    {
+      link_info.thread_count = command_line.thread_count;
+#ifdef _SC_NPROCESSORS_ONLN
+      if (link_info.thread_count == 0)
+	{
+	  long ncpus = sysconf (_SC_NPROCESSORS_ONLN);
+
+	  if (ncpus > 0)
+	    link_info.thread_count = ncpus;
+	}
+#endif
+    }
+
   /* We may have -Bsymbolic, -Bsymbolic-functions, --dynamic-list-data,
      --dynamic-list-cpp-new, --dynamic-list-cpp-typeinfo and
      --dynamic-list FILE.  -Bsymbolic and -Bsymbolic-functions are
@@ -0,0 +1,21 @@
+	.section .text.b,"ax"
+b:
+	.long 0
+	.section .text.a_unlikely,"ax"
+a_unlikely:
+	.long 0
+	.section .text.hot.h,"ax"
+hot_h:
+	.long 0
+	.text
+text:
+	.long 0
+	.section .text.unlikely,"ax"
+unlikely:
+	.long 0
+	.section .text.c,"ax"
+c:
+	.long 0
+	.section .text.hot,"ax"
+hot:
+	.long 0
@@ -0,0 +1,10 @@
+SECTIONS
+{
+  .text :
+  {
+    *(.text.unlikely .text.*_unlikely)
+    *(.text.hot .text.hot.*)
+    *(.text .text.*)
+  }
+  /DISCARD/ : { *(.*) }
+}